@@ -64,6 +64,10 @@ echo [VULKAN] kernel_vulkan_compute.c
 "%MSVC_CL%" %CFLAGS% /Foobj\retryix_kernel_vulkan_compute.obj src\kernel\retryix_kernel_vulkan_compute.c
 if %errorlevel% neq 0 goto :CLEANUP_ERROR
 
+echo [VULKAN] runtime_loader.c (shared Vulkan/CUDA/HIP loader)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_runtime_loader.obj src\utils\retryix_runtime_loader.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
 echo [MODULE] system_module.c
 "%MSVC_CL%" %CFLAGS% /Foobj\retryix_system_module.obj src\modules\retryix_system_module.c
 if %errorlevel% neq 0 goto :CLEANUP_ERROR
@@ -81,6 +85,30 @@ echo [EXTRA] retryix_control.c (6 control/query functions)
 "%MSVC_CL%" %CFLAGS% /Foobj\retryix_control.obj src\control\retryix_control.c
 if %errorlevel% neq 0 goto :CLEANUP_ERROR
 
+echo [EXTRA] retryix_zerocopy_pool.c (registered network buffer pool)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_zerocopy_pool.obj src\comm\retryix_zerocopy_pool.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_zerocopy_shm.c (local shared-memory transport)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_zerocopy_shm.obj src\comm\retryix_zerocopy_shm.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_zerocopy_tcp.c (TCP zero-copy transport)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_zerocopy_tcp.obj src\comm\retryix_zerocopy_tcp.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_zerocopy_perf.c (network perf probe)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_zerocopy_perf.obj src\comm\retryix_zerocopy_perf.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_zerocopy_stripe.c (multi-path striping)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_zerocopy_stripe.obj src\comm\retryix_zerocopy_stripe.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_comm.c (topic pub/sub)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_comm.obj src\comm\retryix_comm.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
 REM === 高級原子操作 (128/256-bit) ===
 echo [ADVANCED] atomic_advanced_module.c (14 high-level atomic ops: 128/256-bit)
 "%MSVC_CL%" %CFLAGS% /Foobj\retryix_atomic_advanced_module.obj src\modules\retryix_atomic_advanced_module.c
@@ -101,6 +129,30 @@ echo [TOPOLOGY EXT] retryix_topology_ext.c - 3 functions: network/audio/multimod
 "%MSVC_CL%" %CFLAGS% /Foobj\retryix_topology_ext.obj src\topology\retryix_topology_ext.c
 if %errorlevel% neq 0 goto :CLEANUP_ERROR
 
+echo [EXTRA] retryix_json_writer.c (streaming JSON/CBOR writer)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_json_writer.obj src\utils\retryix_json_writer.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_topology_cache.c (topology snapshot cache)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_topology_cache.obj src\topology\retryix_topology_cache.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_numa_topology.c (NUMA topology)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_numa_topology.obj src\topology\retryix_numa_topology.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_numa_alloc.c (NUMA placement)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_numa_alloc.obj src\topology\retryix_numa_alloc.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_numa_migrate.c (NUMA page migration)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_numa_migrate.obj src\topology\retryix_numa_migrate.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
+echo [EXTRA] retryix_mem_advise.c (memory advice / prefetch)
+"%MSVC_CL%" %CFLAGS% /Foobj\retryix_mem_advise.obj src\memory\retryix_mem_advise.c
+if %errorlevel% neq 0 goto :CLEANUP_ERROR
+
 REM === GPU 硬體控制層 - Layer 0 寄存器級別控制 ===
 echo [GPU HW] retryix_gpu_hw_windows.c - GPU register-level control with WinRing0
 "%MSVC_CL%" %CFLAGS% /Foobj\retryix_gpu_hw_windows.obj src\device\retryix_gpu_hw_windows.c
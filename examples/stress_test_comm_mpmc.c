@@ -0,0 +1,233 @@
+/*
+ * stress_test_comm_mpmc.c
+ * comm_send_n / comm_recv_n 多生產者多消費者壓力測試
+ *
+ * 多個生產者線程以隨機批次大小送出帶 (生產者, 序號) 的封包,
+ * 多個消費者線程以 comm_recv_n 批次取出, 最後檢查每則訊息恰好收到一次且內容完整。
+ * 依序測試本行程佇列與同名共享通道; 指定參數時只測該通道名稱:
+ *   stress_test_comm_mpmc [channel_name]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_host_comm.h"
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE test_thread_t;
+#define TEST_ADD(p, v)      InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v))
+#define TEST_LOAD(p)        InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+#define TEST_YIELD()        SwitchToThread()
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+typedef pthread_t test_thread_t;
+#define TEST_ADD(p, v)      __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define TEST_LOAD(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define TEST_YIELD()        sched_yield()
+#endif
+
+#define PRODUCERS           4
+#define CONSUMERS           4
+#define MSGS_PER_PRODUCER   50000
+#define MAX_BATCH           16
+#define QUEUE_CAPACITY      256
+#define TOTAL_MSGS          (PRODUCERS * MSGS_PER_PRODUCER)
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+} msg_id_t;
+
+static volatile int32_t g_seen[PRODUCERS][MSGS_PER_PRODUCER];
+static volatile int32_t g_received = 0;
+static volatile int32_t g_corrupt = 0;
+static volatile int32_t g_out_of_range = 0;
+
+/* 負載長度與內容都由 (producer, seq) 決定, 接收端可逐位元組驗證 */
+static int payload_length(uint32_t producer, uint32_t seq) {
+    return (int)sizeof(msg_id_t) + (int)((producer * 131u + seq * 7u) % (sizeof(((comm_packet_t*)0)->data) - sizeof(msg_id_t) + 1));
+}
+
+static char payload_byte(uint32_t producer, uint32_t seq, int i) {
+    return (char)((producer * 31u + seq + (uint32_t)i) & 0xFF);
+}
+
+static void fill_packet(comm_packet_t* p, uint32_t producer, uint32_t seq) {
+    msg_id_t id = { producer, seq };
+    memcpy(p->data, &id, sizeof(id));
+    p->length = payload_length(producer, seq);
+    for (int i = (int)sizeof(id); i < p->length; i++) p->data[i] = payload_byte(producer, seq, i);
+    p->type = (int)producer;
+}
+
+static int check_packet(const comm_packet_t* p) {
+    msg_id_t id;
+    if (p->length < (int)sizeof(id)) return 0;
+    memcpy(&id, p->data, sizeof(id));
+    if (id.producer >= PRODUCERS || id.seq >= MSGS_PER_PRODUCER) {
+        TEST_ADD(&g_out_of_range, 1);
+        return 0;
+    }
+    if (p->type != (int)id.producer || p->length != payload_length(id.producer, id.seq)) return 0;
+    for (int i = (int)sizeof(id); i < p->length; i++) {
+        if (p->data[i] != payload_byte(id.producer, id.seq, i)) return 0;
+    }
+    TEST_ADD(&g_seen[id.producer][id.seq], 1);
+    return 1;
+}
+
+static void producer_body(uint32_t producer) {
+    comm_packet_t batch[MAX_BATCH];
+    uint32_t rng = producer * 2654435761u + 1u;
+    uint32_t seq = 0;
+    while (seq < MSGS_PER_PRODUCER) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        uint32_t n = 1 + rng % MAX_BATCH;
+        if (n > MSGS_PER_PRODUCER - seq) n = MSGS_PER_PRODUCER - seq;
+        for (uint32_t i = 0; i < n; i++) fill_packet(&batch[i], producer, seq + i);
+
+        /* 佇列滿時只送出前段, 剩餘的重試 */
+        size_t sent = 0;
+        while (sent < n) {
+            size_t k = comm_send_n(batch + sent, n - sent);
+            if (k == 0) TEST_YIELD();
+            sent += k;
+        }
+        seq += n;
+    }
+}
+
+static void consumer_body(uint32_t consumer) {
+    comm_packet_t batch[MAX_BATCH];
+    size_t want = 1 + consumer % MAX_BATCH;
+    while (TEST_LOAD(&g_received) < TOTAL_MSGS) {
+        size_t n = comm_recv_n(batch, want);
+        if (n == 0) {
+            TEST_YIELD();
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!check_packet(&batch[i])) TEST_ADD(&g_corrupt, 1);
+        }
+        TEST_ADD(&g_received, (int32_t)n);
+        want = want % MAX_BATCH + 1;
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI producer_thread(LPVOID arg) { producer_body((uint32_t)(uintptr_t)arg); return 0; }
+static DWORD WINAPI consumer_thread(LPVOID arg) { consumer_body((uint32_t)(uintptr_t)arg); return 0; }
+
+static int thread_start(test_thread_t* t, LPTHREAD_START_ROUTINE fn, uint32_t index) {
+    *t = CreateThread(NULL, 0, fn, (LPVOID)(uintptr_t)index, 0, NULL);
+    return *t != NULL;
+}
+
+static void thread_join(test_thread_t t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+#else
+static void* producer_thread(void* arg) { producer_body((uint32_t)(uintptr_t)arg); return NULL; }
+static void* consumer_thread(void* arg) { consumer_body((uint32_t)(uintptr_t)arg); return NULL; }
+
+static int thread_start(test_thread_t* t, void* (*fn)(void*), uint32_t index) {
+    return pthread_create(t, NULL, fn, (void*)(uintptr_t)index) == 0;
+}
+
+static void thread_join(test_thread_t t) {
+    pthread_join(t, NULL);
+}
+#endif
+
+static int run_mpmc(const char* channel_name) {
+    printf("\n=== MPMC: %d producers x %d consumers, %d messages, channel %s ===\n",
+           PRODUCERS, CONSUMERS, TOTAL_MSGS, channel_name ? channel_name : "(process-local)");
+
+    memset((void*)g_seen, 0, sizeof(g_seen));
+    g_received = 0;
+    g_corrupt = 0;
+    g_out_of_range = 0;
+
+    if (comm_init_ex(channel_name, QUEUE_CAPACITY) != COMM_SUCCESS) {
+        printf("  comm_init_ex failed\n");
+        return 0;
+    }
+
+    /* 共享通道可能殘留前次執行的訊息, 先清空 */
+    comm_packet_t drain[MAX_BATCH];
+    while (comm_recv_n(drain, MAX_BATCH) > 0) {}
+
+    test_thread_t producers[PRODUCERS];
+    test_thread_t consumers[CONSUMERS];
+    int started_p = 0, started_c = 0;
+    for (uint32_t i = 0; i < CONSUMERS; i++) {
+        if (!thread_start(&consumers[i], consumer_thread, i)) break;
+        started_c++;
+    }
+    for (uint32_t i = 0; i < PRODUCERS; i++) {
+        if (!thread_start(&producers[i], producer_thread, i)) break;
+        started_p++;
+    }
+    if (started_p != PRODUCERS || started_c != CONSUMERS) {
+        printf("  thread creation failed\n");
+        /* 讓已啟動的消費者結束 */
+        TEST_ADD(&g_received, TOTAL_MSGS);
+    }
+    for (int i = 0; i < started_p; i++) thread_join(producers[i]);
+    for (int i = 0; i < started_c; i++) thread_join(consumers[i]);
+    if (started_p != PRODUCERS || started_c != CONSUMERS) {
+        comm_cleanup();
+        return 0;
+    }
+
+    size_t leftover = comm_recv_n(drain, MAX_BATCH);
+    comm_cleanup();
+
+    int missing = 0, duplicated = 0;
+    for (int p = 0; p < PRODUCERS; p++) {
+        for (int s = 0; s < MSGS_PER_PRODUCER; s++) {
+            if (g_seen[p][s] == 0) missing++;
+            else if (g_seen[p][s] > 1) duplicated++;
+        }
+    }
+
+    printf("  Received:     %d\n", (int)g_received);
+    printf("  Missing:      %d\n", missing);
+    printf("  Duplicated:   %d\n", duplicated);
+    printf("  Corrupted:    %d (out of range ids: %d)\n", (int)g_corrupt, (int)g_out_of_range);
+    printf("  Leftover:     %zu\n", leftover);
+
+    int pass = g_received == TOTAL_MSGS && missing == 0 && duplicated == 0 && g_corrupt == 0 && leftover == 0;
+    printf("  Test: %s\n", pass ? "PASS (every message delivered exactly once)" : "FAIL");
+    return pass;
+}
+
+int main(int argc, char** argv) {
+    printf("RetryIX comm_send_n / comm_recv_n MPMC stress test\n");
+
+    int passed = 0, total = 0;
+    if (argc > 1) {
+        total++;
+        passed += run_mpmc(argv[1]);
+    } else {
+        char name[64];
+#ifdef _WIN32
+        snprintf(name, sizeof(name), "retryix_mpmc_test_%lu", (unsigned long)GetCurrentProcessId());
+#else
+        snprintf(name, sizeof(name), "retryix_mpmc_test_%ld", (long)getpid());
+#endif
+        total += 2;
+        passed += run_mpmc(NULL);
+        passed += run_mpmc(name);
+    }
+
+    printf("\n%d / %d tests passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
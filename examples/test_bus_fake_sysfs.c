@@ -0,0 +1,215 @@
+/*
+ * test_bus_fake_sysfs.c
+ * retryix_bus_set_sysfs_root 假 sysfs 目錄樹測試 (Linux)
+ *
+ * 在暫存目錄下建立 <root>/bus/pci/devices/... 的假目錄樹:
+ *   0000:01:00.0  NVMe, 鏈路降速 (8 / 16 GT/s) 且降寬 (x2 / x4), 無 nvme 子目錄
+ *   0000:02:00.0  NVMe, Gen4 x4, nvme0 (型號 / 佇列 / hwmon 溫度), 插槽 3
+ *   0000:00:02.0  顯示卡, 應被忽略
+ * 檢查列舉結果, 再模擬熱插拔 (移除 01:00.0, 新增 03:00.0) 與升溫後以 retryix_bus_refresh 重讀。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_bus_scheduler.h"
+
+#ifdef _WIN32
+
+int main() {
+    printf("test_bus_fake_sysfs: sysfs 僅適用於 Linux, 略過\n");
+    return 0;
+}
+
+#else
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+static char g_root[256];
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { g_failures++; printf("  FAIL: " __VA_ARGS__); printf("\n"); } \
+} while (0)
+
+/* 建立 <root>/<rel> 及其上層目錄 */
+static void make_dirs(const char* rel) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", g_root, rel);
+    for (char* p = path + strlen(g_root) + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        mkdir(path, 0755);
+        *p = '/';
+    }
+    mkdir(path, 0755);
+}
+
+static void write_attr(const char* bdf, const char* attr, const char* value) {
+    char rel[256];
+    snprintf(rel, sizeof(rel), "bus/pci/devices/%s/%s", bdf, attr);
+    char* slash = strrchr(rel, '/');
+    *slash = '\0';
+    make_dirs(rel);
+    *slash = '/';
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", g_root, rel);
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        printf("  cannot create %s\n", path);
+        g_failures++;
+        return;
+    }
+    fprintf(f, "%s\n", value);
+    fclose(f);
+}
+
+static void add_device(const char* bdf, const char* cls, const char* speed, const char* max_speed,
+                       const char* width, const char* max_width) {
+    write_attr(bdf, "class", cls);
+    write_attr(bdf, "vendor", "0x144d");
+    write_attr(bdf, "device", "0xa80a");
+    write_attr(bdf, "current_link_speed", speed);
+    write_attr(bdf, "max_link_speed", max_speed);
+    write_attr(bdf, "current_link_width", width);
+    write_attr(bdf, "max_link_width", max_width);
+}
+
+static void remove_tree(const char* path) {
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", path);
+    if (system(cmd) != 0) printf("  warning: cannot remove %s\n", path);
+}
+
+static void build_tree(void) {
+    add_device("0000:01:00.0", "0x010802", "8.0 GT/s PCIe", "16.0 GT/s PCIe", "2", "4");
+
+    add_device("0000:02:00.0", "0x010802", "16.0 GT/s PCIe", "16.0 GT/s PCIe", "4", "4");
+    write_attr("0000:02:00.0", "nvme/nvme0/model", "Samsung SSD 990 PRO 2TB");
+    write_attr("0000:02:00.0", "nvme/nvme0/queue_count", "9");
+    write_attr("0000:02:00.0", "nvme/nvme0/sqsize", "1023");
+    write_attr("0000:02:00.0", "nvme/nvme0/hwmon/hwmon3/temp1_input", "45850");
+    write_attr("0000:02:00.0", "nvme/nvme0/hwmon/hwmon3/temp1_max", "81850");
+
+    add_device("0000:00:02.0", "0x030000", "2.5 GT/s PCIe", "2.5 GT/s PCIe", "16", "16");
+
+    make_dirs("bus/pci/slots/3");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bus/pci/slots/3/address", g_root);
+    FILE* f = fopen(path, "w");
+    if (f) {
+        fprintf(f, "0000:02:00\n");
+        fclose(f);
+    }
+}
+
+static int enumerate(retryix_bus_info_t* controllers, int capacity) {
+    int count = capacity;
+    retryix_bus_result_t rc = retryix_bus_enumerate_controllers(controllers, &count);
+    if (rc != RETRYIX_BUS_SUCCESS) {
+        printf("  enumerate failed: %d\n", (int)rc);
+        return -1;
+    }
+    return count;
+}
+
+static void test_initial_scan(void) {
+    printf("\n=== 初次列舉 ===\n");
+    retryix_bus_info_t c[8];
+    int count = enumerate(c, 8);
+    CHECK(count == 2, "expected 2 NVMe controllers, got %d", count);
+    if (count != 2) return;
+
+    /* 依 PCI 位址排序 */
+    CHECK(strstr(c[0].device_name, "0000:01:00.0") != NULL, "controller 0 is %s", c[0].device_name);
+    CHECK(strstr(c[1].device_name, "0000:02:00.0") != NULL, "controller 1 is %s", c[1].device_name);
+    CHECK(c[0].controller_id == 0 && c[1].controller_id == 1, "controller ids %d %d", c[0].controller_id, c[1].controller_id);
+
+    /* 01:00.0: 降速降寬, 無 NVMe 屬性時使用預設佇列深度 */
+    CHECK(c[0].configured_lanes == 2 && c[0].max_lanes == 4, "01:00.0 lanes %d / %d", c[0].configured_lanes, c[0].max_lanes);
+    CHECK(c[0].generation == RETRYIX_NVME_GEN3, "01:00.0 generation %d", c[0].generation);
+    CHECK(c[0].power_limit_active, "01:00.0 should report a downgraded link speed");
+    CHECK(c[0].motherboard_limitation, "01:00.0 should report a narrowed link");
+    CHECK(c[0].pcie_slot_number == -1, "01:00.0 slot %d", c[0].pcie_slot_number);
+    CHECK(strcmp(c[0].model_name, "PCI 144d:a80a") == 0, "01:00.0 model '%s'", c[0].model_name);
+
+    /* 02:00.0: 完整 NVMe 屬性 */
+    CHECK(strcmp(c[1].vendor_id, "144d") == 0 && strcmp(c[1].device_id, "a80a") == 0,
+          "02:00.0 ids %s:%s", c[1].vendor_id, c[1].device_id);
+    CHECK(strcmp(c[1].model_name, "Samsung SSD 990 PRO 2TB") == 0, "02:00.0 model '%s'", c[1].model_name);
+    CHECK(strncmp(c[1].device_name, "nvme0 ", 6) == 0, "02:00.0 name '%s'", c[1].device_name);
+    CHECK(c[1].configured_lanes == 4 && c[1].max_lanes == 4, "02:00.0 lanes %d / %d", c[1].configured_lanes, c[1].max_lanes);
+    CHECK(c[1].generation == RETRYIX_NVME_GEN4, "02:00.0 generation %d", c[1].generation);
+    CHECK(!c[1].power_limit_active && !c[1].motherboard_limitation, "02:00.0 should run at full link");
+    CHECK(c[1].pcie_slot_number == 3, "02:00.0 slot %d", c[1].pcie_slot_number);
+    CHECK(c[1].queue_depth == 1024, "02:00.0 queue depth %d", c[1].queue_depth);
+    CHECK(strstr(c[1].thermal_info, "45.9") != NULL, "02:00.0 thermal '%s'", c[1].thermal_info);
+    CHECK(!c[1].thermal_throttling, "02:00.0 should not be throttling at 45.9 C");
+    CHECK(c[1].theoretical_bandwidth_gbps > c[0].theoretical_bandwidth_gbps,
+          "Gen4 x4 (%.2f) should beat Gen3 x2 (%.2f)", c[1].theoretical_bandwidth_gbps, c[0].theoretical_bandwidth_gbps);
+
+    retryix_bus_info_t best;
+    CHECK(retryix_bus_get_optimal_config(&best) == RETRYIX_BUS_SUCCESS && strstr(best.device_name, "0000:02:00.0") != NULL,
+          "optimal controller should be 02:00.0");
+}
+
+static void test_refresh(void) {
+    printf("\n=== 熱插拔與重新整理 ===\n");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bus/pci/devices/0000:01:00.0", g_root);
+    remove_tree(path);
+    add_device("0000:03:00.0", "0x010802", "32.0 GT/s PCIe", "32.0 GT/s PCIe", "4", "4");
+    write_attr("0000:02:00.0", "nvme/nvme0/hwmon/hwmon3/temp1_input", "79000");
+
+    CHECK(retryix_bus_refresh() == RETRYIX_BUS_SUCCESS, "refresh failed");
+    retryix_bus_info_t c[8];
+    int count = enumerate(c, 8);
+    CHECK(count == 2, "expected 2 controllers after hotplug, got %d", count);
+    if (count != 2) return;
+    CHECK(strstr(c[0].device_name, "0000:02:00.0") != NULL, "controller 0 is %s", c[0].device_name);
+    CHECK(strstr(c[1].device_name, "0000:03:00.0") != NULL, "controller 1 is %s", c[1].device_name);
+    CHECK(c[0].controller_id == 0 && c[1].controller_id == 1, "controller ids %d %d", c[0].controller_id, c[1].controller_id);
+    CHECK(c[0].thermal_throttling, "02:00.0 should be throttling at 79 C (max 81.85 C)");
+    CHECK(c[1].generation == RETRYIX_NVME_GEN5, "03:00.0 generation %d", c[1].generation);
+}
+
+static void test_missing_root(void) {
+    printf("\n=== 不存在的根目錄 ===\n");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/does-not-exist", g_root);
+    CHECK(retryix_bus_set_sysfs_root(path) == RETRYIX_BUS_SUCCESS, "set_sysfs_root failed");
+    retryix_bus_info_t c[8];
+    int count = 8;
+    CHECK(retryix_bus_enumerate_controllers(c, &count) != RETRYIX_BUS_SUCCESS, "enumeration should fail without a sysfs tree");
+}
+
+int main() {
+    printf("RetryIX bus scheduler fake sysfs test\n");
+
+    snprintf(g_root, sizeof(g_root), "/tmp/retryix_sysfs_XXXXXX");
+    if (!mkdtemp(g_root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    build_tree();
+
+    if (retryix_bus_set_sysfs_root(g_root) != RETRYIX_BUS_SUCCESS) {
+        printf("retryix_bus_set_sysfs_root failed\n");
+        remove_tree(g_root);
+        return 1;
+    }
+    test_initial_scan();
+    test_refresh();
+    test_missing_root();
+
+    retryix_bus_set_sysfs_root(NULL);
+    retryix_bus_scheduler_cleanup();
+    remove_tree(g_root);
+
+    printf("\nTest: %s (%d failures)\n", g_failures == 0 ? "PASS" : "FAIL", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * retryix_atomic_internal.h
+ * 平台原子操作 (內部共用, 不對外導出)
+ *
+ * 統一的記憶體序: 載入為 acquire, 存儲為 release,
+ * 讀改寫 (ADD / CAS / XCHG) 與 RX_FENCE 為完整屏障.
+ * 32 / 64 位元版本按欄位寬度選用; Windows 上以 LONG / LONG64 實作.
+ */
+
+#ifndef RETRYIX_ATOMIC_INTERNAL_H
+#define RETRYIX_ATOMIC_INTERNAL_H
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define RX_THREAD_LOCAL __declspec(thread)
+#define RX_LOAD32(p) ((uint32_t)ReadAcquire((volatile LONG*)(p)))
+#define RX_STORE32(p, v) WriteRelease((volatile LONG*)(p), (LONG)(v))
+#define RX_ADD32(p, v) ((uint32_t)InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v)))
+#define RX_CAS32(p, o, n) \
+    (InterlockedCompareExchange((volatile LONG*)(p), (LONG)(n), (LONG)(o)) == (LONG)(o))
+#define RX_LOAD64(p) ((uint64_t)ReadAcquire64((volatile LONG64*)(p)))
+#define RX_STORE64(p, v) WriteRelease64((volatile LONG64*)(p), (LONG64)(v))
+#define RX_ADD64(p, v) ((uint64_t)InterlockedExchangeAdd64((volatile LONG64*)(p), (LONG64)(v)))
+#define RX_CAS64(p, o, n) \
+    (InterlockedCompareExchange64((volatile LONG64*)(p), (LONG64)(n), (LONG64)(o)) == (LONG64)(o))
+#define RX_XCHG64(p, v) ((uint64_t)InterlockedExchange64((volatile LONG64*)(p), (LONG64)(v)))
+#define RX_LOADP(p) ReadPointerAcquire((PVOID volatile*)(p))
+#define RX_STOREP(p, v) WritePointerRelease((PVOID volatile*)(p), (PVOID)(v))
+#define RX_FENCE() MemoryBarrier()
+#define RX_CPU_RELAX() YieldProcessor()
+#define RX_YIELD() SwitchToThread()
+#else
+#include <sched.h>
+#define RX_THREAD_LOCAL __thread
+#define RX_LOAD32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RX_STORE32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RX_ADD32(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define RX_CAS32(p, o, n) __sync_bool_compare_and_swap((p), (o), (n))
+#define RX_LOAD64(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RX_STORE64(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RX_ADD64(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define RX_CAS64(p, o, n) __sync_bool_compare_and_swap((p), (o), (n))
+#define RX_XCHG64(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define RX_LOADP(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RX_STOREP(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RX_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#if defined(__x86_64__) || defined(__i386__)
+#define RX_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define RX_CPU_RELAX() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+#define RX_YIELD() sched_yield()
+#endif
+
+#endif // RETRYIX_ATOMIC_INTERNAL_H
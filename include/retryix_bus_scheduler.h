@@ -74,6 +74,7 @@ typedef struct {
     float actual_bandwidth_gbps;           ///< 實際可用帶寬 (GB/s)
     float peak_measured_bandwidth_gbps;    ///< 實測峰值帶寬 (GB/s)
     int queue_depth;                       ///< NVMe隊列深度
+    int measured_queue_depth;              ///< 實測拐點深度 (達峰值 95% 的最小 QD; 0 = 尚未量測)
 
     // === 限制狀態標誌 ===
     bool power_limit_active;               ///< 電源管理限制啟用
@@ -97,6 +98,120 @@ typedef struct {
 
 } retryix_bus_info_t;
 
+/**
+ * 基準測試參數
+ */
+typedef struct {
+    const char* path;                      ///< 檔案或區塊裝置; NULL = 控制器的第一個命名空間
+    int queue_depth;                       ///< 同時在途的請求數 (1..256)
+    unsigned int block_size;               ///< 每筆讀取大小 (位元組, 4 KB 對齊); 0 = 循序 128 KB / 隨機 4 KB
+    bool random;                           ///< 隨機讀取 (否則循序)
+    unsigned long long test_bytes;         ///< 讀取總量; 0 = 256 MB, 超過檔案大小時以檔案大小為限 (循序)
+} retryix_bus_benchmark_config_t;
+
+/**
+ * 基準測試結果
+ */
+typedef struct {
+    double bandwidth_gbps;                 ///< GB/s
+    double iops;
+    double latency_avg_us;                 ///< 單筆請求由提交到完成
+    double latency_p50_us;
+    double latency_p90_us;
+    double latency_p99_us;
+    double latency_p999_us;
+    double latency_max_us;
+    unsigned long long bytes;
+    unsigned long long ios;
+    unsigned long long errors;
+    int queue_depth;
+    unsigned int block_size;
+    bool direct_io;                        ///< 以 O_DIRECT 繞過頁快取 (否則結果包含快取命中)
+    bool kernel_async;                     ///< 使用核心 io_uring (否則為同步讀取, 實際深度 1)
+} retryix_bus_benchmark_result_t;
+
+/**
+ * 串流讀取器 (不透明)
+ */
+typedef struct retryix_bus_stream retryix_bus_stream_t;
+
+/**
+ * 串流讀取參數
+ */
+typedef struct {
+    const char* path;                      ///< 檔案或區塊裝置
+    int controller_id;                     ///< 決定佇列深度的控制器; -1 = 依檔案所在裝置自動判斷
+    size_t chunk_size;                     ///< 每塊大小 (4 KB 對齊); 0 = 8 MB
+    int chunk_count;                       ///< 輪替的緩衝塊數 (2..16); 0 = 2 (雙緩衝)
+    unsigned long long offset;             ///< 起始位置 (位元組)
+    unsigned long long length;             ///< 讀取長度; 0 = 讀到檔尾
+} retryix_bus_stream_config_t;
+
+/**
+ * 已讀好的一塊資料
+ */
+typedef struct {
+    void* data;                            ///< 位於串流的頁對齊緩衝區, 可直接交給核心
+    size_t bytes;                          ///< 有效位元組; 0 表示已讀完
+    unsigned long long file_offset;        ///< data[0] 在檔案中的位置
+    int sequence;                          ///< 塊序號 (從 0 起)
+    int buffer_index;                      ///< 所在緩衝塊, 交還時使用
+} retryix_bus_stream_chunk_t;
+
+/**
+ * 串流讀取統計
+ */
+typedef struct {
+    unsigned long long bytes_delivered;
+    unsigned long long chunks_delivered;
+    double stall_us;                       ///< 呼叫端在 next 中等待 I/O 的累計時間
+    double bandwidth_gbps;                 ///< 開啟到目前的平均速率
+    int queue_depth;                       ///< 同時在途的讀取數
+    unsigned int io_size;                  ///< 每筆讀取大小
+    int controller_id;                     ///< 實際採用的控制器; -1 = 未對應到控制器
+    bool direct_io;                        ///< 以 O_DIRECT 繞過頁快取
+    bool kernel_async;                     ///< 使用核心 io_uring (否則讀取在 next 內同步完成)
+    bool fixed_buffers;                    ///< 緩衝塊已向核心註冊 (受 memlock 限制)
+    bool mapped_region;                    ///< 緩衝塊為 2MB 對齊的獨立映射區 (否則為頁對齊的主機記憶體)
+} retryix_bus_stream_stats_t;
+
+#define RETRYIX_BUS_MAX_STRIPE_SOURCES 16
+
+/**
+ * 分散讀取的資料來源 (同一份資料在不同控制器上的副本)
+ */
+typedef struct {
+    const char* path;                      ///< 檔案或區塊裝置
+    int controller_id;                     ///< -1 = 依檔案所在裝置自動判斷
+} retryix_bus_stripe_source_t;
+
+/**
+ * 分散讀取中單一裝置的統計
+ */
+typedef struct {
+    int controller_id;                     ///< -1 = 未對應到控制器
+    double weight;                         ///< 初始分配比例 (0..1)
+    double bandwidth_gbps;                 ///< 實際讀取速率
+    unsigned long long bytes;              ///< 由此裝置讀取的位元組
+    unsigned long long stolen_bytes;       ///< 其中從其他裝置接手的位元組
+    unsigned long long peak_inflight_bytes; ///< 最高在途位元組
+    unsigned long long errors;
+    int queue_depth;
+    bool direct_io;
+    bool throttled;                        ///< 讀取期間曾出現熱節流或電源限制
+} retryix_bus_stripe_device_stats_t;
+
+/**
+ * 分散讀取結果
+ */
+typedef struct {
+    double bandwidth_gbps;                 ///< 整體速率
+    double elapsed_ms;
+    unsigned long long bytes;
+    int device_count;
+    retryix_bus_stripe_device_stats_t devices[RETRYIX_BUS_MAX_STRIPE_SOURCES];
+} retryix_bus_stripe_result_t;
+
 /**
  * 優化配置建議結構體
  */
@@ -177,10 +292,123 @@ retryix_bus_get_optimization_suggestions(int controller_id, retryix_bus_optimiza
  * @return 操作結果碼
  *
  * 對指定控制器執行實際帶寬測試，驗證理論值與實際性能的差異。
+ * 循序讀取依 QD1、4、16、64、256 各測一次，取最高帶寬寫入
+ * peak_measured_bandwidth_gbps，達到峰值 95% 的最小深度寫入 measured_queue_depth
+ * (queue_depth 保留硬體佇列深度)；
+ * 另以 4 KB 隨機讀取 QD1 量測 average_latency_us。
  */
 RETRYIX_API retryix_bus_result_t RETRYIX_CALL
 retryix_bus_benchmark_bandwidth(int controller_id, int test_size_mb, float* measured_bandwidth);
 
+/**
+ * @brief 執行單一配置的讀取基準測試
+ * @param controller_id 控制器ID (config->path 為 NULL 時使用其裝置節點)
+ * @param config 測試參數
+ * @param result 輸出測試結果
+ * @return 操作結果碼
+ *
+ * 以 O_DIRECT 開啟 (檔案系統不支援時退回一般 I/O)，以 io_uring 維持固定佇列深度，
+ * 記錄每筆請求延遲的百分位數。只讀取，不寫入。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_benchmark_run(int controller_id, const retryix_bus_benchmark_config_t* config,
+                          retryix_bus_benchmark_result_t* result);
+
+/**
+ * @brief 取得控制器第一個命名空間的裝置節點
+ * @param controller_id 控制器ID
+ * @param path 輸出路徑 (如 /dev/nvme0n1；假 sysfs 根目錄下為 <root>/dev/nvme0n1)
+ * @param path_size 緩衝區大小
+ * @return 操作結果碼
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_get_device_path(int controller_id, char* path, size_t path_size);
+
+/**
+ * @brief 找出檔案或區塊裝置所在的控制器
+ * @param path 檔案或裝置節點
+ * @param controller_id 輸出控制器ID
+ * @return 操作結果碼 (不在任何 NVMe 控制器上時為 RETRYIX_BUS_ERROR_NO_CONTROLLERS)
+ *
+ * 以所在裝置的 major:minor 查 <sysfs>/dev/block，比對其 PCI 路徑。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_find_controller_for_path(const char* path, int* controller_id);
+
+/**
+ * @brief 從多個控制器分散讀取同一段資料
+ * @param sources 資料來源 (每個來源都有完整副本)
+ * @param source_count 來源數 (1..RETRYIX_BUS_MAX_STRIPE_SOURCES)
+ * @param offset 起始位置 (4 KB 對齊)
+ * @param dest 目的緩衝區 (4 KB 對齊)
+ * @param length 讀取長度
+ * @param unit_size 工作單位 (4 KB 對齊); 0 = 1 MB
+ * @param result 輸出統計 (可為 NULL)
+ * @return 操作結果碼
+ *
+ * retryix_bus_get_optimal_config 只挑一個控制器；此函數依各控制器的實測帶寬
+ * (未測時用鏈路帶寬) 把範圍切成連續分片，每個裝置一個執行緒與自己的 io_uring 佇列，
+ * 佇列深度取自其 retryix_bus_info_t。分片讀完的裝置從預估完成時間最晚的裝置尾端
+ * 依速率比例接手剩餘單位；讀取期間定期檢查熱節流與電源限制，受限裝置的佇列深度減半，
+ * 其剩餘工作也會被接手。整體速率趨近各裝置速率之和。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_striped_read(const retryix_bus_stripe_source_t* sources, int source_count,
+                         unsigned long long offset, void* dest, size_t length, size_t unit_size,
+                         retryix_bus_stripe_result_t* result);
+
+// ===================== 串流讀取API =====================
+
+/**
+ * @brief 開啟串流讀取器
+ * @param config 讀取參數
+ * @param stream 輸出讀取器
+ * @return 操作結果碼
+ *
+ * 以 O_DIRECT + io_uring 將檔案依序讀入對齊的 SVM 緩衝塊，取代 fread + memcpy。
+ * 開啟後立即對所有緩衝塊發出讀取；佇列深度取自控制器的 retryix_bus_info_t
+ * (已跑過基準測試時用實測深度，否則依帶寬與延遲估算)。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_stream_open(const retryix_bus_stream_config_t* config, retryix_bus_stream_t** stream);
+
+/**
+ * @brief 取得下一塊資料
+ * @param stream 讀取器
+ * @param chunk 輸出資料塊 (bytes 為 0 表示已讀完)
+ * @return 操作結果碼
+ *
+ * 依序交付，必要時等待該塊讀完。資料塊在交還前保持有效，
+ * 其他緩衝塊同時繼續讀取：核心處理第 k 塊時第 k+1 塊已在途。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_stream_next(retryix_bus_stream_t* stream, retryix_bus_stream_chunk_t* chunk);
+
+/**
+ * @brief 交還資料塊
+ * @param stream 讀取器
+ * @param chunk 由 retryix_bus_stream_next 取得的資料塊
+ * @return 操作結果碼
+ *
+ * 緩衝塊立即用於讀取後續資料；交還後不可再存取 chunk->data。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_stream_release(retryix_bus_stream_t* stream, const retryix_bus_stream_chunk_t* chunk);
+
+/**
+ * @brief 取得串流讀取統計
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_stream_get_stats(const retryix_bus_stream_t* stream, retryix_bus_stream_stats_t* stats);
+
+/**
+ * @brief 關閉串流讀取器
+ * @param stream 讀取器 (等待在途讀取結束後釋放緩衝塊)
+ * @return 操作結果碼
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_stream_close(retryix_bus_stream_t* stream);
+
 /**
  * @brief 設置性能模式
  * @param controller_id 控制器ID
@@ -214,6 +442,27 @@ retryix_bus_monitor_status(int controller_id, retryix_bus_info_t* status);
 RETRYIX_API retryix_bus_result_t RETRYIX_CALL
 retryix_bus_scheduler_cleanup(void);
 
+/**
+ * @brief 設定 sysfs 根目錄 (Linux)
+ * @param root 根目錄, NULL 或空字串恢復預設 "/sys"
+ * @return 操作結果碼
+ *
+ * 測試可指向假的目錄樹 (<root>/bus/pci/devices/...); 會清除控制器快取，
+ * 下次查詢時重新列舉。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_set_sysfs_root(const char* root);
+
+/**
+ * @brief 立即重新讀取控制器狀態
+ * @return 操作結果碼
+ *
+ * 控制器資料會快取，查詢時超過 1 秒才增量更新 (只重讀鏈路、佇列與溫度，
+ * 並增刪熱插拔的裝置)；需要立即反映變化時呼叫此函數。
+ */
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL
+retryix_bus_refresh(void);
+
 // ===================== 工具函數 =====================
 
 /**
@@ -249,4 +498,4 @@ retryix_bus_format_controller_info(const retryix_bus_info_t* info,
 }
 #endif
 
-#endif /* RETRYIX_BUS_SCHEDULER_H */
\ No newline at end of file
+#endif /* RETRYIX_BUS_SCHEDULER_H */
\ No newline at end of file
@@ -0,0 +1,101 @@
+/*
+ * retryix_bus_uring_internal.h
+ * 精簡 io_uring 封裝 (模組間共用, 不對外導出)
+ * 直接以系統呼叫建立環, 不依賴 liburing; 核心不支援或被禁用時 (以及 Windows)
+ * 自動改為同步 pread 模擬, 呼叫端不需區分
+ */
+
+#ifndef RETRYIX_BUS_URING_INTERNAL_H
+#define RETRYIX_BUS_URING_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "retryix_bus_scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RETRYIX_URING_MAX_ENTRIES 256
+
+typedef struct {
+    uint64_t user_data;
+    int32_t res;                          ///< 讀取位元組數或 -errno
+} retryix_uring_cqe_t;
+
+typedef struct {
+    int fd;
+    void* buf;
+    uint32_t len;
+    uint64_t offset;
+    uint64_t user_data;
+} retryix_uring_emul_op_t;
+
+typedef struct {
+    bool kernel;                          ///< true = 核心 io_uring; false = 同步模擬
+    bool fixed_buffers;                   ///< 已註冊固定緩衝區
+    unsigned entries;
+    unsigned pending;                     ///< 已準備尚未提交
+    unsigned inflight;                    ///< 已提交尚未取回
+    // 核心環
+    int ring_fd;
+    void* sq_map;
+    size_t sq_map_size;
+    void* cq_map;
+    size_t cq_map_size;
+    void* sqes;
+    size_t sqes_size;
+    volatile uint32_t* sq_head;
+    volatile uint32_t* sq_tail;
+    uint32_t sq_tail_local;               ///< 已準備到的位置, 提交時才發佈給核心
+    uint32_t sq_mask;
+    uint32_t* sq_array;
+    volatile uint32_t* cq_head;
+    volatile uint32_t* cq_tail;
+    uint32_t cq_mask;
+    void* cqes;
+    // 模擬
+    retryix_uring_emul_op_t emul_ops[RETRYIX_URING_MAX_ENTRIES];
+    retryix_uring_cqe_t emul_cqes[RETRYIX_URING_MAX_ENTRIES];
+    unsigned emul_cq_head;
+    unsigned emul_cq_count;
+} retryix_uring_t;
+
+/// entries 向上取 2 的冪 (最多 RETRYIX_URING_MAX_ENTRIES); allow_kernel = false 強制模擬; 回傳 0 或 -errno
+int retryix_uring_init(retryix_uring_t* ring, unsigned entries, bool allow_kernel);
+void retryix_uring_exit(retryix_uring_t* ring);
+
+/// 註冊固定緩衝區, 之後以 buf_index 發出 READ_FIXED; 失敗 (如 memlock 限制) 時仍可用一般讀取
+bool retryix_uring_register_buffers(retryix_uring_t* ring, void* const* buffers, const size_t* sizes, unsigned count);
+
+/// 準備一筆讀取; buf_index < 0 或未註冊時為一般讀取; 佇列滿時回傳 false
+bool retryix_uring_prep_read(retryix_uring_t* ring, int fd, void* buf, uint32_t len,
+                             uint64_t offset, uint64_t user_data, int buf_index);
+
+/// 提交已準備的讀取, 並等待至少 wait_nr 筆完成; 回傳 0 或 -errno
+int retryix_uring_submit(retryix_uring_t* ring, unsigned wait_nr);
+
+/// 取回最多 max 筆完成事件, 不阻塞
+unsigned retryix_uring_reap(retryix_uring_t* ring, retryix_uring_cqe_t* out, unsigned max);
+
+/// 以 O_DIRECT 開啟唯讀 (不支援時退回一般 I/O, *direct 設為 false); 回傳 fd 或 -errno
+int retryix_uring_open_direct(const char* path, bool* direct);
+void retryix_uring_close(int fd);
+
+/// 檔案或區塊裝置的大小 (位元組); 失敗回傳 0
+uint64_t retryix_uring_file_size(int fd);
+
+/// 單調時鐘 (奈秒)
+uint64_t retryix_uring_now_ns(void);
+
+// ===== 匯流排模組共用 (retryix_bus_scheduler.c) =====
+
+/// 依控制器資訊選擇佇列深度: 已實測用拐點深度, 否則由帶寬 × 延遲估算; info 為 NULL 時回傳預設值
+int retryix_bus_pick_queue_depth(const retryix_bus_info_t* info, unsigned io_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_BUS_URING_INTERNAL_H */
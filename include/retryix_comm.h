@@ -1,6 +1,13 @@
 // retryix_comm.h
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef enum {
     COMM_STATUS_OK = 0,
     COMM_STATUS_FAIL = -1,
@@ -9,8 +16,35 @@ typedef enum {
 
 typedef void (*RetryIXCommCallback)(const char* topic, const char* message);
 
+#define RETRYIX_COMM_WAIT_INFINITE 0xFFFFFFFFu
+
+// 行程內主題式發佈 / 訂閱: 每個訂閱者一條無鎖佇列, 由 poll 或分派線程批次呼叫回呼
+// config_path 可為 NULL (預設值) 或 key=value 文字檔:
+//   queue_capacity  每個訂閱者的佇列容量 (向上取 2 的冪, 預設 4096)
+//   batch           每個訂閱者每輪最多分派的訊息數 (預設 64)
+//   dispatcher      1 = 初始化時啟動專用分派線程
+//   send_timeout_ms 佇列滿時發送端等待的毫秒數 (預設 0, 立即丟棄並回傳 FAIL)
 int retryix_comm_init(const char* config_path);
 int retryix_comm_send(const char* topic, const char* message);
 int retryix_comm_register(const char* topic, RetryIXCommCallback callback);
-int retryix_comm_poll();  // 可阻塞等待或非阻塞查詢事件
+int retryix_comm_poll();  // 非阻塞: 分派目前佇列中的訊息後立即返回, 等待請用 poll_wait
 int retryix_comm_shutdown();
+
+// 主題代號: 名稱只在此雜湊一次, 之後以代號發送; 失敗回傳 -1
+int retryix_comm_topic(const char* topic);
+int retryix_comm_send_id(int topic_id, const char* message);
+
+// retryix_comm_poll 為非阻塞, 回傳本次分派的訊息數;
+// poll_wait 在沒有訊息時休眠至有新訊息或逾時 (逾時回傳 0)
+int retryix_comm_poll_wait(uint32_t timeout_ms);
+
+// 專用分派線程: 啟動後回呼都在該線程執行, 仍可同時呼叫 poll
+int retryix_comm_start_dispatcher(void);
+int retryix_comm_stop_dispatcher(void);
+
+// 因佇列滿而丟棄的訊息總數
+uint64_t retryix_comm_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
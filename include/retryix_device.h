@@ -85,12 +85,34 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_for_platform(
     int* device_count
 );
 
+// 由快取的設備註冊表回傳; 首次呼叫才實際探測, 之後只有熱插拔或手動失效才重新探測
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_all_devices(
     retryix_device_t* devices,
     int max_devices,
     int* device_count
 );
 
+// 原生後端探測選項 (NULL 使用預設)
+typedef struct {
+    int prefer_gpu;             // 1: 只有含 GPU 的後端結果才算找到, 找到後取消其餘探測
+    unsigned int timeout_ms;    // 單一後端探測逾時, 0 = 2000
+    int max_threads;            // 同時探測的執行緒數, 0 = 4
+} retryix_native_probe_options_t;
+
+// 並行探測 Vulkan / CUDA / ROCm / Level Zero / 平台原生來源, 取優先序最高且找到設備的後端
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_native_ex(
+    retryix_device_t* devices,
+    int max_devices,
+    int* device_count,
+    const retryix_native_probe_options_t* options
+);
+
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_native(
+    retryix_device_t* devices,
+    int max_devices,
+    int* device_count
+);
+
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_select_best_device(
     const retryix_device_t* devices,
     int device_count,
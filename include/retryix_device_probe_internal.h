@@ -0,0 +1,35 @@
+/*
+ * retryix_device_probe_internal.h
+ * 設備探測的模組間共用介面 (不對外導出)
+ */
+
+#ifndef RETRYIX_DEVICE_PROBE_INTERNAL_H
+#define RETRYIX_DEVICE_PROBE_INTERNAL_H
+
+#include "retryix_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 在並行探測 session 中呼叫 CUDA / ROCm / Level Zero / OpenCL Intel / Metal 橋接,
+/// 每個橋接各自套用逾時; 完成的結果依上述順序合併 (options 的 prefer_gpu 不適用)
+retryix_result_t retryix_probe_bridges_parallel(
+    retryix_device_t* devices,
+    int max_devices,
+    int* device_count,
+    const retryix_native_probe_options_t* options
+);
+
+// 設備註冊表 (retryix_device.c; build_modular.bat 的 DLL 不含此單元, 其設備模組另有實作)
+/// 標記註冊表失效, 下一次查詢重新探測
+void retryix_invalidate_device_cache(void);
+
+/// 註冊表世代: 每次重新探測得到不同設備清單時遞增 (首次探測後為 1)
+unsigned long long retryix_get_device_generation(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_DEVICE_PROBE_INTERNAL_H */
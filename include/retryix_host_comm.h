@@ -1,12 +1,16 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 // 保證所有 API 皆為 C linkage，C++ 編譯器可正確連結
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define MAX_MSG_QUEUE 128
+#define MAX_MSG_QUEUE 4096               // comm_init 的預設佇列容量
+#define COMM_WAIT_INFINITE 0xFFFFFFFFu
 
 typedef struct {
     char data[256];
@@ -14,11 +18,27 @@ typedef struct {
     int type;
 } comm_packet_t;
 
+// 零拷貝訊息: 發送端 reserve 取得可寫區, 原地寫入後 commit;
+// 接收端 borrow 取得唯讀視圖, 用畢 release 歸還區塊. 負載大小不受 comm_packet_t 限制
+#define COMM_MSG_INLINE_BYTES 32
+
+typedef struct {
+    void* data;                 // reserve: 可寫區; borrow: 訊息內容 (勿跨 release 使用)
+    size_t length;              // reserve: 可寫容量; borrow: 訊息長度
+    int type;
+    uint32_t block;             // 內部區塊代號 (0 = 內嵌於 inline_data)
+    uint32_t size_class;
+    char inline_data[COMM_MSG_INLINE_BYTES];
+} comm_msg_t;
+
 typedef enum {
     COMM_SUCCESS = 0,
     COMM_ERROR_INIT = -1,
     COMM_ERROR_QUEUE_FULL = -2,
-    COMM_ERROR_RECV = -3
+    COMM_ERROR_RECV = -3,
+    COMM_ERROR_TIMEOUT = -4,
+    COMM_ERROR_INVALID = -5,
+    COMM_ERROR_NO_MEMORY = -6
 } comm_result_t;
 
 
@@ -29,11 +49,33 @@ typedef enum {
 comm_result_t retryix_host_comm_init(const char* channel_name);
 void retryix_host_comm_cleanup(void);
 
+// channel_name 為 NULL 或空字串: 本行程佇列; 否則建立或附加同名的跨行程共享通道,
+// 同名的各行程共用同一佇列與訊息區, 已終止行程留下的半途訊息會自動回收
 comm_result_t comm_init(const char* channel_name);
 comm_result_t comm_send(const comm_packet_t* packet);
 comm_result_t comm_recv(comm_packet_t* out_packet);
 void comm_cleanup();
 
+// 指定佇列容量 (向上取 2 的冪, 至少 2); 已初始化時忽略容量
+comm_result_t comm_init_ex(const char* channel_name, size_t capacity);
+
+// 批次收發: 回傳實際送出 / 取得的封包數, 佇列滿或空時提早返回
+size_t comm_send_n(const comm_packet_t* packets, size_t count);
+size_t comm_recv_n(comm_packet_t* out_packets, size_t max_count);
+
+// 阻塞接收: 佇列空時休眠至有新封包或逾時 (COMM_WAIT_INFINITE 表示不逾時)
+comm_result_t comm_recv_wait(comm_packet_t* out_packet, uint32_t timeout_ms);
+
+// 零拷貝訊息 API; comm_recv 只複製前 sizeof(data) 位元組, 較大訊息請以 comm_msg_borrow 接收
+comm_result_t comm_msg_reserve(size_t size, comm_msg_t* out_msg);
+comm_result_t comm_msg_commit(comm_msg_t* msg, size_t length, int type);   // 佇列滿時保留區塊, 可重試或 abort
+void comm_msg_abort(comm_msg_t* msg);
+comm_result_t comm_msg_borrow(comm_msg_t* out_msg, uint32_t timeout_ms);    // timeout_ms = 0 為非阻塞
+void comm_msg_release(comm_msg_t* msg);
+
+// 立即檢查並修補已終止行程留下的通道狀態, 回傳修補的格子數 (通常由收發路徑自動觸發)
+size_t comm_recover(void);
+
 
 #ifdef __cplusplus
 } // extern "C"
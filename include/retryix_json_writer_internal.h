@@ -0,0 +1,103 @@
+/*
+ * retryix_json_writer_internal.h
+ * 單趟串流 JSON 寫入器 (模組間共用, 不對外導出)
+ * 拓撲與健康狀態匯出直接把欄位寫進一塊緩衝區, 不建 DOM、不重新解析;
+ * 同一組呼叫也可輸出 CBOR (RFC 8949, 不定長容器) 作為二進位快照。
+ */
+
+#ifndef RETRYIX_JSON_WRITER_INTERNAL_H
+#define RETRYIX_JSON_WRITER_INTERNAL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RETRYIX_JW_MAX_DEPTH 32
+
+/**
+ * JSON 函數回傳字串前的標頭, retryix_free_json 經由它釋放:
+ * 一般輸出直接釋放整塊, 共用快照則只減少引用
+ */
+typedef struct retryix_json_shared {
+    void (*release)(struct retryix_json_shared* self);
+} retryix_json_shared_t;
+
+typedef enum {
+    RETRYIX_JW_JSON = 0,                   ///< 緊湊 JSON 文字
+    RETRYIX_JW_CBOR                        ///< CBOR 二進位
+} retryix_jw_format_t;
+
+/**
+ * 寫入器狀態 (放在堆疊上即可)
+ * 緩衝區不足時: 堆積模式自動擴充; 固定模式停止寫入但繼續累計所需長度
+ */
+typedef struct {
+    unsigned char* buf;
+    size_t len;                            ///< 已輸出 (或所需) 的位元組數
+    size_t cap;
+    int format;
+    int heap;                              ///< 1 = 緩衝區由寫入器配置
+    int failed;                            ///< 配置失敗或巢狀過深
+    int depth;
+    unsigned char has_items[RETRYIX_JW_MAX_DEPTH];
+} retryix_json_writer_t;
+
+/**
+ * @brief 以堆積緩衝區初始化 (容量不足時倍增)
+ * @param initial_capacity 預估輸出大小, 猜準時整次輸出只配置一次
+ */
+void retryix_jw_init(retryix_json_writer_t* w, retryix_jw_format_t format, size_t initial_capacity);
+
+/**
+ * @brief 以呼叫端的固定緩衝區初始化 (不配置記憶體)
+ */
+void retryix_jw_init_fixed(retryix_json_writer_t* w, retryix_jw_format_t format, void* buffer, size_t size);
+
+// key 在物件內為欄位名稱, 在陣列內或最外層傳 NULL
+void retryix_jw_begin_object(retryix_json_writer_t* w, const char* key);
+void retryix_jw_end_object(retryix_json_writer_t* w);
+void retryix_jw_begin_array(retryix_json_writer_t* w, const char* key);
+void retryix_jw_end_array(retryix_json_writer_t* w);
+void retryix_jw_string(retryix_json_writer_t* w, const char* key, const char* value);   ///< NULL 輸出 null
+void retryix_jw_number(retryix_json_writer_t* w, const char* key, double value);        ///< 非有限值輸出 null
+void retryix_jw_int(retryix_json_writer_t* w, const char* key, long long value);
+void retryix_jw_bool(retryix_json_writer_t* w, const char* key, int value);
+
+/**
+ * @brief 結束輸出
+ * @return JSON 模式補上結尾 '\0'; 堆積模式回傳的緩衝區交給呼叫端 (retryix_free_json 釋放),
+ *         固定模式回傳呼叫端緩衝區; 失敗或固定緩衝區不足時為 NULL (堆積緩衝區已釋放)
+ */
+char* retryix_jw_finish(retryix_json_writer_t* w);
+
+/**
+ * @brief 放棄輸出並釋放堆積緩衝區 (buf/len 在此之前可直接讀取)
+ */
+void retryix_jw_discard(retryix_json_writer_t* w);
+
+/**
+ * @brief 把本寫入器產生的 CBOR 重新輸出到 w (通常轉成 JSON, 與直接輸出 JSON 逐位元組相同)
+ * @return 1 成功; 0 資料不完整或含不支援的型別
+ */
+int retryix_jw_replay_cbor(retryix_json_writer_t* w, const void* cbor, size_t size);
+
+/**
+ * @brief 輸出所需的位元組數 (不含 '\0'), 固定緩衝區不足時用來回報所需大小
+ */
+size_t retryix_jw_length(const retryix_json_writer_t* w);
+
+// 各匯出模組提供的串流輸出 (快照與 JSON 共用同一段程式)
+void retryix_emit_system_health(retryix_json_writer_t* w, const char* key);
+
+/**
+ * @brief 依種類輸出拓撲 (retryix_topology_kind_t), 每次呼叫都重新探測
+ */
+void retryix_topology_emit(int kind, retryix_json_writer_t* w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_JSON_WRITER_INTERNAL_H */
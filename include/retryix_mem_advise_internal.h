@@ -0,0 +1,61 @@
+/*
+ * retryix_mem_advise_internal.h
+ * 記憶體建議與預取 (模組間共用, 不對外導出)
+ * 建議以配置為單位登記, 排程器可查詢某位址所屬配置的存取特性
+ */
+
+#ifndef RETRYIX_MEM_ADVISE_INTERNAL_H
+#define RETRYIX_MEM_ADVISE_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    RETRYIX_MEM_ADVICE_READ_MOSTLY        = 1 << 0,   ///< MADV_WILLNEED, 大區段另加 MADV_HUGEPAGE
+    RETRYIX_MEM_ADVICE_PREFERRED_LOCATION = 1 << 1,   ///< 目標節點設為優先配置節點
+    RETRYIX_MEM_ADVICE_ACCESSED_BY        = 1 << 2    ///< 裝置以 DMA 串流存取: MADV_SEQUENTIAL
+} retryix_mem_advice_t;
+
+/// 以 -1 表示主機 (呼叫線程所在節點)
+#define RETRYIX_MEM_HOST_DEVICE  (-1)
+
+typedef struct {
+    void* base;
+    size_t size;
+    uint32_t advice;                      ///< retryix_mem_advice_t 位元組合
+    int16_t preferred_node;               ///< -1 = 未設定
+    uint64_t accessed_by_devices;         ///< 裝置編號位元遮罩 (0..63)
+    uint64_t prefetched_bytes;            ///< 已完成預取的位元組
+} retryix_mem_advice_record_t;
+
+/// 套用建議並登記到 ptr 的配置記錄; device 為 PREFERRED_LOCATION / ACCESSED_BY 的目標
+/// 回傳 0 或 -errno
+int retryix_mem_apply_advice(void* ptr, size_t size, retryix_mem_advice_t advice, int device);
+
+/// 背景預觸碰 [ptr, ptr + size) 的頁面, 使其在 device 所在節點上配置好實體頁
+/// 已配置的頁面交給 NUMA 搬移引擎; 回傳 0 或 -errno
+int retryix_mem_prefetch_async(void* ptr, size_t size, int device);
+
+/// 等待所有預取完成; 回傳是否在 timeout_ms 內完成
+bool retryix_mem_prefetch_wait(uint32_t timeout_ms);
+
+/// 查詢包含 ptr 的建議記錄
+bool retryix_mem_get_advice(const void* ptr, retryix_mem_advice_record_t* out);
+
+/// 釋放前呼叫: 以包含 ptr 的映射區 (或建議記錄) 為釋放範圍, 移除與其重疊的記錄,
+/// 取消所有與其重疊的預取並等待進行中的區塊結束
+void retryix_mem_forget_advice(void* ptr);
+
+/// 裝置編號對應的 NUMA 節點 (依 PCI 顯示 / 加速器裝置順序); 未知時回傳 -1
+int retryix_mem_device_node(int device);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_MEM_ADVISE_INTERNAL_H */
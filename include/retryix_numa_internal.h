@@ -0,0 +1,197 @@
+/*
+ * retryix_numa_internal.h
+ * NUMA / 快取 / PCI 親和性拓撲 (模組間共用, 不對外導出)
+ * 首次查詢時探索一次並常駐記憶體, 之後的查詢皆為 O(1) 表格存取
+ */
+
+#ifndef RETRYIX_NUMA_INTERNAL_H
+#define RETRYIX_NUMA_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RETRYIX_NUMA_MAX_NODES    64
+#define RETRYIX_NUMA_MAX_CPUS     1024
+#define RETRYIX_NUMA_MASK_WORDS   (RETRYIX_NUMA_MAX_CPUS / 64)
+#define RETRYIX_NUMA_MAX_CACHES   8
+#define RETRYIX_NUMA_MAX_DEVICES  128
+
+typedef enum {
+    RETRYIX_CACHE_DATA = 0,
+    RETRYIX_CACHE_INSTRUCTION,
+    RETRYIX_CACHE_UNIFIED
+} retryix_cache_type_t;
+
+typedef struct {
+    uint8_t level;                        ///< 1 / 2 / 3 ...
+    uint8_t type;                         ///< retryix_cache_type_t
+    uint16_t line_size;                   ///< 位元組
+    uint32_t size_kb;
+    uint32_t shared_cpus;                 ///< 共用此快取的邏輯 CPU 數
+} retryix_cache_info_t;
+
+typedef struct {
+    char bdf[16];                         ///< "0000:3b:00.0"
+    uint16_t vendor_id;
+    uint16_t device_id;
+    uint32_t class_code;                  ///< 24 位 PCI class
+    int16_t node;                         ///< -1 = 無親和性資訊
+} retryix_numa_device_t;
+
+/**
+ * 系統拓撲快照
+ * 節點以 sysfs 節點編號索引 (可能不連續, 以 node_online 判斷)
+ */
+typedef struct {
+    uint32_t node_count;                  ///< 線上節點數
+    uint32_t max_node;                    ///< 最大節點編號 + 1
+    uint32_t cpu_count;                   ///< 最大 CPU 編號 + 1
+    bool node_online[RETRYIX_NUMA_MAX_NODES];
+    uint8_t distance[RETRYIX_NUMA_MAX_NODES][RETRYIX_NUMA_MAX_NODES];   ///< ACPI SLIT 距離 (本地 = 10)
+    uint64_t node_cpus[RETRYIX_NUMA_MAX_NODES][RETRYIX_NUMA_MASK_WORDS];
+    uint32_t node_cpu_count[RETRYIX_NUMA_MAX_NODES];
+    uint64_t node_mem_total[RETRYIX_NUMA_MAX_NODES];                    ///< 位元組
+    uint64_t node_mem_free[RETRYIX_NUMA_MAX_NODES];                     ///< 位元組 (retryix_numa_refresh_free_memory 更新)
+    int16_t cpu_node[RETRYIX_NUMA_MAX_CPUS];                            ///< CPU -> 節點, -1 = 離線
+    uint32_t cache_count;
+    retryix_cache_info_t caches[RETRYIX_NUMA_MAX_CACHES];               ///< 以 CPU 0 為代表
+    uint32_t device_count;
+    retryix_numa_device_t devices[RETRYIX_NUMA_MAX_DEVICES];
+    bool from_firmware;                   ///< false 表示平台未提供 NUMA 資訊, 以單節點代替
+} retryix_numa_topology_t;
+
+/// 取得拓撲快照 (首次呼叫時探索, 線程安全); 永不回傳 NULL
+const retryix_numa_topology_t* retryix_numa_topology(void);
+
+/// 重新讀取各節點可用記憶體
+void retryix_numa_refresh_free_memory(void);
+
+/// CPU 所屬節點 (O(1)); 未知時回傳 0
+int retryix_numa_node_of_cpu(int cpu);
+
+/// 呼叫線程目前所在的節點
+int retryix_numa_current_node(void);
+
+/// PCI 裝置 (BDF 字串) 所屬節點; 未知時回傳 -1
+int retryix_numa_device_node(const char* bdf);
+
+/// 距離 from 節點最近且 (可選) 有足夠可用記憶體的線上節點
+int retryix_numa_nearest_node(int from, uint64_t min_free_bytes);
+
+/// 依距離由近到遠挑選 count 個線上節點 (count <= 0 表示全部), 回傳節點位元遮罩
+uint64_t retryix_numa_nearest_mask(int from, int count);
+
+// === 節點放置配置 (retryix_numa_alloc.c) ===
+
+/// 小於此大小或單節點系統時走 malloc: 預設 first-touch 策略已落在本地節點
+#define RETRYIX_NUMA_MIN_REGION   (64 * 1024)
+
+typedef enum {
+    RETRYIX_NUMA_POLICY_DEFAULT = 0,      ///< 依核心預設 (first-touch)
+    RETRYIX_NUMA_POLICY_PREFERRED,        ///< 優先遮罩中最低節點, 不足時由核心回退
+    RETRYIX_NUMA_POLICY_BIND,             ///< 嚴格限定於遮罩節點
+    RETRYIX_NUMA_POLICY_INTERLEAVE        ///< 逐頁輪流分散於遮罩節點
+} retryix_numa_policy_t;
+
+/// 達到此大小的配置預設以大頁支撐 (retryix_numa_set_huge_policy 可調整)
+#define RETRYIX_NUMA_HUGE_THRESHOLD_DEFAULT  (4u * 1024 * 1024)
+
+typedef struct {
+    uint64_t hugetlb_bytes;               ///< MAP_HUGETLB / MEM_LARGE_PAGES 支撐的位元組
+    uint64_t thp_bytes;                   ///< 2MB 對齊並標記 MADV_HUGEPAGE 的位元組
+    uint64_t thp_backed_bytes;            ///< 其中核心實際以透明大頁填入的位元組 (查詢時讀取 smaps)
+    uint64_t regular_bytes;               ///< 一般頁面映射區
+    uint64_t huge_requests;               ///< 超過門檻的配置次數
+    uint64_t fallbacks;                   ///< 未取得所要求大頁類型的次數
+} retryix_numa_huge_stats_t;
+
+/// 依策略配置; 達到大頁門檻時不論節點數都改以 2MB 對齊映射; 以 retryix_numa_free 釋放
+void* retryix_numa_alloc(size_t size, retryix_numa_policy_t policy, uint64_t nodemask);
+
+/// 釋放 retryix_numa_alloc 的結果 (包含退回 malloc 的配置)
+void retryix_numa_free(void* ptr);
+
+/// 設定大頁門檻 (0 = 停用) 與是否嘗試 hugetlb (1 / 0, -1 = 系統大頁池有頁面時才嘗試)
+void retryix_numa_set_huge_policy(size_t threshold, int use_hugetlb);
+
+size_t retryix_numa_huge_threshold(void);
+
+void retryix_numa_huge_stats(retryix_numa_huge_stats_t* out);
+
+/// ptr 是否位於 retryix_numa_alloc 建立的獨立映射區; 是則回傳其起點與大小
+bool retryix_numa_region_of(const void* ptr, void** base, size_t* size);
+
+/// 將 [ptr, ptr + size) 涵蓋的頁面綁定到 node 並搬移既有頁面
+/// size = 0 時綁定 ptr 所屬的整個映射區 (不屬任何映射區則只綁定該頁)
+/// 回傳 0 或 -errno
+int retryix_numa_bind(void* ptr, size_t size, int node);
+
+/// 與 retryix_numa_bind 相同, 但只設定策略, 既有頁面留給背景搬移處理
+int retryix_numa_set_policy(void* ptr, size_t size, int node);
+
+/// 將範圍設為優先配置於 node (不足時由核心回退), 既有頁面不動
+int retryix_numa_set_preferred(void* ptr, size_t size, int node);
+
+/// ptr 所在頁面目前的實體節點; 尚未配置實體頁或無法查詢時回傳 -1
+int retryix_numa_node_of_addr(const void* ptr);
+
+// === 存取取樣 ===
+
+/// 每個線程每 N 次呼叫取樣一次 (2 的冪)
+#define RETRYIX_NUMA_ACCESS_SAMPLE  16
+
+typedef struct {
+    void* base;
+    size_t size;
+    retryix_numa_policy_t policy;
+    uint64_t nodemask;
+    uint32_t access[RETRYIX_NUMA_MAX_NODES];   ///< 各節點的取樣存取次數
+} retryix_numa_region_info_t;
+
+/// 記錄呼叫線程所在節點對 ptr 的存取 (取樣; 非映射區位址忽略)
+void retryix_numa_record_access(const void* ptr);
+
+/// 複製映射區清單到 out (最多 max 筆), 回傳映射區總數; decay 時將取樣計數減半
+size_t retryix_numa_snapshot_regions(retryix_numa_region_info_t* out, size_t max, bool decay);
+
+// === 頁面搬移 (retryix_numa_migrate.c) ===
+
+typedef struct {
+    uint32_t jobs_pending;                ///< 排隊中與執行中的工作
+    uint64_t jobs_completed;
+    uint64_t pages_total;                 ///< 已提交工作涵蓋的頁數
+    uint64_t pages_scanned;               ///< 已檢查的頁數
+    uint64_t pages_moved;                 ///< 實際搬移的頁數
+    uint64_t pages_failed;                ///< 搬移失敗 (記憶體不足 / 平台不支援)
+} retryix_numa_migration_progress_t;
+
+#define RETRYIX_NUMA_WAIT_INFINITE  0xFFFFFFFFu
+
+/// 背景將 [ptr, ptr + size) 搬到 node; size = 0 表示 ptr 所屬的整個映射區
+/// rebind 時同時把該範圍的策略改為綁定 node; 回傳 0 或 -errno
+int retryix_numa_migrate_async(void* ptr, size_t size, int node, bool rebind);
+
+/// 依各映射區的登記策略, 把偏離的頁面搬回應有節點; 回傳提交的工作數
+int retryix_numa_rebalance(void);
+
+/// 依取樣存取統計, 把映射區搬到主要存取線程所在節點; 回傳提交的工作數
+int retryix_numa_optimize_placement(void);
+
+void retryix_numa_migration_progress(retryix_numa_migration_progress_t* out);
+
+/// 等待所有工作完成; 回傳是否在 timeout_ms 內完成
+bool retryix_numa_migration_wait(uint32_t timeout_ms);
+
+/// 取消與範圍重疊的工作並等待執行中的批次結束 (解除映射前呼叫)
+void retryix_numa_migrate_forget(void* base, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_NUMA_INTERNAL_H */
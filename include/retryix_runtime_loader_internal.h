@@ -0,0 +1,99 @@
+/*
+ * retryix_runtime_loader_internal.h
+ * 共用執行時載入器 (模組間共用, 不對外導出)
+ * 每個執行時 (Vulkan / CUDA Runtime / HIP) 在整個行程只載入一次, 失敗結果也快取;
+ * 符號在第一次使用時經由呼叫端的靜態槽位解析並快取, 之後只剩一次載入。
+ * Vulkan 另提供共用的 VkInstance, 裝置探測與 compute 引擎不再各自建立。
+ * 載入與建立實例都不持有全域鎖: 卡住的 dlopen / vkCreateInstance 只影響同一執行時的等待者。
+ */
+
+#ifndef RETRYIX_RUNTIME_LOADER_INTERNAL_H
+#define RETRYIX_RUNTIME_LOADER_INTERNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    RETRYIX_RUNTIME_VULKAN = 0,
+    RETRYIX_RUNTIME_CUDART,
+    RETRYIX_RUNTIME_HIP,
+    RETRYIX_RUNTIME_COUNT
+} retryix_runtime_id_t;
+
+/**
+ * 延遲解析的符號槽位, 以 RETRYIX_RUNTIME_LAZY("name") 靜態初始化
+ */
+typedef struct {
+    const char* name;
+    void* volatile fn;
+    volatile int missing;                 ///< 已確認不存在, 不再重查
+} retryix_runtime_lazy_t;
+
+#define RETRYIX_RUNTIME_LAZY(sym) { sym, 0, 0 }
+
+/**
+ * @brief 取得執行時的程式庫句柄 (首次呼叫時載入, 之後直接回傳)
+ * @return 句柄; 執行時不存在時為 NULL
+ */
+void* retryix_runtime_open(retryix_runtime_id_t id);
+
+/**
+ * @brief 解析槽位中的符號 (首次使用時查找, 之後直接回傳快取)
+ * @return 函數指標; 執行時或符號不存在時為 NULL
+ */
+void* retryix_runtime_lazy(retryix_runtime_id_t id, retryix_runtime_lazy_t* slot);
+
+// ===================== Vulkan 全域 / 實例層函數 =====================
+
+// 兩個使用者共用的匯出入口; 裝置層函數應經 vkGetDeviceProcAddr 取得
+#define RETRYIX_VK_GLOBAL_FUNCS(X) \
+    X(vkCreateInstance) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkCreateDevice) \
+    X(vkGetDeviceProcAddr)
+
+#define RETRYIX_VK_FN_ENUM_(name) RETRYIX_VK_FN_##name,
+typedef enum {
+    RETRYIX_VK_GLOBAL_FUNCS(RETRYIX_VK_FN_ENUM_)
+    RETRYIX_VK_FN_COUNT
+} retryix_vk_fn_t;
+#undef RETRYIX_VK_FN_ENUM_
+
+void* retryix_vulkan_fn(retryix_vk_fn_t fn);
+
+// 呼叫端需已包含 <vulkan/vulkan.h> (VK_NO_PROTOTYPES)
+#define RETRYIX_VK(name) ((PFN_##name)retryix_vulkan_fn(RETRYIX_VK_FN_##name))
+
+/**
+ * @brief 取得共用 VkInstance 並增加引用 (首次呼叫或失效後建立新實例)
+ * @return VkInstance; Vulkan 不可用時為 NULL (不增加引用)
+ */
+struct VkInstance_T* retryix_vulkan_instance_acquire(void);
+
+/**
+ * @brief 釋放 acquire 取得的實例引用; 歸零後目前實例保留, 供下一個使用者直接取用,
+ *        已失效的實例則在此銷毀
+ */
+void retryix_vulkan_instance_release(struct VkInstance_T* instance);
+
+/**
+ * @brief 使目前實例失效 (設備快取失效時呼叫): 之後的 acquire 建立新實例以列舉熱插拔的設備,
+ *        舊實例無人引用時立即銷毀, 否則延到最後一次釋放
+ */
+void retryix_vulkan_instance_invalidate(void);
+
+/**
+ * @brief 銷毀目前無人引用的共用實例 (引擎清理時呼叫; 仍被引用時延到最後一次釋放)
+ */
+void retryix_runtime_loader_trim(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_RUNTIME_LOADER_INTERNAL_H */
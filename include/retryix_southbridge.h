@@ -0,0 +1,266 @@
+/*
+ * retryix_southbridge.h
+ * 南橋晶片溝通API - 底層硬體協調
+ * PCH/晶片組資訊、PCIe通道協調與通道使用率取樣
+ */
+
+#ifndef RETRYIX_SOUTHBRIDGE_H
+#define RETRYIX_SOUTHBRIDGE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+// === RetryIX Southbridge API Exports ===
+#include "retryix_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ===================== 類型定義 =====================
+
+/**
+ * 南橋溝通錯誤碼
+ */
+typedef enum {
+    RETRYIX_SB_SUCCESS = 0,                    ///< 操作成功
+    RETRYIX_SB_ERROR_NO_CHIPSET = -1,          ///< 無法識別晶片組 / 未初始化
+    RETRYIX_SB_ERROR_ACCESS_DENIED = -2,       ///< 訪問被拒絕
+    RETRYIX_SB_ERROR_LANES_CONFLICT = -3,      ///< 通道配置衝突
+    RETRYIX_SB_ERROR_POWER_LIMIT = -4,         ///< 電源管理限制
+    RETRYIX_SB_ERROR_THERMAL_LIMIT = -5,       ///< 熱限制
+    RETRYIX_SB_ERROR_FIRMWARE_LOCK = -6        ///< 韌體鎖定
+} retryix_southbridge_result_t;
+
+/**
+ * 晶片組類型
+ */
+typedef enum {
+    RETRYIX_CHIPSET_UNKNOWN = 0,
+    RETRYIX_CHIPSET_INTEL_Z690,
+    RETRYIX_CHIPSET_INTEL_H670,
+    RETRYIX_CHIPSET_INTEL_B660,
+    RETRYIX_CHIPSET_AMD_X570,
+    RETRYIX_CHIPSET_AMD_B550,
+    RETRYIX_CHIPSET_AMD_A520
+} retryix_chipset_type_t;
+
+/**
+ * PCH通道狀態
+ */
+typedef enum {
+    RETRYIX_PCH_LANES_AVAILABLE = 0,           ///< 有可用通道
+    RETRYIX_PCH_LANES_SHARED,                  ///< 與SATA/USB共享
+    RETRYIX_PCH_LANES_EXHAUSTED                ///< 已全部占用
+} retryix_pch_lanes_status_t;
+
+/**
+ * 南橋資訊結構體
+ */
+typedef struct {
+    retryix_chipset_type_t chipset_type;
+    char vendor_name[32];
+    char model_name[64];
+
+    // === 通道配置 ===
+    int total_pch_lanes;                       ///< PCH總通道數
+    int available_pch_lanes;                   ///< 尚可分配的PCH通道
+    int cpu_direct_lanes;                      ///< CPU直連通道
+    retryix_pch_lanes_status_t lanes_status;
+
+    // === 控制器狀態 ===
+    bool sata_enabled;
+    bool usb_enabled;
+    bool ethernet_enabled;
+    bool wifi_enabled;
+    bool audio_enabled;
+
+    // === 電源和熱狀態 ===
+    float power_consumption_watts;
+    float temperature_celsius;
+    bool power_gating_active;
+    bool clock_gating_active;
+
+    // === PCIe 配置 ===
+    int pcie_slots_managed;
+    char pcie_configuration[128];
+    char lane_allocation_map[128];
+
+    // === 說明 ===
+    char hardware_limitations[256];
+    char optimization_suggestions[256];
+} retryix_southbridge_info_t;
+
+/**
+ * 通道重分配請求
+ */
+typedef struct {
+    int target_slot;                           ///< 目標插槽
+    int requested_lanes;                       ///< 請求的通道數
+    int priority_level;                        ///< 優先級 (0-10, >= 7 直接批准)
+    bool force_reallocation;                   ///< 強制重分配
+    char reason[128];                          ///< 請求原因
+} retryix_lane_reconfig_request_t;
+
+#define RETRYIX_SB_MAX_LANE_DEVICES 32
+
+/**
+ * 滑動視窗統計 (使用率百分比)
+ */
+typedef struct {
+    float min;
+    float avg;
+    float max;
+    int samples;                               ///< 視窗內實際樣本數
+} retryix_sb_window_t;
+
+/**
+ * 單一 PCIe 裝置的通道使用率快照
+ */
+typedef struct {
+    char bdf[16];                              ///< PCI 位址 (如 0000:02:00.0)
+    char devices[64];                          ///< 掛在此裝置上的區塊裝置 / 網路介面, 逗號分隔
+    bool is_storage;
+    bool is_network;
+    int link_width;                            ///< 目前鏈路寬度
+    int max_link_width;
+    float link_gts;                            ///< 目前每通道速率 (GT/s)
+    float link_bandwidth_gbps;                 ///< 單向可用帶寬 (已扣除編碼開銷)
+    double rx_gbps;                            ///< 讀取 / 接收 (GB/s)
+    double tx_gbps;                            ///< 寫入 / 傳送 (GB/s)
+    float utilization;                         ///< 最新樣本: 較忙方向占鏈路帶寬的百分比
+    retryix_sb_window_t window_short;          ///< 最近 10 個樣本
+    retryix_sb_window_t window_long;           ///< 最近 60 個樣本
+    unsigned long long aer_correctable;        ///< AER 累計可更正錯誤
+    unsigned long long aer_nonfatal;
+    unsigned long long aer_fatal;
+    unsigned long long aer_recent;             ///< 長視窗內新增的 AER 錯誤
+    unsigned long long sample_count;           ///< 累計樣本數
+    unsigned long long sample_time_ns;         ///< 最新樣本的單調時間
+} retryix_southbridge_lane_stats_t;
+
+// ===================== 核心API函數 =====================
+
+/**
+ * @brief 初始化南橋溝通
+ * @return 操作結果碼
+ *
+ * 由 PCI 配置空間辨識晶片組，並啟動通道使用率取樣執行緒 (Linux)。
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_init(void);
+
+/**
+ * @brief 獲取南橋資訊
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_get_info(retryix_southbridge_info_t* info);
+
+/**
+ * @brief 協調PCIe通道重分配
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_coordinate_lanes(const retryix_lane_reconfig_request_t* request, bool* success);
+
+/**
+ * @brief 檢查插槽能否達到16X
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_check_16x_feasibility(int slot_number, bool* can_achieve,
+                                          char* limitation_reason, size_t reason_buffer_size);
+
+/**
+ * @brief 協調電源管理模式
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_power_coordinate(bool high_performance, bool* granted);
+
+/**
+ * @brief 動態重映射通道
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_dynamic_remap(int source_slot, int target_slot, int lanes_to_move);
+
+/**
+ * @brief 協調熱插拔事件
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_hotplug_coordinate(int slot_number, bool device_attached);
+
+/**
+ * @brief 獲取各裝置的通道使用率
+ * @param slot_utilization 輸出最新使用率 (%)，依 PCI 位址排序
+ * @param max_slots 陣列大小
+ * @param actual_slots 輸出實際裝置數
+ * @return 操作結果碼
+ *
+ * 只讀取取樣執行緒發佈的快照，不做系統呼叫；尚無兩個樣本時使用率為 0。
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_get_lane_utilization(float* slot_utilization, int max_slots, int* actual_slots);
+
+/**
+ * @brief 清理南橋溝通資源 (停止取樣執行緒)
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_cleanup(void);
+
+// ===================== 通道使用率取樣API =====================
+
+/**
+ * @brief 啟動取樣執行緒
+ * @param interval_ms 取樣間隔 (毫秒, 10..60000); 已在執行時只更新間隔
+ * @return 操作結果碼
+ *
+ * 每個間隔讀取 /proc/diskstats、/sys/class/net/<介面>/statistics 與各 PCIe 裝置的
+ * AER 計數和鏈路狀態，換算成每個 PCIe 裝置的吞吐量與鏈路使用率，寫入無鎖環形緩衝區。
+ * 裝置清單在啟動時建立。Windows 尚無對應計數來源，回傳 RETRYIX_SB_ERROR_ACCESS_DENIED。
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_start_sampler(unsigned int interval_ms);
+
+/**
+ * @brief 停止取樣執行緒 (保留已發佈的快照)
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_stop_sampler(void);
+
+/**
+ * @brief 讀取各裝置的最新快照與滑動視窗統計
+ * @param stats 輸出陣列
+ * @param max_devices 陣列大小
+ * @param actual_devices 輸出實際裝置數
+ * @return 操作結果碼
+ *
+ * 無鎖讀取，不做系統呼叫，可由任意執行緒頻繁呼叫。
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_get_lane_stats(retryix_southbridge_lane_stats_t* stats, int max_devices, int* actual_devices);
+
+/**
+ * @brief 設定 sysfs 與 procfs 根目錄 (Linux)
+ * @param sys_root NULL 或空字串恢復 "/sys"
+ * @param proc_root NULL 或空字串恢復 "/proc"
+ * @return 操作結果碼
+ *
+ * 測試可指向假的目錄樹；取樣執行緒執行中時回傳 RETRYIX_SB_ERROR_ACCESS_DENIED。
+ */
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_set_sampler_roots(const char* sys_root, const char* proc_root);
+
+// ===================== 工具函數 =====================
+
+RETRYIX_API const char* RETRYIX_CALL
+retryix_southbridge_get_error_string(retryix_southbridge_result_t error_code);
+
+RETRYIX_API const char* RETRYIX_CALL
+retryix_southbridge_get_chipset_name(retryix_chipset_type_t chipset_type);
+
+RETRYIX_API int RETRYIX_CALL
+retryix_southbridge_format_info(const retryix_southbridge_info_t* info,
+                                char* buffer, size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_SOUTHBRIDGE_H */
@@ -0,0 +1,37 @@
+/*
+ * retryix_topology_cache_internal.h
+ * 拓撲快照快取 (模組間共用, 不對外導出)
+ * 每種拓撲只計算一次, 結果是不可變的 JSON + CBOR 區塊, 由所有呼叫端以引用計數共用;
+ * 讀取端只有一次原子加法, 不取鎖。過期或失效時由背景執行緒 (或第一個讀到的呼叫端) 重建。
+ * 系統健康狀態每次都是即時值, 不經過快取。
+ */
+
+#ifndef RETRYIX_TOPOLOGY_CACHE_INTERNAL_H
+#define RETRYIX_TOPOLOGY_CACHE_INTERNAL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RETRYIX_TOPOLOGY_CACHE_DEFAULT_TTL_MS 5000
+
+/**
+ * @brief 取得共用的快取 JSON (呼叫端以 retryix_free_json 釋放引用, 內容不可修改)
+ * @return 快取停用、種類不快取或建立失敗時為 NULL, 呼叫端應改為直接輸出
+ */
+char* retryix_topology_cache_json(int kind);
+
+/**
+ * @brief 把快取的 CBOR 複製到呼叫端緩衝區
+ * @param written 輸出所需位元組數 (緩衝區不足時只回報大小)
+ * @return 1 由快取提供; 0 未快取, 呼叫端應改為直接輸出
+ */
+int retryix_topology_cache_cbor(int kind, void* buffer, size_t size, size_t* written);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_TOPOLOGY_CACHE_INTERNAL_H */
@@ -0,0 +1,26 @@
+/*
+ * retryix_topology_svm_internal.h
+ * 拓撲模組的 SVM 主機配置器 (模組間共用, 不對外導出)
+ * 與 retryix_svm.h 以 context 配置的 retryix_svm_alloc / retryix_svm_free 不同名, 避免宣告衝突
+ */
+
+#ifndef RETRYIX_TOPOLOGY_SVM_INTERNAL_H
+#define RETRYIX_TOPOLOGY_SVM_INTERNAL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 依預設策略配置 (達大頁門檻時為頁對齊的獨立映射區); 拓撲尚未探索或 size = 0 時回傳 NULL
+void* retryix_topology_svm_alloc(size_t size);
+
+/// 釋放 retryix_topology_svm_alloc 的結果, 並取消其範圍內的建議與預取
+void retryix_topology_svm_free(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_TOPOLOGY_SVM_INTERNAL_H */
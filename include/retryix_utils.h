@@ -167,6 +167,76 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_benchmark_to_json(
     size_t max_json_len
 );
 
+// ===== 拓撲與健康狀態匯出 =====
+/**
+ * 拓撲快照種類
+ */
+typedef enum {
+    RETRYIX_TOPOLOGY_NETWORK = 0,
+    RETRYIX_TOPOLOGY_AUDIO,
+    RETRYIX_TOPOLOGY_MULTIMODAL,
+    RETRYIX_TOPOLOGY_ATOMIC,
+    RETRYIX_TOPOLOGY_SVM,
+    RETRYIX_TOPOLOGY_SYSTEM_HEALTH,
+    RETRYIX_TOPOLOGY_KIND_COUNT
+} retryix_topology_kind_t;
+
+/**
+ * @brief 拓撲 / 健康狀態 JSON (緊湊格式)
+ * @return 以 retryix_free_json 釋放的字串，記憶體不足時為 NULL
+ *
+ * 拓撲結果來自快照快取，多個呼叫端共用同一塊唯讀緩衝區 (不可修改)；
+ * 健康狀態每次即時產生。
+ */
+RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void);
+RETRYIX_API char* RETRYIX_CALL retryix_discover_audio_topology_json(void);
+RETRYIX_API char* RETRYIX_CALL retryix_discover_multimodal_topology_json(void);
+RETRYIX_API char* RETRYIX_CALL retryix_discover_atomic_topology_json(void);
+RETRYIX_API char* RETRYIX_CALL retryix_discover_svm_topology_json(void);
+RETRYIX_API char* RETRYIX_CALL retryix_get_system_health_json(void);
+
+/**
+ * @brief 釋放上述 JSON 函數回傳的字串
+ */
+RETRYIX_API void RETRYIX_CALL retryix_free_json(char* json);
+
+/**
+ * @brief 以 CBOR (RFC 8949) 二進位格式輸出拓撲快照，內容與對應的 JSON 相同
+ * @param kind 快照種類
+ * @param buffer 輸出緩衝區 (可為 NULL 以查詢所需大小)
+ * @param buffer_size 緩衝區大小
+ * @param written 輸出實際 (或所需) 位元組數
+ * @return RETRYIX_SUCCESS 成功，緩衝區不足時為 RETRYIX_ERROR_BUFFER_TOO_SMALL
+ *
+ * 直接寫入呼叫端緩衝區，不配置記憶體，適合高頻輪詢。
+ */
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_get_topology_snapshot(
+    retryix_topology_kind_t kind,
+    void* buffer,
+    size_t buffer_size,
+    size_t* written
+);
+
+/**
+ * @brief 設定拓撲快照快取
+ * @param ttl_ms 快照有效期 (毫秒，預設 5000)；0 停用快取，每次呼叫都重新探測
+ * @param background_refresh 非 0 時由背景執行緒在到期前重建有人讀取的快照，
+ *        並在裝置登錄表換代時失效含裝置資訊的拓撲
+ * @return RETRYIX_SUCCESS 成功，ttl_ms 超過一小時為 RETRYIX_ERROR_INVALID_PARAMETER
+ */
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_topology_cache_configure(unsigned int ttl_ms, int background_refresh);
+
+/**
+ * @brief 標記快照失效，下一次讀取 (或背景執行緒) 重建
+ * @param kind 快照種類；RETRYIX_TOPOLOGY_KIND_COUNT 表示全部
+ */
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_invalidate_topology_cache(retryix_topology_kind_t kind);
+
+/**
+ * @brief 停止背景執行緒並釋放快取持有的快照 (呼叫端仍持有的字串照常有效)
+ */
+RETRYIX_API void RETRYIX_CALL retryix_topology_cache_shutdown(void);
+
 // ===== 檔案 I/O 工具 =====
 /**
  * @brief 載入文字檔案內容
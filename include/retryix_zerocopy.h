@@ -29,6 +29,7 @@ typedef enum {
     RETRYIX_NET_PROTO_ROCE_V2,            ///< RoCE v2.0
     RETRYIX_NET_PROTO_TCP_OFFLOAD,        ///< TCP Offload Engine
     RETRYIX_NET_PROTO_UDP_OFFLOAD,        ///< UDP Offload Engine
+    RETRYIX_NET_PROTO_SHM,                ///< 本機共享記憶體 (無 RDMA 網卡時的單邊傳輸)
     RETRYIX_NET_PROTO_UNKNOWN
 } retryix_net_protocol_t;
 
@@ -113,6 +114,61 @@ typedef struct {
     uint64_t transfer_id;                 ///< 傳輸ID
 } retryix_dma_transfer_t;
 
+/**
+ * 註冊緩衝池統計
+ */
+typedef struct {
+    uint64_t bytes_reserved;              ///< 已映射的 slab / 獨立映射位元組數
+    uint64_t bytes_huge;                  ///< 其中由大頁 (hugetlb / large page) 支撐的位元組數
+    uint64_t bytes_pinned;                ///< 已釘住 (mlock) 的位元組數
+    uint64_t bytes_in_use;                ///< 目前交給呼叫端的容量
+    uint64_t pooled_buffers;              ///< 池內已註冊的緩衝區總數
+    uint64_t buffers_in_use;              ///< 使用中的描述符 (含外部註冊)
+    uint64_t slab_refills;                ///< slab 切割次數 (慢路徑)
+    uint64_t registrations;               ///< 一次性鍵值註冊次數
+} retryix_zc_pool_stats_t;
+
+/// 訊息大小掃描點數 (64 B ~ 4 MB, 每點 ×4 / ×8)
+#define RETRYIX_ZC_PERF_SWEEP_POINTS 8
+
+/**
+ * 連線量測結果
+ * 延遲為小訊息往返時間的分位數, 頻寬為管線化串流的實測值
+ */
+typedef struct {
+    float latency_p50_us;                 ///< 往返延遲中位數
+    float latency_p99_us;
+    float latency_p999_us;
+    float bandwidth_mbps;                 ///< 串流頻寬 (掃描中的最大值)
+    uint32_t sweep_size[RETRYIX_ZC_PERF_SWEEP_POINTS];             ///< 訊息大小 (位元組)
+    float sweep_bandwidth_mbps[RETRYIX_ZC_PERF_SWEEP_POINTS];      ///< 各大小的串流頻寬
+    float sweep_latency_us[RETRYIX_ZC_PERF_SWEEP_POINTS];          ///< 各大小的單次傳輸完成時間 (中位數)
+    uint32_t samples;                     ///< 量測操作總數
+    uint32_t failed;                      ///< 失敗或逾時的操作數
+    uint64_t measured_at_ms;              ///< 量測時間 (單調時鐘, 毫秒)
+} retryix_net_perf_t;
+
+/// 多路徑群組 (分條傳輸排程)
+typedef struct retryix_zc_path_group retryix_zc_path_group_t;
+
+#define RETRYIX_ZC_MAX_PATHS 8
+
+/**
+ * 路徑即時統計
+ */
+typedef struct {
+    retryix_net_connection_t connection;
+    uint32_t weight_permille;             ///< 目前的分流比例 (千分比)
+    float throughput_mbps;                ///< 服務速率估計 (完成位元組 / 忙碌時間)
+    uint64_t bytes_completed;
+    uint64_t bytes_in_flight;
+    uint32_t chunks_failed;
+    bool alive;
+} retryix_zc_path_stats_t;
+
+/// retryix_zerocopy_dma_wait 的無限等待值
+#define RETRYIX_ZC_WAIT_INFINITE 0xFFFFFFFFu
+
 // ===================== API函數聲明 =====================
 
 // 網路初始化和清理
@@ -132,9 +188,33 @@ RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_create_net_b
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_destroy_net_buffer(retryix_net_buffer_t* buffer);
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_register_buffer(void* buffer, size_t size, retryix_net_buffer_t** net_buffer);
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_unregister_buffer(retryix_net_buffer_t* buffer);
+// 遠端存取授權: TCP 目標端只接受這裡配發的隨機 rkey; 描述符內的 rkey 僅限本機 (同進程 / 共享記憶體) 使用
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_grant_remote_access(retryix_net_buffer_t* buffer, uint32_t* rkey);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_revoke_remote_access(retryix_net_buffer_t* buffer);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_pool_prewarm(size_t buffer_size, uint32_t count);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_pool_get_stats(retryix_zc_pool_stats_t* stats);
+
+// 本機共享記憶體傳輸 (緩衝區以 retryix_zerocopy_destroy_net_buffer 釋放)
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_shm_create_region(size_t size, retryix_net_buffer_t** buffer);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_shm_connect(int32_t peer_pid, retryix_net_connection_t* connection);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_shm_disconnect(retryix_net_connection_t* connection);
+
+// TCP 傳輸 (Linux; 目標端需先 listen, 單邊操作由其服務線程代為執行)
+// tcp_listen 只綁定回環位址; 跨主機時以 tcp_listen_on 指定介面位址 ("0.0.0.0" = 全部介面)
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_listen(uint16_t port, uint16_t* bound_port);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_listen_on(const char* bind_ip, uint16_t port, uint16_t* bound_port);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_connect(const char* remote_ip, uint16_t remote_port, retryix_net_connection_t* connection);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_disconnect(retryix_net_connection_t* connection);
 
 // 網路連接管理
+// balance_net_load: 以即時速率重新平衡最近建立且尚未銷毀的路徑群組, 輸出各路徑的千分比權重
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_balance_net_load(uint32_t* load_distribution, int num_devices);
+
+// 多路徑分條傳輸 (各連線需通往同一目標; 群組須在 net_cleanup 前銷毀)
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_path_group_create(const retryix_net_connection_t* connections, int num_connections, retryix_zc_path_group_t** group);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_path_group_destroy(retryix_zc_path_group_t* group);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_striped_transfer_async(retryix_zc_path_group_t* group, const void* local_buffer, uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t* transfer_id);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_path_group_get_stats(retryix_zc_path_group_t* group, retryix_zc_path_stats_t* stats, int max_paths, int* num_paths);
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_coherence_protocol(retryix_net_connection_t* connection);
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_create_distributed_svm(void* svm_ptr, size_t size, retryix_net_buffer_t** distributed_buffer);
 
@@ -142,6 +222,11 @@ RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_create_distr
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_discover_net_topology(char* topology_info, size_t buffer_size);
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_monitor_net_perf(float* bandwidth_mbps, float* latency_us, int* packet_loss);
 
+// 網路性能量測 (connection 為 NULL 表示同進程路徑; 結果依連線快取)
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_probe_net_perf(const retryix_net_connection_t* connection, retryix_net_perf_t* perf);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_get_net_perf(const retryix_net_connection_t* connection, uint32_t max_age_ms, retryix_net_perf_t* perf);
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_set_perf_refresh(uint32_t interval_ms);
+
 // 網路健康監控
 RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_get_system_health(char* health_report, size_t buffer_size);
 
@@ -170,4 +255,4 @@ RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_sync_distrib
 }
 #endif
 
-#endif /* RETRYIX_ZEROCOPY_H */
\ No newline at end of file
+#endif /* RETRYIX_ZEROCOPY_H */
@@ -0,0 +1,238 @@
+/*
+ * retryix_zerocopy_internal.h
+ * Zerocopy 模組內部共用介面 (不對外導出)
+ * 緩衝池 / 記憶體鍵查詢 / 平台鎖
+ */
+
+#ifndef RETRYIX_ZEROCOPY_INTERNAL_H
+#define RETRYIX_ZEROCOPY_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "retryix_zerocopy.h"
+#include "retryix_atomic_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ===================== 平台鎖與條件變數 =====================
+
+#ifdef _WIN32
+#include <windows.h>
+#define ZC_MUTEX SRWLOCK
+#define ZC_MUTEX_INITIALIZER SRWLOCK_INIT
+#define ZC_MUTEX_LOCK(m) AcquireSRWLockExclusive(m)
+#define ZC_MUTEX_UNLOCK(m) ReleaseSRWLockExclusive(m)
+#define ZC_COND CONDITION_VARIABLE
+#define ZC_COND_INIT(c) InitializeConditionVariable(c)
+#define ZC_COND_DESTROY(c) ((void)(c))
+#define ZC_COND_WAIT_MS(c, m, ms) SleepConditionVariableSRW((c), (m), (ms), 0)
+#define ZC_COND_BROADCAST(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#define ZC_MUTEX pthread_mutex_t
+#define ZC_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define ZC_MUTEX_LOCK(m) pthread_mutex_lock(m)
+#define ZC_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+#define ZC_COND pthread_cond_t
+#define ZC_COND_INIT(c) pthread_cond_init((c), NULL)
+#define ZC_COND_DESTROY(c) pthread_cond_destroy(c)
+#define ZC_COND_WAIT_MS(c, m, ms) zc_cond_wait_ms((c), (m), (ms))
+#define ZC_COND_BROADCAST(c) pthread_cond_broadcast(c)
+#endif
+
+#ifndef _WIN32
+#include <time.h>
+static inline void zc_cond_wait_ms(pthread_cond_t* cond, pthread_mutex_t* mutex, uint32_t ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, mutex, &deadline);
+}
+#endif
+
+// ===================== 註冊緩衝池 =====================
+
+#define RETRYIX_ZC_POOL_CLASS_COUNT   6          ///< 4K / 16K / 64K / 256K / 1M / 4M
+#define RETRYIX_ZC_POOL_SLAB_BYTES    (2u << 20) ///< 2 MB (x86-64 huge page)
+#define RETRYIX_ZC_POOL_MAX_ENTRIES   (1u << 20) ///< 描述符上限 (鍵空間 24 bit 內)
+
+#define RETRYIX_ZC_CLASS_LARGE     (-1)          ///< 超過最大級別, 獨立映射
+#define RETRYIX_ZC_CLASS_EXTERNAL  (-2)          ///< 使用者自有記憶體的註冊 (含共享記憶體區域)
+
+/**
+ * 池內緩衝區描述符
+ * desc 會直接交給呼叫端, 位址在整個進程生命週期內不變
+ */
+typedef struct retryix_zc_pool_entry {
+    retryix_net_buffer_t desc;            ///< 對外描述符 (buffer / lkey / rkey)
+    size_t capacity;                      ///< 實際保留的位元組數
+    int32_t size_class;                   ///< 級別索引, 或 RETRYIX_ZC_CLASS_*
+    uint32_t index;                       ///< 描述符表索引
+    uint32_t generation;                  ///< 重新註冊次數 (僅獨立映射/外部註冊遞增)
+    volatile uint32_t next_free;          ///< 無鎖空閒串列鏈結 (index+1, 0 = 結尾)
+    volatile uint32_t in_use;             ///< 是否已交給呼叫端
+    bool huge_backed;                     ///< 是否由大頁支撐
+    bool pinned;                          ///< 是否已釘住實體頁
+    uint32_t remote_rkey;                 ///< 遠端存取授權鍵 (0 = 未授權), 受授權表鎖保護
+} retryix_zc_pool_entry_t;
+
+/// 從池中取得緩衝區 (線程快取命中時無鎖且無系統呼叫)
+retryix_zerocopy_result_t retryix_zc_pool_acquire(size_t size, retryix_net_buffer_t** out);
+
+/// 歸還池緩衝區; 鍵值保留給下一次取用
+retryix_zerocopy_result_t retryix_zc_pool_release(retryix_net_buffer_t* desc);
+
+/// 為使用者自有記憶體配發描述符與鍵值
+retryix_zerocopy_result_t retryix_zc_pool_register_external(void* buffer, size_t size, retryix_net_buffer_t** out);
+retryix_zerocopy_result_t retryix_zc_pool_unregister_external(retryix_net_buffer_t* desc);
+
+/// 預先切出並註冊足以容納 count 個 buffer_size 緩衝區的 slab
+retryix_zerocopy_result_t retryix_zc_pool_prewarm(size_t buffer_size, uint32_t count);
+void retryix_zc_pool_get_stats(retryix_zc_pool_stats_t* stats);
+
+/// 依 lkey 取得描述符 (O(1)), 無效時回傳 NULL
+retryix_zc_pool_entry_t* retryix_zc_pool_lookup_lkey(uint32_t lkey);
+
+/// 依 rkey 取得描述符 (O(1)), 無效或未使用時回傳 NULL
+retryix_zc_pool_entry_t* retryix_zc_pool_lookup_rkey(uint32_t rkey);
+
+/**
+ * 驗證 [addr, addr+size) 完全落在 rkey 所註冊的區域內, 成功時輸出本地指標
+ * @return RETRYIX_ZC_SUCCESS 或 RETRYIX_ZC_ERROR_INVALID_PARAM
+ */
+retryix_zerocopy_result_t retryix_zc_pool_resolve(uint32_t rkey, uint64_t addr, size_t size, void** local_ptr);
+
+#define RETRYIX_ZC_REMOTE_MAX_GRANTS  4096       ///< 同時有效的遠端授權上限
+
+/**
+ * 授權遠端對端存取此緩衝區, 每次授權配發一把隨機 rkey (重複授權會撤銷舊鍵)
+ * 緩衝區歸還或取消註冊時自動撤銷
+ */
+retryix_zerocopy_result_t retryix_zc_pool_grant_remote(retryix_net_buffer_t* desc, uint32_t* rkey);
+retryix_zerocopy_result_t retryix_zc_pool_revoke_remote(retryix_net_buffer_t* desc);
+
+/**
+ * 遠端請求專用: 只接受 retryix_zc_pool_grant_remote 配發且仍有效的 rkey,
+ * 並驗證 [addr, addr+size) 落在該次授權的緩衝區內
+ */
+retryix_zerocopy_result_t retryix_zc_pool_resolve_remote(uint32_t rkey, uint64_t addr, size_t size, void** local_ptr);
+
+// ===================== 本機共享記憶體傳輸 (RDMA 替身) =====================
+
+#define RETRYIX_ZC_SHM_MAX_REGIONS  256          ///< 每進程可導出的區域數
+#define RETRYIX_ZC_SHM_MAX_PEERS    32           ///< 每進程可連線的對端數
+
+/// 建立可被同機其他進程單邊存取的區域, 並登記於本進程的導出目錄
+retryix_zerocopy_result_t retryix_zc_shm_create_region(size_t size, retryix_net_buffer_t** out);
+
+/// 撤銷導出並釋放區域; 非共享記憶體描述符回傳 RETRYIX_ZC_ERROR_INVALID_PARAM
+retryix_zerocopy_result_t retryix_zc_shm_destroy_region(retryix_net_buffer_t* desc);
+bool retryix_zc_shm_owns(const retryix_net_buffer_t* desc);
+
+retryix_zerocopy_result_t retryix_zc_shm_connect(int32_t peer_pid, retryix_net_connection_t* connection);
+retryix_zerocopy_result_t retryix_zc_shm_disconnect(retryix_net_connection_t* connection);
+bool retryix_zc_shm_peer_alive(const retryix_net_connection_t* connection);
+
+/**
+ * 將對端虛擬位址 [addr, addr+size) 轉為本地可存取指標
+ * rkey 為 0 時僅依位址範圍查找區域
+ */
+retryix_zerocopy_result_t retryix_zc_shm_resolve(const retryix_net_connection_t* connection, uint32_t rkey,
+                                                 uint64_t addr, size_t size, void** local_ptr);
+
+/// 撤銷導出目錄名稱 (已建立的對端映射不受影響)
+void retryix_zc_shm_shutdown(void);
+
+// ===================== DMA 傳輸記錄 (retryix_zerocopy_module.c) =====================
+
+/// 傳輸完成回呼; 可能在傳輸層線程內 (持有連線鎖) 執行, 不得在其中投遞新傳輸
+typedef void (*retryix_zc_transfer_cb)(void* ctx, uint64_t transfer_id, retryix_dma_status_t status);
+
+/// 配發新的 transfer_id, 狀態為 RETRYIX_DMA_IN_PROGRESS
+uint64_t retryix_zc_transfer_open(void);
+uint64_t retryix_zc_transfer_open_cb(retryix_zc_transfer_cb done, void* ctx);
+
+/// 由傳輸層回報最終狀態 (COMPLETED / ERROR / TIMEOUT)
+void retryix_zc_transfer_finish(uint64_t transfer_id, retryix_dma_status_t status);
+
+/**
+ * 依連線協議投遞單邊寫入
+ * 成功時傳輸終將以 retryix_zc_transfer_finish 回報 (本地路徑會在返回前完成);
+ * 失敗時不回報, 由呼叫端處理
+ */
+retryix_zerocopy_result_t retryix_zc_post_write(const retryix_net_connection_t* connection, const void* local_buffer,
+                                                uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id);
+
+// ===================== TCP 傳輸 (RETRYIX_NET_PROTO_TCP_OFFLOAD) =====================
+
+#define RETRYIX_ZC_TCP_MAX_CONNS    64
+#define RETRYIX_ZC_TCP_ZC_THRESHOLD (16u << 10)  ///< 小於此大小的批次直接複製, MSG_ZEROCOPY 不划算
+
+/// bind_ip 為 NULL 或空字串時只綁定回環位址
+retryix_zerocopy_result_t retryix_zc_tcp_listen(const char* bind_ip, uint16_t port, uint16_t* bound_port);
+retryix_zerocopy_result_t retryix_zc_tcp_connect(const char* ip, uint16_t port, retryix_net_connection_t* connection);
+retryix_zerocopy_result_t retryix_zc_tcp_disconnect(retryix_net_connection_t* connection);
+
+/// 投遞單邊寫入; 完成時以 retryix_zc_transfer_finish 回報 transfer_id
+retryix_zerocopy_result_t retryix_zc_tcp_post_write(const retryix_net_connection_t* connection, const void* local_buffer,
+                                                    uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id);
+
+/// 投遞單邊讀取; 回應資料直接收進 local_buffer
+retryix_zerocopy_result_t retryix_zc_tcp_post_read(const retryix_net_connection_t* connection, void* local_buffer,
+                                                   uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id);
+
+/// 投遞量測用負載: 對端收下後直接丟棄並回 ACK, 不需目標緩衝區
+retryix_zerocopy_result_t retryix_zc_tcp_post_sink(const retryix_net_connection_t* connection, const void* payload,
+                                                   size_t size, uint64_t transfer_id);
+
+/// 等待此連線上所有已投遞的傳輸完成
+retryix_zerocopy_result_t retryix_zc_tcp_flush(const retryix_net_connection_t* connection, uint32_t timeout_ms);
+
+/**
+ * 持有連線引用: 期間其他線程斷線只會讓請求失敗, 連線物件不會被回收
+ * @return 不透明句柄, 以 retryix_zc_tcp_unhold 釋放; 連線不存在時為 NULL
+ */
+void* retryix_zc_tcp_hold(const retryix_net_connection_t* connection);
+void retryix_zc_tcp_unhold(void* handle);
+
+/// 關閉監聽與所有連線 (未完成的傳輸回報 RETRYIX_DMA_ERROR)
+void retryix_zc_tcp_shutdown(void);
+
+// ===================== 網絡性能量測 (retryix_zerocopy_perf.c) =====================
+
+#define RETRYIX_ZC_PERF_MAX_CONNS   64           ///< 快取的連線數上限
+
+/// 依快取選出通往 dest_ip 的最佳連線 (source_ip 可為 NULL 或空字串)
+bool retryix_zc_perf_best_path(const char* source_ip, const char* dest_ip,
+                               retryix_net_connection_t* connection, retryix_net_perf_t* perf);
+
+/// 只查快取, 不觸發量測
+bool retryix_zc_perf_lookup(const retryix_net_connection_t* connection, retryix_net_perf_t* perf);
+
+/// 最近一次量測結果; 尚無量測時回傳 false
+bool retryix_zc_perf_latest(retryix_net_perf_t* perf);
+
+/// 從快取移除 (斷線時呼叫)
+void retryix_zc_perf_forget(const retryix_net_connection_t* connection);
+
+/// 停止背景刷新並清空快取
+void retryix_zc_perf_shutdown(void);
+
+// ===================== 多路徑分條 (retryix_zerocopy_stripe.c) =====================
+
+/// 以即時速率重新估計最近建立且尚未銷毀的路徑群組, 輸出千分比權重; 無群組時回傳 RETRYIX_ZC_ERROR_NOT_INITIALIZED
+retryix_zerocopy_result_t retryix_zc_stripe_rebalance(uint32_t* load_distribution, int num_devices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRYIX_ZEROCOPY_INTERNAL_H */
@@ -0,0 +1,419 @@
+// retryix_bus_stream.c - NVMe 到主機緩衝區的串流讀取
+// 檔案以 O_DIRECT + io_uring 依序讀入 chunk_count 個輪替的頁對齊緩衝塊 (預設雙緩衝):
+// 呼叫端處理第 k 塊時, 其餘緩衝塊的讀取已交給核心, 不再經過 fread 的頁快取與 memcpy
+// 每塊切成不超過佇列深度的讀取並整塊發出, 呼叫端計算期間不需回來補發
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_bus_scheduler.h"
+#include "retryix_bus_uring_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifndef _WIN32
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE             14
+#endif
+#endif
+
+#define STREAM_ALIGN              4096u
+#define STREAM_HUGE_PAGE          (2u << 20)   // 緩衝區達此大小時改用 2MB 對齊的獨立映射區
+#define STREAM_DEFAULT_CHUNK      (8u << 20)
+#define STREAM_MAX_CHUNKS         16
+#define STREAM_MIN_IO             (128u << 10)
+#define STREAM_MAX_QD             RETRYIX_URING_MAX_ENTRIES
+#define STREAM_OFFSET_BITS        40           // user_data: 緩衝塊索引 << 40 | 塊內位移
+
+typedef enum {
+    STREAM_CHUNK_FREE = 0,
+    STREAM_CHUNK_FILLING,
+    STREAM_CHUNK_READY,
+    STREAM_CHUNK_HELD
+} stream_chunk_state_t;
+
+typedef struct {
+    unsigned char* buf;
+    stream_chunk_state_t state;
+    int sequence;
+    unsigned long long file_offset;        // buf[0] 對應的檔案位置 (4 KB 對齊)
+    size_t needed;                         // 需要讀到的位元組 (到區段結尾或檔尾)
+    size_t span;                           // 實際發出的長度 (needed 向上對齊)
+    size_t next_issue;                     // 下一筆尚未發出的塊內位移
+    unsigned outstanding;
+    bool failed;
+} stream_chunk_t;
+
+struct retryix_bus_stream {
+    int fd;
+    retryix_uring_t ring;
+    unsigned char* region;
+    size_t mapped_bytes;                   // > 0: region 為獨立映射區, 否則為對齊的主機配置
+    bool direct;
+    int controller_id;
+    int queue_depth;
+    unsigned io_size;
+    size_t chunk_size;
+    int chunk_count;
+    stream_chunk_t chunks[STREAM_MAX_CHUNKS];
+    unsigned long long start;              // 對齊後的起點
+    unsigned long long offset;             // 呼叫端要求的起點
+    unsigned long long end;                // 結束位置 (不含), 已限制在檔案大小內
+    int total_chunks;
+    int next_fill;
+    int next_deliver;
+    unsigned long long opened_ns;
+    unsigned long long stall_ns;
+    unsigned long long bytes_delivered;
+    unsigned long long chunks_delivered;
+};
+
+static void* stream_host_alloc(size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, STREAM_ALIGN);
+#else
+    void* p = NULL;
+    return posix_memalign(&p, STREAM_ALIGN, bytes) == 0 ? p : NULL;
+#endif
+}
+
+static void stream_host_free(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// 大緩衝區: 多映射一個大頁後裁掉頭尾取得 2MB 對齊並建議透明大頁 (Windows 以 VirtualAlloc 配置);
+// 不依賴拓撲模組, 匯流排模組可單獨連結
+static void* stream_region_map(size_t bytes) {
+#ifdef _WIN32
+    return VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    size_t span = bytes + STREAM_HUGE_PAGE;
+    void* raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    uintptr_t aligned = ((uintptr_t)raw + STREAM_HUGE_PAGE - 1) & ~(uintptr_t)(STREAM_HUGE_PAGE - 1);
+    size_t head = aligned - (uintptr_t)raw;
+    if (head) munmap(raw, head);
+    if (span - head > bytes) munmap((void*)(aligned + bytes), span - head - bytes);
+    madvise((void*)aligned, bytes, MADV_HUGEPAGE);
+    return (void*)aligned;
+#endif
+}
+
+static void stream_region_unmap(void* p, size_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, bytes);
+#endif
+}
+
+static bool stream_issue(retryix_bus_stream_t* s, int index, size_t pos) {
+    stream_chunk_t* c = &s->chunks[index];
+    size_t seg_end = (pos / s->io_size + 1) * s->io_size;
+    if (seg_end > c->span) seg_end = c->span;
+    if (s->ring.pending + s->ring.inflight >= (unsigned)s->queue_depth) {
+        return false;
+    }
+    uint64_t user_data = ((uint64_t)index << STREAM_OFFSET_BITS) | pos;
+    if (!retryix_uring_prep_read(&s->ring, s->fd, c->buf + pos, (uint32_t)(seg_end - pos),
+                                 c->file_offset + pos, user_data, index)) {
+        return false;
+    }
+    c->outstanding++;
+    return true;
+}
+
+// 依序號先後補發讀取, 再把空出的緩衝塊指派給後續區段
+static void stream_pump(retryix_bus_stream_t* s) {
+    for (int seq = s->next_deliver; seq < s->next_fill; seq++) {
+        int index = seq % s->chunk_count;
+        stream_chunk_t* c = &s->chunks[index];
+        if (c->sequence != seq || c->state != STREAM_CHUNK_FILLING) continue;
+        while (c->next_issue < c->span) {
+            if (!stream_issue(s, index, c->next_issue)) return;
+            c->next_issue = (c->next_issue / s->io_size + 1) * s->io_size;
+        }
+    }
+    while (s->next_fill < s->total_chunks) {
+        int index = s->next_fill % s->chunk_count;
+        stream_chunk_t* c = &s->chunks[index];
+        if (c->state != STREAM_CHUNK_FREE) return;
+        unsigned long long begin = s->start + (unsigned long long)s->next_fill * s->chunk_size;
+        unsigned long long stop = begin + s->chunk_size < s->end ? begin + s->chunk_size : s->end;
+        c->state = STREAM_CHUNK_FILLING;
+        c->sequence = s->next_fill++;
+        c->file_offset = begin;
+        c->needed = (size_t)(stop - begin);
+        c->span = (c->needed + STREAM_ALIGN - 1) & ~(size_t)(STREAM_ALIGN - 1);
+        c->next_issue = 0;
+        c->outstanding = 0;
+        c->failed = false;
+        while (c->next_issue < c->span) {
+            if (!stream_issue(s, index, c->next_issue)) return;
+            c->next_issue = (c->next_issue / s->io_size + 1) * s->io_size;
+        }
+    }
+}
+
+static void stream_complete(retryix_bus_stream_t* s, const retryix_uring_cqe_t* cqe) {
+    int index = (int)(cqe->user_data >> STREAM_OFFSET_BITS);
+    size_t pos = (size_t)(cqe->user_data & ((1ull << STREAM_OFFSET_BITS) - 1));
+    if (index < 0 || index >= s->chunk_count) return;
+    stream_chunk_t* c = &s->chunks[index];
+    c->outstanding--;
+
+    size_t seg_end = (pos / s->io_size + 1) * s->io_size;
+    size_t want = (seg_end < c->needed ? seg_end : c->needed) - (pos < c->needed ? pos : c->needed);
+    if (cqe->res < 0 || (cqe->res == 0 && want > 0)) {
+        c->failed = true;
+    } else if ((size_t)cqe->res < want) {
+        // 短讀: 從停下的位置補讀同一區段 (剛取回完成事件, 佇列必有空位)
+        if (!stream_issue(s, index, pos + (size_t)cqe->res)) c->failed = true;
+    }
+    if (c->outstanding == 0 && c->next_issue >= c->span && c->state == STREAM_CHUNK_FILLING) {
+        c->state = STREAM_CHUNK_READY;
+    }
+}
+
+static retryix_bus_result_t stream_progress(retryix_bus_stream_t* s, unsigned wait_nr) {
+    stream_pump(s);
+    if (retryix_uring_submit(&s->ring, wait_nr) != 0) {
+        return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+    }
+    retryix_uring_cqe_t cqes[STREAM_MAX_QD];
+    unsigned n = retryix_uring_reap(&s->ring, cqes, STREAM_MAX_QD);
+    for (unsigned i = 0; i < n; i++) {
+        stream_complete(s, &cqes[i]);
+    }
+    if (n > 0) {
+        stream_pump(s);
+        if (retryix_uring_submit(&s->ring, 0) != 0) {
+            return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+        }
+    }
+    return RETRYIX_BUS_SUCCESS;
+}
+
+static void stream_destroy(retryix_bus_stream_t* s) {
+    // 在途讀取仍會寫入緩衝塊, 先全部取回
+    while (s->ring.pending + s->ring.inflight > 0) {
+        retryix_uring_cqe_t cqes[STREAM_MAX_QD];
+        if (retryix_uring_submit(&s->ring, 1) != 0) break;
+        retryix_uring_reap(&s->ring, cqes, STREAM_MAX_QD);
+    }
+    retryix_uring_exit(&s->ring);
+    retryix_uring_close(s->fd);
+    if (s->region) {
+        if (s->mapped_bytes) stream_region_unmap(s->region, s->mapped_bytes);
+        else stream_host_free(s->region);
+    }
+    free(s);
+}
+
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL retryix_bus_stream_open(const retryix_bus_stream_config_t* config,
+                                                                     retryix_bus_stream_t** stream) {
+    if (!config || !config->path || !stream) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    *stream = NULL;
+    size_t chunk_size = config->chunk_size ? config->chunk_size : STREAM_DEFAULT_CHUNK;
+    chunk_size = (chunk_size + STREAM_ALIGN - 1) & ~(size_t)(STREAM_ALIGN - 1);
+    int chunk_count = config->chunk_count ? config->chunk_count : 2;
+    if (chunk_count < 2 || chunk_count > STREAM_MAX_CHUNKS || chunk_size > (1ull << STREAM_OFFSET_BITS)) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+
+    // 佇列深度取自控制器資訊
+    int controller_id = config->controller_id;
+    retryix_bus_info_t info;
+    bool have_info = false;
+    if (controller_id >= 0) {
+        if (retryix_bus_monitor_status(controller_id, &info) != RETRYIX_BUS_SUCCESS) {
+            return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+        }
+        have_info = true;
+    } else if (retryix_bus_find_controller_for_path(config->path, &controller_id) == RETRYIX_BUS_SUCCESS &&
+               retryix_bus_monitor_status(controller_id, &info) == RETRYIX_BUS_SUCCESS) {
+        have_info = true;
+    } else {
+        controller_id = -1;
+    }
+
+    retryix_bus_stream_t* s = (retryix_bus_stream_t*)calloc(1, sizeof(retryix_bus_stream_t));
+    if (!s) {
+        return RETRYIX_BUS_ERROR_INSUFFICIENT_BUFFER;
+    }
+    s->fd = retryix_uring_open_direct(config->path, &s->direct);
+    if (s->fd < 0) {
+        free(s);
+        return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+    }
+    s->controller_id = controller_id;
+    s->chunk_size = chunk_size;
+    s->chunk_count = chunk_count;
+    s->queue_depth = retryix_bus_pick_queue_depth(have_info ? &info : NULL, STREAM_MIN_IO);
+    size_t io = (chunk_size + (size_t)s->queue_depth - 1) / (size_t)s->queue_depth;
+    io = (io + STREAM_ALIGN - 1) & ~(size_t)(STREAM_ALIGN - 1);
+    if (io < STREAM_MIN_IO) io = STREAM_MIN_IO;
+    if (io > chunk_size) io = chunk_size;
+    s->io_size = (unsigned)io;
+
+    unsigned long long file_size = retryix_uring_file_size(s->fd);
+    if (config->offset > file_size) {
+        stream_destroy(s);
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    s->offset = config->offset;
+    s->start = config->offset & ~(unsigned long long)(STREAM_ALIGN - 1);
+    s->end = config->length && config->length < file_size - config->offset ? config->offset + config->length : file_size;
+    s->total_chunks = s->end > s->offset ? (int)((s->end - s->start + chunk_size - 1) / chunk_size) : 0;
+
+    if (retryix_uring_init(&s->ring, (unsigned)s->queue_depth, true) != 0) {
+        stream_destroy(s);
+        return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+    }
+    if (s->ring.entries < (unsigned)s->queue_depth) s->queue_depth = (int)s->ring.entries;
+
+    // 一次配置所有緩衝塊; 達大頁大小時為 2MB 對齊的映射區, 否則 (或映射失敗) 為頁對齊的主機配置,
+    // 兩者都滿足 O_DIRECT 的對齊要求
+    size_t region_bytes = chunk_size * (size_t)chunk_count;
+    if (region_bytes >= STREAM_HUGE_PAGE) {
+        size_t mapped = (region_bytes + STREAM_HUGE_PAGE - 1) & ~(size_t)(STREAM_HUGE_PAGE - 1);
+        s->region = (unsigned char*)stream_region_map(mapped);
+        if (s->region) s->mapped_bytes = mapped;
+    }
+    if (!s->region) {
+        s->region = (unsigned char*)stream_host_alloc(region_bytes);
+    }
+    if (!s->region) {
+        stream_destroy(s);
+        return RETRYIX_BUS_ERROR_INSUFFICIENT_BUFFER;
+    }
+
+    void* buffers[STREAM_MAX_CHUNKS];
+    size_t sizes[STREAM_MAX_CHUNKS];
+    for (int i = 0; i < chunk_count; i++) {
+        s->chunks[i].buf = s->region + (size_t)i * chunk_size;
+        s->chunks[i].state = STREAM_CHUNK_FREE;
+        s->chunks[i].sequence = -1;
+        buffers[i] = s->chunks[i].buf;
+        sizes[i] = chunk_size;
+    }
+    // 註冊後核心固定這些頁面, 讀取不再逐筆對應使用者頁; 超過 memlock 限制時改用一般讀取
+    retryix_uring_register_buffers(&s->ring, buffers, sizes, (unsigned)chunk_count);
+
+    printf("[BUS-SCHEDULER] 串流讀取 %s: %d 塊 x %zu KB, QD %d, 每筆 %u KB (控制器 %d%s%s%s)\n",
+           config->path, chunk_count, chunk_size >> 10, s->queue_depth, s->io_size >> 10, controller_id,
+           s->direct ? ", O_DIRECT" : "", s->ring.kernel ? ", io_uring" : "", s->ring.fixed_buffers ? ", 固定緩衝" : "");
+
+    s->opened_ns = retryix_uring_now_ns();
+    if (stream_progress(s, 0) != RETRYIX_BUS_SUCCESS) {
+        stream_destroy(s);
+        return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+    }
+    *stream = s;
+    return RETRYIX_BUS_SUCCESS;
+}
+
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL retryix_bus_stream_next(retryix_bus_stream_t* stream, retryix_bus_stream_chunk_t* chunk) {
+    if (!stream || !chunk) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    memset(chunk, 0, sizeof(*chunk));
+    chunk->buffer_index = -1;
+    int seq = stream->next_deliver;
+    if (seq >= stream->total_chunks) {
+        chunk->sequence = seq;
+        chunk->file_offset = stream->end;
+        return RETRYIX_BUS_SUCCESS;
+    }
+    int index = seq % stream->chunk_count;
+    stream_chunk_t* c = &stream->chunks[index];
+    if (c->sequence != seq) {
+        stream_pump(stream);   // 緩衝塊剛交還, 尚未指派
+    }
+    if (c->sequence != seq) {
+        return RETRYIX_BUS_ERROR_INSUFFICIENT_BUFFER;   // 所有緩衝塊都在呼叫端手上
+    }
+
+    unsigned long long wait_start = retryix_uring_now_ns();
+    while (c->state == STREAM_CHUNK_FILLING) {
+        retryix_bus_result_t rc = stream_progress(stream, 1);
+        if (rc != RETRYIX_BUS_SUCCESS) {
+            return rc;
+        }
+    }
+    stream->stall_ns += retryix_uring_now_ns() - wait_start;
+    if (c->failed) {
+        return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+    }
+
+    size_t lead = seq == 0 ? (size_t)(stream->offset - stream->start) : 0;
+    c->state = STREAM_CHUNK_HELD;
+    chunk->data = c->buf + lead;
+    chunk->bytes = c->needed - lead;
+    chunk->file_offset = c->file_offset + lead;
+    chunk->sequence = seq;
+    chunk->buffer_index = index;
+    stream->next_deliver++;
+    stream->bytes_delivered += chunk->bytes;
+    stream->chunks_delivered++;
+    return RETRYIX_BUS_SUCCESS;
+}
+
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL retryix_bus_stream_release(retryix_bus_stream_t* stream, const retryix_bus_stream_chunk_t* chunk) {
+    if (!stream || !chunk) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    if (chunk->buffer_index < 0) {
+        return RETRYIX_BUS_SUCCESS;   // 結尾標記
+    }
+    if (chunk->buffer_index >= stream->chunk_count) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    stream_chunk_t* c = &stream->chunks[chunk->buffer_index];
+    if (c->state != STREAM_CHUNK_HELD || c->sequence != chunk->sequence) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    c->state = STREAM_CHUNK_FREE;
+    return stream_progress(stream, 0);
+}
+
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL retryix_bus_stream_get_stats(const retryix_bus_stream_t* stream, retryix_bus_stream_stats_t* stats) {
+    if (!stream || !stats) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    memset(stats, 0, sizeof(*stats));
+    unsigned long long elapsed = retryix_uring_now_ns() - stream->opened_ns;
+    stats->bytes_delivered = stream->bytes_delivered;
+    stats->chunks_delivered = stream->chunks_delivered;
+    stats->stall_us = (double)stream->stall_ns / 1000.0;
+    stats->bandwidth_gbps = elapsed ? (double)stream->bytes_delivered / (double)elapsed : 0.0;
+    stats->queue_depth = stream->queue_depth;
+    stats->io_size = stream->io_size;
+    stats->controller_id = stream->controller_id;
+    stats->direct_io = stream->direct;
+    stats->kernel_async = stream->ring.kernel;
+    stats->fixed_buffers = stream->ring.fixed_buffers;
+    stats->mapped_region = stream->mapped_bytes > 0;
+    return RETRYIX_BUS_SUCCESS;
+}
+
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL retryix_bus_stream_close(retryix_bus_stream_t* stream) {
+    if (!stream) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    stream_destroy(stream);
+    return RETRYIX_BUS_SUCCESS;
+}
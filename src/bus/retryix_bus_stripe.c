@@ -0,0 +1,489 @@
+// retryix_bus_stripe.c - 多控制器分散讀取
+// 同一份資料在多個控制器上各有副本時, 把讀取範圍依各裝置帶寬切成連續分片,
+// 每個裝置一個執行緒與自己的 io_uring 佇列; 分片讀完的裝置從預估最晚完成的裝置尾端接手,
+// 呼叫端執行緒則定期檢查熱節流與電源限制, 受限裝置降低佇列深度並讓出剩餘工作
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_bus_scheduler.h"
+#include "retryix_bus_uring_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define STRIPE_ALIGN              4096u
+#define STRIPE_DEFAULT_UNIT       (1u << 20)
+#define STRIPE_MAX_UNIT           (1u << 30)
+#define STRIPE_CHECK_INTERVAL_MS  200
+#define STRIPE_THROTTLE_FACTOR    0.5          // 受限裝置的速率估計與佇列深度
+#define STRIPE_BOUNCE_FLAG        0x80000000u  // user_data 低 32 位元: 塊內位移, 最高位表示尾端暫存讀取
+#define STRIPE_MAX_REGISTER       (1ull << 30) // io_uring 單一固定緩衝區上限
+
+#ifdef _WIN32
+#define STRIPE_LOCK(j)       AcquireSRWLockExclusive(&(j)->lock)
+#define STRIPE_UNLOCK(j)     ReleaseSRWLockExclusive(&(j)->lock)
+#define STRIPE_BROADCAST(j)  WakeAllConditionVariable(&(j)->cond)
+#else
+#define STRIPE_LOCK(j)       pthread_mutex_lock(&(j)->lock)
+#define STRIPE_UNLOCK(j)     pthread_mutex_unlock(&(j)->lock)
+#define STRIPE_BROADCAST(j)  pthread_cond_broadcast(&(j)->cond)
+#endif
+
+typedef struct stripe_job stripe_job_t;
+
+typedef struct {
+    stripe_job_t* job;
+    int controller_id;
+    int fd;
+    bool direct;
+    int queue_depth;                       // 未受限時的深度
+    double weight_gbps;                    // 尚無實測時的速率估計
+    // 以下由 job->lock 保護
+    size_t head;                           // 分片 [head, tail) 中尚未發出的單位
+    size_t tail;
+    bool throttled;
+    bool ever_throttled;
+    unsigned long long bytes_done;
+    unsigned long long stolen_bytes;
+    unsigned long long inflight_bytes;
+    unsigned long long peak_inflight;
+    unsigned long long errors;
+    unsigned long long last_ns;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    bool started;
+} stripe_device_t;
+
+struct stripe_job {
+    unsigned char* dest;
+    unsigned long long offset;
+    size_t length;
+    size_t unit;
+    size_t unit_count;
+    int device_count;
+    int finished;
+    unsigned long long start_ns;
+    stripe_device_t devices[RETRYIX_BUS_MAX_STRIPE_SOURCES];
+#ifdef _WIN32
+    SRWLOCK lock;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+};
+
+static size_t stripe_unit_bytes(const stripe_job_t* job, size_t unit) {
+    size_t begin = unit * job->unit;
+    return job->length - begin < job->unit ? job->length - begin : job->unit;
+}
+
+static size_t stripe_range_bytes(const stripe_job_t* job, size_t first, size_t last) {
+    if (first >= last) return 0;
+    return (last - 1) * job->unit + stripe_unit_bytes(job, last - 1) - first * job->unit;
+}
+
+// 位元組/奈秒 (= GB/s); 呼叫時持有 job->lock
+static double stripe_rate(const stripe_device_t* d) {
+    const stripe_job_t* job = d->job;
+    double rate = d->weight_gbps;
+    if (d->bytes_done > 0 && d->last_ns > job->start_ns) {
+        rate = (double)d->bytes_done / (double)(d->last_ns - job->start_ns);
+    }
+    if (d->throttled) rate *= STRIPE_THROTTLE_FACTOR;
+    return rate > 1e-6 ? rate : 1e-6;
+}
+
+// 取下一個單位: 先取自己分片的前端, 用完後依速率比例接手預估最晚完成者的尾端
+static bool stripe_take(stripe_device_t* d, size_t* unit) {
+    stripe_job_t* job = d->job;
+    bool found = false;
+    STRIPE_LOCK(job);
+    if (d->head >= d->tail) {
+        stripe_device_t* victim = NULL;
+        double worst = 0.0;
+        for (int i = 0; i < job->device_count; i++) {
+            stripe_device_t* v = &job->devices[i];
+            if (v == d || v->head >= v->tail) continue;
+            double remaining = (double)stripe_range_bytes(job, v->head, v->tail) / stripe_rate(v);
+            if (remaining > worst) {
+                worst = remaining;
+                victim = v;
+            }
+        }
+        if (victim) {
+            double mine = stripe_rate(d);
+            double theirs = stripe_rate(victim);
+            size_t left = victim->tail - victim->head;
+            size_t take = (size_t)((double)left * mine / (mine + theirs) + 0.5);
+            if (take > 0) {
+                d->head = victim->tail - take;
+                d->tail = victim->tail;
+                victim->tail = d->head;
+                d->stolen_bytes += stripe_range_bytes(job, d->head, d->tail);
+            }
+        }
+    }
+    if (d->head < d->tail) {
+        *unit = d->head++;
+        found = true;
+    }
+    STRIPE_UNLOCK(job);
+    return found;
+}
+
+static bool stripe_issue(stripe_device_t* d, retryix_uring_t* ring, unsigned char* bounce,
+                         size_t unit, size_t pos, size_t len, bool fixed) {
+    stripe_job_t* job = d->job;
+    size_t begin = unit * job->unit + pos;
+    uint64_t user_data = ((uint64_t)unit << 32) | (uint32_t)pos;
+    if (bounce) {
+        return retryix_uring_prep_read(ring, d->fd, bounce, STRIPE_ALIGN, job->offset + begin,
+                                       user_data | STRIPE_BOUNCE_FLAG, -1);
+    }
+    return retryix_uring_prep_read(ring, d->fd, job->dest + begin, (uint32_t)len, job->offset + begin,
+                                   user_data, fixed ? 0 : -1);
+}
+
+static void stripe_run_device(stripe_device_t* d) {
+    stripe_job_t* job = d->job;
+    retryix_uring_t* ring = (retryix_uring_t*)malloc(sizeof(retryix_uring_t));
+    unsigned char* bounce = NULL;
+#ifdef _WIN32
+    bounce = (unsigned char*)_aligned_malloc(STRIPE_ALIGN, STRIPE_ALIGN);
+#else
+    if (posix_memalign((void**)&bounce, STRIPE_ALIGN, STRIPE_ALIGN) != 0) bounce = NULL;
+#endif
+    if (!ring || !bounce || retryix_uring_init(ring, (unsigned)d->queue_depth, true) != 0) {
+        STRIPE_LOCK(job);
+        d->weight_gbps = 0.0;   // 速率估計趨近 0, 剩餘工作全數由其他裝置接手
+        STRIPE_UNLOCK(job);
+        free(ring);
+#ifdef _WIN32
+        _aligned_free(bounce);
+#else
+        free(bounce);
+#endif
+        return;
+    }
+    bool fixed = false;
+    if (job->length <= STRIPE_MAX_REGISTER) {
+        void* buffers[1] = { job->dest };
+        size_t sizes[1] = { (job->length + STRIPE_ALIGN - 1) & ~(size_t)(STRIPE_ALIGN - 1) };
+        fixed = retryix_uring_register_buffers(ring, buffers, sizes, 1);
+    }
+
+    unsigned ops = 0;
+    for (;;) {
+        STRIPE_LOCK(job);
+        unsigned limit = (unsigned)(d->throttled ? (d->queue_depth + 1) / 2 : d->queue_depth);
+        STRIPE_UNLOCK(job);
+        if (limit > ring->entries) limit = ring->entries;
+
+        size_t unit;
+        unsigned long long failed = 0;
+        while (ops + 2 <= limit && stripe_take(d, &unit)) {
+            size_t bytes = stripe_unit_bytes(job, unit);
+            // O_DIRECT 只能讀整頁: 資料尾端不足一頁的部分讀進暫存頁再複製
+            size_t body = d->direct ? bytes & ~(size_t)(STRIPE_ALIGN - 1) : bytes;
+            if (body > 0) {
+                if (stripe_issue(d, ring, NULL, unit, 0, body, fixed)) ops++;
+                else failed++;
+            }
+            if (body < bytes) {
+                if (stripe_issue(d, ring, bounce, unit, body, bytes - body, false)) ops++;
+                else failed++;
+            }
+            STRIPE_LOCK(job);
+            d->inflight_bytes += bytes;
+            if (d->inflight_bytes > d->peak_inflight) d->peak_inflight = d->inflight_bytes;
+            d->errors += failed;
+            STRIPE_UNLOCK(job);
+            failed = 0;
+        }
+        if (ops == 0) break;
+        if (retryix_uring_submit(ring, 1) != 0) {
+            STRIPE_LOCK(job);
+            d->errors++;
+            STRIPE_UNLOCK(job);
+            break;
+        }
+
+        retryix_uring_cqe_t cqes[RETRYIX_URING_MAX_ENTRIES];
+        unsigned n = retryix_uring_reap(ring, cqes, RETRYIX_URING_MAX_ENTRIES);
+        unsigned long long done = 0, lost = 0, errors = 0;
+        for (unsigned i = 0; i < n; i++) {
+            ops--;
+            size_t u = (size_t)(cqes[i].user_data >> 32);
+            uint32_t low = (uint32_t)cqes[i].user_data;
+            size_t pos = low & ~STRIPE_BOUNCE_FLAG;
+            size_t bytes = stripe_unit_bytes(job, u);
+            size_t body = d->direct ? bytes & ~(size_t)(STRIPE_ALIGN - 1) : bytes;
+            size_t want = ((low & STRIPE_BOUNCE_FLAG) ? bytes : body) - pos;
+            if (cqes[i].res <= 0 || ((low & STRIPE_BOUNCE_FLAG) && (size_t)cqes[i].res < want)) {
+                errors++;
+                lost += want;
+            } else if (low & STRIPE_BOUNCE_FLAG) {
+                memcpy(job->dest + u * job->unit + pos, bounce, want);
+                done += want;
+            } else if ((size_t)cqes[i].res < want) {
+                // 短讀: 補讀剩餘部分, 已取回完成事件故佇列有空位
+                done += (size_t)cqes[i].res;
+                if (stripe_issue(d, ring, NULL, u, pos + (size_t)cqes[i].res, want - (size_t)cqes[i].res, fixed)) {
+                    ops++;
+                } else {
+                    errors++;
+                    lost += want - (size_t)cqes[i].res;
+                }
+            } else {
+                done += want;
+            }
+        }
+        STRIPE_LOCK(job);
+        d->bytes_done += done;
+        d->inflight_bytes = d->inflight_bytes > done + lost ? d->inflight_bytes - done - lost : 0;
+        d->errors += errors;
+        d->last_ns = retryix_uring_now_ns();
+        STRIPE_UNLOCK(job);
+    }
+
+    // 提交失敗時仍有在途讀取寫入 dest, 全部取回後才離開
+    while (ring->pending + ring->inflight > 0) {
+        retryix_uring_cqe_t cqes[RETRYIX_URING_MAX_ENTRIES];
+        if (retryix_uring_submit(ring, 1) != 0) break;
+        retryix_uring_reap(ring, cqes, RETRYIX_URING_MAX_ENTRIES);
+    }
+    retryix_uring_exit(ring);
+    free(ring);
+#ifdef _WIN32
+    _aligned_free(bounce);
+#else
+    free(bounce);
+#endif
+}
+
+static void stripe_worker_finish(stripe_device_t* d) {
+    STRIPE_LOCK(d->job);
+    d->job->finished++;
+    STRIPE_BROADCAST(d->job);
+    STRIPE_UNLOCK(d->job);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI stripe_worker_win(LPVOID arg) {
+    stripe_run_device((stripe_device_t*)arg);
+    stripe_worker_finish((stripe_device_t*)arg);
+    return 0;
+}
+#else
+static void* stripe_worker_posix(void* arg) {
+    stripe_run_device((stripe_device_t*)arg);
+    stripe_worker_finish((stripe_device_t*)arg);
+    return NULL;
+}
+#endif
+
+// 等待全部裝置完成, 最多 timeout_ms; 呼叫時持有 job->lock
+static void stripe_wait(stripe_job_t* job, unsigned timeout_ms) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(&job->cond, &job->lock, timeout_ms, 0);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&job->cond, &job->lock, &ts);
+#endif
+}
+
+static void stripe_release(stripe_job_t* job) {
+    for (int i = 0; i < job->device_count; i++) {
+        retryix_uring_close(job->devices[i].fd);
+    }
+#ifndef _WIN32
+    pthread_cond_destroy(&job->cond);
+    pthread_mutex_destroy(&job->lock);
+#endif
+    free(job);
+}
+
+RETRYIX_API retryix_bus_result_t RETRYIX_CALL retryix_bus_striped_read(const retryix_bus_stripe_source_t* sources, int source_count,
+                                                                      unsigned long long offset, void* dest, size_t length, size_t unit_size,
+                                                                      retryix_bus_stripe_result_t* result) {
+    if (result) {
+        memset(result, 0, sizeof(*result));
+    }
+    if (!sources || source_count < 1 || source_count > RETRYIX_BUS_MAX_STRIPE_SOURCES || !dest) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    size_t unit = unit_size ? unit_size : STRIPE_DEFAULT_UNIT;
+    if ((offset & (STRIPE_ALIGN - 1)) || ((uintptr_t)dest & (STRIPE_ALIGN - 1)) ||
+        (unit & (STRIPE_ALIGN - 1)) || unit > STRIPE_MAX_UNIT) {
+        return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+    }
+    if (length == 0) {
+        return RETRYIX_BUS_SUCCESS;
+    }
+
+    stripe_job_t* job = (stripe_job_t*)calloc(1, sizeof(stripe_job_t));
+    if (!job) {
+        return RETRYIX_BUS_ERROR_INSUFFICIENT_BUFFER;
+    }
+    job->dest = (unsigned char*)dest;
+    job->offset = offset;
+    job->length = length;
+    job->unit = unit;
+    job->unit_count = (length + unit - 1) / unit;
+#ifdef _WIN32
+    InitializeSRWLock(&job->lock);
+    InitializeConditionVariable(&job->cond);
+#else
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->cond, NULL);
+#endif
+
+    // 各來源的控制器、初始速率與佇列深度
+    double total_weight = 0.0;
+    for (int i = 0; i < source_count; i++) {
+        stripe_device_t* d = &job->devices[i];
+        d->job = job;
+        d->controller_id = sources[i].controller_id;
+        d->fd = -1;
+        if (!sources[i].path) {
+            stripe_release(job);
+            return RETRYIX_BUS_ERROR_INVALID_PARAMETER;
+        }
+        retryix_bus_info_t info;
+        bool have_info = false;
+        if (d->controller_id >= 0 || retryix_bus_find_controller_for_path(sources[i].path, &d->controller_id) == RETRYIX_BUS_SUCCESS) {
+            have_info = retryix_bus_monitor_status(d->controller_id, &info) == RETRYIX_BUS_SUCCESS;
+        }
+        if (!have_info) {
+            d->controller_id = -1;
+        }
+        d->weight_gbps = 1.0;
+        if (have_info) {
+            if (info.peak_measured_bandwidth_gbps > 0.0f) d->weight_gbps = info.peak_measured_bandwidth_gbps;
+            else if (info.actual_bandwidth_gbps > 0.0f) d->weight_gbps = info.actual_bandwidth_gbps;
+            else if (info.theoretical_bandwidth_gbps > 0.0f) d->weight_gbps = info.theoretical_bandwidth_gbps;
+            d->throttled = info.thermal_throttling || info.power_limit_active;
+            d->ever_throttled = d->throttled;
+            info.thermal_throttling = false;   // 受限時的減半由執行期處理
+            info.power_limit_active = false;
+        }
+        d->queue_depth = retryix_bus_pick_queue_depth(have_info ? &info : NULL, (unsigned)(unit < (128u << 10) ? unit : (128u << 10)));
+        total_weight += d->throttled ? d->weight_gbps * STRIPE_THROTTLE_FACTOR : d->weight_gbps;
+        d->fd = retryix_uring_open_direct(sources[i].path, &d->direct);
+        job->device_count = i + 1;
+        if (d->fd < 0) {
+            stripe_release(job);
+            return RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+        }
+    }
+
+    // 依速率比例切成連續分片
+    double cumulative = 0.0;
+    size_t boundary = 0;
+    for (int i = 0; i < job->device_count; i++) {
+        stripe_device_t* d = &job->devices[i];
+        cumulative += d->throttled ? d->weight_gbps * STRIPE_THROTTLE_FACTOR : d->weight_gbps;
+        size_t next = i == job->device_count - 1 ? job->unit_count
+                                                 : (size_t)((double)job->unit_count * cumulative / total_weight + 0.5);
+        d->head = boundary;
+        d->tail = next < boundary ? boundary : next;
+        boundary = d->tail;
+    }
+
+    job->start_ns = retryix_uring_now_ns();
+    for (int i = 0; i < job->device_count; i++) {
+        stripe_device_t* d = &job->devices[i];
+#ifdef _WIN32
+        d->thread = CreateThread(NULL, 0, stripe_worker_win, d, 0, NULL);
+        d->started = d->thread != NULL;
+#else
+        d->started = pthread_create(&d->thread, NULL, stripe_worker_posix, d) == 0;
+#endif
+        if (!d->started) {
+            stripe_run_device(d);   // 無法建立執行緒時在呼叫端執行緒讀完此分片
+            stripe_worker_finish(d);
+        }
+    }
+
+    // 讀取期間定期重讀控制器狀態, 受限裝置的剩餘工作會被其他裝置接手
+    STRIPE_LOCK(job);
+    while (job->finished < job->device_count) {
+        stripe_wait(job, STRIPE_CHECK_INTERVAL_MS);
+        if (job->finished >= job->device_count) break;
+        STRIPE_UNLOCK(job);
+        bool limited[RETRYIX_BUS_MAX_STRIPE_SOURCES];
+        for (int i = 0; i < job->device_count; i++) {
+            retryix_bus_info_t info;
+            limited[i] = job->devices[i].controller_id >= 0 &&
+                         retryix_bus_monitor_status(job->devices[i].controller_id, &info) == RETRYIX_BUS_SUCCESS &&
+                         (info.thermal_throttling || info.power_limit_active);
+        }
+        STRIPE_LOCK(job);
+        for (int i = 0; i < job->device_count; i++) {
+            job->devices[i].throttled = limited[i];
+            if (limited[i]) job->devices[i].ever_throttled = true;
+        }
+    }
+    STRIPE_UNLOCK(job);
+
+    for (int i = 0; i < job->device_count; i++) {
+        stripe_device_t* d = &job->devices[i];
+        if (!d->started) continue;
+#ifdef _WIN32
+        WaitForSingleObject(d->thread, INFINITE);
+        CloseHandle(d->thread);
+#else
+        pthread_join(d->thread, NULL);
+#endif
+    }
+    unsigned long long elapsed = retryix_uring_now_ns() - job->start_ns;
+
+    unsigned long long total_bytes = 0, total_errors = 0;
+    size_t unread = 0;
+    for (int i = 0; i < job->device_count; i++) {
+        stripe_device_t* d = &job->devices[i];
+        total_bytes += d->bytes_done;
+        total_errors += d->errors;
+        unread += d->tail > d->head ? d->tail - d->head : 0;
+        if (result) {
+            retryix_bus_stripe_device_stats_t* s = &result->devices[i];
+            s->controller_id = d->controller_id;
+            s->weight = total_weight > 0.0 ? (d->throttled ? d->weight_gbps * STRIPE_THROTTLE_FACTOR : d->weight_gbps) / total_weight : 0.0;
+            s->bandwidth_gbps = d->last_ns > job->start_ns ? (double)d->bytes_done / (double)(d->last_ns - job->start_ns) : 0.0;
+            s->bytes = d->bytes_done;
+            s->stolen_bytes = d->stolen_bytes;
+            s->peak_inflight_bytes = d->peak_inflight;
+            s->errors = d->errors;
+            s->queue_depth = d->queue_depth;
+            s->direct_io = d->direct;
+            s->throttled = d->ever_throttled;
+        }
+    }
+    if (result) {
+        result->device_count = job->device_count;
+        result->bytes = total_bytes;
+        result->elapsed_ms = (double)elapsed / 1e6;
+        result->bandwidth_gbps = elapsed ? (double)total_bytes / (double)elapsed : 0.0;
+    }
+    stripe_release(job);
+    return total_errors == 0 && unread == 0 && total_bytes == length ? RETRYIX_BUS_SUCCESS : RETRYIX_BUS_ERROR_HARDWARE_ACCESS;
+}
@@ -0,0 +1,326 @@
+// retryix_bus_uring.c - 精簡 io_uring 封裝
+// 以 io_uring_setup / io_uring_enter / io_uring_register 系統呼叫直接操作提交與完成環
+// 無核心支援時退回同步模擬: prep 只記錄請求, submit 依序 pread 並把結果放進本地完成佇列
+#define RETRYIX_BUILD_DLL
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "retryix_bus_uring_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <linux/fs.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define RETRYIX_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+#endif
+
+#ifdef RETRYIX_HAVE_IO_URING
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup    425
+#define __NR_io_uring_enter    426
+#define __NR_io_uring_register 427
+#endif
+#define URING_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define URING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+uint64_t retryix_uring_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// ===== 核心環 =====
+
+#ifdef RETRYIX_HAVE_IO_URING
+
+static int uring_kernel_init(retryix_uring_t* ring) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, ring->entries, &params);
+    if (fd < 0) return -errno;
+
+    ring->ring_fd = fd;
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && ring->cq_map_size > ring->sq_map_size) ring->sq_map_size = ring->cq_map_size;
+
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) goto fail;
+    if (single) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) goto fail;
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto fail;
+
+    char* sq = (char*)ring->sq_map;
+    char* cq = (char*)ring->cq_map;
+    ring->sq_head = (volatile uint32_t*)(sq + params.sq_off.head);
+    ring->sq_tail = (volatile uint32_t*)(sq + params.sq_off.tail);
+    ring->sq_mask = *(uint32_t*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t*)(sq + params.sq_off.array);
+    ring->cq_head = (volatile uint32_t*)(cq + params.cq_off.head);
+    ring->cq_tail = (volatile uint32_t*)(cq + params.cq_off.tail);
+    ring->cq_mask = *(uint32_t*)(cq + params.cq_off.ring_mask);
+    ring->cqes = cq + params.cq_off.cqes;
+    ring->sq_tail_local = *ring->sq_tail;
+    ring->entries = params.sq_entries;
+    ring->kernel = true;
+    return 0;
+
+fail:
+    {
+        int err = -errno;
+        if (ring->sqes && ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+        if (ring->cq_map && ring->cq_map != MAP_FAILED && ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+        if (ring->sq_map && ring->sq_map != MAP_FAILED) munmap(ring->sq_map, ring->sq_map_size);
+        close(fd);
+        ring->sq_map = ring->cq_map = ring->sqes = NULL;
+        return err;
+    }
+}
+
+#endif
+
+int retryix_uring_init(retryix_uring_t* ring, unsigned entries, bool allow_kernel) {
+    if (!ring || entries == 0) return -EINVAL;
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+    unsigned cap = 1;
+    while (cap < entries && cap < RETRYIX_URING_MAX_ENTRIES) cap <<= 1;
+    ring->entries = cap;
+#ifdef RETRYIX_HAVE_IO_URING
+    if (allow_kernel && uring_kernel_init(ring) == 0) return 0;
+#else
+    (void)allow_kernel;
+#endif
+    ring->kernel = false;   // ENOSYS / EPERM (seccomp) / 舊核心: 同步模擬
+    return 0;
+}
+
+void retryix_uring_exit(retryix_uring_t* ring) {
+    if (!ring) return;
+#ifdef RETRYIX_HAVE_IO_URING
+    if (ring->kernel) {
+        munmap(ring->sqes, ring->sqes_size);
+        if (ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+        munmap(ring->sq_map, ring->sq_map_size);
+        close(ring->ring_fd);
+    }
+#endif
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+}
+
+bool retryix_uring_register_buffers(retryix_uring_t* ring, void* const* buffers, const size_t* sizes, unsigned count) {
+#ifdef RETRYIX_HAVE_IO_URING
+    if (!ring->kernel || count == 0) return false;
+    struct iovec* iov = (struct iovec*)calloc(count, sizeof(struct iovec));
+    if (!iov) return false;
+    for (unsigned i = 0; i < count; i++) {
+        iov[i].iov_base = buffers[i];
+        iov[i].iov_len = sizes[i];
+    }
+    int rc = (int)syscall(__NR_io_uring_register, ring->ring_fd, IORING_REGISTER_BUFFERS, iov, count);
+    free(iov);
+    ring->fixed_buffers = rc == 0;
+    return ring->fixed_buffers;
+#else
+    (void)ring; (void)buffers; (void)sizes; (void)count;
+    return false;
+#endif
+}
+
+bool retryix_uring_prep_read(retryix_uring_t* ring, int fd, void* buf, uint32_t len,
+                             uint64_t offset, uint64_t user_data, int buf_index) {
+    if (ring->pending + ring->inflight >= ring->entries) return false;
+#ifdef RETRYIX_HAVE_IO_URING
+    if (ring->kernel) {
+        uint32_t index = ring->sq_tail_local & ring->sq_mask;
+        struct io_uring_sqe* sqe = &((struct io_uring_sqe*)ring->sqes)[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = (buf_index >= 0 && ring->fixed_buffers) ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)buf;
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->user_data = user_data;
+        if (sqe->opcode == IORING_OP_READ_FIXED) sqe->buf_index = (uint16_t)buf_index;
+        ring->sq_array[index] = index;
+        ring->sq_tail_local++;
+        ring->pending++;
+        return true;
+    }
+#else
+    (void)buf_index;
+#endif
+    retryix_uring_emul_op_t* op = &ring->emul_ops[ring->pending++];
+    op->fd = fd;
+    op->buf = buf;
+    op->len = len;
+    op->offset = offset;
+    op->user_data = user_data;
+    return true;
+}
+
+static int32_t uring_emul_read(const retryix_uring_emul_op_t* op) {
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle(op->fd);
+    OVERLAPPED ov;
+    DWORD done = 0;
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = (DWORD)op->offset;
+    ov.OffsetHigh = (DWORD)(op->offset >> 32);
+    if (!ReadFile(handle, op->buf, op->len, &done, &ov)) {
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -EIO;
+    }
+    return (int32_t)done;
+#else
+    ssize_t n;
+    do {
+        n = pread(op->fd, op->buf, op->len, (off_t)op->offset);
+    } while (n < 0 && errno == EINTR);
+    return n < 0 ? -errno : (int32_t)n;
+#endif
+}
+
+int retryix_uring_submit(retryix_uring_t* ring, unsigned wait_nr) {
+#ifdef RETRYIX_HAVE_IO_URING
+    if (ring->kernel) {
+        unsigned to_submit = ring->pending;
+        // 部分提交時其餘請求留在提交環, 下次 enter 再交給核心
+        URING_STORE_RELEASE(ring->sq_tail, ring->sq_tail_local);
+        if (wait_nr > ring->inflight + to_submit) wait_nr = ring->inflight + to_submit;
+        for (;;) {
+            int rc = (int)syscall(__NR_io_uring_enter, ring->ring_fd, to_submit, wait_nr,
+                                  wait_nr ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+            if (rc >= 0) {
+                ring->pending -= (unsigned)rc;
+                ring->inflight += (unsigned)rc;
+                return 0;
+            }
+            if (errno != EINTR) return -errno;
+        }
+    }
+#endif
+    (void)wait_nr;
+    for (unsigned i = 0; i < ring->pending; i++) {
+        unsigned slot = (ring->emul_cq_head + ring->emul_cq_count) % RETRYIX_URING_MAX_ENTRIES;
+        ring->emul_cqes[slot].user_data = ring->emul_ops[i].user_data;
+        ring->emul_cqes[slot].res = uring_emul_read(&ring->emul_ops[i]);
+        ring->emul_cq_count++;
+    }
+    ring->inflight += ring->pending;
+    ring->pending = 0;
+    return 0;
+}
+
+unsigned retryix_uring_reap(retryix_uring_t* ring, retryix_uring_cqe_t* out, unsigned max) {
+    unsigned n = 0;
+#ifdef RETRYIX_HAVE_IO_URING
+    if (ring->kernel) {
+        uint32_t head = *ring->cq_head;
+        uint32_t tail = URING_LOAD_ACQUIRE(ring->cq_tail);
+        while (head != tail && n < max) {
+            struct io_uring_cqe* cqe = &((struct io_uring_cqe*)ring->cqes)[head & ring->cq_mask];
+            out[n].user_data = cqe->user_data;
+            out[n].res = cqe->res;
+            n++;
+            head++;
+        }
+        URING_STORE_RELEASE(ring->cq_head, head);
+        ring->inflight -= n;
+        return n;
+    }
+#endif
+    while (ring->emul_cq_count > 0 && n < max) {
+        out[n++] = ring->emul_cqes[ring->emul_cq_head];
+        ring->emul_cq_head = (ring->emul_cq_head + 1) % RETRYIX_URING_MAX_ENTRIES;
+        ring->emul_cq_count--;
+    }
+    ring->inflight -= n;
+    return n;
+}
+
+// ===== 檔案 =====
+
+int retryix_uring_open_direct(const char* path, bool* direct) {
+    if (!path) return -EINVAL;
+#ifdef _WIN32
+    // Windows 模擬路徑不繞過快取 (FILE_FLAG_NO_BUFFERING 需以 CreateFile 開啟)
+    if (direct) *direct = false;
+    int fd = _open(path, _O_RDONLY | _O_BINARY);
+    return fd < 0 ? -errno : fd;
+#else
+    int fd = open(path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (fd >= 0) {
+        if (direct) *direct = true;
+        return fd;
+    }
+    if (errno != EINVAL) return -errno;
+    fd = open(path, O_RDONLY | O_CLOEXEC);   // 檔案系統不支援 O_DIRECT
+    if (direct) *direct = false;
+    return fd < 0 ? -errno : fd;
+#endif
+}
+
+void retryix_uring_close(int fd) {
+#ifdef _WIN32
+    if (fd >= 0) _close(fd);
+#else
+    if (fd >= 0) close(fd);
+#endif
+}
+
+uint64_t retryix_uring_file_size(int fd) {
+#ifdef _WIN32
+    __int64 size = _filelengthi64(fd);
+    return size < 0 ? 0 : (uint64_t)size;
+#else
+    struct stat st;
+    if (fstat(fd, &st) != 0) return 0;
+    if (S_ISBLK(st.st_mode)) {
+        uint64_t bytes = 0;
+#ifdef BLKGETSIZE64
+        if (ioctl(fd, BLKGETSIZE64, &bytes) != 0) bytes = 0;
+#endif
+        return bytes;
+    }
+    return (uint64_t)st.st_size;
+#endif
+}
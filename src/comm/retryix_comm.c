@@ -0,0 +1,554 @@
+// retryix_comm.c - 行程內主題式發佈 / 訂閱
+// 主題名稱內部化為固定表中的代號 (開放定址, 不搬移), 發送端以代號直接取得訂閱者清單
+// 每個訂閱者一條有界無鎖佇列 (多生產者 / 單消費者), 小訊息內嵌於格子, 大訊息以參考計數共用一份
+// poll 逐一認領訂閱者, 一次取出整批訊息呼叫回呼後再整批歸還格子
+// 訂閱者清單寫時複製: 註冊時發佈新清單, 舊清單保留到 shutdown, 發送端讀取不需加鎖
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "retryix_comm.h"
+#include "retryix_atomic_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+static SRWLOCK g_comm_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE g_comm_cond = CONDITION_VARIABLE_INIT;
+#define COMM_LOCK()             AcquireSRWLockExclusive(&g_comm_lock)
+#define COMM_UNLOCK()           ReleaseSRWLockExclusive(&g_comm_lock)
+#define COMM_BROADCAST()        WakeAllConditionVariable(&g_comm_cond)
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+static pthread_mutex_t g_comm_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_comm_cond = PTHREAD_COND_INITIALIZER;
+#define COMM_LOCK()             pthread_mutex_lock(&g_comm_lock)
+#define COMM_UNLOCK()           pthread_mutex_unlock(&g_comm_lock)
+#define COMM_BROADCAST()        pthread_cond_broadcast(&g_comm_cond)
+#endif
+
+#define COMM_CACHE_LINE         64
+#define COMM_TOPIC_SLOTS        4096                // 2 的冪; 最多內部化 3/4
+#define COMM_TOPIC_LIMIT        (COMM_TOPIC_SLOTS / 4 * 3)
+#define COMM_DEFAULT_QUEUE      4096
+#define COMM_DEFAULT_BATCH      64
+#define COMM_MAX_BATCH          1024
+#define COMM_INLINE_BYTES       48                  // 含結尾 NUL, 47 字元以內的訊息不另配置
+#define COMM_DISPATCH_SLICE_MS  100                 // 分派線程檢查停止旗標的間隔
+
+typedef struct {
+    volatile uint32_t refs;
+    uint32_t length;
+    char data[];
+} comm_payload_t;
+
+typedef struct {
+    volatile uint64_t sequence;
+    comm_payload_t* payload;                        // NULL = 內嵌
+    char inline_data[COMM_INLINE_BYTES];
+} comm_slot_t;
+
+typedef struct comm_subscriber {
+    RetryIXCommCallback callback;
+    int topic_id;
+    volatile uint32_t draining;                     // 同一訂閱者同時只由一個線程分派
+    uint64_t mask;
+    comm_slot_t* slots;
+    volatile uint64_t dropped;
+    char pad0[COMM_CACHE_LINE - 2 * sizeof(void*) - 2 * sizeof(uint32_t) - 2 * sizeof(uint64_t)];
+    volatile uint64_t enqueue_pos;
+    char pad1[COMM_CACHE_LINE - sizeof(uint64_t)];
+    uint64_t dequeue_pos;                           // 只由持有 draining 的線程讀寫
+    char pad2[COMM_CACHE_LINE - sizeof(uint64_t)];
+} comm_subscriber_t;
+
+// 寫時複製的訂閱者清單
+typedef struct comm_sub_list {
+    struct comm_sub_list* retired_next;
+    uint32_t count;
+    comm_subscriber_t* subs[];
+} comm_sub_list_t;
+
+typedef struct {
+    uint32_t hash;
+    const char* volatile name;                      // NULL = 空槽; 發佈後不再改變
+    comm_sub_list_t* volatile subs;
+} comm_topic_t;
+
+static comm_topic_t g_topics[COMM_TOPIC_SLOTS];
+static uint32_t g_topic_count = 0;
+static comm_sub_list_t* volatile g_all_subs = NULL;  // 所有訂閱者, 供 poll 走訪
+static comm_sub_list_t* g_retired = NULL;
+static volatile uint32_t g_initialized = 0;
+
+static uint64_t g_queue_capacity = COMM_DEFAULT_QUEUE;
+static uint32_t g_batch = COMM_DEFAULT_BATCH;
+static uint32_t g_send_timeout_ms = 0;
+static bool g_config_dispatcher = false;
+
+// 阻塞 poll: 有等待者時發送端才遞增事件計數並廣播
+static volatile uint32_t g_waiters = 0;
+static volatile uint32_t g_event = 0;
+static volatile uint64_t g_dropped = 0;
+
+static volatile uint32_t g_dispatcher_running = 0;
+static volatile uint32_t g_dispatcher_stop = 0;
+#ifdef _WIN32
+static HANDLE g_dispatcher = NULL;
+#else
+static pthread_t g_dispatcher;
+#endif
+
+// ===== 時間 / 等待 =====
+
+static uint64_t comm_now_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+#endif
+}
+
+// 呼叫者持鎖
+static void comm_wait(uint32_t timeout_ms) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(&g_comm_cond, &g_comm_lock,
+        timeout_ms == RETRYIX_COMM_WAIT_INFINITE ? INFINITE : timeout_ms, 0);
+#else
+    if (timeout_ms == RETRYIX_COMM_WAIT_INFINITE) {
+        pthread_cond_wait(&g_comm_cond, &g_comm_lock);
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&g_comm_cond, &g_comm_lock, &ts);
+#endif
+}
+
+static void comm_notify(void) {
+    // 發佈與檢查等待者之間需完整屏障, 與 poll_wait 遞增 g_waiters 後的重試配對
+    RX_FENCE();
+    if (RX_LOAD32(&g_waiters) == 0) return;
+    COMM_LOCK();
+    RX_ADD32(&g_event, 1);
+    COMM_BROADCAST();
+    COMM_UNLOCK();
+}
+
+// ===== 主題表 =====
+
+static uint32_t topic_hash(const char* name) {
+    uint32_t h = 2166136261u;                       // FNV-1a
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+static int topic_find(const char* name, uint32_t hash) {
+    for (uint32_t i = 0; i < COMM_TOPIC_SLOTS; i++) {
+        uint32_t index = (hash + i) & (COMM_TOPIC_SLOTS - 1);
+        const char* entry = (const char*)RX_LOADP(&g_topics[index].name);
+        if (!entry) return -(int)index - 1;         // 空槽: 未找到, 回傳可插入位置
+        if (g_topics[index].hash == hash && strcmp(entry, name) == 0) return (int)index;
+    }
+    return -(int)COMM_TOPIC_SLOTS - 1;
+}
+
+// 呼叫者持鎖
+static int topic_intern_locked(const char* name, uint32_t hash) {
+    int found = topic_find(name, hash);
+    if (found >= 0) return found;
+    if (found == -(int)COMM_TOPIC_SLOTS - 1 || g_topic_count >= COMM_TOPIC_LIMIT) return -1;
+
+    int index = -found - 1;
+    size_t length = strlen(name);
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) return -1;
+    memcpy(copy, name, length + 1);
+    g_topics[index].hash = hash;
+    g_topics[index].subs = NULL;
+    RX_STOREP(&g_topics[index].name, (const char*)copy);
+    g_topic_count++;
+    return index;
+}
+
+static bool topic_valid(int topic_id) {
+    return topic_id >= 0 && topic_id < COMM_TOPIC_SLOTS && RX_LOADP(&g_topics[topic_id].name) != NULL;
+}
+
+// 呼叫者持鎖; 以新清單取代 *list, 舊清單延後到 shutdown 才釋放
+static bool sub_list_append_locked(comm_sub_list_t* volatile* list, comm_subscriber_t* sub) {
+    comm_sub_list_t* old = (comm_sub_list_t*)RX_LOADP(list);
+    uint32_t count = old ? old->count : 0;
+    comm_sub_list_t* next = (comm_sub_list_t*)malloc(sizeof(comm_sub_list_t) + (count + 1) * sizeof(comm_subscriber_t*));
+    if (!next) return false;
+    next->retired_next = NULL;
+    next->count = count + 1;
+    if (count) memcpy(next->subs, old->subs, count * sizeof(comm_subscriber_t*));
+    next->subs[count] = sub;
+    RX_STOREP(list, next);
+    if (old) {
+        old->retired_next = g_retired;
+        g_retired = old;
+    }
+    return true;
+}
+
+// ===== 訂閱者佇列 =====
+
+static comm_subscriber_t* sub_create(int topic_id, RetryIXCommCallback callback) {
+    comm_subscriber_t* sub;
+#ifdef _WIN32
+    sub = (comm_subscriber_t*)_aligned_malloc(sizeof(comm_subscriber_t), COMM_CACHE_LINE);
+#else
+    if (posix_memalign((void**)&sub, COMM_CACHE_LINE, sizeof(comm_subscriber_t)) != 0) sub = NULL;
+#endif
+    if (!sub) return NULL;
+    memset(sub, 0, sizeof(*sub));
+    sub->slots = (comm_slot_t*)malloc((size_t)g_queue_capacity * sizeof(comm_slot_t));
+    if (!sub->slots) {
+#ifdef _WIN32
+        _aligned_free(sub);
+#else
+        free(sub);
+#endif
+        return NULL;
+    }
+    sub->callback = callback;
+    sub->topic_id = topic_id;
+    sub->mask = g_queue_capacity - 1;
+    for (uint64_t i = 0; i < g_queue_capacity; i++) sub->slots[i].sequence = i;
+    return sub;
+}
+
+static void payload_release(comm_payload_t* payload) {
+    if (payload && RX_ADD32(&payload->refs, (uint32_t)-1) == 1) free(payload);
+}
+
+static void sub_destroy(comm_subscriber_t* sub) {
+    for (uint64_t pos = sub->dequeue_pos; pos < sub->enqueue_pos; pos++) {
+        comm_slot_t* slot = &sub->slots[pos & sub->mask];
+        if (slot->sequence == pos + 1) payload_release(slot->payload);
+    }
+    free(sub->slots);
+#ifdef _WIN32
+    _aligned_free(sub);
+#else
+    free(sub);
+#endif
+}
+
+// 多生產者入隊; payload 為 NULL 時把 message 複製進格子
+static bool sub_enqueue(comm_subscriber_t* sub, const char* message, size_t length, comm_payload_t* payload) {
+    uint64_t pos = RX_LOAD64(&sub->enqueue_pos);
+    comm_slot_t* slot;
+    for (;;) {
+        slot = &sub->slots[pos & sub->mask];
+        int64_t diff = (int64_t)(RX_LOAD64(&slot->sequence) - pos);
+        if (diff == 0) {
+            if (RX_CAS64(&sub->enqueue_pos, pos, pos + 1)) break;
+            pos = RX_LOAD64(&sub->enqueue_pos);
+        } else if (diff < 0) {
+            return false;                           // 滿: 消費者尚未歸還該格
+        } else {
+            pos = RX_LOAD64(&sub->enqueue_pos);
+        }
+    }
+    slot->payload = payload;
+    if (!payload) memcpy(slot->inline_data, message, length + 1);
+    RX_STORE64(&slot->sequence, pos + 1);
+    return true;
+}
+
+static bool sub_enqueue_timed(comm_subscriber_t* sub, const char* message, size_t length, comm_payload_t* payload) {
+    if (sub_enqueue(sub, message, length, payload)) return true;
+    if (g_send_timeout_ms == 0) return false;
+    uint64_t deadline = comm_now_ms() + g_send_timeout_ms;
+    do {
+        comm_notify();                              // 讓休眠中的分派者先清出空間
+        RX_YIELD();
+        if (sub_enqueue(sub, message, length, payload)) return true;
+    } while (comm_now_ms() < deadline);
+    return false;
+}
+
+// 取出一批就緒訊息呼叫回呼, 全部呼叫完才一次歸還格子; 回傳分派數
+static uint32_t sub_drain(comm_subscriber_t* sub, uint32_t max_count) {
+    if (!RX_CAS32(&sub->draining, 0, 1)) return 0;  // 其他線程正在分派此訂閱者
+    uint64_t pos = sub->dequeue_pos;
+    uint32_t ready = 0;
+    while (ready < max_count && RX_LOAD64(&sub->slots[(pos + ready) & sub->mask].sequence) == pos + ready + 1) ready++;
+
+    const char* topic = g_topics[sub->topic_id].name;
+    for (uint32_t i = 0; i < ready; i++) {
+        comm_slot_t* slot = &sub->slots[(pos + i) & sub->mask];
+        sub->callback(topic, slot->payload ? slot->payload->data : slot->inline_data);
+    }
+    for (uint32_t i = 0; i < ready; i++) {
+        comm_slot_t* slot = &sub->slots[(pos + i) & sub->mask];
+        payload_release(slot->payload);
+        RX_STORE64(&slot->sequence, pos + i + sub->mask + 1);
+    }
+    sub->dequeue_pos = pos + ready;
+    RX_STORE32(&sub->draining, 0);
+    return ready;
+}
+
+// ===== 設定 =====
+
+static bool comm_load_config(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char key[64];
+        unsigned long value;
+        if (line[0] == '#' || sscanf(line, " %63[^= \t] = %lu", key, &value) != 2) continue;
+        if (strcmp(key, "queue_capacity") == 0) {
+            uint64_t cap = 2;
+            while (cap < value && cap < ((uint64_t)1 << 24)) cap <<= 1;
+            g_queue_capacity = cap;
+        } else if (strcmp(key, "batch") == 0) {
+            g_batch = value == 0 ? 1 : value > COMM_MAX_BATCH ? COMM_MAX_BATCH : (uint32_t)value;
+        } else if (strcmp(key, "send_timeout_ms") == 0) {
+            g_send_timeout_ms = (uint32_t)value;
+        } else if (strcmp(key, "dispatcher") == 0) {
+            g_config_dispatcher = value != 0;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+// ===== 公開 API =====
+
+int retryix_comm_init(const char* config_path) {
+    COMM_LOCK();
+    if (g_initialized) {
+        COMM_UNLOCK();
+        return COMM_STATUS_OK;
+    }
+    g_queue_capacity = COMM_DEFAULT_QUEUE;
+    g_batch = COMM_DEFAULT_BATCH;
+    g_send_timeout_ms = 0;
+    g_config_dispatcher = false;
+    if (config_path && config_path[0] && !comm_load_config(config_path)) {
+        COMM_UNLOCK();
+        return COMM_STATUS_FAIL;
+    }
+    bool start_dispatcher = g_config_dispatcher;
+    RX_STORE32(&g_initialized, 1);
+    COMM_UNLOCK();
+
+    if (start_dispatcher) return retryix_comm_start_dispatcher();
+    return COMM_STATUS_OK;
+}
+
+int retryix_comm_topic(const char* topic) {
+    if (!topic || !RX_LOAD32(&g_initialized)) return -1;
+    uint32_t hash = topic_hash(topic);
+    int found = topic_find(topic, hash);
+    if (found >= 0) return found;
+    COMM_LOCK();
+    found = topic_intern_locked(topic, hash);
+    COMM_UNLOCK();
+    return found;
+}
+
+int retryix_comm_register(const char* topic, RetryIXCommCallback callback) {
+    if (!topic || !callback || !RX_LOAD32(&g_initialized)) return COMM_STATUS_FAIL;
+    uint32_t hash = topic_hash(topic);
+    COMM_LOCK();
+    int topic_id = topic_intern_locked(topic, hash);
+    comm_subscriber_t* sub = topic_id >= 0 ? sub_create(topic_id, callback) : NULL;
+    bool ok = sub && sub_list_append_locked(&g_all_subs, sub);
+    if (ok && !sub_list_append_locked(&g_topics[topic_id].subs, sub)) {
+        ok = false;                                 // 已在全域清單中: 保留, 不會收到訊息
+        sub = NULL;
+    }
+    COMM_UNLOCK();
+    if (!ok && sub) sub_destroy(sub);
+    return ok ? COMM_STATUS_OK : COMM_STATUS_FAIL;
+}
+
+// 投遞給主題的所有訂閱者; 有佇列滿而丟棄時回傳 FAIL (其餘訂閱者照常收到)
+int retryix_comm_send_id(int topic_id, const char* message) {
+    if (!message || !RX_LOAD32(&g_initialized) || !topic_valid(topic_id)) return COMM_STATUS_FAIL;
+    comm_sub_list_t* list = (comm_sub_list_t*)RX_LOADP(&g_topics[topic_id].subs);
+    if (!list) return COMM_STATUS_OK;
+
+    size_t length = strlen(message);
+    comm_payload_t* payload = NULL;
+    if (length >= COMM_INLINE_BYTES) {
+        if (length > 0xFFFFFFFFu) return COMM_STATUS_FAIL;
+        payload = (comm_payload_t*)malloc(sizeof(comm_payload_t) + length + 1);
+        if (!payload) return COMM_STATUS_FAIL;
+        payload->refs = list->count;
+        payload->length = (uint32_t)length;
+        memcpy(payload->data, message, length + 1);
+    }
+
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < list->count; i++) {
+        comm_subscriber_t* sub = list->subs[i];
+        if (!sub_enqueue_timed(sub, message, length, payload)) {
+            RX_ADD64(&sub->dropped, 1);
+            dropped++;
+        }
+    }
+    if (dropped) {
+        RX_ADD64(&g_dropped, dropped);
+        if (payload && RX_ADD32(&payload->refs, (uint32_t)0 - dropped) == dropped) free(payload);
+    }
+    if (dropped < list->count) comm_notify();
+    return dropped ? COMM_STATUS_FAIL : COMM_STATUS_OK;
+}
+
+// 依名稱發送: 每次雜湊查表, 熱路徑請先以 retryix_comm_topic 取得代號
+int retryix_comm_send(const char* topic, const char* message) {
+    if (!topic || !RX_LOAD32(&g_initialized)) return COMM_STATUS_FAIL;
+    int topic_id = topic_find(topic, topic_hash(topic));
+    if (topic_id < 0) return COMM_STATUS_OK;        // 尚無訂閱者的主題不內部化
+    return retryix_comm_send_id(topic_id, message);
+}
+
+int retryix_comm_poll() {
+    if (!RX_LOAD32(&g_initialized)) return COMM_STATUS_FAIL;
+    comm_sub_list_t* list = (comm_sub_list_t*)RX_LOADP(&g_all_subs);
+    if (!list) return 0;
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < list->count; i++) total += sub_drain(list->subs[i], g_batch);
+    return (int)total;
+}
+
+int retryix_comm_poll_wait(uint32_t timeout_ms) {
+    int n = retryix_comm_poll();
+    if (n != 0 || timeout_ms == 0) return n;
+
+    uint64_t deadline = comm_now_ms() + timeout_ms;
+    RX_ADD32(&g_waiters, 1);
+    for (;;) {
+        uint32_t event = RX_LOAD32(&g_event);
+        n = retryix_comm_poll();
+        if (n != 0) break;
+        uint32_t wait_ms = RETRYIX_COMM_WAIT_INFINITE;
+        if (timeout_ms != RETRYIX_COMM_WAIT_INFINITE) {
+            uint64_t now = comm_now_ms();
+            if (now >= deadline) break;
+            wait_ms = (uint32_t)(deadline - now);
+        }
+        COMM_LOCK();
+        if (RX_LOAD32(&g_event) == event) comm_wait(wait_ms);
+        COMM_UNLOCK();
+        if (RX_LOAD32(&g_dispatcher_stop)) break;   // 停止分派線程時提早返回
+    }
+    RX_ADD32(&g_waiters, (uint32_t)-1);
+    return n;
+}
+
+static void dispatcher_loop(void) {
+    while (!RX_LOAD32(&g_dispatcher_stop)) retryix_comm_poll_wait(COMM_DISPATCH_SLICE_MS);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI dispatcher_main_win(LPVOID arg) {
+    (void)arg;
+    dispatcher_loop();
+    return 0;
+}
+#else
+static void* dispatcher_main_posix(void* arg) {
+    (void)arg;
+    dispatcher_loop();
+    return NULL;
+}
+#endif
+
+int retryix_comm_start_dispatcher(void) {
+    if (!RX_LOAD32(&g_initialized)) return COMM_STATUS_FAIL;
+    COMM_LOCK();
+    if (g_dispatcher_running) {
+        COMM_UNLOCK();
+        return COMM_STATUS_OK;
+    }
+    RX_STORE32(&g_dispatcher_stop, 0);
+#ifdef _WIN32
+    g_dispatcher = CreateThread(NULL, 0, dispatcher_main_win, NULL, 0, NULL);
+    bool ok = g_dispatcher != NULL;
+#else
+    bool ok = pthread_create(&g_dispatcher, NULL, dispatcher_main_posix, NULL) == 0;
+#endif
+    if (ok) RX_STORE32(&g_dispatcher_running, 1);
+    COMM_UNLOCK();
+    return ok ? COMM_STATUS_OK : COMM_STATUS_FAIL;
+}
+
+// 不可在回呼中呼叫 (分派線程會等待自己結束)
+int retryix_comm_stop_dispatcher(void) {
+    COMM_LOCK();
+    if (!g_dispatcher_running) {
+        COMM_UNLOCK();
+        return COMM_STATUS_OK;
+    }
+    RX_STORE32(&g_dispatcher_stop, 1);
+    RX_ADD32(&g_event, 1);
+    COMM_BROADCAST();
+    COMM_UNLOCK();
+#ifdef _WIN32
+    WaitForSingleObject(g_dispatcher, INFINITE);
+    CloseHandle(g_dispatcher);
+    g_dispatcher = NULL;
+#else
+    pthread_join(g_dispatcher, NULL);
+#endif
+    COMM_LOCK();
+    RX_STORE32(&g_dispatcher_running, 0);
+    RX_STORE32(&g_dispatcher_stop, 0);
+    COMM_UNLOCK();
+    return COMM_STATUS_OK;
+}
+
+uint64_t retryix_comm_dropped(void) {
+    return RX_LOAD64(&g_dropped);
+}
+
+// 呼叫前須停止發送與 poll; 未分派的訊息直接丟棄
+int retryix_comm_shutdown() {
+    if (!RX_LOAD32(&g_initialized)) return COMM_STATUS_OK;
+    retryix_comm_stop_dispatcher();
+
+    COMM_LOCK();
+    RX_STORE32(&g_initialized, 0);
+    comm_sub_list_t* all = (comm_sub_list_t*)g_all_subs;
+    if (all) {
+        for (uint32_t i = 0; i < all->count; i++) sub_destroy(all->subs[i]);
+        free(all);
+    }
+    g_all_subs = NULL;
+    for (uint32_t i = 0; i < COMM_TOPIC_SLOTS; i++) {
+        free((void*)g_topics[i].name);
+        free(g_topics[i].subs);
+    }
+    memset(g_topics, 0, sizeof(g_topics));
+    g_topic_count = 0;
+    while (g_retired) {
+        comm_sub_list_t* next = g_retired->retired_next;
+        free(g_retired);
+        g_retired = next;
+    }
+    g_dropped = 0;
+    COMM_UNLOCK();
+    return COMM_STATUS_OK;
+}
@@ -1,46 +1,1105 @@
 #include "retryix_host_comm.h"
+#include "retryix_atomic_internal.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
-static comm_packet_t msg_queue[MAX_MSG_QUEUE];
-static int queue_head = 0;
-static int queue_tail = 0;
-static int initialized = 0;
+// 有界無鎖 MPMC 環 (Vyukov 序號式): 每格的 sequence 指出該格目前可供哪個位置的生產者 / 消費者使用
+// 生產者與消費者各自以 CAS 推進 enqueue_pos / dequeue_pos, 批次操作一次認領多個連續格
+// 環格只攜帶 64 位元組描述符: 小訊息內嵌, 其餘指向訊息區 (arena) 中的 slab 區塊, 負載本身不經佇列複製
+// 環與訊息區皆為不含指標的連續區塊 (以位移定址): 未命名通道放在本行程記憶體,
+// 具名通道則放在同一個具名共享記憶體段中, 由多個行程同時附加
 
-comm_result_t comm_init(const char* channel_name) {
-    (void)channel_name;
-    if (initialized) return COMM_SUCCESS;
-    memset(msg_queue, 0, sizeof(msg_queue));
-    queue_head = queue_tail = 0;
-    initialized = 1;
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#define HC_CACHE_LINE 64
+#define HC_PAGE_BYTES 4096
+
+// ===== 訊息區: 2 的冪級距 slab, 每級一個無鎖空閒堆疊 =====
+// 區塊以 (位移 / 64) 的 32 位元代號表示; 空閒時前 4 位元組存放下一個空閒區塊代號
+// 小級距每次切出 1MB 區段再分割, 1MB 以上的區塊單獨切出; 區塊歸還後留在本級重用
+
+#define COMM_CLASS_MIN_SHIFT    6                   // 64 B
+#define COMM_CLASS_COUNT        25                  // 64 B .. 1 GB
+#define COMM_SLAB_BYTES         ((uint64_t)1 << 20)
+#define COMM_ARENA_HEADER_BYTES HC_PAGE_BYTES
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define COMM_ARENA_DEFAULT_BYTES ((uint64_t)1 << 32)   // 僅保留位址空間, 實體頁按需配置
+#else
+#define COMM_ARENA_DEFAULT_BYTES ((uint64_t)1 << 28)
+#endif
+
+// ===== 具名通道 =====
+#define COMM_SHM_MAGIC          0x52584843u         // "RXHC"
+#define COMM_SHM_VERSION        3
+#define COMM_SHM_MAX_PROCS      64
+#define COMM_PROC_CLAIMS        16                  // 每行程可同時進行的收發操作數
+#define COMM_SHM_ARENA_BYTES    ((uint64_t)64 << 20)
+#define COMM_SHM_NAME_MAX       128
+#define COMM_RECOVER_INTERVAL_MS 1000               // 佇列停滯時檢查已終止行程的間隔
+#define COMM_DESC_DROPPED       ((int32_t)0x80000000)   // 回收後留下的空訊息, 接收端略過
+
+typedef struct {
+    uint64_t capacity;
+    volatile uint64_t bump;                         // 下一個未切出的位移
+    uint32_t commit_on_refill;                      // Windows 本行程訊息區: 切出時才提交頁面
+    uint32_t reserved;
+    volatile uint64_t free_heads[COMM_CLASS_COUNT]; // 高 32 位 ABA 標記 | 低 32 位區塊代號
+} comm_arena_t;
+
+typedef struct {
+    uint32_t block;             // 0 = 內嵌
+    uint32_t length;
+    int32_t type;
+    uint32_t size_class;
+    char inline_data[COMM_MSG_INLINE_BYTES];
+} comm_desc_t;
+
+typedef struct {
+    volatile uint64_t sequence;
+    uint64_t reserved;
+    comm_desc_t desc;
+} comm_cell_t;
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t mask;
+    volatile uint32_t closed;
+    char pad0[HC_CACHE_LINE - 2 * sizeof(uint64_t) - sizeof(uint32_t)];
+    volatile uint64_t enqueue_pos;
+    char pad1[HC_CACHE_LINE - sizeof(uint64_t)];
+    volatile uint64_t dequeue_pos;
+    char pad2[HC_CACHE_LINE - sizeof(uint64_t)];
+    volatile uint32_t data_event;   // 等待字: 有接收者休眠時, 生產者遞增後喚醒
+    volatile uint32_t waiters;
+    char pad3[HC_CACHE_LINE - 2 * sizeof(uint32_t)];
+    comm_cell_t cells[];
+} comm_ring_t;
+
+// 認領紀錄: CAS 推進 enqueue_pos / dequeue_pos 之前先寫下欲認領的區間, 發佈 / 歸還後清除;
+// 行程死在 CAS 與寫完格子之間時, 回收端憑此找出它認領的格子
+#define COMM_CLAIM_FREE         0
+#define COMM_CLAIM_ENQUEUE      1
+#define COMM_CLAIM_DEQUEUE      2
+
+typedef struct {
+    volatile uint32_t kind;     // COMM_CLAIM_*; 非 FREE 時由取得它的線程獨佔
+    volatile uint32_t count;
+    volatile uint64_t pos;
+} comm_claim_t;
+
+// 行程以 (PID, 啟動時間) 識別, 排除 PID 重用
+typedef struct {
+    volatile uint32_t pid;      // 0 = 空槽
+    volatile uint32_t waiters;  // 此行程目前休眠中的接收者數
+    uint64_t start_time;        // 行程啟動時間
+    comm_claim_t claims[COMM_PROC_CLAIMS];
+} comm_proc_slot_t;
+
+// 共享段開頭; 其後依序為環與訊息區
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    volatile uint32_t ready;    // 格式化完成後才設為 1
+    uint32_t reserved;
+    uint64_t total_bytes;
+    uint64_t ring_offset;
+    uint64_t arena_offset;
+    uint64_t arena_bytes;
+    comm_proc_slot_t procs[COMM_SHM_MAX_PROCS];
+} comm_shm_header_t;
+
+typedef struct {
+    comm_ring_t* ring;
+    comm_arena_t* arena;
+    bool shared;
+    uint32_t pid;
+    volatile uint32_t closing;  // comm_cleanup 進行中: 阻塞接收者應立即返回
+    volatile uint32_t local_waiters;    // 本行程位於 ring_dequeue_wait 內的線程數
+    comm_shm_header_t* header;
+    comm_proc_slot_t* self;
+    uint64_t mapped_bytes;
+    volatile uint64_t last_recover_ms;
+    char name[COMM_SHM_NAME_MAX];
+#ifdef _WIN32
+    HANDLE mapping;
+    HANDLE lock;                // 具名互斥鎖; 持有者終止時由系統以 WAIT_ABANDONED 交出
+    HANDLE wake;                // 具名號誌: WaitOnAddress 無法跨行程
+#else
+    int fd;                     // flock 於行程終止時自動釋放
+#endif
+} comm_channel_t;
+
+static comm_channel_t g_channel;
+static volatile uint32_t g_state = 0;   // 0 未初始化, 1 初始化中, 2 就緒, 3 關閉中
+
+// ===== 等待 / 喚醒 =====
+
+static void ring_wait(comm_channel_t* ch, uint32_t expected, uint32_t timeout_ms) {
+#ifdef _WIN32
+    DWORD ms = timeout_ms == COMM_WAIT_INFINITE ? INFINITE : timeout_ms;
+    if (ch->shared) {
+        WaitForSingleObject(ch->wake, ms);
+    } else {
+        WaitOnAddress(&ch->ring->data_event, &expected, sizeof(expected), ms);
+    }
+#else
+    struct timespec ts;
+    struct timespec* tsp = NULL;
+    if (timeout_ms != COMM_WAIT_INFINITE) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        tsp = &ts;
+    }
+    // 非 PRIVATE: 等待字位於共享段時跨行程同樣有效
+    syscall(SYS_futex, &ch->ring->data_event, FUTEX_WAIT, expected, tsp, NULL, 0);
+#endif
+}
+
+static void ring_wake_all(comm_channel_t* ch) {
+#ifdef _WIN32
+    if (ch->shared) {
+        LONG waiters = (LONG)RX_LOAD32(&ch->ring->waiters);
+        if (waiters > 0) ReleaseSemaphore(ch->wake, waiters, NULL);
+    } else {
+        WakeByAddressAll((PVOID)&ch->ring->data_event);
+    }
+#else
+    syscall(SYS_futex, &ch->ring->data_event, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+static uint64_t ring_now_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+#endif
+}
+
+// ===== 訊息區操作 =====
+
+static void* arena_map(uint64_t bytes) {
+#ifdef _WIN32
+    // 僅保留位址空間, 切出區段時才提交
+    void* base = VirtualAlloc(NULL, (SIZE_T)bytes, MEM_RESERVE, PAGE_READWRITE);
+    if (base && !VirtualAlloc(base, COMM_ARENA_HEADER_BYTES, MEM_COMMIT, PAGE_READWRITE)) {
+        VirtualFree(base, 0, MEM_RELEASE);
+        return NULL;
+    }
+    return base;
+#else
+    void* base = mmap(NULL, (size_t)bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return base == MAP_FAILED ? NULL : base;
+#endif
+}
+
+static void arena_unmap(void* base, uint64_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, (size_t)bytes);
+#endif
+}
+
+static void arena_format(comm_arena_t* arena, uint64_t capacity, bool commit_on_refill) {
+    memset(arena, 0, sizeof(*arena));
+    arena->capacity = capacity;
+    arena->bump = COMM_ARENA_HEADER_BYTES;
+    arena->commit_on_refill = commit_on_refill ? 1u : 0u;
+}
+
+static inline void* arena_ptr(comm_arena_t* arena, uint32_t block) {
+    return (char*)arena + ((uint64_t)block << COMM_CLASS_MIN_SHIFT);
+}
+
+static inline uint64_t arena_class_bytes(uint32_t size_class) {
+    return (uint64_t)1 << (size_class + COMM_CLASS_MIN_SHIFT);
+}
+
+static int arena_class_of(size_t size) {
+    uint32_t size_class = 0;
+    while (size_class < COMM_CLASS_COUNT && arena_class_bytes(size_class) < size) size_class++;
+    return size_class < COMM_CLASS_COUNT ? (int)size_class : -1;
+}
+
+static void arena_push_chain(comm_arena_t* arena, uint32_t size_class, uint32_t first, uint32_t last) {
+    volatile uint64_t* head = &arena->free_heads[size_class];
+    for (;;) {
+        uint64_t old = RX_LOAD64(head);
+        *(volatile uint32_t*)arena_ptr(arena, last) = (uint32_t)old;
+        uint64_t desired = ((old >> 32) + 1) << 32 | first;
+        if (RX_CAS64(head, old, desired)) return;
+    }
+}
+
+// 切出新區段: 保留第一個區塊給呼叫者, 其餘串成鏈推入空閒堆疊
+static uint32_t arena_refill(comm_arena_t* arena, uint32_t size_class) {
+    uint64_t block_bytes = arena_class_bytes(size_class);
+    uint64_t slab_bytes = block_bytes < COMM_SLAB_BYTES ? COMM_SLAB_BYTES : block_bytes;
+    uint64_t offset;
+    do {
+        offset = RX_LOAD64(&arena->bump);
+        if (offset + slab_bytes > arena->capacity) return 0;   // 訊息區耗盡
+    } while (!RX_CAS64(&arena->bump, offset, offset + slab_bytes));
+#ifdef _WIN32
+    if (arena->commit_on_refill &&
+        !VirtualAlloc((char*)arena + offset, (SIZE_T)slab_bytes, MEM_COMMIT, PAGE_READWRITE)) return 0;
+#endif
+
+    uint32_t first = (uint32_t)(offset >> COMM_CLASS_MIN_SHIFT);
+    uint32_t stride = (uint32_t)(block_bytes >> COMM_CLASS_MIN_SHIFT);
+    uint32_t count = (uint32_t)(slab_bytes / block_bytes);
+    if (count > 1) {
+        for (uint32_t i = 1; i + 1 < count; i++) {
+            *(uint32_t*)arena_ptr(arena, first + i * stride) = first + (i + 1) * stride;
+        }
+        arena_push_chain(arena, size_class, first + stride, first + (count - 1) * stride);
+    }
+    return first;
+}
+
+static uint32_t arena_alloc(comm_arena_t* arena, uint32_t size_class) {
+    volatile uint64_t* head = &arena->free_heads[size_class];
+    for (;;) {
+        uint64_t old = RX_LOAD64(head);
+        uint32_t block = (uint32_t)old;
+        if (block == 0) return arena_refill(arena, size_class);
+        // 讀到的 next 可能已被其他線程改寫, 此時標記必然改變而 CAS 失敗
+        uint32_t next = *(volatile uint32_t*)arena_ptr(arena, block);
+        uint64_t desired = ((old >> 32) + 1) << 32 | next;
+        if (RX_CAS64(head, old, desired)) return block;
+    }
+}
+
+static void arena_free(comm_arena_t* arena, uint32_t size_class, uint32_t block) {
+    arena_push_chain(arena, size_class, block, block);
+}
+
+// ===== 環操作 =====
+
+static size_t ring_bytes(uint64_t capacity) {
+    return sizeof(comm_ring_t) + (size_t)capacity * sizeof(comm_cell_t);
+}
+
+static void ring_format(comm_ring_t* ring, uint64_t capacity) {
+    memset(ring, 0, sizeof(*ring));
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    for (uint64_t i = 0; i < capacity; i++) {
+        ring->cells[i].sequence = i;
+    }
+}
+
+// 取得本行程一筆空閒的認領紀錄; 本行程佇列不需崩潰回收, 回傳 NULL
+static comm_claim_t* claim_begin(comm_channel_t* ch, uint32_t kind) {
+    if (!ch->self) return NULL;
+    for (;;) {
+        for (uint32_t i = 0; i < COMM_PROC_CLAIMS; i++) {
+            comm_claim_t* claim = &ch->self->claims[i];
+            if (RX_LOAD32(&claim->kind) == COMM_CLAIM_FREE && RX_CAS32(&claim->kind, COMM_CLAIM_FREE, kind)) {
+                return claim;
+            }
+        }
+        RX_YIELD();             // 本行程同時收發的線程超過 COMM_PROC_CLAIMS
+    }
+}
+
+// 每次 CAS 前寫入; 其後的 CAS 為完整屏障, 成功時回收端讀到推進後的位置也必讀到此區間
+static inline void claim_set(comm_claim_t* claim, uint64_t pos, size_t n) {
+    if (!claim) return;
+    RX_STORE32(&claim->count, (uint32_t)n);
+    RX_STORE64(&claim->pos, pos);
+}
+
+static inline void claim_end(comm_claim_t* claim) {
+    if (claim) RX_STORE32(&claim->kind, COMM_CLAIM_FREE);
+}
+
+static size_t ring_enqueue(comm_channel_t* ch, const comm_desc_t* descs, size_t count) {
+    comm_ring_t* ring = ch->ring;
+    comm_claim_t* claim = claim_begin(ch, COMM_CLAIM_ENQUEUE);
+    uint64_t pos = RX_LOAD64(&ring->enqueue_pos);
+    size_t n;
+    for (;;) {
+        comm_cell_t* cell = &ring->cells[pos & ring->mask];
+        int64_t diff = (int64_t)(RX_LOAD64(&cell->sequence) - pos);
+        if (diff < 0) {                         // 滿: 該格仍待上一輪消費
+            claim_end(claim);
+            return 0;
+        }
+        if (diff > 0) {                         // 其他生產者已認領, 重新讀取
+            pos = RX_LOAD64(&ring->enqueue_pos);
+            continue;
+        }
+        n = 1;
+        while (n < count && RX_LOAD64(&ring->cells[(pos + n) & ring->mask].sequence) == pos + n) n++;
+        claim_set(claim, pos, n);
+        if (RX_CAS64(&ring->enqueue_pos, pos, pos + n)) break;
+        pos = RX_LOAD64(&ring->enqueue_pos);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        comm_cell_t* cell = &ring->cells[(pos + i) & ring->mask];
+        cell->desc = descs[i];
+        RX_STORE64(&cell->sequence, pos + i + 1);
+    }
+    claim_end(claim);
+
+    // 發佈與檢查等待者之間需完整屏障, 與接收端 waiters 遞增後的重試配對
+    RX_FENCE();
+    if (RX_LOAD32(&ring->waiters) != 0) {
+        RX_ADD32(&ring->data_event, 1);
+        ring_wake_all(ch);
+    }
+    return n;
+}
+
+static size_t ring_dequeue_raw(comm_channel_t* ch, comm_desc_t* out, size_t max_count) {
+    comm_ring_t* ring = ch->ring;
+    comm_claim_t* claim = claim_begin(ch, COMM_CLAIM_DEQUEUE);
+    uint64_t pos = RX_LOAD64(&ring->dequeue_pos);
+    size_t n;
+    for (;;) {
+        comm_cell_t* cell = &ring->cells[pos & ring->mask];
+        int64_t diff = (int64_t)(RX_LOAD64(&cell->sequence) - (pos + 1));
+        if (diff < 0) {                         // 空
+            claim_end(claim);
+            return 0;
+        }
+        if (diff > 0) {
+            pos = RX_LOAD64(&ring->dequeue_pos);
+            continue;
+        }
+        n = 1;
+        while (n < max_count && RX_LOAD64(&ring->cells[(pos + n) & ring->mask].sequence) == pos + n + 1) n++;
+        claim_set(claim, pos, n);
+        if (RX_CAS64(&ring->dequeue_pos, pos, pos + n)) break;
+        pos = RX_LOAD64(&ring->dequeue_pos);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        comm_cell_t* cell = &ring->cells[(pos + i) & ring->mask];
+        out[i] = cell->desc;
+        RX_STORE64(&cell->sequence, pos + i + ring->mask + 1);
+    }
+    claim_end(claim);
+    return n;
+}
+
+// 取出並濾掉崩潰回收留下的空訊息
+static size_t ring_dequeue(comm_channel_t* ch, comm_desc_t* out, size_t max_count) {
+    for (;;) {
+        size_t n = ring_dequeue_raw(ch, out, max_count);
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (out[i].type != COMM_DESC_DROPPED) out[kept++] = out[i];
+        }
+        if (kept > 0 || n == 0) return kept;
+    }
+}
+
+static void channel_maybe_recover(comm_channel_t* ch);
+
+static comm_result_t ring_dequeue_wait_registered(comm_channel_t* ch, comm_desc_t* out, uint32_t timeout_ms) {
+    comm_ring_t* ring = ch->ring;
+    if (ring_dequeue(ch, out, 1)) return COMM_SUCCESS;
+    if (timeout_ms == 0) return COMM_ERROR_RECV;
+
+    uint64_t deadline = ring_now_ms() + timeout_ms;
+    comm_result_t result = COMM_ERROR_TIMEOUT;
+    RX_ADD32(&ring->waiters, 1);
+    if (ch->self) RX_ADD32(&ch->self->waiters, 1);
+    for (;;) {
+        uint32_t event = RX_LOAD32(&ring->data_event);
+        if (ring_dequeue(ch, out, 1)) {
+            result = COMM_SUCCESS;
+            break;
+        }
+        if (RX_LOAD32(&ring->closed) || RX_LOAD32(&ch->closing)) {
+            result = COMM_ERROR_INIT;
+            break;
+        }
+        uint32_t wait_ms = COMM_WAIT_INFINITE;
+        if (timeout_ms != COMM_WAIT_INFINITE) {
+            uint64_t now = ring_now_ms();
+            if (now >= deadline) break;
+            wait_ms = (uint32_t)(deadline - now);
+        }
+        if (ch->shared) {
+            // 共享通道分段等待: 佇列非空卻取不到時, 可能卡在已終止行程認領的格子上
+            if (wait_ms > COMM_RECOVER_INTERVAL_MS) wait_ms = COMM_RECOVER_INTERVAL_MS;
+            if (RX_LOAD64(&ring->enqueue_pos) != RX_LOAD64(&ring->dequeue_pos)) channel_maybe_recover(ch);
+        }
+        ring_wait(ch, event, wait_ms);
+    }
+    if (ch->self) RX_ADD32(&ch->self->waiters, (uint32_t)-1);
+    RX_ADD32(&ring->waiters, (uint32_t)-1);
+    return result;
+}
+
+// 先登記再檢查 closing, 與 comm_cleanup 的先設 closing 再等 local_waiters 歸零配對,
+// 保證 cleanup 解除映射時沒有本行程線程仍在環上
+static comm_result_t ring_dequeue_wait(comm_channel_t* ch, comm_desc_t* out, uint32_t timeout_ms) {
+    RX_ADD32(&ch->local_waiters, 1);
+    comm_result_t result = RX_LOAD32(&ch->closing) ? COMM_ERROR_INIT : ring_dequeue_wait_registered(ch, out, timeout_ms);
+    RX_ADD32(&ch->local_waiters, (uint32_t)-1);
+    return result;
+}
+
+// ===== 具名通道: 行程登記與崩潰回收 =====
+
+static uint32_t proc_self_pid(void) {
+#ifdef _WIN32
+    return (uint32_t)GetCurrentProcessId();
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+// 行程啟動時間; 無法取得時回傳 0 (只比對 PID)
+static uint64_t proc_start_time(uint32_t pid) {
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process) return 0;
+    FILETIME created, exited, kernel, user;
+    uint64_t start = 0;
+    if (GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+        start = ((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime;
+    }
+    CloseHandle(process);
+    return start;
+#else
+    char path[64];
+    char buf[1024];
+    snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+    // 第 2 欄 (comm) 可含空白, 從最後一個 ')' 之後起算第 22 欄 starttime
+    char* p = strrchr(buf, ')');
+    if (!p) return 0;
+    unsigned long long start = 0;
+    int field = 2;
+    for (p++; *p && field < 22; p++) {
+        if (*p == ' ') field++;
+    }
+    if (field == 22) sscanf(p, "%llu", &start);
+    return start;
+#endif
+}
+
+static bool proc_alive(uint32_t pid, uint64_t start_time) {
+    if (pid == 0) return false;
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+    if (!process) return false;
+    bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    if (!alive) return false;
+#else
+    if (kill((pid_t)pid, 0) != 0 && errno != EPERM) return false;
+#endif
+    return start_time == 0 || proc_start_time(pid) == start_time;
+}
+
+static bool channel_lock(comm_channel_t* ch, bool wait) {
+#ifdef _WIN32
+    DWORD rc = WaitForSingleObject(ch->lock, wait ? INFINITE : 0);
+    return rc == WAIT_OBJECT_0 || rc == WAIT_ABANDONED;
+#else
+    return flock(ch->fd, wait ? LOCK_EX : (LOCK_EX | LOCK_NB)) == 0;
+#endif
+}
+
+static void channel_unlock(comm_channel_t* ch) {
+#ifdef _WIN32
+    ReleaseMutex(ch->lock);
+#else
+    flock(ch->fd, LOCK_UN);
+#endif
+}
+
+// 位置是否落在存活行程 (含本行程其他線程) 的認領紀錄內; 該認領者可能仍在寫入格子
+static bool claim_covered_live(comm_shm_header_t* header, uint32_t kind, uint64_t pos) {
+    for (uint32_t i = 0; i < COMM_SHM_MAX_PROCS; i++) {
+        comm_proc_slot_t* slot = &header->procs[i];
+        if (RX_LOAD32(&slot->pid) == 0) continue;
+        for (uint32_t j = 0; j < COMM_PROC_CLAIMS; j++) {
+            comm_claim_t* claim = &slot->claims[j];
+            if (RX_LOAD32(&claim->kind) != kind) continue;
+            if (pos - RX_LOAD64(&claim->pos) < RX_LOAD32(&claim->count)) return true;
+        }
+    }
+    return false;
+}
+
+static bool slot_has_claims(const comm_proc_slot_t* slot) {
+    for (uint32_t j = 0; j < COMM_PROC_CLAIMS; j++) {
+        if (RX_LOAD32(&slot->claims[j].kind) != COMM_CLAIM_FREE) return true;
+    }
+    return false;
+}
+
+// 清除已終止行程的登記, 並依其認領紀錄修補留下的半途格子 (呼叫者持通道鎖):
+// - 已認領未發佈: 發佈為空訊息, 接收端略過
+// - 已取出未歸還: 歸還該格並釋放其區塊
+// 認領紀錄寫在 CAS 之前, CAS 未成功的區間可能屬於其他認領者: 格子狀態不符者略過;
+// 仍有存活紀錄涵蓋者保留紀錄, 留待下次回收 (槽位在紀錄清空前不會重新登記)
+// 終止行程持有的 reserve / borrow 區塊無從得知, 會留在訊息區中不再重用
+static size_t channel_recover_locked(comm_channel_t* ch) {
+    comm_shm_header_t* header = ch->header;
+    comm_ring_t* ring = ch->ring;
+    size_t repaired = 0;
+
+    for (uint32_t i = 0; i < COMM_SHM_MAX_PROCS; i++) {
+        comm_proc_slot_t* slot = &header->procs[i];
+        uint32_t pid = RX_LOAD32(&slot->pid);
+        if (pid == 0 || slot == ch->self || proc_alive(pid, slot->start_time)) continue;
+        uint32_t stale_waiters = RX_LOAD32(&slot->waiters);
+        if (stale_waiters) RX_ADD32(&ring->waiters, (uint32_t)0 - stale_waiters);
+        slot->waiters = 0;
+        RX_STORE32(&slot->pid, 0);
+    }
+
+    // 先讀位置再查紀錄: 位置之前的格子, 其認領者的紀錄在 CAS 前已寫入, 發佈 / 歸還前不會清除
+    uint64_t head = RX_LOAD64(&ring->dequeue_pos);
+    uint64_t tail = RX_LOAD64(&ring->enqueue_pos);
+    for (uint32_t i = 0; i < COMM_SHM_MAX_PROCS; i++) {
+        if (RX_LOAD32(&header->procs[i].pid) != 0) continue;
+        for (uint32_t j = 0; j < COMM_PROC_CLAIMS; j++) {
+            comm_claim_t* claim = &header->procs[i].claims[j];
+            uint32_t kind = RX_LOAD32(&claim->kind);
+            if (kind == COMM_CLAIM_FREE) continue;
+            uint64_t first = RX_LOAD64(&claim->pos);
+            uint32_t count = RX_LOAD32(&claim->count);
+            bool deferred = false;
+            for (uint64_t pos = first; pos < first + count; pos++) {
+                comm_cell_t* cell = &ring->cells[pos & ring->mask];
+                if (kind == COMM_CLAIM_ENQUEUE ? (pos < head || pos >= tail) : pos >= head) continue;
+                if (claim_covered_live(header, kind, pos)) {
+                    deferred = true;
+                    continue;
+                }
+                if (kind == COMM_CLAIM_ENQUEUE) {
+                    if (RX_LOAD64(&cell->sequence) != pos) continue;
+                    cell->desc.block = 0;
+                    cell->desc.length = 0;
+                    cell->desc.type = COMM_DESC_DROPPED;
+                    RX_STORE64(&cell->sequence, pos + 1);
+                } else {
+                    if (RX_LOAD64(&cell->sequence) != pos + 1) continue;
+                    if (cell->desc.block && cell->desc.type != COMM_DESC_DROPPED) {
+                        arena_free(ch->arena, cell->desc.size_class, cell->desc.block);
+                    }
+                    RX_STORE64(&cell->sequence, pos + ring->capacity);
+                }
+                repaired++;
+            }
+            if (!deferred) RX_STORE32(&claim->kind, COMM_CLAIM_FREE);
+        }
+    }
+    if (repaired) {
+        RX_ADD32(&ring->data_event, 1);
+        ring_wake_all(ch);
+    }
+    return repaired;
+}
+
+static void channel_maybe_recover(comm_channel_t* ch) {
+    if (!ch->shared) return;
+    uint64_t now = ring_now_ms();
+    uint64_t last = RX_LOAD64(&ch->last_recover_ms);
+    if (now - last < COMM_RECOVER_INTERVAL_MS || !RX_CAS64(&ch->last_recover_ms, last, now)) return;
+    if (!channel_lock(ch, false)) return;   // 其他行程正在初始化或回收
+    channel_recover_locked(ch);
+    channel_unlock(ch);
+}
+
+static void channel_format(comm_channel_t* ch, uint64_t total, uint64_t ring_offset, uint64_t arena_offset, uint64_t cap) {
+    comm_shm_header_t* header = ch->header;
+    memset(header, 0, sizeof(*header));
+    header->magic = COMM_SHM_MAGIC;
+    header->version = COMM_SHM_VERSION;
+    header->total_bytes = total;
+    header->ring_offset = ring_offset;
+    header->arena_offset = arena_offset;
+    header->arena_bytes = COMM_SHM_ARENA_BYTES;
+    ring_format((comm_ring_t*)((char*)header + ring_offset), cap);
+    arena_format((comm_arena_t*)((char*)header + arena_offset), COMM_SHM_ARENA_BYTES, false);
+    RX_STORE32(&header->ready, 1);
+}
+
+static bool channel_header_valid(const comm_shm_header_t* header, uint64_t mapped) {
+    return header->magic == COMM_SHM_MAGIC && header->version == COMM_SHM_VERSION &&
+           RX_LOAD32(&header->ready) == 1 && header->total_bytes <= mapped &&
+           header->arena_offset + header->arena_bytes <= header->total_bytes;
+}
+
+static void channel_unmap(comm_channel_t* ch) {
+#ifdef _WIN32
+    if (ch->header) UnmapViewOfFile(ch->header);
+    if (ch->mapping) CloseHandle(ch->mapping);
+    if (ch->wake) CloseHandle(ch->wake);
+    if (ch->lock) CloseHandle(ch->lock);
+    ch->mapping = ch->wake = ch->lock = NULL;
+#else
+    if (ch->header) munmap(ch->header, (size_t)ch->mapped_bytes);
+    if (ch->fd >= 0) close(ch->fd);
+    ch->fd = -1;
+#endif
+    ch->header = NULL;
+}
+
+// 建立或附加具名共享段; 段內已有有效格式時沿用其容量, 半途格式化 (建立者崩潰) 則重新格式化
+static comm_result_t channel_open_shared(comm_channel_t* ch, const char* channel_name, uint64_t cap) {
+    size_t name_len = 0;
+    char suffix[COMM_SHM_NAME_MAX - 32];
+    for (const char* p = channel_name; *p && name_len + 1 < sizeof(suffix); p++) {
+        char c = *p;
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+        suffix[name_len++] = ok ? c : '_';
+    }
+    suffix[name_len] = '\0';
+
+    uint64_t ring_offset = (sizeof(comm_shm_header_t) + HC_PAGE_BYTES - 1) & ~(uint64_t)(HC_PAGE_BYTES - 1);
+    uint64_t arena_offset = (ring_offset + ring_bytes(cap) + HC_PAGE_BYTES - 1) & ~(uint64_t)(HC_PAGE_BYTES - 1);
+    uint64_t total = arena_offset + COMM_SHM_ARENA_BYTES;
+
+#ifdef _WIN32
+    char object_name[COMM_SHM_NAME_MAX + 16];
+    snprintf(ch->name, sizeof(ch->name), "Local\\retryix_comm_%s", suffix);
+    snprintf(object_name, sizeof(object_name), "%s_lock", ch->name);
+    ch->lock = CreateMutexA(NULL, FALSE, object_name);
+    snprintf(object_name, sizeof(object_name), "%s_wake", ch->name);
+    ch->wake = CreateSemaphoreA(NULL, 0, 0x7FFFFFFF, object_name);
+    if (!ch->lock || !ch->wake) {
+        channel_unmap(ch);
+        return COMM_ERROR_INIT;
+    }
+    channel_lock(ch, true);
+
+    // 已存在時 CreateFileMapping 傳回原映射並忽略大小
+    ch->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                     (DWORD)(total >> 32), (DWORD)total, ch->name);
+    bool existed = ch->mapping && GetLastError() == ERROR_ALREADY_EXISTS;
+    if (ch->mapping) ch->header = (comm_shm_header_t*)MapViewOfFile(ch->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!ch->header) {
+        channel_unlock(ch);
+        channel_unmap(ch);
+        return COMM_ERROR_INIT;
+    }
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(ch->header, &info, sizeof(info));
+    ch->mapped_bytes = (uint64_t)info.RegionSize;
+    if (!existed || !channel_header_valid(ch->header, ch->mapped_bytes)) {
+        if (ch->mapped_bytes < total) {
+            channel_unlock(ch);
+            channel_unmap(ch);
+            return COMM_ERROR_INIT;
+        }
+        channel_format(ch, total, ring_offset, arena_offset, cap);
+    }
+#else
+    snprintf(ch->name, sizeof(ch->name), "/retryix_comm_%s", suffix);
+    ch->fd = shm_open(ch->name, O_RDWR | O_CREAT, 0600);
+    if (ch->fd < 0) return COMM_ERROR_INIT;
+    channel_lock(ch, true);
+
+    struct stat st;
+    bool valid = false;
+    if (fstat(ch->fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(comm_shm_header_t)) {
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, ch->fd, 0);
+        if (map != MAP_FAILED) {
+            ch->header = (comm_shm_header_t*)map;
+            ch->mapped_bytes = (uint64_t)st.st_size;
+            valid = channel_header_valid(ch->header, ch->mapped_bytes);
+            if (!valid) {
+                munmap(map, (size_t)st.st_size);
+                ch->header = NULL;
+            }
+        }
+    }
+    if (!valid) {
+        void* map = MAP_FAILED;
+        if (ftruncate(ch->fd, 0) == 0 && ftruncate(ch->fd, (off_t)total) == 0) {
+            map = mmap(NULL, (size_t)total, PROT_READ | PROT_WRITE, MAP_SHARED, ch->fd, 0);
+        }
+        if (map == MAP_FAILED) {
+            channel_unlock(ch);
+            close(ch->fd);
+            ch->fd = -1;
+            return COMM_ERROR_INIT;
+        }
+        ch->header = (comm_shm_header_t*)map;
+        ch->mapped_bytes = total;
+        channel_format(ch, total, ring_offset, arena_offset, cap);
+    }
+#endif
+
+    comm_shm_header_t* header = ch->header;
+    ch->ring = (comm_ring_t*)((char*)header + header->ring_offset);
+    ch->arena = (comm_arena_t*)((char*)header + header->arena_offset);
+    ch->shared = true;
+    ch->self = NULL;
+
+    // 先回收已終止行程的槽位與格子, 再登記本行程
+    channel_recover_locked(ch);
+    uint64_t start_time = proc_start_time(ch->pid);
+    for (uint32_t i = 0; i < COMM_SHM_MAX_PROCS && !ch->self; i++) {
+        comm_proc_slot_t* slot = &header->procs[i];
+        if (RX_LOAD32(&slot->pid) != 0 || slot_has_claims(slot)) continue;
+        slot->start_time = start_time;
+        slot->waiters = 0;
+        RX_STORE32(&slot->pid, ch->pid);
+        ch->self = slot;
+    }
+    channel_unlock(ch);
+
+    if (!ch->self) {
+        channel_unmap(ch);
+        return COMM_ERROR_INIT;     // 附加行程數已滿
+    }
     return COMM_SUCCESS;
 }
 
-comm_result_t comm_send(const comm_packet_t* packet) {
-    if (!initialized) return COMM_ERROR_INIT;
-    if (((queue_tail + 1) % MAX_MSG_QUEUE) == queue_head)
-        return COMM_ERROR_QUEUE_FULL;
+// 解除本行程登記; 最後一個離開的行程刪除具名段
+static void channel_close_shared(comm_channel_t* ch) {
+    channel_lock(ch, true);
+    ch->self->waiters = 0;
+    RX_STORE32(&ch->self->pid, 0);
+    bool others = false;
+    for (uint32_t i = 0; i < COMM_SHM_MAX_PROCS; i++) {
+        comm_proc_slot_t* slot = &ch->header->procs[i];
+        uint32_t pid = RX_LOAD32(&slot->pid);
+        if (pid != 0 && proc_alive(pid, slot->start_time)) others = true;
+    }
+#ifndef _WIN32
+    if (!others) shm_unlink(ch->name);
+#else
+    (void)others;               // 具名映射隨最後一個控制代碼關閉而消失
+#endif
+    channel_unlock(ch);
+    channel_unmap(ch);
+}
+
+// ===== 封包 <-> 描述符 =====
+
+static comm_result_t packet_to_desc(comm_arena_t* arena, const comm_packet_t* packet, comm_desc_t* desc) {
+    if (packet->length < 0 || (size_t)packet->length > sizeof(packet->data)) return COMM_ERROR_INVALID;
+    desc->length = (uint32_t)packet->length;
+    desc->type = packet->type;
+    desc->size_class = 0;
+    if (desc->length <= COMM_MSG_INLINE_BYTES) {
+        desc->block = 0;
+        memcpy(desc->inline_data, packet->data, desc->length);
+        return COMM_SUCCESS;
+    }
+    int size_class = arena_class_of(desc->length);
+    desc->block = arena_alloc(arena, (uint32_t)size_class);
+    if (!desc->block) return COMM_ERROR_NO_MEMORY;
+    desc->size_class = (uint32_t)size_class;
+    memcpy(arena_ptr(arena, desc->block), packet->data, desc->length);
+    return COMM_SUCCESS;
+}
+
+static void desc_to_packet(comm_arena_t* arena, const comm_desc_t* desc, comm_packet_t* packet) {
+    size_t copy = desc->length < sizeof(packet->data) ? desc->length : sizeof(packet->data);
+    const void* src = desc->block ? arena_ptr(arena, desc->block) : desc->inline_data;
+    memcpy(packet->data, src, copy);
+    packet->length = (int)copy;
+    packet->type = desc->type;
+    if (desc->block) arena_free(arena, desc->size_class, desc->block);
+}
+
+static void desc_discard(comm_arena_t* arena, const comm_desc_t* desc) {
+    if (desc->block) arena_free(arena, desc->size_class, desc->block);
+}
+
+// ===== 公開 API =====
+
+static comm_channel_t* comm_channel(void) {
+    return RX_LOAD32(&g_state) == 2 ? &g_channel : NULL;
+}
+
+// channel_name 為 NULL 或空字串時建立本行程佇列, 否則建立或附加同名的跨行程通道
+comm_result_t comm_init_ex(const char* channel_name, size_t capacity) {
+    if (capacity < 2 || capacity > ((size_t)1 << 30)) return COMM_ERROR_INVALID;
+
+    for (;;) {
+        uint32_t state = RX_LOAD32(&g_state);
+        if (state == 2) return COMM_SUCCESS;
+        if (state == 0 && RX_CAS32(&g_state, 0, 1)) break;
+        RX_YIELD();
+    }
+
+    uint64_t cap = 2;
+    while (cap < capacity) cap <<= 1;
+
+    comm_channel_t* ch = &g_channel;
+    memset(ch, 0, sizeof(*ch));
+    ch->pid = proc_self_pid();
+#ifndef _WIN32
+    ch->fd = -1;
+#endif
+
+    if (channel_name && channel_name[0]) {
+        comm_result_t rc = channel_open_shared(ch, channel_name, cap);
+        RX_STORE32(&g_state, rc == COMM_SUCCESS ? 2 : 0);
+        return rc;
+    }
 
-    msg_queue[queue_tail] = *packet;
-    queue_tail = (queue_tail + 1) % MAX_MSG_QUEUE;
+    comm_ring_t* ring;
+#ifdef _WIN32
+    ring = (comm_ring_t*)_aligned_malloc(ring_bytes(cap), HC_CACHE_LINE);
+#else
+    if (posix_memalign((void**)&ring, HC_CACHE_LINE, ring_bytes(cap)) != 0) ring = NULL;
+#endif
+    comm_arena_t* arena = ring ? (comm_arena_t*)arena_map(COMM_ARENA_DEFAULT_BYTES) : NULL;
+    if (!arena) {
+#ifdef _WIN32
+        _aligned_free(ring);
+#else
+        free(ring);
+#endif
+        RX_STORE32(&g_state, 0);
+        return COMM_ERROR_INIT;
+    }
+    ring_format(ring, cap);
+#ifdef _WIN32
+    arena_format(arena, COMM_ARENA_DEFAULT_BYTES, true);
+#else
+    arena_format(arena, COMM_ARENA_DEFAULT_BYTES, false);
+#endif
+    ch->ring = ring;
+    ch->arena = arena;
+    RX_STORE32(&g_state, 2);
     return COMM_SUCCESS;
 }
 
+comm_result_t comm_init(const char* channel_name) {
+    return comm_init_ex(channel_name, MAX_MSG_QUEUE);
+}
+
+comm_result_t comm_send(const comm_packet_t* packet) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch) return COMM_ERROR_INIT;
+    if (!packet) return COMM_ERROR_INVALID;
+
+    comm_desc_t desc;
+    comm_result_t rc = packet_to_desc(ch->arena, packet, &desc);
+    if (rc != COMM_SUCCESS) return rc;
+    if (ring_enqueue(ch, &desc, 1)) return COMM_SUCCESS;
+    desc_discard(ch->arena, &desc);
+    channel_maybe_recover(ch);
+    return COMM_ERROR_QUEUE_FULL;
+}
+
 comm_result_t comm_recv(comm_packet_t* out_packet) {
-    if (!initialized) return COMM_ERROR_INIT;
-    if (queue_head == queue_tail) return COMM_ERROR_RECV;
+    comm_channel_t* ch = comm_channel();
+    if (!ch) return COMM_ERROR_INIT;
+    if (!out_packet) return COMM_ERROR_INVALID;
 
-    *out_packet = msg_queue[queue_head];
-    queue_head = (queue_head + 1) % MAX_MSG_QUEUE;
+    comm_desc_t desc;
+    if (!ring_dequeue(ch, &desc, 1)) return COMM_ERROR_RECV;
+    desc_to_packet(ch->arena, &desc, out_packet);
     return COMM_SUCCESS;
 }
 
+#define COMM_BATCH 32
+
+size_t comm_send_n(const comm_packet_t* packets, size_t count) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch || !packets) return 0;
+
+    comm_desc_t descs[COMM_BATCH];
+    size_t sent = 0;
+    while (sent < count) {
+        size_t batch = count - sent < COMM_BATCH ? count - sent : COMM_BATCH;
+        size_t ready = 0;
+        while (ready < batch && packet_to_desc(ch->arena, &packets[sent + ready], &descs[ready]) == COMM_SUCCESS) ready++;
+
+        size_t queued = 0;
+        while (queued < ready) {
+            size_t n = ring_enqueue(ch, descs + queued, ready - queued);
+            if (n == 0) break;
+            queued += n;
+        }
+        for (size_t i = queued; i < ready; i++) desc_discard(ch->arena, &descs[i]);
+        sent += queued;
+        if (queued < batch) break;
+    }
+    return sent;
+}
 
+size_t comm_recv_n(comm_packet_t* out_packets, size_t max_count) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch || !out_packets) return 0;
 
+    comm_desc_t descs[COMM_BATCH];
+    size_t received = 0;
+    while (received < max_count) {
+        size_t want = max_count - received < COMM_BATCH ? max_count - received : COMM_BATCH;
+        size_t n = ring_dequeue(ch, descs, want);
+        if (n == 0) break;
+        for (size_t i = 0; i < n; i++) desc_to_packet(ch->arena, &descs[i], &out_packets[received + i]);
+        received += n;
+    }
+    return received;
+}
+
+comm_result_t comm_recv_wait(comm_packet_t* out_packet, uint32_t timeout_ms) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch) return COMM_ERROR_INIT;
+    if (!out_packet) return COMM_ERROR_INVALID;
+
+    comm_desc_t desc;
+    comm_result_t rc = ring_dequeue_wait(ch, &desc, timeout_ms);
+    if (rc == COMM_SUCCESS) desc_to_packet(ch->arena, &desc, out_packet);
+    return rc;
+}
+
+// ===== 零拷貝訊息 =====
+
+comm_result_t comm_msg_reserve(size_t size, comm_msg_t* out_msg) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch) return COMM_ERROR_INIT;
+    if (!out_msg || size > 0xFFFFFFFFu) return COMM_ERROR_INVALID;
+
+    int size_class = arena_class_of(size ? size : 1);
+    if (size_class < 0) return COMM_ERROR_INVALID;
+    uint32_t block = arena_alloc(ch->arena, (uint32_t)size_class);
+    if (!block) return COMM_ERROR_NO_MEMORY;
+
+    out_msg->block = block;
+    out_msg->size_class = (uint32_t)size_class;
+    out_msg->data = arena_ptr(ch->arena, block);
+    out_msg->length = (size_t)arena_class_bytes((uint32_t)size_class);
+    out_msg->type = 0;
+    return COMM_SUCCESS;
+}
+
+comm_result_t comm_msg_commit(comm_msg_t* msg, size_t length, int type) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch) return COMM_ERROR_INIT;
+    if (!msg || !msg->block || length > msg->length || type == COMM_DESC_DROPPED) return COMM_ERROR_INVALID;
+
+    comm_desc_t desc;
+    desc.block = msg->block;
+    desc.size_class = msg->size_class;
+    desc.length = (uint32_t)length;
+    desc.type = type;
+    if (!ring_enqueue(ch, &desc, 1)) {
+        channel_maybe_recover(ch);
+        return COMM_ERROR_QUEUE_FULL;
+    }
+    msg->block = 0;
+    msg->data = NULL;
+    return COMM_SUCCESS;
+}
+
+void comm_msg_abort(comm_msg_t* msg) {
+    comm_channel_t* ch = comm_channel();
+    if (!msg || !msg->block || !ch) return;
+    arena_free(ch->arena, msg->size_class, msg->block);
+    msg->block = 0;
+    msg->data = NULL;
+}
+
+comm_result_t comm_msg_borrow(comm_msg_t* out_msg, uint32_t timeout_ms) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch) return COMM_ERROR_INIT;
+    if (!out_msg) return COMM_ERROR_INVALID;
+
+    comm_desc_t desc;
+    comm_result_t rc = ring_dequeue_wait(ch, &desc, timeout_ms);
+    if (rc != COMM_SUCCESS) return rc;
+
+    out_msg->block = desc.block;
+    out_msg->size_class = desc.size_class;
+    out_msg->length = desc.length;
+    out_msg->type = desc.type;
+    if (desc.block) {
+        out_msg->data = arena_ptr(ch->arena, desc.block);
+    } else {
+        memcpy(out_msg->inline_data, desc.inline_data, desc.length);
+        out_msg->data = out_msg->inline_data;
+    }
+    return COMM_SUCCESS;
+}
+
+void comm_msg_release(comm_msg_t* msg) {
+    if (!msg) return;
+    comm_channel_t* ch = comm_channel();
+    if (msg->block && ch) arena_free(ch->arena, msg->size_class, msg->block);
+    msg->block = 0;
+    msg->data = NULL;
+}
+
+// 立即修補已終止行程留下的通道狀態; 回傳修補的格子數 (本行程佇列恆為 0)
+size_t comm_recover(void) {
+    comm_channel_t* ch = comm_channel();
+    if (!ch || !ch->shared || !channel_lock(ch, true)) return 0;
+    size_t repaired = channel_recover_locked(ch);
+    channel_unlock(ch);
+    return repaired;
+}
+
+// 呼叫前須停止收發; 阻塞中的接收者會被喚醒並回傳 COMM_ERROR_INIT, 未歸還的訊息視圖隨之失效
+// 具名通道只解除本行程的附加, 其他行程照常使用
 void comm_cleanup() {
-    initialized = 0;
-    queue_head = queue_tail = 0;
+    if (!RX_CAS32(&g_state, 2, 3)) return;
+    comm_channel_t* ch = &g_channel;
+    comm_ring_t* ring = ch->ring;
+
+    // 具名通道的 ring->closed 為各行程共用, 只以本行程的 closing 通知自己的接收者;
+    // 等本行程所有接收者離開環後才解除映射
+    RX_STORE32(&ch->closing, 1);
+    RX_FENCE();
+    if (!ch->shared) RX_STORE32(&ring->closed, 1);
+    while (RX_LOAD32(&ch->local_waiters) != 0) {
+        RX_ADD32(&ring->data_event, 1);
+        ring_wake_all(ch);
+        RX_YIELD();
+    }
+
+    if (ch->shared) {
+        channel_close_shared(ch);
+        RX_STORE32(&g_state, 0);
+        return;
+    }
+
+    arena_unmap(ch->arena, ch->arena->capacity);
+#ifdef _WIN32
+    _aligned_free(ring);
+#else
+    free(ring);
+#endif
+    ch->arena = NULL;
+    ch->ring = NULL;
+    RX_STORE32(&g_state, 0);
 }
 
 void retryix_host_comm_cleanup(void) {
@@ -0,0 +1,540 @@
+// retryix_zerocopy_perf.c - 網絡性能量測與快取
+// 往返延遲分位數 (p50/p99/p999) + 管線化串流頻寬 + 訊息大小掃描, 依連線快取並可背景刷新
+// TCP 連線以 SINK 負載量測 (對端丟棄後 ACK), 同進程與共享記憶體連線量測本地單邊寫入路徑
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_zerocopy_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define ZC_PERF_PING_SIZE      64
+#define ZC_PERF_PING_COUNT     2000          // p999 需要至少 1000 個樣本
+#define ZC_PERF_MAX_SIZE       (4u << 20)
+#define ZC_PERF_POINT_BYTES    (2u << 20)    // 每個掃描點的單次量測與串流各自的負載上限
+#define ZC_PERF_STREAM_MIN_OPS 2
+#define ZC_PERF_STREAM_MAX_OPS 256
+#define ZC_PERF_WINDOW         64            // 串流時的在途傳輸數
+#define ZC_PERF_LAT_REPEAT     5             // 小訊息的重複次數; 大訊息依負載上限遞減, 至少 1 次
+#define ZC_PERF_OP_TIMEOUT_MS  2000
+#define ZC_PERF_MAX_FAILURES   16            // 連續失敗即視為路徑中斷
+
+static const uint32_t g_sweep_sizes[RETRYIX_ZC_PERF_SWEEP_POINTS] = {
+    64, 512, 4096, 16384, 65536, 262144, 1048576, 4194304
+};
+
+typedef struct {
+    bool used;
+    retryix_net_connection_t connection;
+    retryix_net_perf_t perf;
+} zc_perf_entry_t;
+
+static ZC_MUTEX g_perf_lock = ZC_MUTEX_INITIALIZER;     // 保護快取
+static ZC_MUTEX g_probe_lock = ZC_MUTEX_INITIALIZER;    // 同一時間只跑一個量測, 避免互相干擾
+static zc_perf_entry_t g_perf_cache[RETRYIX_ZC_PERF_MAX_CONNS];
+static int g_latest_index = -1;
+
+static volatile uint32_t g_refresh_interval_ms = 0;
+static volatile uint32_t g_refresh_running = 0;
+#ifdef _WIN32
+static HANDLE g_refresh_thread = NULL;
+#else
+static pthread_t g_refresh_thread;
+#endif
+
+// === 時鐘 ===
+static uint64_t zc_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void zc_sleep_ms(uint32_t ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    usleep(ms * 1000u);
+#endif
+}
+
+// === 快取鍵 ===
+// connection 為 NULL 時以同進程路徑的虛擬連線代表
+static void zc_local_key(retryix_net_connection_t* key) {
+    memset(key, 0, sizeof(*key));
+    snprintf(key->remote_ip, sizeof(key->remote_ip), "local");
+    snprintf(key->local_ip, sizeof(key->local_ip), "local");
+    key->protocol = RETRYIX_NET_PROTO_UNKNOWN;
+}
+
+static bool zc_same_conn(const retryix_net_connection_t* a, const retryix_net_connection_t* b) {
+    return a->protocol == b->protocol && a->qp_num == b->qp_num && a->psn == b->psn &&
+           strcmp(a->remote_ip, b->remote_ip) == 0;
+}
+
+static int zc_find_locked(const retryix_net_connection_t* key) {
+    for (int i = 0; i < RETRYIX_ZC_PERF_MAX_CONNS; i++) {
+        if (g_perf_cache[i].used && zc_same_conn(&g_perf_cache[i].connection, key)) return i;
+    }
+    return -1;
+}
+
+static void zc_store(const retryix_net_connection_t* key, const retryix_net_perf_t* perf) {
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    int idx = zc_find_locked(key);
+    if (idx < 0) {
+        // 取空槽, 滿時覆蓋最舊的結果
+        uint64_t oldest = UINT64_MAX;
+        for (int i = 0; i < RETRYIX_ZC_PERF_MAX_CONNS; i++) {
+            if (!g_perf_cache[i].used) { idx = i; break; }
+            if (g_perf_cache[i].perf.measured_at_ms < oldest) {
+                oldest = g_perf_cache[i].perf.measured_at_ms;
+                idx = i;
+            }
+        }
+        g_perf_cache[idx].used = true;
+        g_perf_cache[idx].connection = *key;
+    }
+    g_perf_cache[idx].perf = *perf;
+    g_latest_index = idx;
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+}
+
+// === 量測傳輸 ===
+// 來源緩衝區以引用計數歸還: 量測本身持有一份, 每個 TCP 傳輸在完成回呼中釋放一份。
+// 等待逾時而放棄的傳輸仍在送出佇列中引用負載, 須等它最終完成 (或連線失效) 才能回到池中。
+typedef struct {
+    volatile int64_t refs;
+    retryix_net_buffer_t* buffer;
+} zc_probe_source_t;
+
+static void zc_probe_source_put(zc_probe_source_t* src) {
+    if (RX_ADD64(&src->refs, -1) != 1) return;
+    retryix_zc_pool_release(src->buffer);
+    free(src);
+}
+
+// 在傳輸層線程內執行 (持有連線鎖); 只歸還緩衝區, 不投遞新傳輸
+static void zc_probe_source_done(void* ctx, uint64_t transfer_id, retryix_dma_status_t status) {
+    (void)transfer_id;
+    (void)status;
+    zc_probe_source_put((zc_probe_source_t*)ctx);
+}
+
+typedef struct {
+    const retryix_net_connection_t* connection;
+    bool tcp;
+    zc_probe_source_t* source;
+    retryix_net_buffer_t* target;         ///< 本地路徑的寫入目標
+    uint32_t samples;
+    uint32_t failed;
+    uint32_t consecutive_failures;
+} zc_probe_t;
+
+static retryix_zerocopy_result_t zc_probe_post(zc_probe_t* p, size_t size, uint64_t* id) {
+    if (p->tcp) {
+        RX_ADD64(&p->source->refs, 1);
+        *id = retryix_zc_transfer_open_cb(zc_probe_source_done, p->source);
+        retryix_zerocopy_result_t rc = retryix_zc_tcp_post_sink(p->connection, p->source->buffer->buffer, size, *id);
+        if (rc != RETRYIX_ZC_SUCCESS) retryix_zc_transfer_finish(*id, RETRYIX_DMA_ERROR);
+        return rc;
+    }
+    // 本地路徑在返回前完成, 不會留下引用來源緩衝區的傳輸
+    return retryix_zerocopy_dma_transfer_async(NULL, p->source->buffer->buffer, (uint64_t)(uintptr_t)p->target->buffer,
+                                               size, p->target->rkey, id);
+}
+
+static void zc_probe_account(zc_probe_t* p, bool ok) {
+    p->samples++;
+    if (ok) {
+        p->consecutive_failures = 0;
+    } else {
+        p->failed++;
+        p->consecutive_failures++;
+    }
+}
+
+// 單次傳輸的完成時間 (奈秒), 失敗回傳 0
+static uint64_t zc_probe_once(zc_probe_t* p, size_t size) {
+    uint64_t id = 0;
+    uint64_t t0 = zc_now_ns();
+    bool ok = zc_probe_post(p, size, &id) == RETRYIX_ZC_SUCCESS &&
+              retryix_zerocopy_dma_wait(id, ZC_PERF_OP_TIMEOUT_MS) == RETRYIX_ZC_SUCCESS;
+    uint64_t elapsed = zc_now_ns() - t0;
+    zc_probe_account(p, ok);
+    return ok ? (elapsed ? elapsed : 1) : 0;
+}
+
+// 管線化串流, 回傳 Mbps (失敗回傳 0)
+static float zc_probe_stream(zc_probe_t* p, size_t size) {
+    // 整次量測 (延遲 + 8 個掃描點) 的負載約 25 MB, 不致長時間佔用路徑
+    uint32_t ops = (uint32_t)(ZC_PERF_POINT_BYTES / size);
+    if (ops < ZC_PERF_STREAM_MIN_OPS) ops = ZC_PERF_STREAM_MIN_OPS;
+    if (ops > ZC_PERF_STREAM_MAX_OPS) ops = ZC_PERF_STREAM_MAX_OPS;
+
+    uint64_t ids[ZC_PERF_WINDOW];
+    uint32_t posted = 0, completed = 0, ok_ops = 0;
+    uint64_t t0 = zc_now_ns();
+
+    while (completed < ops) {
+        if (posted < ops && posted - completed < ZC_PERF_WINDOW) {
+            if (zc_probe_post(p, size, &ids[posted % ZC_PERF_WINDOW]) != RETRYIX_ZC_SUCCESS) {
+                ids[posted % ZC_PERF_WINDOW] = 0;
+            }
+            posted++;
+            continue;
+        }
+        uint64_t id = ids[completed % ZC_PERF_WINDOW];
+        bool ok = id && retryix_zerocopy_dma_wait(id, ZC_PERF_OP_TIMEOUT_MS) == RETRYIX_ZC_SUCCESS;
+        zc_probe_account(p, ok);
+        if (ok) ok_ops++;
+        completed++;
+    }
+
+    uint64_t elapsed = zc_now_ns() - t0;
+    if (ok_ops == 0 || elapsed == 0) return 0.0f;
+    return (float)((double)ok_ops * (double)size * 8000.0 / (double)elapsed);
+}
+
+static int zc_cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static float zc_percentile_us(const uint64_t* sorted, uint32_t n, double q) {
+    uint32_t idx = (uint32_t)(q * (double)n);
+    if (idx >= n) idx = n - 1;
+    return (float)((double)sorted[idx] / 1000.0);
+}
+
+static retryix_zerocopy_result_t zc_run_probe(zc_probe_t* p, retryix_net_perf_t* perf) {
+    memset(perf, 0, sizeof(*perf));
+
+    // 1. 小訊息往返延遲分布
+    uint64_t* lat = (uint64_t*)malloc(sizeof(uint64_t) * ZC_PERF_PING_COUNT);
+    if (!lat) return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ZC_PERF_PING_COUNT; i++) {
+        uint64_t t = zc_probe_once(p, ZC_PERF_PING_SIZE);
+        if (t) lat[n++] = t;
+        if (p->consecutive_failures >= ZC_PERF_MAX_FAILURES) break;
+    }
+    if (n == 0 || p->consecutive_failures >= ZC_PERF_MAX_FAILURES) {
+        free(lat);
+        return RETRYIX_ZC_ERROR_NETWORK_DOWN;
+    }
+    qsort(lat, n, sizeof(uint64_t), zc_cmp_u64);
+    perf->latency_p50_us = zc_percentile_us(lat, n, 0.50);
+    perf->latency_p99_us = zc_percentile_us(lat, n, 0.99);
+    perf->latency_p999_us = zc_percentile_us(lat, n, 0.999);
+    free(lat);
+
+    // 2. 訊息大小掃描: 單次完成時間中位數 + 串流頻寬
+    for (int s = 0; s < RETRYIX_ZC_PERF_SWEEP_POINTS; s++) {
+        size_t size = g_sweep_sizes[s];
+        uint64_t reps[ZC_PERF_LAT_REPEAT];
+        uint32_t got = 0;
+        size_t repeat = ZC_PERF_POINT_BYTES / size;
+        if (repeat < 1) repeat = 1;
+        if (repeat > ZC_PERF_LAT_REPEAT) repeat = ZC_PERF_LAT_REPEAT;
+        for (size_t r = 0; r < repeat; r++) {
+            uint64_t t = zc_probe_once(p, size);
+            if (t) reps[got++] = t;
+        }
+        perf->sweep_size[s] = (uint32_t)size;
+        if (got) {
+            qsort(reps, got, sizeof(uint64_t), zc_cmp_u64);
+            perf->sweep_latency_us[s] = (float)((double)reps[got / 2] / 1000.0);
+        }
+        perf->sweep_bandwidth_mbps[s] = zc_probe_stream(p, size);
+        if (perf->sweep_bandwidth_mbps[s] > perf->bandwidth_mbps) {
+            perf->bandwidth_mbps = perf->sweep_bandwidth_mbps[s];
+        }
+        if (p->consecutive_failures >= ZC_PERF_MAX_FAILURES) return RETRYIX_ZC_ERROR_NETWORK_DOWN;
+    }
+
+    perf->samples = p->samples;
+    perf->failed = p->failed;
+    perf->measured_at_ms = zc_now_ns() / 1000000ull;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+static retryix_zerocopy_result_t zc_probe_connection(const retryix_net_connection_t* connection,
+                                                     retryix_net_perf_t* perf) {
+    zc_probe_t p;
+    memset(&p, 0, sizeof(p));
+    p.connection = connection;
+    void* hold = NULL;
+
+    if (connection) {
+        switch (connection->protocol) {
+        case RETRYIX_NET_PROTO_TCP_OFFLOAD:
+            // 量測期間持有連線, 其他線程同時斷線也不會回收連線物件
+            hold = retryix_zc_tcp_hold(connection);
+            if (!hold) return RETRYIX_ZC_ERROR_NETWORK_DOWN;
+            p.tcp = true;
+            break;
+        case RETRYIX_NET_PROTO_SHM:
+            // 共享記憶體寫入即本地 memcpy 到共享映射, 以本地路徑量測
+            if (!retryix_zc_shm_peer_alive(connection)) return RETRYIX_ZC_ERROR_NETWORK_DOWN;
+            break;
+        default:
+            return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+        }
+    }
+
+    p.source = (zc_probe_source_t*)calloc(1, sizeof(zc_probe_source_t));
+    if (!p.source) {
+        retryix_zc_tcp_unhold(hold);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    p.source->refs = 1;
+    retryix_zerocopy_result_t rc = retryix_zc_pool_acquire(ZC_PERF_MAX_SIZE, &p.source->buffer);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        free(p.source);
+        retryix_zc_tcp_unhold(hold);
+        return rc;
+    }
+    if (!p.tcp && (rc = retryix_zc_pool_acquire(ZC_PERF_MAX_SIZE, &p.target)) != RETRYIX_ZC_SUCCESS) {
+        zc_probe_source_put(p.source);
+        retryix_zc_tcp_unhold(hold);
+        return rc;
+    }
+    memset(p.source->buffer->buffer, 0x5A, ZC_PERF_MAX_SIZE);
+
+    ZC_MUTEX_LOCK(&g_probe_lock);
+    rc = zc_run_probe(&p, perf);
+    ZC_MUTEX_UNLOCK(&g_probe_lock);
+
+    // 仍有逾時放棄的傳輸時, 由最後一個完成回呼歸還
+    zc_probe_source_put(p.source);
+    if (p.target) retryix_zc_pool_release(p.target);
+    retryix_zc_tcp_unhold(hold);
+    return rc;
+}
+
+// === 背景刷新 ===
+static void zc_refresh_loop(void) {
+    uint32_t slept = 0;
+    while (RX_LOAD32(&g_refresh_running)) {
+        uint32_t interval = RX_LOAD32(&g_refresh_interval_ms);
+        zc_sleep_ms(50);
+        slept += 50;
+        if (slept < interval) continue;
+        slept = 0;
+
+        uint64_t now_ms = zc_now_ns() / 1000000ull;
+        for (int i = 0; i < RETRYIX_ZC_PERF_MAX_CONNS && RX_LOAD32(&g_refresh_running); i++) {
+            retryix_net_connection_t key;
+            bool stale = false;
+            ZC_MUTEX_LOCK(&g_perf_lock);
+            if (g_perf_cache[i].used && now_ms - g_perf_cache[i].perf.measured_at_ms >= interval) {
+                key = g_perf_cache[i].connection;
+                stale = true;
+            }
+            ZC_MUTEX_UNLOCK(&g_perf_lock);
+            if (!stale) continue;
+
+            bool local = key.protocol == RETRYIX_NET_PROTO_UNKNOWN;
+            retryix_net_perf_t perf;
+            retryix_zerocopy_result_t rc = zc_probe_connection(local ? NULL : &key, &perf);
+            if (rc == RETRYIX_ZC_SUCCESS) {
+                zc_store(&key, &perf);
+            } else if (rc == RETRYIX_ZC_ERROR_NETWORK_DOWN || rc == RETRYIX_ZC_ERROR_INVALID_PARAM) {
+                retryix_zc_perf_forget(&key);  // 連線已斷開
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI zc_refresh_main(LPVOID arg) {
+    (void)arg;
+    zc_refresh_loop();
+    return 0;
+}
+#else
+static void* zc_refresh_main(void* arg) {
+    (void)arg;
+    zc_refresh_loop();
+    return NULL;
+}
+#endif
+
+static void zc_refresh_stop(void) {
+    if (!RX_LOAD32(&g_refresh_running)) return;
+    RX_STORE32(&g_refresh_running, 0);
+#ifdef _WIN32
+    WaitForSingleObject(g_refresh_thread, INFINITE);
+    CloseHandle(g_refresh_thread);
+    g_refresh_thread = NULL;
+#else
+    pthread_join(g_refresh_thread, NULL);
+#endif
+}
+
+// === 內部 API ===
+
+bool retryix_zc_perf_lookup(const retryix_net_connection_t* connection, retryix_net_perf_t* perf) {
+    retryix_net_connection_t key;
+    if (connection) key = *connection; else zc_local_key(&key);
+
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    int idx = zc_find_locked(&key);
+    if (idx >= 0) *perf = g_perf_cache[idx].perf;
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+    return idx >= 0;
+}
+
+bool retryix_zc_perf_latest(retryix_net_perf_t* perf) {
+    bool found = false;
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    if (g_latest_index >= 0 && g_perf_cache[g_latest_index].used) {
+        *perf = g_perf_cache[g_latest_index].perf;
+        found = true;
+    }
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+    return found;
+}
+
+static bool zc_is_local_name(const char* ip) {
+    return strcmp(ip, "local") == 0 || strcmp(ip, "localhost") == 0 ||
+           strncmp(ip, "127.", 4) == 0 || strcmp(ip, "::1") == 0 || strncmp(ip, "shm:", 4) == 0;
+}
+
+bool retryix_zc_perf_best_path(const char* source_ip, const char* dest_ip,
+                               retryix_net_connection_t* connection, retryix_net_perf_t* perf) {
+    bool found = false;
+    double best_us = 0.0;
+    bool dest_local = zc_is_local_name(dest_ip);
+
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    for (int i = 0; i < RETRYIX_ZC_PERF_MAX_CONNS; i++) {
+        const zc_perf_entry_t* e = &g_perf_cache[i];
+        if (!e->used || e->perf.bandwidth_mbps <= 0.0f) continue;
+
+        // 同進程量測只代表 "local" 本身, 不代表通往本機其他進程的路徑
+        bool in_process = e->connection.protocol == RETRYIX_NET_PROTO_UNKNOWN;
+        bool match = strcmp(e->connection.remote_ip, dest_ip) == 0 ||
+                     (dest_local && !in_process && zc_is_local_name(e->connection.remote_ip));
+        if (!match) continue;
+        if (source_ip && source_ip[0] && e->connection.local_ip[0] &&
+            strcmp(source_ip, e->connection.local_ip) != 0 && !zc_is_local_name(source_ip)) {
+            continue;
+        }
+
+        // 以 64 KB 訊息的預估完成時間評分: 往返延遲 + 序列化時間
+        double cost_us = e->perf.latency_p50_us + 65536.0 * 8.0 / e->perf.bandwidth_mbps;
+        if (!found || cost_us < best_us) {
+            best_us = cost_us;
+            *connection = e->connection;
+            *perf = e->perf;
+            found = true;
+        }
+    }
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+    return found;
+}
+
+void retryix_zc_perf_forget(const retryix_net_connection_t* connection) {
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    int idx = zc_find_locked(connection);
+    if (idx >= 0) {
+        g_perf_cache[idx].used = false;
+        if (g_latest_index == idx) g_latest_index = -1;
+    }
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+}
+
+void retryix_zc_perf_shutdown(void) {
+    zc_refresh_stop();
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    memset(g_perf_cache, 0, sizeof(g_perf_cache));
+    g_latest_index = -1;
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+}
+
+// === 對外 API ===
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_probe_net_perf(
+    const retryix_net_connection_t* connection, retryix_net_perf_t* perf) {
+
+    if (!perf) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_net_perf_t result;
+    retryix_zerocopy_result_t rc = zc_probe_connection(connection, &result);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        return rc;
+    }
+
+    retryix_net_connection_t key;
+    if (connection) key = *connection; else zc_local_key(&key);
+    zc_store(&key, &result);
+    *perf = result;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_get_net_perf(
+    const retryix_net_connection_t* connection, uint32_t max_age_ms, retryix_net_perf_t* perf) {
+
+    if (!perf) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_net_connection_t key;
+    if (connection) key = *connection; else zc_local_key(&key);
+
+    bool fresh = false;
+    uint64_t now_ms = zc_now_ns() / 1000000ull;
+    ZC_MUTEX_LOCK(&g_perf_lock);
+    int idx = zc_find_locked(&key);
+    if (idx >= 0 && (max_age_ms == RETRYIX_ZC_WAIT_INFINITE ||
+                     now_ms - g_perf_cache[idx].perf.measured_at_ms <= max_age_ms)) {
+        *perf = g_perf_cache[idx].perf;
+        fresh = true;
+    }
+    ZC_MUTEX_UNLOCK(&g_perf_lock);
+
+    return fresh ? RETRYIX_ZC_SUCCESS : retryix_zerocopy_probe_net_perf(connection, perf);
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_set_perf_refresh(uint32_t interval_ms) {
+    if (interval_ms == 0) {
+        zc_refresh_stop();
+        RX_STORE32(&g_refresh_interval_ms, 0);
+        return RETRYIX_ZC_SUCCESS;
+    }
+
+    RX_STORE32(&g_refresh_interval_ms, interval_ms);
+    if (RX_LOAD32(&g_refresh_running)) {
+        return RETRYIX_ZC_SUCCESS;
+    }
+
+    RX_STORE32(&g_refresh_running, 1);
+#ifdef _WIN32
+    g_refresh_thread = CreateThread(NULL, 0, zc_refresh_main, NULL, 0, NULL);
+    if (!g_refresh_thread) {
+#else
+    if (pthread_create(&g_refresh_thread, NULL, zc_refresh_main, NULL) != 0) {
+#endif
+        RX_STORE32(&g_refresh_running, 0);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    return RETRYIX_ZC_SUCCESS;
+}
@@ -0,0 +1,642 @@
+// retryix_zerocopy_pool.c - 預註冊網路緩衝池
+// 大頁支撐的 slab, 依大小分級, 每線程無鎖快取
+// 描述符與 lkey/rkey 一旦配發便永久綁定同一塊記憶體, 重用時不需重新註冊
+#define RETRYIX_BUILD_DLL
+#ifdef _WIN32
+#define _CRT_RAND_S                  // rand_s: 系統亂數, 用於遠端授權鍵
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "retryix_zerocopy_internal.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#endif
+
+#define ZC_CHUNK_SHIFT     10
+#define ZC_CHUNK_ENTRIES   (1u << ZC_CHUNK_SHIFT)
+#define ZC_CHUNK_COUNT     (RETRYIX_ZC_POOL_MAX_ENTRIES / ZC_CHUNK_ENTRIES)
+#define ZC_TLS_DEPTH       32
+#define ZC_SPARE_LIST      RETRYIX_ZC_POOL_CLASS_COUNT   // 獨立映射/外部註冊用的閒置描述符
+
+static const size_t k_class_bytes[RETRYIX_ZC_POOL_CLASS_COUNT] = {
+    4u << 10, 16u << 10, 64u << 10, 256u << 10, 1u << 20, 4u << 20
+};
+
+// === 描述符表: 分塊配置, 已發佈的塊永不移動 ===
+static retryix_zc_pool_entry_t* g_chunks[ZC_CHUNK_COUNT];
+static volatile uint32_t g_entry_count = 0;
+
+// === 每級別無鎖空閒堆疊: 低 32 位 = index+1, 高 32 位 = ABA 標記 ===
+static volatile uint64_t g_free_heads[RETRYIX_ZC_POOL_CLASS_COUNT + 1];
+
+static volatile long g_pool_lock = 0;
+static uint32_t g_key_salt = 0;
+static bool g_hugetlb_disabled = false;
+
+// === 統計 (只在慢路徑更新) ===
+static volatile int64_t g_bytes_reserved = 0;
+static volatile int64_t g_bytes_huge = 0;
+static volatile int64_t g_bytes_pinned = 0;
+static volatile int64_t g_slab_refills = 0;
+static volatile int64_t g_registrations = 0;
+
+// === 每線程快取 ===
+typedef struct {
+    uint32_t count[RETRYIX_ZC_POOL_CLASS_COUNT];
+    uint32_t slots[RETRYIX_ZC_POOL_CLASS_COUNT][ZC_TLS_DEPTH];
+    bool exit_hook_installed;
+} zc_tls_cache_t;
+
+static RX_THREAD_LOCAL zc_tls_cache_t t_cache;
+
+static void zc_revoke_remote(retryix_zc_pool_entry_t* e);
+
+#ifdef _WIN32
+static DWORD g_fls_index = FLS_OUT_OF_INDEXES;
+static INIT_ONCE g_fls_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_key_t g_tls_key;
+static pthread_once_t g_tls_once = PTHREAD_ONCE_INIT;
+#endif
+
+static void zc_lock(void) {
+#ifdef _WIN32
+    while (InterlockedExchange(&g_pool_lock, 1) != 0) RX_CPU_RELAX();
+#else
+    while (__sync_lock_test_and_set(&g_pool_lock, 1)) RX_CPU_RELAX();
+#endif
+}
+
+static void zc_unlock(void) {
+#ifdef _WIN32
+    InterlockedExchange(&g_pool_lock, 0);
+#else
+    __sync_lock_release(&g_pool_lock);
+#endif
+}
+
+static uint32_t zc_entry_count(void) {
+#ifdef _WIN32
+    return (uint32_t)InterlockedCompareExchange((volatile LONG*)&g_entry_count, 0, 0);
+#else
+    return __sync_fetch_and_add(&g_entry_count, 0);
+#endif
+}
+
+static inline retryix_zc_pool_entry_t* zc_entry(uint32_t index) {
+    return &g_chunks[index >> ZC_CHUNK_SHIFT][index & (ZC_CHUNK_ENTRIES - 1)];
+}
+
+static int zc_class_for(size_t size) {
+    for (int c = 0; c < RETRYIX_ZC_POOL_CLASS_COUNT; c++) {
+        if (size <= k_class_bytes[c]) return c;
+    }
+    return RETRYIX_ZC_CLASS_LARGE;
+}
+
+// === 無鎖堆疊 ===
+static void zc_stack_push(volatile uint64_t* head, retryix_zc_pool_entry_t* e) {
+    uint64_t old_head, new_head;
+    do {
+        old_head = RX_LOAD64(head);
+        e->next_free = (uint32_t)old_head;
+        new_head = (((old_head >> 32) + 1) << 32) | (uint64_t)(e->index + 1);
+    } while (!RX_CAS64(head, old_head, new_head));
+}
+
+static retryix_zc_pool_entry_t* zc_stack_pop(volatile uint64_t* head) {
+    for (;;) {
+        uint64_t old_head = RX_LOAD64(head);
+        uint32_t top = (uint32_t)old_head;
+        if (top == 0) return NULL;
+        // 描述符永不釋放, 即使被他人搶先彈出, 讀取 next_free 仍安全; 標記防止 ABA
+        retryix_zc_pool_entry_t* e = zc_entry(top - 1);
+        uint64_t new_head = (((old_head >> 32) + 1) << 32) | (uint64_t)e->next_free;
+        if (RX_CAS64(head, old_head, new_head)) return e;
+    }
+}
+
+// === 鍵值 ===
+static uint32_t zc_make_rkey(const retryix_zc_pool_entry_t* e) {
+    return (((e->generation & 0xFFu) << 24) | (e->index + 1)) ^ g_key_salt;
+}
+
+static void zc_assign_keys(retryix_zc_pool_entry_t* e) {
+    e->desc.lkey = e->index + 1;
+    e->desc.rkey = zc_make_rkey(e);
+    e->desc.remote_key = ((uint64_t)e->desc.rkey << 32) | e->desc.lkey;
+    e->desc.is_registered = true;
+    e->desc.handle = e;
+}
+
+// === 記憶體映射: 先試 hugetlb, 退回 2MB 對齊 + THP 建議 ===
+static void* zc_map_region(size_t bytes, bool* huge) {
+    *huge = false;
+#ifdef _WIN32
+    SIZE_T large_min = GetLargePageMinimum();
+    if (!g_hugetlb_disabled && large_min && (bytes % large_min) == 0) {
+        void* p = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (p) { *huge = true; return p; }
+        g_hugetlb_disabled = true;  // 缺少 SeLockMemoryPrivilege, 之後不再嘗試
+    }
+    return VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (!g_hugetlb_disabled && (bytes % RETRYIX_ZC_POOL_SLAB_BYTES) == 0) {
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) { *huge = true; return p; }
+        g_hugetlb_disabled = true;  // 未預留 hugetlb 頁, 之後不再嘗試
+    }
+#endif
+    size_t span = bytes + RETRYIX_ZC_POOL_SLAB_BYTES;
+    uint8_t* raw = (uint8_t*)mmap(NULL, span, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == (uint8_t*)MAP_FAILED) return NULL;
+    uint8_t* aligned = (uint8_t*)(((uintptr_t)raw + RETRYIX_ZC_POOL_SLAB_BYTES - 1) &
+                                  ~(uintptr_t)(RETRYIX_ZC_POOL_SLAB_BYTES - 1));
+    if (aligned > raw) munmap(raw, (size_t)(aligned - raw));
+    size_t tail = (size_t)((raw + span) - (aligned + bytes));
+    if (tail) munmap(aligned + bytes, tail);
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+    return aligned;
+#endif
+}
+
+static void zc_unmap_region(void* p, size_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munlock(p, bytes);
+    munmap(p, bytes);
+#endif
+}
+
+// 註冊 = 釘住實體頁 (盡力而為, 受 RLIMIT_MEMLOCK 限制)
+static bool zc_pin_region(void* p, size_t bytes) {
+#ifdef _WIN32
+    (void)p; (void)bytes;
+    return false;
+#else
+    if (mlock(p, bytes) != 0) return false;
+    RX_ADD64(&g_bytes_pinned, (int64_t)bytes);
+    return true;
+#endif
+}
+
+static size_t zc_round_up(size_t bytes, size_t align) {
+    return (bytes + align - 1) & ~(align - 1);
+}
+
+// === 描述符配置 (需持有 g_pool_lock) ===
+static retryix_zc_pool_entry_t* zc_new_entry_locked(void) {
+    uint32_t index = g_entry_count;
+    if (index >= RETRYIX_ZC_POOL_MAX_ENTRIES) return NULL;
+
+    uint32_t chunk = index >> ZC_CHUNK_SHIFT;
+    if (!g_chunks[chunk]) {
+        g_chunks[chunk] = (retryix_zc_pool_entry_t*)calloc(ZC_CHUNK_ENTRIES, sizeof(retryix_zc_pool_entry_t));
+        if (!g_chunks[chunk]) return NULL;
+    }
+    retryix_zc_pool_entry_t* e = zc_entry(index);
+    memset(e, 0, sizeof(*e));
+    e->index = index;
+
+    if (g_key_salt == 0) {
+        g_key_salt = ((uint32_t)time(NULL) * 2654435761u) ^ (uint32_t)(uintptr_t)&g_key_salt;
+        g_key_salt |= 1u;
+    }
+
+#ifdef _WIN32
+    MemoryBarrier();
+    InterlockedIncrement((volatile LONG*)&g_entry_count);
+#else
+    __sync_fetch_and_add(&g_entry_count, 1);
+#endif
+    return e;
+}
+
+static retryix_zc_pool_entry_t* zc_get_spare_entry(void) {
+    retryix_zc_pool_entry_t* e = zc_stack_pop(&g_free_heads[ZC_SPARE_LIST]);
+    if (e) {
+        e->generation++;
+        return e;
+    }
+    zc_lock();
+    e = zc_new_entry_locked();
+    zc_unlock();
+    return e;
+}
+
+// 切出一個 slab 並一次性註冊其中所有緩衝區; keep_one 時保留一個給呼叫端
+static retryix_zc_pool_entry_t* zc_carve_slab(int size_class, bool keep_one) {
+    size_t class_bytes = k_class_bytes[size_class];
+    size_t slab_bytes = class_bytes * 2 > RETRYIX_ZC_POOL_SLAB_BYTES ? class_bytes * 2 : RETRYIX_ZC_POOL_SLAB_BYTES;
+    uint32_t per_slab = (uint32_t)(slab_bytes / class_bytes);
+
+    bool huge = false;
+    uint8_t* base = (uint8_t*)zc_map_region(slab_bytes, &huge);
+    if (!base) return NULL;
+    bool pinned = zc_pin_region(base, slab_bytes);
+
+    retryix_zc_pool_entry_t* kept = NULL;
+    uint32_t carved = 0;
+
+    zc_lock();
+    for (uint32_t i = 0; i < per_slab; i++) {
+        retryix_zc_pool_entry_t* e = zc_new_entry_locked();
+        if (!e) break;
+        e->capacity = class_bytes;
+        e->size_class = size_class;
+        e->huge_backed = huge;
+        e->pinned = pinned;
+        e->desc.buffer = base + (size_t)i * class_bytes;
+        e->desc.size = class_bytes;
+        e->desc.owns_buffer = true;
+        zc_assign_keys(e);
+        carved++;
+        if (keep_one && !kept) kept = e;
+        else zc_stack_push(&g_free_heads[size_class], e);
+    }
+    zc_unlock();
+
+    if (carved == 0) {
+        if (pinned) RX_ADD64(&g_bytes_pinned, -(int64_t)slab_bytes);
+        zc_unmap_region(base, slab_bytes);
+        return NULL;
+    }
+    // 描述符耗盡時剩餘部分不再使用, 但仍計入保留量 (slab 不可部分釋放)
+    RX_ADD64(&g_bytes_reserved, (int64_t)slab_bytes);
+    if (huge) RX_ADD64(&g_bytes_huge, (int64_t)slab_bytes);
+    RX_ADD64(&g_slab_refills, 1);
+    RX_ADD64(&g_registrations, (int64_t)carved);
+    return kept;
+}
+
+// === 線程結束時把快取歸還全域堆疊 ===
+static void zc_tls_flush(void* arg) {
+    zc_tls_cache_t* cache = (zc_tls_cache_t*)arg;
+    if (!cache) return;
+    for (int c = 0; c < RETRYIX_ZC_POOL_CLASS_COUNT; c++) {
+        while (cache->count[c] > 0) {
+            uint32_t index = cache->slots[c][--cache->count[c]];
+            zc_stack_push(&g_free_heads[c], zc_entry(index));
+        }
+    }
+}
+
+#ifdef _WIN32
+static VOID WINAPI zc_fls_callback(PVOID data) { zc_tls_flush(data); }
+
+static BOOL CALLBACK zc_fls_init(PINIT_ONCE once, PVOID param, PVOID* ctx) {
+    (void)once; (void)param; (void)ctx;
+    g_fls_index = FlsAlloc(zc_fls_callback);
+    return TRUE;
+}
+#else
+static void zc_tls_key_init(void) {
+    pthread_key_create(&g_tls_key, zc_tls_flush);
+}
+#endif
+
+static void zc_tls_install_exit_hook(void) {
+    t_cache.exit_hook_installed = true;
+#ifdef _WIN32
+    InitOnceExecuteOnce(&g_fls_once, zc_fls_init, NULL, NULL);
+    if (g_fls_index != FLS_OUT_OF_INDEXES) FlsSetValue(g_fls_index, &t_cache);
+#else
+    pthread_once(&g_tls_once, zc_tls_key_init);
+    pthread_setspecific(g_tls_key, &t_cache);
+#endif
+}
+
+// === 獨立映射 (超過最大級別) ===
+static retryix_zerocopy_result_t zc_acquire_large(size_t size, retryix_net_buffer_t** out) {
+    size_t bytes = zc_round_up(size, RETRYIX_ZC_POOL_SLAB_BYTES);
+    bool huge = false;
+    void* p = zc_map_region(bytes, &huge);
+    if (!p) return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+
+    retryix_zc_pool_entry_t* e = zc_get_spare_entry();
+    if (!e) {
+        zc_unmap_region(p, bytes);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    e->capacity = bytes;
+    e->size_class = RETRYIX_ZC_CLASS_LARGE;
+    e->huge_backed = huge;
+    e->pinned = zc_pin_region(p, bytes);
+    e->desc.buffer = p;
+    e->desc.size = size;
+    e->desc.owns_buffer = true;
+    zc_assign_keys(e);
+    RX_STORE32(&e->in_use, 1);
+
+    RX_ADD64(&g_bytes_reserved, (int64_t)bytes);
+    if (huge) RX_ADD64(&g_bytes_huge, (int64_t)bytes);
+    RX_ADD64(&g_registrations, 1);
+    *out = &e->desc;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+// === 內部 API ===
+
+retryix_zerocopy_result_t retryix_zc_pool_acquire(size_t size, retryix_net_buffer_t** out) {
+    if (size == 0 || !out) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    int c = zc_class_for(size);
+    if (c == RETRYIX_ZC_CLASS_LARGE) return zc_acquire_large(size, out);
+
+    if (!t_cache.exit_hook_installed) zc_tls_install_exit_hook();
+
+    retryix_zc_pool_entry_t* e = NULL;
+    if (t_cache.count[c] > 0) {
+        e = zc_entry(t_cache.slots[c][--t_cache.count[c]]);
+    } else {
+        // 批次補充快取, 減少對全域堆疊的 CAS 次數
+        e = zc_stack_pop(&g_free_heads[c]);
+        while (e && t_cache.count[c] < ZC_TLS_DEPTH / 2) {
+            retryix_zc_pool_entry_t* extra = zc_stack_pop(&g_free_heads[c]);
+            if (!extra) break;
+            t_cache.slots[c][t_cache.count[c]++] = extra->index;
+        }
+        if (!e) e = zc_carve_slab(c, true);
+        if (!e) return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+
+    e->desc.size = size;
+    RX_STORE32(&e->in_use, 1);
+    *out = &e->desc;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+static retryix_zc_pool_entry_t* zc_entry_from_desc(const retryix_net_buffer_t* desc) {
+    if (!desc || desc->lkey == 0) return NULL;
+    retryix_zc_pool_entry_t* e = retryix_zc_pool_lookup_lkey(desc->lkey);
+    if (!e || &e->desc != desc || !e->in_use) return NULL;
+    return e;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_release(retryix_net_buffer_t* desc) {
+    retryix_zc_pool_entry_t* e = zc_entry_from_desc(desc);
+    if (!e || e->size_class == RETRYIX_ZC_CLASS_EXTERNAL) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    zc_revoke_remote(e);
+    RX_STORE32(&e->in_use, 0);
+
+    if (e->size_class == RETRYIX_ZC_CLASS_LARGE) {
+        zc_unmap_region(e->desc.buffer, e->capacity);
+        RX_ADD64(&g_bytes_reserved, -(int64_t)e->capacity);
+        if (e->huge_backed) RX_ADD64(&g_bytes_huge, -(int64_t)e->capacity);
+        if (e->pinned) RX_ADD64(&g_bytes_pinned, -(int64_t)e->capacity);
+        memset(&e->desc, 0, sizeof(e->desc));
+        zc_stack_push(&g_free_heads[ZC_SPARE_LIST], e);
+        return RETRYIX_ZC_SUCCESS;
+    }
+
+    // 池內緩衝區: 鍵值與註冊保留, 只回到快取
+    // (只釋放不取得的線程也要掛上結束鉤子, 否則結束時快取內的緩衝區不會歸還)
+    if (!t_cache.exit_hook_installed) zc_tls_install_exit_hook();
+    int c = e->size_class;
+    e->desc.size = e->capacity;
+    if (t_cache.count[c] == ZC_TLS_DEPTH) {
+        while (t_cache.count[c] > ZC_TLS_DEPTH / 2) {
+            uint32_t index = t_cache.slots[c][--t_cache.count[c]];
+            zc_stack_push(&g_free_heads[c], zc_entry(index));
+        }
+    }
+    t_cache.slots[c][t_cache.count[c]++] = e->index;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_register_external(void* buffer, size_t size, retryix_net_buffer_t** out) {
+    if (!buffer || size == 0 || !out) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    retryix_zc_pool_entry_t* e = zc_get_spare_entry();
+    if (!e) return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+
+    e->capacity = size;
+    e->size_class = RETRYIX_ZC_CLASS_EXTERNAL;
+    e->huge_backed = false;
+    e->pinned = false;
+    e->desc.buffer = buffer;
+    e->desc.size = size;
+    e->desc.owns_buffer = false;
+    zc_assign_keys(e);
+    RX_STORE32(&e->in_use, 1);
+    RX_ADD64(&g_registrations, 1);
+    *out = &e->desc;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_unregister_external(retryix_net_buffer_t* desc) {
+    retryix_zc_pool_entry_t* e = zc_entry_from_desc(desc);
+    if (!e || e->size_class != RETRYIX_ZC_CLASS_EXTERNAL) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    zc_revoke_remote(e);
+    RX_STORE32(&e->in_use, 0);
+    memset(&e->desc, 0, sizeof(e->desc));
+    zc_stack_push(&g_free_heads[ZC_SPARE_LIST], e);
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_prewarm(size_t buffer_size, uint32_t count) {
+    if (buffer_size == 0 || count == 0) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    int c = zc_class_for(buffer_size);
+    if (c == RETRYIX_ZC_CLASS_LARGE) return RETRYIX_ZC_ERROR_BUFFER_TOO_SMALL;
+
+    size_t class_bytes = k_class_bytes[c];
+    size_t slab_bytes = class_bytes * 2 > RETRYIX_ZC_POOL_SLAB_BYTES ? class_bytes * 2 : RETRYIX_ZC_POOL_SLAB_BYTES;
+    uint32_t per_slab = (uint32_t)(slab_bytes / class_bytes);
+    uint32_t slabs = (count + per_slab - 1) / per_slab;
+
+    for (uint32_t i = 0; i < slabs; i++) {
+        int64_t before = RX_ADD64(&g_slab_refills, 0);
+        zc_carve_slab(c, false);
+        if (RX_ADD64(&g_slab_refills, 0) == before) return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    return RETRYIX_ZC_SUCCESS;
+}
+
+void retryix_zc_pool_get_stats(retryix_zc_pool_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    uint32_t count = zc_entry_count();
+    for (uint32_t i = 0; i < count; i++) {
+        retryix_zc_pool_entry_t* e = zc_entry(i);
+        if (e->size_class >= 0) stats->pooled_buffers++;
+        if (e->in_use) {
+            stats->buffers_in_use++;
+            if (e->size_class != RETRYIX_ZC_CLASS_EXTERNAL) stats->bytes_in_use += e->capacity;
+        }
+    }
+    stats->bytes_reserved = (uint64_t)RX_ADD64(&g_bytes_reserved, 0);
+    stats->bytes_huge = (uint64_t)RX_ADD64(&g_bytes_huge, 0);
+    stats->bytes_pinned = (uint64_t)RX_ADD64(&g_bytes_pinned, 0);
+    stats->slab_refills = (uint64_t)RX_ADD64(&g_slab_refills, 0);
+    stats->registrations = (uint64_t)RX_ADD64(&g_registrations, 0);
+}
+
+// === 鍵值查詢 ===
+
+retryix_zc_pool_entry_t* retryix_zc_pool_lookup_lkey(uint32_t lkey) {
+    if (lkey == 0 || lkey > zc_entry_count()) return NULL;
+    return zc_entry(lkey - 1);
+}
+
+retryix_zc_pool_entry_t* retryix_zc_pool_lookup_rkey(uint32_t rkey) {
+    uint32_t raw = rkey ^ g_key_salt;
+    uint32_t lkey = raw & 0xFFFFFFu;
+    retryix_zc_pool_entry_t* e = retryix_zc_pool_lookup_lkey(lkey);
+    if (!e || !e->in_use || e->desc.rkey != rkey) return NULL;
+    return e;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_resolve(uint32_t rkey, uint64_t addr, size_t size, void** local_ptr) {
+    retryix_zc_pool_entry_t* e = retryix_zc_pool_lookup_rkey(rkey);
+    if (!e || !local_ptr) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    uint64_t base = (uint64_t)(uintptr_t)e->desc.buffer;
+    if (addr < base || size > e->desc.size || addr - base > e->desc.size - size) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+    *local_ptr = (void*)(uintptr_t)addr;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+// === 遠端存取授權 ===
+// 描述符的 rkey 可由索引推算, 只適合本機; 遠端請求改查這張表: 每次授權一把 32 位元系統亂數鍵,
+// 以鍵值開放定址 (線性探測, 刪除時回移), 只有明確授權且尚未撤銷的緩衝區可被遠端存取
+
+#define ZC_GRANT_SLOTS (RETRYIX_ZC_REMOTE_MAX_GRANTS * 2)
+
+typedef struct {
+    uint32_t rkey;                        ///< 0 = 空槽
+    uint32_t lkey;
+} zc_grant_t;
+
+static zc_grant_t g_grants[ZC_GRANT_SLOTS];
+static uint32_t g_grant_count = 0;
+static ZC_MUTEX g_grant_lock = ZC_MUTEX_INITIALIZER;
+
+static bool zc_random_u32(uint32_t* out) {
+#ifdef _WIN32
+    unsigned int v;
+    if (rand_s(&v) != 0) return false;
+    *out = (uint32_t)v;
+    return true;
+#else
+    for (;;) {
+        ssize_t n = getrandom(out, sizeof(*out), 0);
+        if (n == (ssize_t)sizeof(*out)) return true;
+        if (n < 0 && errno == EINTR) continue;
+        break;
+    }
+    // 舊核心沒有 getrandom
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = read(fd, out, sizeof(*out)) == (ssize_t)sizeof(*out);
+    close(fd);
+    return ok;
+#endif
+}
+
+// 需持有 g_grant_lock; 找不到時回傳 -1
+static int zc_grant_find_locked(uint32_t rkey) {
+    if (rkey == 0) return -1;
+    for (uint32_t i = rkey & (ZC_GRANT_SLOTS - 1);; i = (i + 1) & (ZC_GRANT_SLOTS - 1)) {
+        if (g_grants[i].rkey == 0) return -1;
+        if (g_grants[i].rkey == rkey) return (int)i;
+    }
+}
+
+// 需持有 g_grant_lock; 刪除後把同一探測鏈上的後續項目往回移, 查詢不需墓碑
+static void zc_grant_remove_locked(uint32_t slot) {
+    g_grants[slot].rkey = 0;
+    g_grant_count--;
+    for (uint32_t i = (slot + 1) & (ZC_GRANT_SLOTS - 1); g_grants[i].rkey != 0; i = (i + 1) & (ZC_GRANT_SLOTS - 1)) {
+        uint32_t home = g_grants[i].rkey & (ZC_GRANT_SLOTS - 1);
+        // home 不在 (slot, i] 之間時, 這一項可以填回空出的位置
+        bool movable = (slot <= i) ? (home <= slot || home > i) : (home <= slot && home > i);
+        if (!movable) continue;
+        g_grants[slot] = g_grants[i];
+        g_grants[i].rkey = 0;
+        slot = i;
+    }
+}
+
+static void zc_revoke_remote(retryix_zc_pool_entry_t* e) {
+    ZC_MUTEX_LOCK(&g_grant_lock);
+    int slot = zc_grant_find_locked(e->remote_rkey);
+    if (slot >= 0) zc_grant_remove_locked((uint32_t)slot);
+    e->remote_rkey = 0;
+    ZC_MUTEX_UNLOCK(&g_grant_lock);
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_grant_remote(retryix_net_buffer_t* desc, uint32_t* rkey) {
+    retryix_zc_pool_entry_t* e = zc_entry_from_desc(desc);
+    if (!e || !rkey) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    ZC_MUTEX_LOCK(&g_grant_lock);
+    int old = zc_grant_find_locked(e->remote_rkey);
+    if (old >= 0) zc_grant_remove_locked((uint32_t)old);
+    e->remote_rkey = 0;
+    if (g_grant_count >= RETRYIX_ZC_REMOTE_MAX_GRANTS) {
+        ZC_MUTEX_UNLOCK(&g_grant_lock);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    uint32_t key = 0;
+    while (key == 0 || zc_grant_find_locked(key) >= 0) {
+        if (!zc_random_u32(&key)) {
+            ZC_MUTEX_UNLOCK(&g_grant_lock);
+            return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
+        }
+    }
+    uint32_t i = key & (ZC_GRANT_SLOTS - 1);
+    while (g_grants[i].rkey != 0) i = (i + 1) & (ZC_GRANT_SLOTS - 1);
+    g_grants[i].rkey = key;
+    g_grants[i].lkey = e->desc.lkey;
+    g_grant_count++;
+    e->remote_rkey = key;
+    ZC_MUTEX_UNLOCK(&g_grant_lock);
+
+    *rkey = key;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_revoke_remote(retryix_net_buffer_t* desc) {
+    retryix_zc_pool_entry_t* e = zc_entry_from_desc(desc);
+    if (!e) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    zc_revoke_remote(e);
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_pool_resolve_remote(uint32_t rkey, uint64_t addr, size_t size, void** local_ptr) {
+    if (!local_ptr) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    retryix_zerocopy_result_t rc = RETRYIX_ZC_ERROR_INVALID_PARAM;
+    ZC_MUTEX_LOCK(&g_grant_lock);
+    int slot = zc_grant_find_locked(rkey);
+    retryix_zc_pool_entry_t* e = (slot >= 0) ? retryix_zc_pool_lookup_lkey(g_grants[slot].lkey) : NULL;
+    if (e && e->in_use && e->remote_rkey == rkey) {
+        uint64_t base = (uint64_t)(uintptr_t)e->desc.buffer;
+        if (addr >= base && size <= e->desc.size && addr - base <= e->desc.size - size) {
+            *local_ptr = (void*)(uintptr_t)addr;
+            rc = RETRYIX_ZC_SUCCESS;
+        }
+    }
+    ZC_MUTEX_UNLOCK(&g_grant_lock);
+    return rc;
+}
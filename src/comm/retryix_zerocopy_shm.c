@@ -0,0 +1,542 @@
+// retryix_zerocopy_shm.c - 本機共享記憶體傳輸 (RDMA 替身)
+// 目標進程以 memfd 建立區域並登記於具名導出目錄, 發起進程依 (pid, rkey, 遠端位址)
+// 映射同一批實體頁後直接讀寫, 語義與 RDMA 單邊 READ/WRITE 相同
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_zerocopy_internal.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+#define ZC_SHM_MAGIC    0x5A43534Du   // "ZCSM"
+#define ZC_SHM_VERSION  1
+
+// === 導出目錄 (位於具名共享記憶體, 由擁有者寫入, 對端唯讀) ===
+typedef struct {
+    volatile uint32_t rkey;      ///< 0 = 空槽; 最後寫入, 最先清除
+    int32_t fd;                  ///< 擁有者進程內的 memfd (Linux)
+    uint64_t base;               ///< 擁有者進程內的虛擬位址
+    uint64_t size;
+} zc_shm_dir_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t owner_pid;
+    volatile uint32_t high_water;
+    zc_shm_dir_entry_t regions[RETRYIX_ZC_SHM_MAX_REGIONS];
+} zc_shm_dir_t;
+
+// === 本進程導出的區域 ===
+typedef struct {
+    retryix_net_buffer_t* desc;
+    void* map;
+    size_t size;
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    int fd;
+#endif
+} zc_shm_local_t;
+
+// === 對端映射 ===
+typedef struct zc_shm_retired {
+    void* map;
+    size_t size;
+    struct zc_shm_retired* next;
+} zc_shm_retired_t;
+
+typedef struct {
+    volatile uint32_t rkey;      ///< 與目錄槽位的 rkey 相同時 local 有效
+    uint8_t* local;
+    uint64_t size;
+} zc_shm_map_t;
+
+typedef struct {
+    int32_t pid;                 ///< 0 = 空槽
+    zc_shm_dir_t* dir;
+#ifdef _WIN32
+    HANDLE dir_handle;
+#endif
+    zc_shm_map_t maps[RETRYIX_ZC_SHM_MAX_REGIONS];
+    zc_shm_retired_t* retired;   ///< 槽位重用後的舊映射, 斷線時才解除 (讀寫中的線程可能仍持有)
+} zc_shm_peer_t;
+
+static ZC_MUTEX g_shm_lock = ZC_MUTEX_INITIALIZER;
+static zc_shm_dir_t* g_dir = NULL;
+#ifdef _WIN32
+static HANDLE g_dir_handle = NULL;
+#else
+static char g_dir_name[64];
+#endif
+static zc_shm_local_t g_local[RETRYIX_ZC_SHM_MAX_REGIONS];
+static zc_shm_peer_t g_peers[RETRYIX_ZC_SHM_MAX_PEERS];
+
+static int32_t zc_self_pid(void) {
+#ifdef _WIN32
+    return (int32_t)GetCurrentProcessId();
+#else
+    return (int32_t)getpid();
+#endif
+}
+
+static void zc_dir_name(int32_t pid, char* name, size_t len) {
+#ifdef _WIN32
+    snprintf(name, len, "Local\\retryix_zc_%d", (int)pid);
+#else
+    snprintf(name, len, "/retryix_zc_%d", (int)pid);
+#endif
+}
+
+#ifdef _WIN32
+static void zc_region_name(int32_t pid, uint32_t slot, uint32_t rkey, char* name, size_t len) {
+    snprintf(name, len, "Local\\retryix_zc_%d_%u_%08x", (int)pid, slot, rkey);
+}
+#endif
+
+// === 平台映射 ===
+static void* zc_shm_map_object(size_t size,
+#ifdef _WIN32
+                               HANDLE handle
+#else
+                               int fd
+#endif
+                               ) {
+#ifdef _WIN32
+    return MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+#else
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return (p == MAP_FAILED) ? NULL : p;
+#endif
+}
+
+static void zc_shm_unmap(void* p, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(p);
+#else
+    munmap(p, size);
+#endif
+}
+
+// 建立本進程的導出目錄 (需持有 g_shm_lock)
+static bool zc_ensure_directory_locked(void) {
+    if (g_dir) return true;
+
+    char name[64];
+    zc_dir_name(zc_self_pid(), name, sizeof(name));
+#ifdef _WIN32
+    g_dir_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                      0, (DWORD)sizeof(zc_shm_dir_t), name);
+    if (!g_dir_handle) return false;
+    g_dir = (zc_shm_dir_t*)zc_shm_map_object(sizeof(zc_shm_dir_t), g_dir_handle);
+    if (!g_dir) {
+        CloseHandle(g_dir_handle);
+        g_dir_handle = NULL;
+        return false;
+    }
+#else
+    // 同 pid 的殘留目錄只可能來自已結束的舊進程
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)sizeof(zc_shm_dir_t)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    g_dir = (zc_shm_dir_t*)zc_shm_map_object(sizeof(zc_shm_dir_t), fd);
+    close(fd);
+    if (!g_dir) {
+        shm_unlink(name);
+        return false;
+    }
+    snprintf(g_dir_name, sizeof(g_dir_name), "%s", name);
+#endif
+    memset(g_dir, 0, sizeof(*g_dir));
+    g_dir->version = ZC_SHM_VERSION;
+    g_dir->owner_pid = zc_self_pid();
+    RX_FENCE();
+    g_dir->magic = ZC_SHM_MAGIC;
+    return true;
+}
+
+// === 目標端: 區域導出 ===
+
+retryix_zerocopy_result_t retryix_zc_shm_create_region(size_t size, retryix_net_buffer_t** out) {
+    if (size == 0 || !out) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    ZC_MUTEX_LOCK(&g_shm_lock);
+    if (!zc_ensure_directory_locked()) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_NO_DEVICE;
+    }
+
+    uint32_t slot = 0;
+    while (slot < RETRYIX_ZC_SHM_MAX_REGIONS && g_local[slot].desc) slot++;
+    if (slot == RETRYIX_ZC_SHM_MAX_REGIONS) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+
+    zc_shm_local_t* region = &g_local[slot];
+    retryix_net_buffer_t* desc = NULL;
+    retryix_zerocopy_result_t rc = RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+
+#ifdef _WIN32
+    // 名稱含 rkey, 需先配發鍵值; 以佔位位址註冊後再更新
+    static char placeholder;
+    rc = retryix_zc_pool_register_external(&placeholder, 1, &desc);
+    if (rc != RETRYIX_ZC_SUCCESS) goto fail;
+    char name[96];
+    zc_region_name(zc_self_pid(), slot, desc->rkey, name, sizeof(name));
+    region->handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                        (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFFu), name);
+    if (!region->handle) goto fail_unregister;
+    region->map = zc_shm_map_object(size, region->handle);
+    if (!region->map) {
+        CloseHandle(region->handle);
+        goto fail_unregister;
+    }
+    desc->buffer = region->map;
+    desc->size = size;
+    retryix_zc_pool_lookup_lkey(desc->lkey)->capacity = size;
+#else
+    int fd = -1;
+#ifdef SYS_memfd_create
+    fd = (int)syscall(SYS_memfd_create, "retryix_zc", 0u);
+#endif
+    if (fd < 0) {
+        // 舊核心: 具名物件建立後立即取消連結, 只經由 /proc/<pid>/fd 存取
+        char name[64];
+        snprintf(name, sizeof(name), "/retryix_zc_%d_%u", (int)zc_self_pid(), slot);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0) shm_unlink(name);
+    }
+    if (fd < 0) goto fail;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        goto fail;
+    }
+    region->map = zc_shm_map_object(size, fd);
+    if (!region->map) {
+        close(fd);
+        goto fail;
+    }
+    region->fd = fd;
+    rc = retryix_zc_pool_register_external(region->map, size, &desc);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        zc_shm_unmap(region->map, size);
+        close(fd);
+        goto fail;
+    }
+#endif
+
+    desc->owns_buffer = true;
+    region->desc = desc;
+    region->size = size;
+
+    // 發佈: 先寫內容, 最後寫 rkey
+    zc_shm_dir_entry_t* entry = &g_dir->regions[slot];
+#ifdef _WIN32
+    entry->fd = -1;
+#else
+    entry->fd = region->fd;
+#endif
+    entry->base = (uint64_t)(uintptr_t)desc->buffer;
+    entry->size = size;
+    RX_FENCE();
+    entry->rkey = desc->rkey;
+    if (slot + 1 > g_dir->high_water) g_dir->high_water = slot + 1;
+
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+    *out = desc;
+    return RETRYIX_ZC_SUCCESS;
+
+#ifdef _WIN32
+fail_unregister:
+    retryix_zc_pool_unregister_external(desc);
+    rc = RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+#endif
+fail:
+    memset(region, 0, sizeof(*region));
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+    return rc;
+}
+
+static int zc_local_slot_of(const retryix_net_buffer_t* desc) {
+    for (int i = 0; i < RETRYIX_ZC_SHM_MAX_REGIONS; i++) {
+        if (g_local[i].desc == desc) return i;
+    }
+    return -1;
+}
+
+bool retryix_zc_shm_owns(const retryix_net_buffer_t* desc) {
+    if (!desc) return false;
+    ZC_MUTEX_LOCK(&g_shm_lock);
+    bool owned = zc_local_slot_of(desc) >= 0;
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+    return owned;
+}
+
+retryix_zerocopy_result_t retryix_zc_shm_destroy_region(retryix_net_buffer_t* desc) {
+    ZC_MUTEX_LOCK(&g_shm_lock);
+    int slot = desc ? zc_local_slot_of(desc) : -1;
+    if (slot < 0) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    // 先撤銷目錄項, 新的對端存取立即失敗; 已建立的對端映射仍指向同一批頁, 不會失效
+    g_dir->regions[slot].rkey = 0;
+    RX_FENCE();
+
+    zc_shm_local_t* region = &g_local[slot];
+    retryix_zc_pool_unregister_external(region->desc);
+    zc_shm_unmap(region->map, region->size);
+#ifdef _WIN32
+    CloseHandle(region->handle);
+#else
+    close(region->fd);
+#endif
+    memset(region, 0, sizeof(*region));
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+    return RETRYIX_ZC_SUCCESS;
+}
+
+void retryix_zc_shm_shutdown(void) {
+    ZC_MUTEX_LOCK(&g_shm_lock);
+#ifndef _WIN32
+    // 只移除名稱; 目錄本身仍映射, 區域照常服務已連線的對端
+    if (g_dir_name[0]) {
+        shm_unlink(g_dir_name);
+        g_dir_name[0] = '\0';
+    }
+#endif
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+}
+
+// === 發起端: 連線與位址解析 ===
+
+static bool zc_pid_alive(int32_t pid) {
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)pid);
+    if (!process) return false;
+    bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return alive;
+#else
+    return kill(pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+static zc_shm_peer_t* zc_peer_of(const retryix_net_connection_t* connection) {
+    if (!connection || connection->protocol != RETRYIX_NET_PROTO_SHM) return NULL;
+    uint32_t slot = connection->qp_num;
+    if (slot == 0 || slot > RETRYIX_ZC_SHM_MAX_PEERS) return NULL;
+    zc_shm_peer_t* peer = &g_peers[slot - 1];
+    return (peer->pid != 0 && (uint32_t)peer->pid == connection->psn) ? peer : NULL;
+}
+
+retryix_zerocopy_result_t retryix_zc_shm_connect(int32_t peer_pid, retryix_net_connection_t* connection) {
+    if (peer_pid <= 0 || !connection) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    if (!zc_pid_alive(peer_pid)) return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+
+    char name[64];
+    zc_dir_name(peer_pid, name, sizeof(name));
+
+    ZC_MUTEX_LOCK(&g_shm_lock);
+    uint32_t slot = 0;
+    while (slot < RETRYIX_ZC_SHM_MAX_PEERS && g_peers[slot].pid != 0) slot++;
+    if (slot == RETRYIX_ZC_SHM_MAX_PEERS) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_DEVICE_BUSY;
+    }
+    zc_shm_peer_t* peer = &g_peers[slot];
+
+#ifdef _WIN32
+    peer->dir_handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (!peer->dir_handle) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+    peer->dir = (zc_shm_dir_t*)MapViewOfFile(peer->dir_handle, FILE_MAP_READ, 0, 0, sizeof(zc_shm_dir_t));
+    if (!peer->dir) {
+        CloseHandle(peer->dir_handle);
+        peer->dir_handle = NULL;
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+#else
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+    void* p = mmap(NULL, sizeof(zc_shm_dir_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+    peer->dir = (zc_shm_dir_t*)p;
+#endif
+
+    if (peer->dir->magic != ZC_SHM_MAGIC || peer->dir->version != ZC_SHM_VERSION ||
+        peer->dir->owner_pid != peer_pid) {
+        zc_shm_unmap(peer->dir, sizeof(zc_shm_dir_t));
+#ifdef _WIN32
+        CloseHandle(peer->dir_handle);
+#endif
+        memset(peer, 0, sizeof(*peer));
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+    peer->pid = peer_pid;
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+
+    memset(connection, 0, sizeof(*connection));
+    snprintf(connection->remote_ip, sizeof(connection->remote_ip), "shm:%d", (int)peer_pid);
+    snprintf(connection->local_ip, sizeof(connection->local_ip), "shm:%d", (int)zc_self_pid());
+    connection->protocol = RETRYIX_NET_PROTO_SHM;
+    connection->qp_num = slot + 1;
+    connection->psn = (uint32_t)peer_pid;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_shm_disconnect(retryix_net_connection_t* connection) {
+    ZC_MUTEX_LOCK(&g_shm_lock);
+    zc_shm_peer_t* peer = zc_peer_of(connection);
+    if (!peer) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < RETRYIX_ZC_SHM_MAX_REGIONS; i++) {
+        if (peer->maps[i].local) zc_shm_unmap(peer->maps[i].local, (size_t)peer->maps[i].size);
+    }
+    while (peer->retired) {
+        zc_shm_retired_t* next = peer->retired->next;
+        zc_shm_unmap(peer->retired->map, peer->retired->size);
+        free(peer->retired);
+        peer->retired = next;
+    }
+    zc_shm_unmap(peer->dir, sizeof(zc_shm_dir_t));
+#ifdef _WIN32
+    CloseHandle(peer->dir_handle);
+#endif
+    memset(peer, 0, sizeof(*peer));
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+
+    connection->qp_num = 0;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+bool retryix_zc_shm_peer_alive(const retryix_net_connection_t* connection) {
+    zc_shm_peer_t* peer = zc_peer_of(connection);
+    return peer && zc_pid_alive(peer->pid);
+}
+
+// 映射對端的某個區域 (慢路徑, 每個 rkey 只發生一次)
+static retryix_zerocopy_result_t zc_map_peer_region(zc_shm_peer_t* peer, uint32_t slot, uint32_t rkey) {
+    ZC_MUTEX_LOCK(&g_shm_lock);
+    zc_shm_map_t* m = &peer->maps[slot];
+    if (m->rkey == rkey && m->local) {
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_SUCCESS;
+    }
+
+    const zc_shm_dir_entry_t* entry = &peer->dir->regions[slot];
+    uint64_t size = entry->size;
+    uint8_t* local = NULL;
+#ifdef _WIN32
+    char name[96];
+    zc_region_name(peer->pid, slot, rkey, name, sizeof(name));
+    HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (handle) {
+        local = (uint8_t*)MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)size);
+        CloseHandle(handle);  // 視圖保持映射物件存活
+    }
+#else
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/fd/%d", (int)peer->pid, (int)entry->fd);
+    int fd = open(path, O_RDWR);
+    if (fd >= 0) {
+        local = (uint8_t*)zc_shm_map_object((size_t)size, fd);
+        close(fd);
+    }
+#endif
+    // 映射期間擁有者可能已撤銷或重用此槽位
+    if (!local || entry->rkey != rkey) {
+        if (local) zc_shm_unmap(local, (size_t)size);
+        ZC_MUTEX_UNLOCK(&g_shm_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+
+    if (m->local) {
+        zc_shm_retired_t* old = (zc_shm_retired_t*)malloc(sizeof(zc_shm_retired_t));
+        if (old) {
+            old->map = m->local;
+            old->size = (size_t)m->size;
+            old->next = peer->retired;
+            peer->retired = old;
+        }
+    }
+    m->rkey = 0;
+    RX_FENCE();
+    m->local = local;
+    m->size = size;
+    RX_FENCE();
+    m->rkey = rkey;
+    ZC_MUTEX_UNLOCK(&g_shm_lock);
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_shm_resolve(const retryix_net_connection_t* connection, uint32_t rkey,
+                                                 uint64_t addr, size_t size, void** local_ptr) {
+    zc_shm_peer_t* peer = zc_peer_of(connection);
+    if (!peer || !local_ptr || size == 0) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    const zc_shm_dir_t* dir = peer->dir;
+    uint32_t high_water = dir->high_water;
+    if (high_water > RETRYIX_ZC_SHM_MAX_REGIONS) high_water = RETRYIX_ZC_SHM_MAX_REGIONS;
+
+    for (uint32_t slot = 0; slot < high_water; slot++) {
+        const zc_shm_dir_entry_t* entry = &dir->regions[slot];
+        uint32_t entry_rkey = entry->rkey;
+        if (entry_rkey == 0 || (rkey != 0 && entry_rkey != rkey)) continue;
+        RX_FENCE();
+
+        uint64_t base = entry->base;
+        uint64_t region_size = entry->size;
+        if (addr < base || size > region_size || addr - base > region_size - size) {
+            if (rkey != 0) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+            continue;
+        }
+
+        // 自我連線: 直接使用本地位址
+        if (peer->pid == zc_self_pid()) {
+            *local_ptr = (void*)(uintptr_t)addr;
+            return RETRYIX_ZC_SUCCESS;
+        }
+
+        zc_shm_map_t* m = &peer->maps[slot];
+        if (m->rkey != entry_rkey) {
+            retryix_zerocopy_result_t rc = zc_map_peer_region(peer, slot, entry_rkey);
+            if (rc != RETRYIX_ZC_SUCCESS) return rc;
+        }
+        *local_ptr = m->local + (addr - base);
+        return RETRYIX_ZC_SUCCESS;
+    }
+    return RETRYIX_ZC_ERROR_INVALID_PARAM;
+}
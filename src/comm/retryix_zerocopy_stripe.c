@@ -0,0 +1,517 @@
+// retryix_zerocopy_stripe.c - 多路徑分條傳輸排程
+// 大傳輸切成 256 KB 分條, 每片送往「預估完成時間」最早的路徑 (依即時服務速率加權);
+// 小訊息與分條以 DRR 輪流出隊, 小訊息最多只需等待一個分條
+// 服務速率 = 已完成位元組 / 路徑忙碌時間, 與目前分到的流量多寡無關, 不會因權重低而越分越少
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_zerocopy_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define ZC_STRIPE_CHUNK        (256u << 10)  // 分條大小
+#define ZC_STRIPE_SMALL_LIMIT  (64u << 10)   // 小於此大小不分條, 走小訊息佇列
+#define ZC_STRIPE_QUANTUM      (256u << 10)  // DRR 每輪配額 (兩類相同, 頻寬各半)
+#define ZC_STRIPE_WINDOW_MIN   (1u << 20)    // 每路徑在途位元組下限
+#define ZC_STRIPE_QUEUE_NS     1000000.0     // 在途量以約 1 ms 的服務時間為限, 讓小訊息不被堵在傳輸層後面
+#define ZC_STRIPE_MAX_INFLIGHT 256           // 每路徑在途分條上限
+#define ZC_STRIPE_SAMPLE_NS    20000000ull   // 速率取樣的最短忙碌時間 (20 ms)
+#define ZC_STRIPE_DEFAULT_MBPS 1000.0        // 尚無量測時的初始估計
+
+enum { ZC_CLASS_SMALL = 0, ZC_CLASS_BULK = 1, ZC_CLASS_COUNT = 2 };
+
+typedef struct zc_stripe_parent {
+    uint64_t transfer_id;                 ///< 對外的 transfer_id
+    uint32_t remaining;                   ///< 尚未完成的分條數
+    bool failed;
+} zc_stripe_parent_t;
+
+typedef struct zc_stripe_item {
+    struct zc_stripe_item* next;
+    struct retryix_zc_path_group* group;
+    zc_stripe_parent_t* parent;
+    const uint8_t* source;
+    uint64_t remote_addr;
+    uint32_t size;
+    uint32_t rkey;
+    int path;                             ///< 送出後才決定
+} zc_stripe_item_t;
+
+typedef struct {
+    zc_stripe_item_t* head;
+    zc_stripe_item_t* tail;
+    uint32_t deficit;
+} zc_stripe_queue_t;
+
+typedef struct {
+    retryix_net_connection_t connection;
+    bool alive;
+    double bytes_per_ns;                  ///< 服務速率估計
+    uint64_t inflight_bytes;
+    uint32_t inflight_ops;
+    uint64_t bytes_completed;
+    uint32_t chunks_failed;
+    uint64_t last_tick_ns;
+    uint64_t busy_ns;                     ///< 本取樣窗內的忙碌時間
+    uint64_t window_bytes;                ///< 本取樣窗內完成的位元組
+} zc_stripe_path_t;
+
+struct retryix_zc_path_group {
+    ZC_MUTEX lock;
+    ZC_COND cond;
+    int num_paths;
+    zc_stripe_path_t paths[RETRYIX_ZC_MAX_PATHS];
+    zc_stripe_queue_t queues[ZC_CLASS_COUNT];
+    int turn;                             ///< DRR 目前服務的類別
+    uint32_t queued;
+    volatile uint32_t running;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    struct retryix_zc_path_group* live_prev;   ///< 存活群組串列, 受 g_groups_lock 保護
+    struct retryix_zc_path_group* live_next;
+};
+
+static ZC_MUTEX g_groups_lock = ZC_MUTEX_INITIALIZER;
+// 存活群組, 最新建立者在前; balance_net_load 的對象為串列首 (最近建立且尚未銷毀者)
+static retryix_zc_path_group_t* g_live_groups = NULL;
+
+static uint64_t zc_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// === 路徑速率 (需持有 group->lock) ===
+static void zc_path_tick(zc_stripe_path_t* p, uint64_t now) {
+    if (p->inflight_ops > 0) p->busy_ns += now - p->last_tick_ns;
+    p->last_tick_ns = now;
+    if (p->busy_ns >= ZC_STRIPE_SAMPLE_NS) {
+        double sample = (double)p->window_bytes / (double)p->busy_ns;
+        p->bytes_per_ns = 0.75 * p->bytes_per_ns + 0.25 * sample;
+        p->busy_ns = 0;
+        p->window_bytes = 0;
+    }
+}
+
+// 預估完成時間最早的可用路徑
+static int zc_pick_path_locked(retryix_zc_path_group_t* g, uint32_t size) {
+    int best = -1;
+    double best_ns = 0.0;
+    for (int i = 0; i < g->num_paths; i++) {
+        zc_stripe_path_t* p = &g->paths[i];
+        if (!p->alive || p->inflight_ops >= ZC_STRIPE_MAX_INFLIGHT) continue;
+        double window = p->bytes_per_ns * ZC_STRIPE_QUEUE_NS;
+        if (window < ZC_STRIPE_WINDOW_MIN) window = ZC_STRIPE_WINDOW_MIN;
+        if (p->inflight_ops > 0 && (double)(p->inflight_bytes + size) > window) continue;
+        double finish_ns = (double)(p->inflight_bytes + size) / p->bytes_per_ns;
+        if (best < 0 || finish_ns < best_ns) {
+            best = i;
+            best_ns = finish_ns;
+        }
+    }
+    return best;
+}
+
+// === DRR 佇列 (需持有 group->lock) ===
+static void zc_queue_push(zc_stripe_queue_t* q, zc_stripe_item_t* item) {
+    item->next = NULL;
+    if (q->tail) q->tail->next = item; else q->head = item;
+    q->tail = item;
+}
+
+static void zc_queue_push_front(zc_stripe_queue_t* q, zc_stripe_item_t* item) {
+    item->next = q->head;
+    q->head = item;
+    if (!q->tail) q->tail = item;
+}
+
+static zc_stripe_item_t* zc_drr_peek_locked(retryix_zc_path_group_t* g) {
+    // 配額不小於最大項目, 兩類各補一次配額後必有一項可出隊
+    for (int guard = 0; guard < 2 * ZC_CLASS_COUNT + 1; guard++) {
+        zc_stripe_queue_t* q = &g->queues[g->turn];
+        if (q->head && q->head->size <= q->deficit) return q->head;
+        if (!q->head) q->deficit = 0;
+        g->turn = (g->turn + 1) % ZC_CLASS_COUNT;
+        if (g->queues[g->turn].head) g->queues[g->turn].deficit += ZC_STRIPE_QUANTUM;
+    }
+    return NULL;
+}
+
+static void zc_drr_pop_locked(retryix_zc_path_group_t* g) {
+    zc_stripe_queue_t* q = &g->queues[g->turn];
+    zc_stripe_item_t* item = q->head;
+    q->head = item->next;
+    if (!q->head) {
+        q->tail = NULL;
+        q->deficit = 0;
+    } else {
+        q->deficit -= item->size;
+    }
+    g->queued--;
+}
+
+// === 完成處理 ===
+static void zc_parent_settle_locked(zc_stripe_parent_t* parent, bool ok) {
+    if (!ok) parent->failed = true;
+    if (--parent->remaining == 0) {
+        retryix_zc_transfer_finish(parent->transfer_id, parent->failed ? RETRYIX_DMA_ERROR : RETRYIX_DMA_COMPLETED);
+        free(parent);
+    }
+}
+
+// 由傳輸層回呼 (可能持有連線鎖): 只更新統計並喚醒排程線程
+static void zc_chunk_done(void* ctx, uint64_t transfer_id, retryix_dma_status_t status) {
+    (void)transfer_id;
+    zc_stripe_item_t* item = (zc_stripe_item_t*)ctx;
+    retryix_zc_path_group_t* g = item->group;
+    bool ok = status == RETRYIX_DMA_COMPLETED;
+
+    ZC_MUTEX_LOCK(&g->lock);
+    zc_stripe_path_t* p = &g->paths[item->path];
+    zc_path_tick(p, zc_now_ns());
+    p->inflight_bytes -= item->size;
+    p->inflight_ops--;
+    if (ok) {
+        p->bytes_completed += item->size;
+        p->window_bytes += item->size;
+    } else {
+        p->chunks_failed++;
+    }
+    zc_parent_settle_locked(item->parent, ok);
+    ZC_COND_BROADCAST(&g->cond);
+    ZC_MUTEX_UNLOCK(&g->lock);
+    free(item);
+}
+
+// === 排程線程 ===
+static void zc_stripe_loop(retryix_zc_path_group_t* g) {
+    ZC_MUTEX_LOCK(&g->lock);
+    while (RX_LOAD32(&g->running)) {
+        zc_stripe_item_t* item = g->queued ? zc_drr_peek_locked(g) : NULL;
+        int path = item ? zc_pick_path_locked(g, item->size) : -1;
+        if (!item || path < 0) {
+            // 沒有工作或所有路徑的窗口已滿: 等待完成回呼
+            ZC_COND_WAIT_MS(&g->cond, &g->lock, 50);
+            continue;
+        }
+        zc_drr_pop_locked(g);
+
+        zc_stripe_path_t* p = &g->paths[path];
+        zc_path_tick(p, zc_now_ns());
+        p->inflight_bytes += item->size;
+        p->inflight_ops++;
+        item->path = path;
+        retryix_net_connection_t connection = p->connection;
+        ZC_MUTEX_UNLOCK(&g->lock);
+
+        // 投遞時不持有群組鎖: 本地路徑會在投遞內直接回呼
+        uint64_t id = retryix_zc_transfer_open_cb(zc_chunk_done, item);
+        retryix_zerocopy_result_t rc = retryix_zc_post_write(&connection, item->source, item->remote_addr,
+                                                             item->size, item->rkey, id);
+
+        ZC_MUTEX_LOCK(&g->lock);
+        if (rc == RETRYIX_ZC_SUCCESS) continue;
+
+        // 投遞失敗: 撤回在途記帳; 連線已失效則停用路徑, 分條改走其他路徑
+        zc_path_tick(p, zc_now_ns());
+        p->inflight_bytes -= item->size;
+        p->inflight_ops--;
+        if (rc == RETRYIX_ZC_ERROR_DEVICE_BUSY) {
+            zc_queue_push_front(&g->queues[item->size < ZC_STRIPE_SMALL_LIMIT ? ZC_CLASS_SMALL : ZC_CLASS_BULK], item);
+            g->queued++;
+            ZC_COND_WAIT_MS(&g->cond, &g->lock, 1);
+            continue;
+        }
+        p->chunks_failed++;
+        if (rc == RETRYIX_ZC_ERROR_NETWORK_DOWN || rc == RETRYIX_ZC_ERROR_INVALID_PARAM) {
+            p->alive = false;
+            bool any_alive = false;
+            for (int i = 0; i < g->num_paths; i++) any_alive |= g->paths[i].alive;
+            if (any_alive) {
+                zc_queue_push_front(&g->queues[item->size < ZC_STRIPE_SMALL_LIMIT ? ZC_CLASS_SMALL : ZC_CLASS_BULK], item);
+                g->queued++;
+                continue;
+            }
+        }
+        zc_parent_settle_locked(item->parent, false);
+        free(item);
+    }
+    ZC_MUTEX_UNLOCK(&g->lock);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI zc_stripe_main(LPVOID arg) {
+    zc_stripe_loop((retryix_zc_path_group_t*)arg);
+    return 0;
+}
+#else
+static void* zc_stripe_main(void* arg) {
+    zc_stripe_loop((retryix_zc_path_group_t*)arg);
+    return NULL;
+}
+#endif
+
+// 依服務速率計算各路徑的千分比權重 (需持有 group->lock)
+static void zc_weights_locked(retryix_zc_path_group_t* g, uint32_t* permille) {
+    double total = 0.0;
+    for (int i = 0; i < g->num_paths; i++) {
+        if (g->paths[i].alive) total += g->paths[i].bytes_per_ns;
+    }
+    for (int i = 0; i < g->num_paths; i++) {
+        permille[i] = (g->paths[i].alive && total > 0.0)
+            ? (uint32_t)(g->paths[i].bytes_per_ns * 1000.0 / total + 0.5) : 0;
+    }
+}
+
+// === 內部 API ===
+
+retryix_zerocopy_result_t retryix_zc_stripe_rebalance(uint32_t* load_distribution, int num_devices) {
+    ZC_MUTEX_LOCK(&g_groups_lock);
+    retryix_zc_path_group_t* g = g_live_groups;
+    if (!g) {
+        ZC_MUTEX_UNLOCK(&g_groups_lock);
+        return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
+    }
+
+    uint32_t permille[RETRYIX_ZC_MAX_PATHS];
+    ZC_MUTEX_LOCK(&g->lock);
+    // 立即把未滿取樣窗的資料併入估計, 反映最新的即時速率
+    uint64_t now = zc_now_ns();
+    for (int i = 0; i < g->num_paths; i++) {
+        zc_stripe_path_t* p = &g->paths[i];
+        zc_path_tick(p, now);
+        if (p->busy_ns > 0 && p->window_bytes > 0) {
+            p->bytes_per_ns = 0.5 * p->bytes_per_ns + 0.5 * ((double)p->window_bytes / (double)p->busy_ns);
+            p->busy_ns = 0;
+            p->window_bytes = 0;
+        }
+    }
+    zc_weights_locked(g, permille);
+    int n = g->num_paths;
+    ZC_MUTEX_UNLOCK(&g->lock);
+    ZC_MUTEX_UNLOCK(&g_groups_lock);
+
+    for (int i = 0; i < num_devices; i++) {
+        load_distribution[i] = (i < n) ? permille[i] : 0;
+    }
+    return RETRYIX_ZC_SUCCESS;
+}
+
+// === 對外 API ===
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_path_group_create(
+    const retryix_net_connection_t* connections, int num_connections, retryix_zc_path_group_t** group) {
+
+    if (!connections || num_connections <= 0 || num_connections > RETRYIX_ZC_MAX_PATHS || !group) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_zc_path_group_t* g = (retryix_zc_path_group_t*)calloc(1, sizeof(retryix_zc_path_group_t));
+    if (!g) {
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+#ifdef _WIN32
+    InitializeSRWLock(&g->lock);
+#else
+    pthread_mutex_init(&g->lock, NULL);
+#endif
+    ZC_COND_INIT(&g->cond);
+
+    // 初始權重取量測快取 (不在此觸發量測), 之後由即時速率修正
+    uint64_t now = zc_now_ns();
+    g->num_paths = num_connections;
+    for (int i = 0; i < num_connections; i++) {
+        zc_stripe_path_t* p = &g->paths[i];
+        retryix_net_perf_t perf;
+        double mbps = retryix_zc_perf_lookup(&connections[i], &perf) && perf.bandwidth_mbps > 0.0f
+            ? perf.bandwidth_mbps : ZC_STRIPE_DEFAULT_MBPS;
+        p->connection = connections[i];
+        p->alive = true;
+        p->bytes_per_ns = mbps / 8000.0;
+        p->last_tick_ns = now;
+    }
+
+    g->running = 1;
+#ifdef _WIN32
+    g->thread = CreateThread(NULL, 0, zc_stripe_main, g, 0, NULL);
+    if (!g->thread) {
+#else
+    if (pthread_create(&g->thread, NULL, zc_stripe_main, g) != 0) {
+        pthread_mutex_destroy(&g->lock);
+#endif
+        ZC_COND_DESTROY(&g->cond);
+        free(g);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+
+    ZC_MUTEX_LOCK(&g_groups_lock);
+    g->live_next = g_live_groups;
+    if (g_live_groups) g_live_groups->live_prev = g;
+    g_live_groups = g;
+    ZC_MUTEX_UNLOCK(&g_groups_lock);
+
+    *group = g;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_path_group_destroy(retryix_zc_path_group_t* group) {
+    if (!group) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+    retryix_zc_path_group_t* g = group;
+
+    // 移出存活串列; 若為最新者, balance_net_load 自動改用次新的存活群組
+    ZC_MUTEX_LOCK(&g_groups_lock);
+    if (g->live_prev) g->live_prev->live_next = g->live_next;
+    else if (g_live_groups == g) g_live_groups = g->live_next;
+    if (g->live_next) g->live_next->live_prev = g->live_prev;
+    g->live_prev = g->live_next = NULL;
+    ZC_MUTEX_UNLOCK(&g_groups_lock);
+
+    RX_STORE32(&g->running, 0);
+    ZC_MUTEX_LOCK(&g->lock);
+    ZC_COND_BROADCAST(&g->cond);
+    ZC_MUTEX_UNLOCK(&g->lock);
+#ifdef _WIN32
+    WaitForSingleObject(g->thread, INFINITE);
+    CloseHandle(g->thread);
+#else
+    pthread_join(g->thread, NULL);
+#endif
+
+    // 未送出的分條以失敗結束; 在途分條等傳輸層回報 (連線中斷時傳輸層會回報錯誤)
+    ZC_MUTEX_LOCK(&g->lock);
+    for (int c = 0; c < ZC_CLASS_COUNT; c++) {
+        zc_stripe_item_t* item = g->queues[c].head;
+        while (item) {
+            zc_stripe_item_t* next = item->next;
+            zc_parent_settle_locked(item->parent, false);
+            free(item);
+            item = next;
+        }
+        g->queues[c].head = g->queues[c].tail = NULL;
+    }
+    g->queued = 0;
+    for (;;) {
+        uint32_t inflight = 0;
+        for (int i = 0; i < g->num_paths; i++) inflight += g->paths[i].inflight_ops;
+        if (inflight == 0) break;
+        ZC_COND_WAIT_MS(&g->cond, &g->lock, 50);
+    }
+    ZC_MUTEX_UNLOCK(&g->lock);
+
+#ifndef _WIN32
+    pthread_mutex_destroy(&g->lock);
+#endif
+    ZC_COND_DESTROY(&g->cond);
+    free(g);
+    return RETRYIX_ZC_SUCCESS;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_striped_transfer_async(
+    retryix_zc_path_group_t* group, const void* local_buffer,
+    uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t* transfer_id) {
+
+    if (!group || !local_buffer || size == 0 || !transfer_id) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    bool small = size < ZC_STRIPE_SMALL_LIMIT;
+    size_t chunks = small ? 1 : (size + ZC_STRIPE_CHUNK - 1) / ZC_STRIPE_CHUNK;
+
+    zc_stripe_parent_t* parent = (zc_stripe_parent_t*)calloc(1, sizeof(zc_stripe_parent_t));
+    zc_stripe_item_t* items = NULL;
+    for (size_t i = 0; parent && i < chunks; i++) {
+        zc_stripe_item_t* item = (zc_stripe_item_t*)calloc(1, sizeof(zc_stripe_item_t));
+        if (!item) break;
+        size_t offset = i * ZC_STRIPE_CHUNK;
+        item->group = group;
+        item->parent = parent;
+        item->source = (const uint8_t*)local_buffer + offset;
+        item->remote_addr = remote_addr + offset;
+        item->size = (uint32_t)(small ? size : ((size - offset) < ZC_STRIPE_CHUNK ? (size - offset) : ZC_STRIPE_CHUNK));
+        item->rkey = rkey;
+        item->next = items;
+        items = item;
+        parent->remaining++;
+    }
+    if (!parent || parent->remaining != chunks) {
+        while (items) {
+            zc_stripe_item_t* next = items->next;
+            free(items);
+            items = next;
+        }
+        free(parent);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint64_t id = retryix_zc_transfer_open();
+    parent->transfer_id = id;
+
+    // items 為反序鏈結, 依位移順序入隊
+    zc_stripe_item_t* ordered = NULL;
+    while (items) {
+        zc_stripe_item_t* next = items->next;
+        items->next = ordered;
+        ordered = items;
+        items = next;
+    }
+
+    ZC_MUTEX_LOCK(&group->lock);
+    zc_stripe_queue_t* q = &group->queues[small ? ZC_CLASS_SMALL : ZC_CLASS_BULK];
+    while (ordered) {
+        zc_stripe_item_t* next = ordered->next;
+        zc_queue_push(q, ordered);
+        group->queued++;
+        ordered = next;
+    }
+    ZC_COND_BROADCAST(&group->cond);
+    ZC_MUTEX_UNLOCK(&group->lock);
+
+    *transfer_id = id;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_path_group_get_stats(
+    retryix_zc_path_group_t* group, retryix_zc_path_stats_t* stats, int max_paths, int* num_paths) {
+
+    if (!group || !stats || max_paths <= 0 || !num_paths) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t permille[RETRYIX_ZC_MAX_PATHS];
+    ZC_MUTEX_LOCK(&group->lock);
+    zc_weights_locked(group, permille);
+    int n = group->num_paths < max_paths ? group->num_paths : max_paths;
+    for (int i = 0; i < n; i++) {
+        const zc_stripe_path_t* p = &group->paths[i];
+        stats[i].connection = p->connection;
+        stats[i].weight_permille = permille[i];
+        stats[i].throughput_mbps = (float)(p->bytes_per_ns * 8000.0);
+        stats[i].bytes_completed = p->bytes_completed;
+        stats[i].bytes_in_flight = p->inflight_bytes;
+        stats[i].chunks_failed = p->chunks_failed;
+        stats[i].alive = p->alive;
+    }
+    ZC_MUTEX_UNLOCK(&group->lock);
+
+    *num_paths = n;
+    return RETRYIX_ZC_SUCCESS;
+}
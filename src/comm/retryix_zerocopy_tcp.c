@@ -0,0 +1,876 @@
+// retryix_zerocopy_tcp.c - TCP 傳輸 (RETRYIX_NET_PROTO_TCP_OFFLOAD)
+// 發起端: 每連線一個送出線程, 把佇列中的請求聚成單次 sendmsg (大批次走 MSG_ZEROCOPY),
+//         一個接收線程處理 ACK / READ 回應與 SO_EE_ORIGIN_ZEROCOPY 完成通知
+// 目標端: 服務線程以遠端授權鍵 (retryix_zc_pool_grant_remote) 驗證後把 WRITE 負載直接收進目標記憶體,
+//         不經中間緩衝; 預設只監聽回環位址
+// 線路格式為主機位元組序, 兩端需為相同架構
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_zerocopy_internal.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <linux/errqueue.h>
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+
+#define ZC_TCP_MAGIC       0x5A435450u   // "ZCTP"
+#define ZC_TCP_PENDING     1024          // 每連線未完成傳輸上限
+#define ZC_TCP_QUEUE       1024
+#define ZC_TCP_BATCH       64            // 單次 sendmsg 最多聚合的請求數
+#define ZC_TCP_ACK_BATCH   32
+#define ZC_TCP_ZC_RANGES   16
+#define ZC_TCP_ZC_LINGER_MS 1000         // 斷線後等待 MSG_ZEROCOPY 完成通知的上限
+
+enum {
+    ZC_TCP_OP_WRITE = 1,
+    ZC_TCP_OP_READ = 2,
+    ZC_TCP_OP_ACK = 3,
+    ZC_TCP_OP_READ_RESP = 4,
+    ZC_TCP_OP_SINK = 5            ///< 量測用: 目標端丟棄負載後回 ACK
+};
+
+typedef struct {
+    uint32_t magic;
+    uint16_t op;
+    uint16_t status;              ///< retryix_zerocopy_result_t (回應)
+    uint32_t rkey;
+    uint32_t reserved;
+    uint64_t transfer_id;
+    uint64_t remote_addr;
+    uint64_t length;
+} zc_tcp_hdr_t;
+
+typedef struct {
+    zc_tcp_hdr_t hdr;             ///< 以 MSG_ZEROCOPY 送出時需保持不變直到完成, 故放在此處
+    const void* payload;          ///< WRITE 負載
+    void* read_dst;               ///< READ 目的地
+    uint64_t transfer_id;         ///< 0 = 空槽
+    uint64_t zc_seq;
+    bool sent;
+    bool zc_tracked;
+    bool answered;
+    retryix_dma_status_t status;
+} zc_tcp_pending_t;
+
+typedef struct {
+    int fd;                       ///< -1 = 空槽
+    uint32_t cookie;
+    uint32_t refs;                ///< 受 g_tcp_lock 保護; g_conns 持有一份, 歸零時回收
+    volatile uint32_t alive;
+    pthread_t sender;
+    pthread_t receiver;
+    pthread_mutex_t lock;
+    pthread_cond_t send_cond;
+    pthread_cond_t done_cond;
+
+    uint32_t queue[ZC_TCP_QUEUE]; ///< 待送出的 pending 槽位
+    uint32_t q_head;
+    uint32_t q_count;
+
+    zc_tcp_pending_t pending[ZC_TCP_PENDING];
+    uint32_t outstanding;
+    uint32_t waiting_zc;
+    bool sending;                 ///< 送出線程放開鎖執行 sendmsg 中, 其 iov 仍引用 pending 槽
+
+    bool zerocopy_enabled;
+    uint64_t zc_next_seq;         ///< 下一個 MSG_ZEROCOPY 呼叫的序號
+    uint64_t zc_completed;        ///< 序號 < 此值者已完成
+    uint64_t zc_ranges[ZC_TCP_ZC_RANGES][2];  ///< 亂序到達的完成區間
+    uint32_t zc_range_count;
+} zc_tcp_conn_t;
+
+static pthread_mutex_t g_tcp_lock = PTHREAD_MUTEX_INITIALIZER;
+static zc_tcp_conn_t* g_conns[RETRYIX_ZC_TCP_MAX_CONNS];
+static int g_listen_fd = -1;
+static pthread_t g_accept_thread;
+static int g_server_fds[RETRYIX_ZC_TCP_MAX_CONNS];
+static bool g_server_fds_ready = false;
+static uint32_t g_cookie_seed = 0x9E3779B9u;
+
+// === 通用 I/O ===
+static bool zc_recv_all(int fd, void* buf, size_t len) {
+    uint8_t* p = (uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, MSG_WAITALL);
+        if (n > 0) { p += n; len -= (size_t)n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        return false;
+    }
+    return true;
+}
+
+static bool zc_drain(int fd, uint64_t len) {
+    uint8_t scratch[16384];
+    while (len > 0) {
+        size_t chunk = len > sizeof(scratch) ? sizeof(scratch) : (size_t)len;
+        if (!zc_recv_all(fd, scratch, chunk)) return false;
+        len -= chunk;
+    }
+    return true;
+}
+
+// sendmsg 直到全部送出; *zc_calls 為成功的 MSG_ZEROCOPY 呼叫數 (失敗時也有效)
+static bool zc_send_iov(int fd, struct iovec* iov, int iovcnt, bool use_zc, int* zc_calls) {
+    *zc_calls = 0;
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL | (use_zc ? MSG_ZEROCOPY : 0));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS && use_zc) { use_zc = false; continue; }  // optmem 用盡, 退回複製
+            if (errno == EAGAIN) { poll(&(struct pollfd){ fd, POLLOUT, 0 }, 1, 100); continue; }
+            return false;
+        }
+        if (use_zc) (*zc_calls)++;
+        while (n > 0 && iovcnt > 0) {
+            if ((size_t)n >= iov->iov_len) {
+                n -= (ssize_t)iov->iov_len;
+                iov++;
+                iovcnt--;
+            } else {
+                iov->iov_base = (uint8_t*)iov->iov_base + n;
+                iov->iov_len -= (size_t)n;
+                n = 0;
+            }
+        }
+    }
+    return true;
+}
+
+static void zc_tune_socket(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// === 發起端: 完成判定 (需持有 conn->lock) ===
+static void zc_try_complete_locked(zc_tcp_conn_t* c, zc_tcp_pending_t* p) {
+    if (!p->transfer_id || !p->sent || !p->answered) return;
+    if (p->zc_tracked && p->zc_seq >= c->zc_completed) {
+        return;  // 核心仍引用使用者頁面
+    }
+    if (p->zc_tracked) c->waiting_zc--;
+    uint64_t id = p->transfer_id;
+    retryix_dma_status_t status = p->status;
+    memset(p, 0, sizeof(*p));
+    c->outstanding--;
+    retryix_zc_transfer_finish(id, status);
+    pthread_cond_broadcast(&c->done_cond);
+}
+
+// 連線失效: 先標記並關閉 socket 讓送出線程離開 sendmsg, 等它放下 iov 後才回報失敗並清空槽位;
+// 核心仍引用頁面的 MSG_ZEROCOPY 傳輸保留到完成通知到達 (見 zc_receiver_main 結尾)
+static void zc_fail_all_locked(zc_tcp_conn_t* c) {
+    RX_STORE32(&c->alive, 0);
+    shutdown(c->fd, SHUT_RDWR);
+    c->q_count = 0;
+    pthread_cond_broadcast(&c->send_cond);
+    while (c->sending) pthread_cond_wait(&c->send_cond, &c->lock);
+
+    c->outstanding = 0;
+    c->waiting_zc = 0;
+    for (uint32_t i = 0; i < ZC_TCP_PENDING; i++) {
+        zc_tcp_pending_t* p = &c->pending[i];
+        if (!p->transfer_id) continue;
+        if (p->zc_tracked && p->zc_seq >= c->zc_completed) {
+            p->answered = true;
+            p->status = RETRYIX_DMA_ERROR;
+            c->outstanding++;
+            c->waiting_zc++;
+            continue;
+        }
+        retryix_zc_transfer_finish(p->transfer_id, RETRYIX_DMA_ERROR);
+        memset(p, 0, sizeof(*p));
+    }
+    pthread_cond_broadcast(&c->done_cond);
+}
+
+// 記錄 [lo, hi] 已完成的 MSG_ZEROCOPY 呼叫
+static void zc_note_zerocopy_done_locked(zc_tcp_conn_t* c, uint32_t lo, uint32_t hi) {
+    // 核心序號為 32 位, 以目前位置展開成 64 位
+    uint64_t base = c->zc_completed & ~0xFFFFFFFFull;
+    uint64_t lo64 = base | lo, hi64 = base | hi;
+    if (lo64 + 0x80000000ull < c->zc_completed) { lo64 += 0x100000000ull; hi64 += 0x100000000ull; }
+    if (hi64 < lo64) hi64 += 0x100000000ull;
+
+    if (lo64 <= c->zc_completed) {
+        if (hi64 + 1 > c->zc_completed) c->zc_completed = hi64 + 1;
+    } else if (c->zc_range_count < ZC_TCP_ZC_RANGES) {
+        c->zc_ranges[c->zc_range_count][0] = lo64;
+        c->zc_ranges[c->zc_range_count][1] = hi64;
+        c->zc_range_count++;
+    }
+    // 合併先前亂序到達的區間
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (uint32_t i = 0; i < c->zc_range_count; i++) {
+            if (c->zc_ranges[i][0] <= c->zc_completed) {
+                if (c->zc_ranges[i][1] + 1 > c->zc_completed) c->zc_completed = c->zc_ranges[i][1] + 1;
+                c->zc_ranges[i][0] = c->zc_ranges[c->zc_range_count - 1][0];
+                c->zc_ranges[i][1] = c->zc_ranges[c->zc_range_count - 1][1];
+                c->zc_range_count--;
+                merged = true;
+                break;
+            }
+        }
+    }
+    if (c->waiting_zc == 0) return;
+    for (uint32_t i = 0; i < ZC_TCP_PENDING; i++) {
+        if (c->pending[i].zc_tracked) zc_try_complete_locked(c, &c->pending[i]);
+    }
+}
+
+static void zc_drain_errqueue(zc_tcp_conn_t* c) {
+    for (;;) {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(c->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) return;
+
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            const struct sock_extended_err* ee = (const struct sock_extended_err*)CMSG_DATA(cm);
+            if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            pthread_mutex_lock(&c->lock);
+            zc_note_zerocopy_done_locked(c, ee->ee_info, ee->ee_data);
+            pthread_mutex_unlock(&c->lock);
+        }
+    }
+}
+
+// === 發起端: 送出線程 ===
+static void* zc_sender_main(void* arg) {
+    zc_tcp_conn_t* c = (zc_tcp_conn_t*)arg;
+    struct iovec iov[ZC_TCP_BATCH * 2];
+    uint32_t slots[ZC_TCP_BATCH];
+
+    for (;;) {
+        pthread_mutex_lock(&c->lock);
+        while (c->alive && c->q_count == 0) pthread_cond_wait(&c->send_cond, &c->lock);
+        if (!c->alive) {
+            pthread_mutex_unlock(&c->lock);
+            break;
+        }
+        int n = 0, iovcnt = 0;
+        size_t payload_bytes = 0;
+        while (c->q_count > 0 && n < ZC_TCP_BATCH) {
+            uint32_t slot = c->queue[c->q_head];
+            c->q_head = (c->q_head + 1) % ZC_TCP_QUEUE;
+            c->q_count--;
+            zc_tcp_pending_t* p = &c->pending[slot];
+            slots[n++] = slot;
+            iov[iovcnt].iov_base = &p->hdr;
+            iov[iovcnt++].iov_len = sizeof(p->hdr);
+            if (p->hdr.op == ZC_TCP_OP_WRITE || p->hdr.op == ZC_TCP_OP_SINK) {
+                iov[iovcnt].iov_base = (void*)p->payload;
+                iov[iovcnt++].iov_len = (size_t)p->hdr.length;
+                payload_bytes += (size_t)p->hdr.length;
+            }
+        }
+        bool use_zc = c->zerocopy_enabled && payload_bytes >= RETRYIX_ZC_TCP_ZC_THRESHOLD;
+        c->sending = true;
+        pthread_mutex_unlock(&c->lock);
+
+        int zc_calls;
+        bool ok = zc_send_iov(c->fd, iov, iovcnt, use_zc, &zc_calls);
+
+        pthread_mutex_lock(&c->lock);
+        // 失敗時已送出的 MSG_ZEROCOPY 呼叫同樣要記錄, 否則斷線時會在核心仍引用頁面時回報完成
+        uint64_t last_seq = c->zc_next_seq + (uint64_t)zc_calls - 1;
+        c->zc_next_seq += (uint64_t)zc_calls;
+        for (int i = 0; i < n; i++) {
+            zc_tcp_pending_t* p = &c->pending[slots[i]];
+            p->sent = true;
+            if (zc_calls > 0) {
+                p->zc_tracked = true;
+                p->zc_seq = last_seq;
+                c->waiting_zc++;
+            }
+            zc_try_complete_locked(c, p);
+        }
+        c->sending = false;
+        pthread_cond_broadcast(&c->send_cond);
+        if (!ok) {
+            zc_fail_all_locked(c);
+            pthread_mutex_unlock(&c->lock);
+            break;
+        }
+        pthread_mutex_unlock(&c->lock);
+    }
+    return NULL;
+}
+
+// === 發起端: 接收線程 ===
+static void* zc_receiver_main(void* arg) {
+    zc_tcp_conn_t* c = (zc_tcp_conn_t*)arg;
+
+    while (RX_LOAD32(&c->alive)) {
+        struct pollfd pfd = { c->fd, POLLIN, 0 };
+        int rc = poll(&pfd, 1, 200);
+        if (rc < 0 && errno != EINTR) break;
+        if (rc <= 0) continue;
+        if (pfd.revents & POLLERR) zc_drain_errqueue(c);
+        if (!(pfd.revents & (POLLIN | POLLHUP))) continue;
+
+        zc_tcp_hdr_t hdr;
+        if (!zc_recv_all(c->fd, &hdr, sizeof(hdr)) || hdr.magic != ZC_TCP_MAGIC) break;
+
+        pthread_mutex_lock(&c->lock);
+        zc_tcp_pending_t* p = &c->pending[hdr.transfer_id % ZC_TCP_PENDING];
+        bool known = p->transfer_id == hdr.transfer_id;
+        void* dst = known ? p->read_dst : NULL;
+        uint64_t expected = known ? p->hdr.length : 0;
+        pthread_mutex_unlock(&c->lock);
+
+        bool ok = true;
+        if (hdr.op == ZC_TCP_OP_READ_RESP && hdr.length > 0) {
+            // 讀取回應直接收進呼叫端緩衝區
+            ok = (dst && hdr.length <= expected)
+                 ? zc_recv_all(c->fd, dst, (size_t)hdr.length)
+                 : zc_drain(c->fd, hdr.length);
+        }
+        if (!ok) break;
+
+        pthread_mutex_lock(&c->lock);
+        if (known && p->transfer_id == hdr.transfer_id) {
+            p->answered = true;
+            p->status = (hdr.status == RETRYIX_ZC_SUCCESS) ? RETRYIX_DMA_COMPLETED : RETRYIX_DMA_ERROR;
+            zc_try_complete_locked(c, p);
+        }
+        pthread_mutex_unlock(&c->lock);
+    }
+
+    pthread_mutex_lock(&c->lock);
+    zc_fail_all_locked(c);
+    // 等待保留的 MSG_ZEROCOPY 傳輸收到完成通知; 逾時則放棄等待, 直接回報失敗
+    struct timespec now, deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += ZC_TCP_ZC_LINGER_MS / 1000;
+    deadline.tv_nsec += (long)(ZC_TCP_ZC_LINGER_MS % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000L; }
+    while (c->waiting_zc > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec)) break;
+        pthread_mutex_unlock(&c->lock);
+        zc_drain_errqueue(c);
+        poll(NULL, 0, 10);
+        pthread_mutex_lock(&c->lock);
+    }
+    if (c->waiting_zc > 0) {
+        c->zc_completed = c->zc_next_seq;
+        for (uint32_t i = 0; i < ZC_TCP_PENDING; i++) {
+            if (c->pending[i].zc_tracked) zc_try_complete_locked(c, &c->pending[i]);
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+// === 目標端: 服務線程 ===
+static void* zc_server_main(void* arg) {
+    int fd = (int)(intptr_t)arg;
+    zc_tcp_hdr_t acks[ZC_TCP_ACK_BATCH];
+    int ack_count = 0;
+    int zc_calls;
+
+    for (;;) {
+        zc_tcp_hdr_t hdr;
+        if (!zc_recv_all(fd, &hdr, sizeof(hdr)) || hdr.magic != ZC_TCP_MAGIC) break;
+
+        void* local = NULL;
+        retryix_zerocopy_result_t rc = (hdr.op == ZC_TCP_OP_SINK) ? RETRYIX_ZC_SUCCESS
+            : retryix_zc_pool_resolve_remote(hdr.rkey, hdr.remote_addr, (size_t)hdr.length, &local);
+
+        if (hdr.op == ZC_TCP_OP_WRITE || hdr.op == ZC_TCP_OP_SINK) {
+            bool ok = (local != NULL) ? zc_recv_all(fd, local, (size_t)hdr.length)
+                                      : zc_drain(fd, hdr.length);
+            if (!ok) break;
+            zc_tcp_hdr_t* ack = &acks[ack_count++];
+            memset(ack, 0, sizeof(*ack));
+            ack->magic = ZC_TCP_MAGIC;
+            ack->op = ZC_TCP_OP_ACK;
+            ack->status = (uint16_t)rc;
+            ack->transfer_id = hdr.transfer_id;
+        } else if (hdr.op == ZC_TCP_OP_READ) {
+            zc_tcp_hdr_t resp;
+            memset(&resp, 0, sizeof(resp));
+            resp.magic = ZC_TCP_MAGIC;
+            resp.op = ZC_TCP_OP_READ_RESP;
+            resp.status = (uint16_t)rc;
+            resp.transfer_id = hdr.transfer_id;
+            resp.length = (rc == RETRYIX_ZC_SUCCESS) ? hdr.length : 0;
+            // 先送出累積的 ACK, 保持回應順序
+            struct iovec iov[ZC_TCP_ACK_BATCH + 2];
+            int iovcnt = 0;
+            if (ack_count) {
+                iov[iovcnt].iov_base = acks;
+                iov[iovcnt++].iov_len = sizeof(zc_tcp_hdr_t) * (size_t)ack_count;
+                ack_count = 0;
+            }
+            iov[iovcnt].iov_base = &resp;
+            iov[iovcnt++].iov_len = sizeof(resp);
+            if (resp.length) {
+                iov[iovcnt].iov_base = local;
+                iov[iovcnt++].iov_len = (size_t)resp.length;
+            }
+            if (!zc_send_iov(fd, iov, iovcnt, false, &zc_calls)) break;
+            continue;
+        } else {
+            break;
+        }
+
+        // 後續請求已在接收緩衝區時延後回覆, 多個 ACK 合併為一次系統呼叫
+        int queued = 0;
+        if (ack_count < ZC_TCP_ACK_BATCH && ioctl(fd, FIONREAD, &queued) == 0 && queued >= (int)sizeof(zc_tcp_hdr_t)) {
+            continue;
+        }
+        struct iovec iov = { acks, sizeof(zc_tcp_hdr_t) * (size_t)ack_count };
+        if (!zc_send_iov(fd, &iov, 1, false, &zc_calls)) break;
+        ack_count = 0;
+    }
+
+    pthread_mutex_lock(&g_tcp_lock);
+    for (int i = 0; i < RETRYIX_ZC_TCP_MAX_CONNS; i++) {
+        if (g_server_fds[i] == fd) g_server_fds[i] = -1;
+    }
+    pthread_mutex_unlock(&g_tcp_lock);
+    close(fd);
+    return NULL;
+}
+
+static void* zc_accept_main(void* arg) {
+    int listen_fd = (int)(intptr_t)arg;
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;  // 監聽端已關閉
+        }
+        zc_tune_socket(fd);
+
+        pthread_mutex_lock(&g_tcp_lock);
+        int slot = -1;
+        for (int i = 0; i < RETRYIX_ZC_TCP_MAX_CONNS; i++) {
+            if (g_server_fds[i] < 0) { slot = i; break; }
+        }
+        if (slot >= 0) g_server_fds[slot] = fd;
+        pthread_mutex_unlock(&g_tcp_lock);
+
+        pthread_t thread;
+        if (slot < 0 || pthread_create(&thread, NULL, zc_server_main, (void*)(intptr_t)fd) != 0) {
+            pthread_mutex_lock(&g_tcp_lock);
+            if (slot >= 0) g_server_fds[slot] = -1;
+            pthread_mutex_unlock(&g_tcp_lock);
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+// === 內部 API ===
+
+retryix_zerocopy_result_t retryix_zc_tcp_listen(const char* bind_ip, uint16_t port, uint16_t* bound_port) {
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICHOST;
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+    if (getaddrinfo((bind_ip && bind_ip[0]) ? bind_ip : "127.0.0.1", port_str, &hints, &res) != 0 || !res) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&g_tcp_lock);
+    if (!g_server_fds_ready) {
+        for (int i = 0; i < RETRYIX_ZC_TCP_MAX_CONNS; i++) g_server_fds[i] = -1;
+        g_server_fds_ready = true;
+    }
+    if (g_listen_fd >= 0) {
+        pthread_mutex_unlock(&g_tcp_lock);
+        freeaddrinfo(res);
+        return RETRYIX_ZC_ERROR_DEVICE_BUSY;
+    }
+
+    int fd = socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        pthread_mutex_unlock(&g_tcp_lock);
+        freeaddrinfo(res);
+        return RETRYIX_ZC_ERROR_NETWORK_DOWN;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    int bound = bind(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (bound != 0 || listen(fd, 64) != 0 || getsockname(fd, (struct sockaddr*)&addr, &len) != 0) {
+        close(fd);
+        pthread_mutex_unlock(&g_tcp_lock);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+    if (pthread_create(&g_accept_thread, NULL, zc_accept_main, (void*)(intptr_t)fd) != 0) {
+        close(fd);
+        pthread_mutex_unlock(&g_tcp_lock);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    g_listen_fd = fd;
+    pthread_mutex_unlock(&g_tcp_lock);
+
+    if (bound_port) {
+        *bound_port = (addr.ss_family == AF_INET6) ? ntohs(((struct sockaddr_in6*)&addr)->sin6_port)
+                                                   : ntohs(((struct sockaddr_in*)&addr)->sin_port);
+    }
+    return RETRYIX_ZC_SUCCESS;
+}
+
+// 需持有 g_tcp_lock
+static zc_tcp_conn_t* zc_conn_of_locked(const retryix_net_connection_t* connection) {
+    if (!connection || connection->protocol != RETRYIX_NET_PROTO_TCP_OFFLOAD) return NULL;
+    uint32_t slot = connection->qp_num;
+    if (slot == 0 || slot > RETRYIX_ZC_TCP_MAX_CONNS) return NULL;
+    zc_tcp_conn_t* c = g_conns[slot - 1];
+    return (c && c->cookie == connection->psn) ? c : NULL;
+}
+
+// 停止連線: 未完成的傳輸回報失敗, 兩個線程隨即結束; 物件留到最後一個引用釋放
+static void zc_conn_kill(zc_tcp_conn_t* c) {
+    pthread_mutex_lock(&c->lock);
+    zc_fail_all_locked(c);
+    pthread_mutex_unlock(&c->lock);
+}
+
+static void zc_conn_destroy(zc_tcp_conn_t* c) {
+    zc_conn_kill(c);
+    pthread_join(c->sender, NULL);
+    pthread_join(c->receiver, NULL);
+    close(c->fd);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->send_cond);
+    pthread_cond_destroy(&c->done_cond);
+    free(c);
+}
+
+// 查詢並持有引用, 需配對 zc_conn_put; 已斷開或 cookie 不符時回傳 NULL
+static zc_tcp_conn_t* zc_conn_get(const retryix_net_connection_t* connection) {
+    pthread_mutex_lock(&g_tcp_lock);
+    zc_tcp_conn_t* c = zc_conn_of_locked(connection);
+    if (c) c->refs++;
+    pthread_mutex_unlock(&g_tcp_lock);
+    return c;
+}
+
+static void zc_conn_put(zc_tcp_conn_t* c) {
+    pthread_mutex_lock(&g_tcp_lock);
+    bool last = --c->refs == 0;
+    pthread_mutex_unlock(&g_tcp_lock);
+    if (last) zc_conn_destroy(c);
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_connect(const char* ip, uint16_t port, retryix_net_connection_t* connection) {
+    if (!ip || !connection || port == 0) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+    if (getaddrinfo(ip, port_str, &hints, &res) != 0 || !res) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    int fd = socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        if (fd >= 0) close(fd);
+        freeaddrinfo(res);
+        return RETRYIX_ZC_ERROR_CONNECTION_FAILED;
+    }
+    freeaddrinfo(res);
+    zc_tune_socket(fd);
+
+    zc_tcp_conn_t* c = (zc_tcp_conn_t*)calloc(1, sizeof(zc_tcp_conn_t));
+    if (!c) {
+        close(fd);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    int one = 1;
+    c->fd = fd;
+    c->alive = 1;
+    c->zerocopy_enabled = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->send_cond, NULL);
+    pthread_cond_init(&c->done_cond, NULL);
+
+    // 線程先啟動再發佈到 g_conns, 其他線程查得到的連線一定完整
+    if (pthread_create(&c->sender, NULL, zc_sender_main, c) != 0) {
+        close(fd);
+        pthread_mutex_destroy(&c->lock);
+        pthread_cond_destroy(&c->send_cond);
+        pthread_cond_destroy(&c->done_cond);
+        free(c);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+    if (pthread_create(&c->receiver, NULL, zc_receiver_main, c) != 0) {
+        zc_conn_kill(c);
+        pthread_join(c->sender, NULL);
+        close(fd);
+        pthread_mutex_destroy(&c->lock);
+        pthread_cond_destroy(&c->send_cond);
+        pthread_cond_destroy(&c->done_cond);
+        free(c);
+        return RETRYIX_ZC_ERROR_OUT_OF_MEMORY;
+    }
+
+    pthread_mutex_lock(&g_tcp_lock);
+    int slot = -1;
+    for (int i = 0; i < RETRYIX_ZC_TCP_MAX_CONNS; i++) {
+        if (!g_conns[i]) { slot = i; break; }
+    }
+    if (slot >= 0) {
+        g_cookie_seed = g_cookie_seed * 1664525u + 1013904223u;
+        c->cookie = g_cookie_seed | 1u;
+        c->refs = 1;
+        g_conns[slot] = c;
+    }
+    pthread_mutex_unlock(&g_tcp_lock);
+    if (slot < 0) {
+        zc_conn_destroy(c);
+        return RETRYIX_ZC_ERROR_DEVICE_BUSY;
+    }
+
+    memset(connection, 0, sizeof(*connection));
+    struct sockaddr_storage local, remote;
+    socklen_t llen = sizeof(local), rlen = sizeof(remote);
+    if (getsockname(fd, (struct sockaddr*)&local, &llen) == 0 && local.ss_family == AF_INET) {
+        struct sockaddr_in* a = (struct sockaddr_in*)&local;
+        inet_ntop(AF_INET, &a->sin_addr, connection->local_ip, sizeof(connection->local_ip));
+        connection->local_port = ntohs(a->sin_port);
+    }
+    if (getpeername(fd, (struct sockaddr*)&remote, &rlen) == 0 && remote.ss_family == AF_INET) {
+        struct sockaddr_in* a = (struct sockaddr_in*)&remote;
+        inet_ntop(AF_INET, &a->sin_addr, connection->remote_ip, sizeof(connection->remote_ip));
+    } else {
+        snprintf(connection->remote_ip, sizeof(connection->remote_ip), "%s", ip);
+    }
+    connection->remote_port = port;
+    connection->protocol = RETRYIX_NET_PROTO_TCP_OFFLOAD;
+    connection->qp_num = (uint32_t)slot + 1;
+    connection->psn = c->cookie;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_disconnect(retryix_net_connection_t* connection) {
+    // 先送完已投遞的請求
+    retryix_zerocopy_result_t rc = retryix_zc_tcp_flush(connection, 5000);
+    if (rc == RETRYIX_ZC_ERROR_INVALID_PARAM) return rc;
+
+    pthread_mutex_lock(&g_tcp_lock);
+    zc_tcp_conn_t* c = zc_conn_of_locked(connection);
+    if (c) g_conns[connection->qp_num - 1] = NULL;
+    pthread_mutex_unlock(&g_tcp_lock);
+    if (!c) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    // 仍被其他線程持有 (例如背景量測) 時, 它們的請求立即失敗, 最後一個引用釋放時回收
+    zc_conn_kill(c);
+    zc_conn_put(c);
+    connection->qp_num = 0;
+    return RETRYIX_ZC_SUCCESS;
+}
+
+static retryix_zerocopy_result_t zc_post(const retryix_net_connection_t* connection, uint16_t op,
+                                         const void* payload, void* read_dst, uint64_t remote_addr,
+                                         size_t size, uint32_t rkey, uint64_t transfer_id) {
+    zc_tcp_conn_t* c = zc_conn_get(connection);
+    if (!c) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    retryix_zerocopy_result_t rc = RETRYIX_ZC_SUCCESS;
+    pthread_mutex_lock(&c->lock);
+    zc_tcp_pending_t* p = &c->pending[transfer_id % ZC_TCP_PENDING];
+    if (!c->alive) {
+        rc = RETRYIX_ZC_ERROR_NETWORK_DOWN;
+    } else if (p->transfer_id || c->q_count == ZC_TCP_QUEUE) {
+        rc = RETRYIX_ZC_ERROR_DEVICE_BUSY;
+    }
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        pthread_mutex_unlock(&c->lock);
+        zc_conn_put(c);
+        return rc;
+    }
+    memset(p, 0, sizeof(*p));
+    p->transfer_id = transfer_id;
+    p->payload = payload;
+    p->read_dst = read_dst;
+    p->hdr.magic = ZC_TCP_MAGIC;
+    p->hdr.op = op;
+    p->hdr.rkey = rkey;
+    p->hdr.transfer_id = transfer_id;
+    p->hdr.remote_addr = remote_addr;
+    p->hdr.length = size;
+
+    c->queue[(c->q_head + c->q_count) % ZC_TCP_QUEUE] = (uint32_t)(transfer_id % ZC_TCP_PENDING);
+    c->q_count++;
+    c->outstanding++;
+    pthread_cond_signal(&c->send_cond);
+    pthread_mutex_unlock(&c->lock);
+    zc_conn_put(c);
+    return RETRYIX_ZC_SUCCESS;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_post_write(const retryix_net_connection_t* connection, const void* local_buffer,
+                                                    uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id) {
+    return zc_post(connection, ZC_TCP_OP_WRITE, local_buffer, NULL, remote_addr, size, rkey, transfer_id);
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_post_read(const retryix_net_connection_t* connection, void* local_buffer,
+                                                   uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id) {
+    return zc_post(connection, ZC_TCP_OP_READ, NULL, local_buffer, remote_addr, size, rkey, transfer_id);
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_post_sink(const retryix_net_connection_t* connection, const void* payload,
+                                                   size_t size, uint64_t transfer_id) {
+    return zc_post(connection, ZC_TCP_OP_SINK, payload, NULL, 0, size, 0, transfer_id);
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_flush(const retryix_net_connection_t* connection, uint32_t timeout_ms) {
+    zc_tcp_conn_t* c = zc_conn_get(connection);
+    if (!c) return RETRYIX_ZC_ERROR_INVALID_PARAM;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000L; }
+
+    retryix_zerocopy_result_t rc = RETRYIX_ZC_SUCCESS;
+    pthread_mutex_lock(&c->lock);
+    while (c->alive && c->outstanding > 0) {
+        if (timeout_ms == RETRYIX_ZC_WAIT_INFINITE) {
+            pthread_cond_wait(&c->done_cond, &c->lock);
+        } else if (pthread_cond_timedwait(&c->done_cond, &c->lock, &deadline) == ETIMEDOUT) {
+            rc = RETRYIX_ZC_ERROR_TIMEOUT;
+            break;
+        }
+    }
+    if (!c->alive) rc = RETRYIX_ZC_ERROR_NETWORK_DOWN;
+    pthread_mutex_unlock(&c->lock);
+    zc_conn_put(c);
+    return rc;
+}
+
+void* retryix_zc_tcp_hold(const retryix_net_connection_t* connection) {
+    return zc_conn_get(connection);
+}
+
+void retryix_zc_tcp_unhold(void* handle) {
+    if (handle) zc_conn_put((zc_tcp_conn_t*)handle);
+}
+
+void retryix_zc_tcp_shutdown(void) {
+    pthread_mutex_lock(&g_tcp_lock);
+    int listen_fd = g_listen_fd;
+    g_listen_fd = -1;
+    zc_tcp_conn_t* conns[RETRYIX_ZC_TCP_MAX_CONNS];
+    memcpy(conns, g_conns, sizeof(conns));
+    memset(g_conns, 0, sizeof(g_conns));
+    if (g_server_fds_ready) {
+        for (int i = 0; i < RETRYIX_ZC_TCP_MAX_CONNS; i++) {
+            if (g_server_fds[i] >= 0) shutdown(g_server_fds[i], SHUT_RDWR);  // 服務線程自行關閉
+        }
+    }
+    pthread_mutex_unlock(&g_tcp_lock);
+
+    if (listen_fd >= 0) {
+        shutdown(listen_fd, SHUT_RDWR);
+        close(listen_fd);
+        pthread_join(g_accept_thread, NULL);
+    }
+    for (int i = 0; i < RETRYIX_ZC_TCP_MAX_CONNS; i++) {
+        if (!conns[i]) continue;
+        zc_conn_kill(conns[i]);
+        zc_conn_put(conns[i]);
+    }
+}
+
+#else  /* !__linux__ */
+
+// 非 Linux 平台尚無 TCP 傳輸實作
+retryix_zerocopy_result_t retryix_zc_tcp_listen(const char* bind_ip, uint16_t port, uint16_t* bound_port) {
+    (void)bind_ip; (void)port; (void)bound_port;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_connect(const char* ip, uint16_t port, retryix_net_connection_t* connection) {
+    (void)ip; (void)port; (void)connection;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_disconnect(retryix_net_connection_t* connection) {
+    (void)connection;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_post_write(const retryix_net_connection_t* connection, const void* local_buffer,
+                                                    uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id) {
+    (void)connection; (void)local_buffer; (void)remote_addr; (void)size; (void)rkey; (void)transfer_id;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_post_read(const retryix_net_connection_t* connection, void* local_buffer,
+                                                   uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id) {
+    (void)connection; (void)local_buffer; (void)remote_addr; (void)size; (void)rkey; (void)transfer_id;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_post_sink(const retryix_net_connection_t* connection, const void* payload,
+                                                   size_t size, uint64_t transfer_id) {
+    (void)connection; (void)payload; (void)size; (void)transfer_id;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+retryix_zerocopy_result_t retryix_zc_tcp_flush(const retryix_net_connection_t* connection, uint32_t timeout_ms) {
+    (void)connection; (void)timeout_ms;
+    return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+}
+
+void* retryix_zc_tcp_hold(const retryix_net_connection_t* connection) {
+    (void)connection;
+    return NULL;
+}
+
+void retryix_zc_tcp_unhold(void* handle) {
+    (void)handle;
+}
+
+void retryix_zc_tcp_shutdown(void) {
+}
+
+#endif
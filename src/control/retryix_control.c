@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include "retryix.h"
 #include "cJSON.h"
+#include "retryix_json_writer_internal.h"
 #include "retryix_core.h"
 #include "retryix_device.h"
 
@@ -105,27 +106,22 @@ RETRYIX_API char* RETRYIX_CALL retryix_query_workload_affinity(uint64_t workload
         }
     }
 
+    retryix_json_writer_t w;
+    retryix_jw_init(&w, RETRYIX_JW_JSON, 256);
+    retryix_jw_begin_object(&w, NULL);
+    retryix_jw_number(&w, "workload_id", (double)workload_id);
     if (index == -1) {
-        cJSON *root = cJSON_CreateObject();
-        cJSON_AddNumberToObject(root, "workload_id", (double)workload_id);
-        cJSON_AddStringToObject(root, "status", "not_found");
-        char* json = cJSON_Print(root);
-        cJSON_Delete(root);
-        return json;
-    }
-
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "workload_id", (double)workload_id);
-    cJSON_AddNumberToObject(root, "numa_node", (double)g_workload_table[index].numa_node);
-    cJSON_AddNumberToObject(root, "gpu_device", (double)g_workload_table[index].gpu_device_index);
-    cJSON_AddNumberToObject(root, "network_port", (double)g_workload_table[index].network_port_index);
-    cJSON_AddBoolToObject(root, "rdma_enabled", g_workload_table[index].rdma_enabled);
-    cJSON_AddBoolToObject(root, "gpu_audio_offload", g_workload_table[index].gpu_audio_offload);
-    cJSON_AddStringToObject(root, "status", "active");
-
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+        retryix_jw_string(&w, "status", "not_found");
+    } else {
+        retryix_jw_int(&w, "numa_node", g_workload_table[index].numa_node);
+        retryix_jw_int(&w, "gpu_device", g_workload_table[index].gpu_device_index);
+        retryix_jw_int(&w, "network_port", g_workload_table[index].network_port_index);
+        retryix_jw_bool(&w, "rdma_enabled", g_workload_table[index].rdma_enabled);
+        retryix_jw_bool(&w, "gpu_audio_offload", g_workload_table[index].gpu_audio_offload);
+        retryix_jw_string(&w, "status", "active");
+    }
+    retryix_jw_end_object(&w);
+    return retryix_jw_finish(&w);
 }
 
 // 原子設備重置
@@ -179,48 +175,50 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_query_device_temperature(
     return RETRYIX_SUCCESS;
 }
 
-// 系統健康狀態
-RETRYIX_API char* RETRYIX_CALL retryix_get_system_health_json(void) {
-    cJSON *root = cJSON_CreateObject();
-    cJSON *devices = cJSON_CreateArray();
+// 系統健康狀態 (JSON 與 CBOR 快照共用的串流輸出)
+void retryix_emit_system_health(retryix_json_writer_t* w, const char* key) {
+    retryix_jw_begin_object(w, key);
+    retryix_jw_begin_array(w, "devices");
 
     retryix_device_t gpus[RETRYIX_MAX_DEVICES];
     int gpu_count = 0;
     if (retryix_discover_all_devices(gpus, RETRYIX_MAX_DEVICES, &gpu_count) == RETRYIX_SUCCESS) {
         for (int i = 0; i < gpu_count; i++) {
-            cJSON *gpu = cJSON_CreateObject();
-            cJSON_AddStringToObject(gpu, "type", "GPU");
-            cJSON_AddStringToObject(gpu, "name", gpus[i].name);
-            
             float temp = 0.0f;
             retryix_query_device_temperature(gpus[i].name, &temp);
-            cJSON_AddNumberToObject(gpu, "temperature_c", temp);
-            cJSON_AddStringToObject(gpu, "status", temp < 85.0f ? "healthy" : "warning");
-            
-            cJSON_AddItemToArray(devices, gpu);
+
+            retryix_jw_begin_object(w, NULL);
+            retryix_jw_string(w, "type", "GPU");
+            retryix_jw_string(w, "name", gpus[i].name);
+            retryix_jw_number(w, "temperature_c", temp);
+            retryix_jw_string(w, "status", temp < 85.0f ? "healthy" : "warning");
+            retryix_jw_end_object(w);
         }
     }
 
     const char* nics[] = {"Mellanox ConnectX-6", "Intel E810", "NVIDIA BlueField"};
     for (int i = 0; i < 3; i++) {
-        cJSON *nic = cJSON_CreateObject();
-        cJSON_AddStringToObject(nic, "type", "Network");
-        cJSON_AddStringToObject(nic, "name", nics[i]);
-        
         double latency = 0.0;
         retryix_query_link_latency_us(nics[i], &latency);
-        cJSON_AddNumberToObject(nic, "latency_us", latency);
-        cJSON_AddStringToObject(nic, "status", latency < 10.0 ? "healthy" : "degraded");
-        
-        cJSON_AddItemToArray(devices, nic);
+
+        retryix_jw_begin_object(w, NULL);
+        retryix_jw_string(w, "type", "Network");
+        retryix_jw_string(w, "name", nics[i]);
+        retryix_jw_number(w, "latency_us", latency);
+        retryix_jw_string(w, "status", latency < 10.0 ? "healthy" : "degraded");
+        retryix_jw_end_object(w);
     }
 
-    cJSON_AddItemToObject(root, "devices", devices);
-    cJSON_AddNumberToObject(root, "active_workloads", g_workload_count);
-    cJSON_AddStringToObject(root, "overall_status", "operational");
-    cJSON_AddStringToObject(root, "timestamp", __DATE__ " " __TIME__);
+    retryix_jw_end_array(w);
+    retryix_jw_int(w, "active_workloads", g_workload_count);
+    retryix_jw_string(w, "overall_status", "operational");
+    retryix_jw_string(w, "timestamp", __DATE__ " " __TIME__);
+    retryix_jw_end_object(w);
+}
 
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+RETRYIX_API char* RETRYIX_CALL retryix_get_system_health_json(void) {
+    retryix_json_writer_t w;
+    retryix_jw_init(&w, RETRYIX_JW_JSON, 2048);
+    retryix_emit_system_health(&w, NULL);
+    return retryix_jw_finish(&w);
 }
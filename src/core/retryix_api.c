@@ -1,6 +1,7 @@
 // retryix_api.c - RetryIX 公共 API 實現
 #include "retryix.h" // 確保正確引入型別定義
 #include "retryix_svm.h" // 確保 struct 定義可用
+#include "retryix_device_probe_internal.h" // retryix_invalidate_device_cache
 #include <string.h>
 
 static retryix_system_state_t g_api_state = {0};
@@ -31,6 +32,8 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_auto_initialize(int prefer_gpu
     int max_attempts = 1 + retries;
     for (int attempt = 0; attempt < max_attempts; ++attempt) {
         dev_count = 0;
+        /* discovery results are cached; a retry must force a fresh probe */
+        if (attempt > 0) retryix_invalidate_device_cache();
         if (retryix_discover_all_devices(devs, RETRYIX_MAX_DEVICES, &dev_count) == RETRYIX_SUCCESS && dev_count > 0) {
             g_api_state.device_count = dev_count;
             g_api_state.best_device = devs[0];
@@ -6,40 +6,21 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <errno.h>
-// Bridge headers for vendor-specific fallback discovery
-#include "retryix_bridge_cuda.h"
-#include "retryix_bridge_rocm.h"
-#include "retryix_bridge_intel_l0.h"
-#include "retryix_bridge_opencl_intel.h"
-#ifdef __APPLE__
-#include "retryix_bridge_metal.h"
-#else
-/* Provide a weak prototype so the bridge can be called if present at link time on non-Apple builds */
-extern RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_apple_metal_platforms(
-	retryix_platform_t* platforms, int max_platforms, int* platform_count);
-#endif
+// Vendor bridge fallbacks (CUDA/ROCm/L0/...) run through the parallel probe
+// session in retryix_device_native.c, which resolves the bridges at runtime.
+#include "retryix_device_probe_internal.h"
+#include "retryix_runtime_loader_internal.h"
 
-/* Runtime symbol resolver: provide a single file-scope helper so we avoid
-   defining functions inside other functions (MSVC does not support nested
-   function definitions). This helper uses GetProcAddress on Windows and
-   dlsym on POSIX systems. */
 #if defined(_WIN32)
 #include <windows.h>
 #else
-#include <dlfcn.h>
+#include <pthread.h>
 #endif
-
-static void* rix_get_sym(const char* name) {
-#if defined(_WIN32)
-	HMODULE m = GetModuleHandleA(NULL);
-	return m ? (void*)GetProcAddress(m, name) : NULL;
-#else
-	return dlsym(RTLD_DEFAULT, name);
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <unistd.h>
 #endif
-}
-
-/* Typedef for bridge discover functions */
-typedef retryix_result_t (*discover_fn)(retryix_platform_t*, int, int*);
 
 // Simple debug logger enabled by setting the environment variable RETRYIX_DEBUG (any value)
 #define DEBUG_LOG(fmt, ...) do { if (getenv("RETRYIX_DEBUG")) fprintf(stderr, fmt, ##__VA_ARGS__); } while(0)
@@ -171,12 +152,13 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_for_platform(
 	return (out > 0) ? RETRYIX_SUCCESS : RETRYIX_ERROR_NO_DEVICE;
 }
 
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_all_devices(
+/* Full discovery walk (OpenCL platforms, then vendor bridges). Only the
+   registry below calls this; public queries are served from its cache. */
+static retryix_result_t discover_all_devices_uncached(
 	retryix_device_t* devices,
 	int max_devices,
 	int* device_count
 ) {
-	if (!devices || !device_count || max_devices <= 0) return RETRYIX_ERROR_NULL_PTR;
 	*device_count = 0;
 
 	cl_uint num_platforms = 0;
@@ -256,54 +238,172 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_all_devices(
 		// If OpenCL discovered nothing, try vendor-specific bridge fallbacks
 		if (out == 0) {
 			device_file_log("[retryix_discover_all_devices] OpenCL found no devices; trying vendor bridge fallbacks\n");
-			retryix_platform_t plats[16];
-			int pc = 0;
-
-			/* runtime bridge discovery: rix_get_sym and discover_fn are defined
-			   at file scope above to avoid nested function definitions and
-			   repeated includes. */
-
-			#define TRY_BRIDGE_NAME(symname) \
-			do { \
-				pc = 0; memset(plats, 0, sizeof(plats)); \
-				discover_fn fn = (discover_fn)rix_get_sym(symname); \
-				if (fn) { \
-					if (fn(plats, (int)(sizeof(plats)/sizeof(plats[0])), &pc) == RETRYIX_SUCCESS && pc > 0) { \
-						for (int _i = 0; _i < pc && out < max_devices; ++_i) { \
-							retryix_platform_t* pplat = &plats[_i]; \
-							retryix_device_t* d = &devices[out]; \
-							memset(d, 0, sizeof(*d)); \
-							d->struct_size = sizeof(retryix_device_t); \
-							d->struct_version = 0x00010000; \
-							d->id = NULL; \
-							d->platform_id = NULL; \
-							strncpy(d->name, pplat->name, RETRYIX_MAX_NAME_LEN-1); \
-							strncpy(d->vendor, pplat->vendor, RETRYIX_MAX_NAME_LEN-1); \
-							strncpy(d->version, pplat->version, RETRYIX_MAX_VERSION_LEN-1); \
-							d->type = CL_DEVICE_TYPE_GPU; /* best-effort guess */ \
-							d->is_available = 1; \
-							d->performance_score = 40.0f; \
-							d->is_preferred = 0; \
-							device_file_log("[retryix_discover_all_devices] bridge-added device name='%s' vendor='%s'\n", d->name, d->vendor); \
-							out++; \
-						} \
-					} \
-				} \
-			} while (0)
-
-			TRY_BRIDGE_NAME("retryix_discover_cuda_platforms");
-			TRY_BRIDGE_NAME("retryix_discover_rocm_platforms");
-			TRY_BRIDGE_NAME("retryix_discover_intel_l0_platforms");
-			TRY_BRIDGE_NAME("retryix_discover_opencl_intel_platforms");
-			TRY_BRIDGE_NAME("retryix_discover_apple_metal_platforms");
-
-			#undef TRY_BRIDGE_NAME
+
+			/* Each bridge may dlopen and initialize a heavy vendor runtime, so they
+			   are probed concurrently with a per-bridge timeout and a hung driver
+			   cannot stall the others. Results are appended in bridge order. */
+			int bridge_count = 0;
+			retryix_probe_bridges_parallel(devices + out, max_devices - out, &bridge_count, NULL);
+			for (int i = 0; i < bridge_count; ++i) {
+				retryix_device_t* d = &devices[out];
+				d->performance_score = 40.0f;
+				d->is_preferred = 0;
+				device_file_log("[retryix_discover_all_devices] bridge-added device name='%s' vendor='%s'\n", d->name, d->vendor);
+				out++;
+			}
 		}
 
 	*device_count = out;
 	return (out > 0) ? RETRYIX_SUCCESS : RETRYIX_ERROR_NO_DEVICE;
 }
 
+/* ---------------------------------------------------------------------------
+   Device registry: discovery runs once and the result (including failure) is
+   cached. It is rebuilt only when a hotplug uevent for a pci/drm/accel device
+   arrives on the kernel netlink socket, or after an explicit
+   retryix_invalidate_device_cache(). The generation counter advances only
+   when a rebuild produces a different device list.
+   --------------------------------------------------------------------------- */
+#if defined(_WIN32)
+static SRWLOCK g_registry_lock = SRWLOCK_INIT;
+#define REGISTRY_LOCK()   AcquireSRWLockExclusive(&g_registry_lock)
+#define REGISTRY_UNLOCK() ReleaseSRWLockExclusive(&g_registry_lock)
+#else
+static pthread_mutex_t g_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+#define REGISTRY_LOCK()   pthread_mutex_lock(&g_registry_lock)
+#define REGISTRY_UNLOCK() pthread_mutex_unlock(&g_registry_lock)
+#endif
+
+static retryix_device_t g_registry[RETRYIX_MAX_DEVICES];
+static int g_registry_count = 0;
+static retryix_result_t g_registry_result = RETRYIX_ERROR_NO_DEVICE;
+static int g_registry_valid = 0;
+static unsigned long long g_registry_generation = 0;
+#if defined(__linux__)
+static int g_uevent_fd = -1;        /* -2: netlink unavailable, rely on explicit invalidation */
+#endif
+
+#if defined(__linux__)
+/* Open the kernel uevent socket before the first discovery so that devices
+   appearing while discovery runs still mark the cache stale. */
+static void registry_open_uevent(void) {
+	if (g_uevent_fd != -1) return;
+	int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+	if (fd >= 0) {
+		struct sockaddr_nl addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.nl_family = AF_NETLINK;
+		addr.nl_groups = 1; /* kernel broadcast group, no udevd needed */
+		if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+			close(fd);
+			fd = -1;
+		}
+	}
+	g_uevent_fd = (fd >= 0) ? fd : -2;
+	device_file_log("[device_registry] uevent monitor %s\n", fd >= 0 ? "active" : "unavailable");
+}
+
+/* Drain pending uevents without blocking; returns 1 if any of them adds or
+   removes a device discovery could report. */
+static int registry_drain_uevents(void) {
+	if (g_uevent_fd < 0) return 0;
+	int stale = 0;
+	char buf[8192];
+	for (;;) {
+		ssize_t n = recv(g_uevent_fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == ENOBUFS) { stale = 1; continue; } /* events were dropped */
+			break;
+		}
+		buf[n] = '\0';
+		/* "action@devpath\0KEY=VALUE\0..." */
+		int relevant_action = strncmp(buf, "add@", 4) == 0 || strncmp(buf, "remove@", 7) == 0 ||
+			strncmp(buf, "bind@", 5) == 0 || strncmp(buf, "unbind@", 7) == 0;
+		if (!relevant_action) continue;
+		for (const char* kv = buf; kv < buf + n; kv += strlen(kv) + 1) {
+			if (strcmp(kv, "SUBSYSTEM=pci") == 0 || strcmp(kv, "SUBSYSTEM=drm") == 0 ||
+				strcmp(kv, "SUBSYSTEM=accel") == 0) {
+				device_file_log("[device_registry] hotplug uevent '%s'\n", buf);
+				stale = 1;
+				break;
+			}
+		}
+	}
+	return stale;
+}
+#endif
+
+static int registry_same_devices(const retryix_device_t* a, int na, const retryix_device_t* b, int nb) {
+	if (na != nb) return 0;
+	for (int i = 0; i < na; ++i) {
+		if (a[i].id != b[i].id || a[i].type != b[i].type ||
+			strcmp(a[i].name, b[i].name) != 0 || strcmp(a[i].vendor, b[i].vendor) != 0 ||
+			strcmp(a[i].driver_version, b[i].driver_version) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+/* Caller holds the registry lock. */
+static void registry_refresh_locked(void) {
+#if defined(__linux__)
+	registry_open_uevent();
+	if (registry_drain_uevents()) {
+		g_registry_valid = 0;
+		retryix_vulkan_instance_invalidate();
+	}
+#endif
+	if (g_registry_valid) return;
+
+	retryix_device_t* fresh = (retryix_device_t*)malloc(sizeof(g_registry));
+	if (!fresh) return;
+	int count = 0;
+	retryix_result_t result = discover_all_devices_uncached(fresh, RETRYIX_MAX_DEVICES, &count);
+	if (!registry_same_devices(fresh, count, g_registry, g_registry_count) || g_registry_generation == 0) {
+		g_registry_generation++;
+	}
+	memcpy(g_registry, fresh, sizeof(retryix_device_t) * (size_t)count);
+	g_registry_count = count;
+	g_registry_result = result;
+	g_registry_valid = 1;
+	free(fresh);
+	DEBUG_LOG("[device_registry] rebuilt: %d devices, generation %llu\n", count, g_registry_generation);
+}
+
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_all_devices(
+	retryix_device_t* devices,
+	int max_devices,
+	int* device_count
+) {
+	if (!devices || !device_count || max_devices <= 0) return RETRYIX_ERROR_NULL_PTR;
+
+	REGISTRY_LOCK();
+	registry_refresh_locked();
+	int n = (g_registry_count < max_devices) ? g_registry_count : max_devices;
+	memcpy(devices, g_registry, sizeof(retryix_device_t) * (size_t)n);
+	*device_count = n;
+	retryix_result_t result = g_registry_result;
+	REGISTRY_UNLOCK();
+	return result;
+}
+
+void retryix_invalidate_device_cache(void) {
+	REGISTRY_LOCK();
+	g_registry_valid = 0;
+	REGISTRY_UNLOCK();
+	/* A VkInstance only enumerates the GPUs present when it was created. */
+	retryix_vulkan_instance_invalidate();
+}
+
+unsigned long long retryix_get_device_generation(void) {
+	REGISTRY_LOCK();
+	registry_refresh_locked();
+	unsigned long long generation = g_registry_generation;
+	REGISTRY_UNLOCK();
+	return generation;
+}
+
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_select_best_device(
 	const retryix_device_t* devices,
 	int device_count,
@@ -1,13 +1,25 @@
 // retryix_device_native.c
-// 原生硬體偵測 - 分層回退策略: Vulkan → DXGI → Registry
+// 原生硬體偵測 - 並行探測各後端, 依優先序取結果: Vulkan → CUDA → ROCm → L0 → DXGI/sysfs → Registry
 // RetryIX 3.0.0 魯班
 
 #include "retryix_core.h"
 #include "retryix_device.h"
+#include "retryix_device_probe_internal.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+// 執行期符號查找 (橋接模組)
+#ifdef _WIN32
+#include <windows.h>
+#define DLSYM(h, n) ((void*)GetProcAddress((HMODULE)(h), n))
+#else
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#define DLSYM(h, n) dlsym(h, n)
+#endif
+
 // Vulkan 支持 (動態加載,可選)
 #ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
@@ -16,18 +28,8 @@
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
 
-// Vulkan 函數指針
-typedef VkResult (VKAPI_PTR *PFN_vkCreateInstance_)(const VkInstanceCreateInfo*, const VkAllocationCallbacks*, VkInstance*);
-typedef void (VKAPI_PTR *PFN_vkDestroyInstance_)(VkInstance, const VkAllocationCallbacks*);
-typedef VkResult (VKAPI_PTR *PFN_vkEnumeratePhysicalDevices_)(VkInstance, uint32_t*, VkPhysicalDevice*);
-typedef void (VKAPI_PTR *PFN_vkGetPhysicalDeviceProperties_)(VkPhysicalDevice, VkPhysicalDeviceProperties*);
-typedef void (VKAPI_PTR *PFN_vkGetPhysicalDeviceMemoryProperties_)(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties*);
-
-static PFN_vkCreateInstance_ vkCreateInstance_dyn = NULL;
-static PFN_vkDestroyInstance_ vkDestroyInstance_dyn = NULL;
-static PFN_vkEnumeratePhysicalDevices_ vkEnumeratePhysicalDevices_dyn = NULL;
-static PFN_vkGetPhysicalDeviceProperties_ vkGetPhysicalDeviceProperties_dyn = NULL;
-static PFN_vkGetPhysicalDeviceMemoryProperties_ vkGetPhysicalDeviceMemoryProperties_dyn = NULL;
+// Vulkan 程式庫、符號與 VkInstance 由共用載入器提供 (與 compute 引擎共用)
+#include "retryix_runtime_loader_internal.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -108,152 +110,6 @@ static int query_windows_gpu_registry(retryix_device_t* devices, int max_devices
     return count;
 }
 
-// Vulkan 硬體查詢 (跨平台,優先使用)
-static int query_vulkan_gpu(retryix_device_t* devices, int max_devices) {
-    int count = 0;
-    
-#ifdef _WIN32
-    HMODULE vulkan_lib = LoadLibraryA("vulkan-1.dll");
-    if (!vulkan_lib) return 0;
-    
-    vkCreateInstance_dyn = (PFN_vkCreateInstance_)GetProcAddress(vulkan_lib, "vkCreateInstance");
-    vkDestroyInstance_dyn = (PFN_vkDestroyInstance_)GetProcAddress(vulkan_lib, "vkDestroyInstance");
-    vkEnumeratePhysicalDevices_dyn = (PFN_vkEnumeratePhysicalDevices_)GetProcAddress(vulkan_lib, "vkEnumeratePhysicalDevices");
-    vkGetPhysicalDeviceProperties_dyn = (PFN_vkGetPhysicalDeviceProperties_)GetProcAddress(vulkan_lib, "vkGetPhysicalDeviceProperties");
-    vkGetPhysicalDeviceMemoryProperties_dyn = (PFN_vkGetPhysicalDeviceMemoryProperties_)GetProcAddress(vulkan_lib, "vkGetPhysicalDeviceMemoryProperties");
-    
-    if (!vkCreateInstance_dyn || !vkEnumeratePhysicalDevices_dyn || !vkGetPhysicalDeviceProperties_dyn) {
-        FreeLibrary(vulkan_lib);
-        return 0;
-    }
-#endif
-    
-    // 創建 Vulkan 實例
-    VkApplicationInfo app_info;
-    memset(&app_info, 0, sizeof(app_info));
-    app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    app_info.pNext = NULL;
-    app_info.pApplicationName = "RetryIX";
-    app_info.applicationVersion = VK_MAKE_VERSION(3, 0, 0);
-    app_info.pEngineName = "LuBan";
-    app_info.engineVersion = VK_MAKE_VERSION(3, 0, 0);
-    app_info.apiVersion = VK_API_VERSION_1_0;
-    
-    VkInstanceCreateInfo create_info;
-    memset(&create_info, 0, sizeof(create_info));
-    create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-    create_info.pNext = NULL;
-    create_info.flags = 0;
-    create_info.pApplicationInfo = &app_info;
-    create_info.enabledLayerCount = 0;
-    create_info.ppEnabledLayerNames = NULL;
-    create_info.enabledExtensionCount = 0;
-    create_info.ppEnabledExtensionNames = NULL;
-    
-    VkInstance instance = VK_NULL_HANDLE;
-    VkResult result = vkCreateInstance_dyn(&create_info, NULL, &instance);
-    if (result != VK_SUCCESS) {
-#ifdef _WIN32
-        FreeLibrary(vulkan_lib);
-#endif
-        return 0;
-    }
-    
-    // 枚舉物理設備
-    uint32_t device_count = 0;
-    result = vkEnumeratePhysicalDevices_dyn(instance, &device_count, NULL);
-    
-    if (result != VK_SUCCESS || device_count == 0) {
-        vkDestroyInstance_dyn(instance, NULL);
-#ifdef _WIN32
-        FreeLibrary(vulkan_lib);
-#endif
-        return 0;
-    }
-    
-    if (device_count > (uint32_t)max_devices) {
-        device_count = (uint32_t)max_devices;
-    }
-    
-    VkPhysicalDevice* physical_devices = (VkPhysicalDevice*)malloc(sizeof(VkPhysicalDevice) * device_count);
-    if (!physical_devices) {
-        vkDestroyInstance_dyn(instance, NULL);
-#ifdef _WIN32
-        FreeLibrary(vulkan_lib);
-#endif
-        return 0;
-    }
-    
-    result = vkEnumeratePhysicalDevices_dyn(instance, &device_count, physical_devices);
-    if (result != VK_SUCCESS) {
-        free(physical_devices);
-        vkDestroyInstance_dyn(instance, NULL);
-#ifdef _WIN32
-        FreeLibrary(vulkan_lib);
-#endif
-        return 0;
-    }
-    
-    for (uint32_t i = 0; i < device_count; i++) {
-        VkPhysicalDeviceProperties props;
-        VkPhysicalDeviceMemoryProperties mem_props;
-        
-        vkGetPhysicalDeviceProperties_dyn(physical_devices[i], &props);
-        vkGetPhysicalDeviceMemoryProperties_dyn(physical_devices[i], &mem_props);
-        
-        retryix_device_t* d = &devices[count];
-        memset(d, 0, sizeof(*d));
-        d->struct_size = sizeof(retryix_device_t);
-        d->struct_version = 0x00010000;
-        
-        // 設備名稱
-        strncpy(d->name, props.deviceName, RETRYIX_MAX_NAME_LEN - 1);
-        
-        // 判斷供應商
-        if (props.vendorID == 0x1002) { // AMD
-            strncpy(d->vendor, "Advanced Micro Devices, Inc.", RETRYIX_MAX_NAME_LEN - 1);
-            d->custom_flags |= 0x01;
-            if (strstr(props.deviceName, "RX 5") || strstr(props.deviceName, "5700")) {
-                d->is_amd_rx5000 = 1;
-            }
-        } else if (props.vendorID == 0x10DE) { // NVIDIA
-            strncpy(d->vendor, "NVIDIA Corporation", RETRYIX_MAX_NAME_LEN - 1);
-            d->custom_flags |= 0x02;
-        } else if (props.vendorID == 0x8086) { // Intel
-            strncpy(d->vendor, "Intel Corporation", RETRYIX_MAX_NAME_LEN - 1);
-        }
-        
-        // 計算總 VRAM (所有 DEVICE_LOCAL 內存堆)
-        cl_ulong total_vram = 0;
-        for (uint32_t j = 0; j < mem_props.memoryHeapCount; j++) {
-            if (mem_props.memoryHeaps[j].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
-                total_vram += mem_props.memoryHeaps[j].size;
-            }
-        }
-        d->global_memory = total_vram;
-        
-        // Vulkan API 版本
-        snprintf(d->version, RETRYIX_MAX_VERSION_LEN, "Vulkan %d.%d.%d", 
-            VK_VERSION_MAJOR(props.apiVersion),
-            VK_VERSION_MINOR(props.apiVersion),
-            VK_VERSION_PATCH(props.apiVersion));
-        
-        d->is_available = 1;
-        d->performance_score = 80.0f; // Vulkan 獲取的信息最完整
-        
-        count++;
-    }
-    
-    free(physical_devices);
-    vkDestroyInstance_dyn(instance, NULL);
-    
-#ifdef _WIN32
-    FreeLibrary(vulkan_lib);
-#endif
-    
-    return count;
-}
-
 // DXGI 硬體查詢 (Windows 10+)
 #ifdef _WIN32
 #include <dxgi.h>
@@ -424,46 +280,481 @@ static int query_linux_gpu_sysfs(retryix_device_t* devices, int max_devices) {
 
 #endif
 
-// 統一的原生硬體偵測接口 - 分層回退策略
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_native(
-    retryix_device_t* devices,
-    int max_devices,
-    int* device_count
-) {
-    if (!devices || !device_count || max_devices <= 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+// Vulkan 硬體查詢 (跨平台,優先使用)
+static int query_vulkan_gpu(retryix_device_t* devices, int max_devices) {
+    int count = 0;
+    
+    PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices_dyn = RETRYIX_VK(vkEnumeratePhysicalDevices);
+    PFN_vkGetPhysicalDeviceProperties vkGetPhysicalDeviceProperties_dyn = RETRYIX_VK(vkGetPhysicalDeviceProperties);
+    PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties_dyn = RETRYIX_VK(vkGetPhysicalDeviceMemoryProperties);
+    if (!vkEnumeratePhysicalDevices_dyn || !vkGetPhysicalDeviceProperties_dyn || !vkGetPhysicalDeviceMemoryProperties_dyn) {
+        return 0;
     }
     
-    *device_count = 0;
-    int count = 0;
+    // 共用 Vulkan 實例 (首次使用時建立)
+    VkInstance instance = retryix_vulkan_instance_acquire();
+    if (instance == VK_NULL_HANDLE) {
+        return 0;
+    }
+    
+    // 枚舉物理設備
+    uint32_t device_count = 0;
+    VkResult result = vkEnumeratePhysicalDevices_dyn(instance, &device_count, NULL);
     
-    // 第 1 層: 嘗試 Vulkan (最詳細,跨平台)
-    count = query_vulkan_gpu(devices, max_devices);
-    if (count > 0) {
-        *device_count = count;
-        return RETRYIX_SUCCESS;
+    if (result != VK_SUCCESS || device_count == 0) {
+        retryix_vulkan_instance_release(instance);
+        return 0;
     }
     
-#ifdef _WIN32
-    // 第 2 層: 嘗試 DXGI (Windows 原生,較詳細)
-    count = query_windows_gpu_dxgi(devices, max_devices);
-    if (count > 0) {
-        *device_count = count;
-        return RETRYIX_SUCCESS;
+    if (device_count > (uint32_t)max_devices) {
+        device_count = (uint32_t)max_devices;
     }
     
-    // 第 3 層: 降級到註冊表 (最基本)
-    count = query_windows_gpu_registry(devices, max_devices);
-    *device_count = count;
+    VkPhysicalDevice* physical_devices = (VkPhysicalDevice*)malloc(sizeof(VkPhysicalDevice) * device_count);
+    if (!physical_devices) {
+        retryix_vulkan_instance_release(instance);
+        return 0;
+    }
     
-#elif defined(__linux__)
-    // Linux: 嘗試 sysfs
-    count = query_linux_gpu_sysfs(devices, max_devices);
-    *device_count = count;
+    result = vkEnumeratePhysicalDevices_dyn(instance, &device_count, physical_devices);
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE) {  // 截斷到 max_devices 時回傳 VK_INCOMPLETE
+        free(physical_devices);
+        retryix_vulkan_instance_release(instance);
+        return 0;
+    }
+    
+    for (uint32_t i = 0; i < device_count; i++) {
+        VkPhysicalDeviceProperties props;
+        VkPhysicalDeviceMemoryProperties mem_props;
+        
+        vkGetPhysicalDeviceProperties_dyn(physical_devices[i], &props);
+        vkGetPhysicalDeviceMemoryProperties_dyn(physical_devices[i], &mem_props);
+        
+        retryix_device_t* d = &devices[count];
+        memset(d, 0, sizeof(*d));
+        d->struct_size = sizeof(retryix_device_t);
+        d->struct_version = 0x00010000;
+        
+        // 設備名稱與類型 (軟體光柵如 llvmpipe 回報為 CPU)
+        strncpy(d->name, props.deviceName, RETRYIX_MAX_NAME_LEN - 1);
+        d->type = (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) ? CL_DEVICE_TYPE_CPU : CL_DEVICE_TYPE_GPU;
+        
+        // 判斷供應商
+        if (props.vendorID == 0x1002) { // AMD
+            strncpy(d->vendor, "Advanced Micro Devices, Inc.", RETRYIX_MAX_NAME_LEN - 1);
+            d->custom_flags |= 0x01;
+            if (strstr(props.deviceName, "RX 5") || strstr(props.deviceName, "5700")) {
+                d->is_amd_rx5000 = 1;
+            }
+        } else if (props.vendorID == 0x10DE) { // NVIDIA
+            strncpy(d->vendor, "NVIDIA Corporation", RETRYIX_MAX_NAME_LEN - 1);
+            d->custom_flags |= 0x02;
+        } else if (props.vendorID == 0x8086) { // Intel
+            strncpy(d->vendor, "Intel Corporation", RETRYIX_MAX_NAME_LEN - 1);
+        }
+        
+        // 計算總 VRAM (所有 DEVICE_LOCAL 內存堆)
+        cl_ulong total_vram = 0;
+        for (uint32_t j = 0; j < mem_props.memoryHeapCount; j++) {
+            if (mem_props.memoryHeaps[j].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                total_vram += mem_props.memoryHeaps[j].size;
+            }
+        }
+        d->global_memory = total_vram;
+        
+        // Vulkan API 版本
+        snprintf(d->version, RETRYIX_MAX_VERSION_LEN, "Vulkan %d.%d.%d", 
+            VK_VERSION_MAJOR(props.apiVersion),
+            VK_VERSION_MINOR(props.apiVersion),
+            VK_VERSION_PATCH(props.apiVersion));
+        
+        d->is_available = 1;
+        d->performance_score = 80.0f; // Vulkan 獲取的信息最完整
+        
+        count++;
+    }
     
+    free(physical_devices);
+    retryix_vulkan_instance_release(instance);
+    
+    return count;
+}
+
+// ===================== 並行後端探測 =====================
+// 各後端 (Vulkan / CUDA / ROCm / Level Zero / 平台原生) 可能各自 dlopen 並初始化沉重的執行時,
+// 在小型執行緒池上同時探測。結果依固定優先序決定 (與完成先後無關):
+// 取優先序最高且找到設備的後端; prefer_gpu 時只有含 GPU 的結果算數,
+// 一旦所有更高優先序的探測都已結束, 其餘探測即取消 (尚未開始的不再啟動)。
+// 逾時的探測被放棄, 其執行緒在背景自行結束並釋放共享狀態。
+// 設備註冊表的橋接後備探測共用同一 session, 但改為等所有探測結束後依序合併結果。
+
+#define NATIVE_PROBE_DEFAULT_TIMEOUT_MS 2000
+#define NATIVE_PROBE_DEFAULT_THREADS    4
+
+typedef int (*native_probe_fn)(retryix_device_t* devices, int max_devices);
+
+// 橋接模組 (CUDA/ROCm/L0) 以執行期符號查找, 未連結時視為無設備
+static int probe_bridge(const char* symbol, retryix_device_t* devices, int max_devices) {
+    typedef retryix_result_t (RETRYIX_CALL *bridge_discover_fn)(retryix_platform_t*, int, int*);
+#ifdef _WIN32
+    bridge_discover_fn fn = (bridge_discover_fn)DLSYM(GetModuleHandleA(NULL), symbol);
 #else
-    return RETRYIX_ERROR_NOT_SUPPORTED;
+    bridge_discover_fn fn = (bridge_discover_fn)DLSYM(RTLD_DEFAULT, symbol);
 #endif
-    
-    return (*device_count > 0) ? RETRYIX_SUCCESS : RETRYIX_ERROR_NO_DEVICE;
+    if (!fn) return 0;
+
+    retryix_platform_t* plats = (retryix_platform_t*)calloc((size_t)max_devices, sizeof(retryix_platform_t));
+    if (!plats) return 0;
+    int pc = 0;
+    int count = 0;
+    if (fn(plats, max_devices, &pc) == RETRYIX_SUCCESS) {
+        for (int i = 0; i < pc && count < max_devices; i++) {
+            retryix_device_t* d = &devices[count++];
+            memset(d, 0, sizeof(*d));
+            d->struct_size = sizeof(retryix_device_t);
+            d->struct_version = 0x00010000;
+            strncpy(d->name, plats[i].name, RETRYIX_MAX_NAME_LEN - 1);
+            strncpy(d->vendor, plats[i].vendor, RETRYIX_MAX_NAME_LEN - 1);
+            strncpy(d->version, plats[i].version, RETRYIX_MAX_VERSION_LEN - 1);
+            d->type = CL_DEVICE_TYPE_GPU;
+            d->is_available = 1;
+            d->performance_score = 70.0f;
+        }
+    }
+    free(plats);
+    return count;
+}
+
+static int probe_cuda(retryix_device_t* devices, int max_devices) {
+    return probe_bridge("retryix_discover_cuda_platforms", devices, max_devices);
+}
+
+static int probe_rocm(retryix_device_t* devices, int max_devices) {
+    return probe_bridge("retryix_discover_rocm_platforms", devices, max_devices);
+}
+
+static int probe_intel_l0(retryix_device_t* devices, int max_devices) {
+    return probe_bridge("retryix_discover_intel_l0_platforms", devices, max_devices);
+}
+
+static int probe_opencl_intel(retryix_device_t* devices, int max_devices) {
+    return probe_bridge("retryix_discover_opencl_intel_platforms", devices, max_devices);
+}
+
+static int probe_apple_metal(retryix_device_t* devices, int max_devices) {
+    return probe_bridge("retryix_discover_apple_metal_platforms", devices, max_devices);
+}
+
+typedef struct {
+    const char* name;
+    native_probe_fn fn;
+} native_probe_entry_t;
+
+// 陣列順序即優先序
+static const native_probe_entry_t g_native_probes[] = {
+    { "vulkan",     query_vulkan_gpu },
+    { "cuda",       probe_cuda },
+    { "rocm",       probe_rocm },
+    { "level_zero", probe_intel_l0 },
+#ifdef _WIN32
+    { "dxgi",       query_windows_gpu_dxgi },
+    { "registry",   query_windows_gpu_registry },
+#elif defined(__linux__)
+    { "sysfs",      query_linux_gpu_sysfs },
+#endif
+};
+#define NATIVE_PROBE_COUNT ((int)(sizeof(g_native_probes) / sizeof(g_native_probes[0])))
+
+// 設備註冊表在 OpenCL 找不到設備時的橋接後備, 結果依陣列順序合併
+static const native_probe_entry_t g_bridge_probes[] = {
+    { "cuda",         probe_cuda },
+    { "rocm",         probe_rocm },
+    { "level_zero",   probe_intel_l0 },
+    { "opencl_intel", probe_opencl_intel },
+    { "metal",        probe_apple_metal },
+};
+#define BRIDGE_PROBE_COUNT ((int)(sizeof(g_bridge_probes) / sizeof(g_bridge_probes[0])))
+
+#define PROBE_SLOT_MAX  8                  // 單一 session 最多探測數, 需不小於上面兩表
+typedef char probe_slot_max_check[(NATIVE_PROBE_COUNT <= PROBE_SLOT_MAX && BRIDGE_PROBE_COUNT <= PROBE_SLOT_MAX) ? 1 : -1];
+
+typedef enum {
+    NATIVE_PROBE_PENDING = 0,
+    NATIVE_PROBE_RUNNING,
+    NATIVE_PROBE_DONE,
+    NATIVE_PROBE_TIMED_OUT,
+    NATIVE_PROBE_CANCELLED
+} native_probe_state_t;
+
+typedef struct {
+    native_probe_state_t state;
+    unsigned long long start_ms;
+    int count;
+    int has_gpu;
+    retryix_device_t* devices;             // 每個探測獨立的輸出區, 逾時後工作執行緒仍可能寫入
+} native_probe_slot_t;
+
+typedef struct {
+#ifdef _WIN32
+    SRWLOCK lock;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+    int refs;                              // 協調者 + 仍在執行的工作執行緒, 歸零者釋放
+    int next;                              // 下一個待領取的探測
+    int cancelled;
+    int capacity;
+    const native_probe_entry_t* probes;
+    int probe_count;
+    native_probe_slot_t slots[PROBE_SLOT_MAX];
+} native_probe_session_t;
+
+#ifdef _WIN32
+#define PROBE_LOCK(s)   AcquireSRWLockExclusive(&(s)->lock)
+#define PROBE_UNLOCK(s) ReleaseSRWLockExclusive(&(s)->lock)
+#define PROBE_SIGNAL(s) WakeAllConditionVariable(&(s)->cond)
+#else
+#define PROBE_LOCK(s)   pthread_mutex_lock(&(s)->lock)
+#define PROBE_UNLOCK(s) pthread_mutex_unlock(&(s)->lock)
+#define PROBE_SIGNAL(s) pthread_cond_broadcast(&(s)->cond)
+#endif
+
+static unsigned long long probe_now_ms(void) {
+#ifdef _WIN32
+    return (unsigned long long)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000ull + (unsigned long long)ts.tv_nsec / 1000000ull;
+#endif
+}
+
+static void probe_wait(native_probe_session_t* s, unsigned long long wait_ms) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(&s->cond, &s->lock, (DWORD)wait_ms, 0);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)(wait_ms / 1000);
+    ts.tv_nsec += (long)(wait_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&s->cond, &s->lock, &ts);
+#endif
+}
+
+// 呼叫者持有鎖; 回傳 1 表示已由此呼叫釋放 session
+static int probe_release_locked(native_probe_session_t* s) {
+    if (--s->refs > 0) return 0;
+    PROBE_UNLOCK(s);
+#ifndef _WIN32
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+#endif
+    for (int i = 0; i < s->probe_count; i++) free(s->slots[i].devices);
+    free(s);
+    return 1;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI probe_worker(LPVOID arg)
+#else
+static void* probe_worker(void* arg)
+#endif
+{
+    native_probe_session_t* s = (native_probe_session_t*)arg;
+    PROBE_LOCK(s);
+    while (!s->cancelled && s->next < s->probe_count) {
+        int i = s->next++;
+        native_probe_slot_t* slot = &s->slots[i];
+        slot->state = NATIVE_PROBE_RUNNING;
+        slot->start_ms = probe_now_ms();
+        PROBE_UNLOCK(s);
+
+        int count = s->probes[i].fn(slot->devices, s->capacity);
+
+        PROBE_LOCK(s);
+        if (slot->state == NATIVE_PROBE_RUNNING) {
+            slot->state = NATIVE_PROBE_DONE;
+            slot->count = count;
+            for (int k = 0; k < count; k++) {
+                if (slot->devices[k].type & CL_DEVICE_TYPE_GPU) slot->has_gpu = 1;
+            }
+        }
+        PROBE_SIGNAL(s);
+    }
+    if (!probe_release_locked(s)) PROBE_UNLOCK(s);
+    return 0;
+}
+
+// 呼叫者持有鎖
+static int probe_spawn_locked(native_probe_session_t* s) {
+    s->refs++;
+#ifdef _WIN32
+    HANDLE h = CreateThread(NULL, 0, probe_worker, s, 0, NULL);
+    if (h) {
+        CloseHandle(h);
+        return 1;
+    }
+#else
+    pthread_t t;
+    if (pthread_create(&t, NULL, probe_worker, s) == 0) {
+        pthread_detach(t);
+        return 1;
+    }
+#endif
+    s->refs--;
+    return 0;
+}
+
+// merge = 0: 取優先序最高的結果; merge = 1: 等所有探測結束 (或逾時) 後依序合併
+static retryix_result_t probe_backends_parallel(const native_probe_entry_t* probes, int probe_count, int merge,
+                                                retryix_device_t* devices, int max_devices, int* device_count,
+                                                const retryix_native_probe_options_t* options) {
+    int prefer_gpu = (options && !merge) ? options->prefer_gpu : 0;
+    unsigned long long timeout_ms = (options && options->timeout_ms) ? options->timeout_ms : NATIVE_PROBE_DEFAULT_TIMEOUT_MS;
+    int threads = (options && options->max_threads > 0) ? options->max_threads : NATIVE_PROBE_DEFAULT_THREADS;
+    if (threads > probe_count) threads = probe_count;
+
+    native_probe_session_t* s = (native_probe_session_t*)calloc(1, sizeof(native_probe_session_t));
+    if (!s) return RETRYIX_ERROR_OUT_OF_MEMORY;
+    s->probes = probes;
+    s->probe_count = probe_count;
+    s->capacity = max_devices < RETRYIX_MAX_DEVICES ? max_devices : RETRYIX_MAX_DEVICES;
+    for (int i = 0; i < probe_count; i++) {
+        s->slots[i].devices = (retryix_device_t*)calloc((size_t)s->capacity, sizeof(retryix_device_t));
+        if (!s->slots[i].devices) {
+            for (int k = 0; k < i; k++) free(s->slots[k].devices);
+            free(s);
+            return RETRYIX_ERROR_OUT_OF_MEMORY;
+        }
+    }
+#ifdef _WIN32
+    InitializeSRWLock(&s->lock);
+    InitializeConditionVariable(&s->cond);
+#else
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+#endif
+    s->refs = 1;
+
+    PROBE_LOCK(s);
+    int spawned = 0;
+    for (int t = 0; t < threads; t++) spawned += probe_spawn_locked(s);
+    if (spawned == 0) {
+        // 無法建立執行緒時在目前執行緒依序探測
+        PROBE_UNLOCK(s);
+        s->refs++;
+        probe_worker(s);
+        PROBE_LOCK(s);
+    }
+
+    int winner = -1;
+    for (;;) {
+        unsigned long long now = probe_now_ms();
+        unsigned long long wait_ms = timeout_ms;
+        int finished = 0;
+        for (int i = 0; i < probe_count; i++) {
+            native_probe_slot_t* slot = &s->slots[i];
+            if (slot->state == NATIVE_PROBE_RUNNING) {
+                unsigned long long elapsed = now - slot->start_ms;
+                if (elapsed >= timeout_ms) {
+                    slot->state = NATIVE_PROBE_TIMED_OUT;
+                    // 卡住的工作執行緒不再計入, 補一個新的繼續領取剩餘探測
+                    if (s->next < probe_count) probe_spawn_locked(s);
+                } else {
+                    if (timeout_ms - elapsed < wait_ms) wait_ms = timeout_ms - elapsed;
+                }
+            }
+            if (slot->state >= NATIVE_PROBE_DONE) finished++;
+        }
+
+        // 依優先序: 遇到尚未結束的探測就必須等它
+        int undecided = merge;
+        for (int i = 0; i < probe_count && winner < 0 && !undecided; i++) {
+            native_probe_slot_t* slot = &s->slots[i];
+            if (slot->state < NATIVE_PROBE_DONE) undecided = 1;
+            else if (slot->state == NATIVE_PROBE_DONE && slot->count > 0 && (!prefer_gpu || slot->has_gpu)) winner = i;
+        }
+        if (winner >= 0) break;
+        if (finished == probe_count) {
+            // prefer_gpu 但沒有任何 GPU: 退回優先序最高的非空結果
+            for (int i = 0; i < probe_count && winner < 0 && !merge; i++) {
+                if (s->slots[i].state == NATIVE_PROBE_DONE && s->slots[i].count > 0) winner = i;
+            }
+            break;
+        }
+        if (s->refs == 1 && s->next < probe_count && !probe_spawn_locked(s)) break;   // 沒有執行緒能推進剩餘探測
+        probe_wait(s, wait_ms ? wait_ms : 1);
+    }
+
+    s->cancelled = 1;
+    for (int i = 0; i < probe_count; i++) {
+        native_probe_slot_t* slot = &s->slots[i];
+        if (slot->state == NATIVE_PROBE_PENDING) slot->state = NATIVE_PROBE_CANCELLED;
+        if (getenv("RETRYIX_DEBUG")) {
+            static const char* state_names[] = { "pending", "running", "done", "timed out", "cancelled" };
+            fprintf(stderr, "[retryix_discover_devices_native] probe %-10s %-9s devices=%d%s\n",
+                    probes[i].name, state_names[slot->state],
+                    slot->state == NATIVE_PROBE_DONE ? slot->count : 0,
+                    (i == winner || (merge && slot->state == NATIVE_PROBE_DONE && slot->count > 0)) ? " <- selected" : "");
+        }
+    }
+
+    int count = 0;
+    if (merge) {
+        for (int i = 0; i < probe_count && count < max_devices; i++) {
+            native_probe_slot_t* slot = &s->slots[i];
+            if (slot->state != NATIVE_PROBE_DONE) continue;
+            int n = slot->count < max_devices - count ? slot->count : max_devices - count;
+            memcpy(devices + count, slot->devices, sizeof(retryix_device_t) * (size_t)n);
+            count += n;
+        }
+    } else if (winner >= 0) {
+        count = s->slots[winner].count < max_devices ? s->slots[winner].count : max_devices;
+        memcpy(devices, s->slots[winner].devices, sizeof(retryix_device_t) * (size_t)count);
+    }
+    *device_count = count;
+    if (!probe_release_locked(s)) PROBE_UNLOCK(s);
+
+    return (count > 0) ? RETRYIX_SUCCESS : RETRYIX_ERROR_NO_DEVICE;
+}
+
+// 統一的原生硬體偵測接口 - 並行探測, 依優先序取結果
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_native_ex(
+    retryix_device_t* devices,
+    int max_devices,
+    int* device_count,
+    const retryix_native_probe_options_t* options
+) {
+    if (!devices || !device_count || max_devices <= 0) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+    *device_count = 0;
+    return probe_backends_parallel(g_native_probes, NATIVE_PROBE_COUNT, 0, devices, max_devices, device_count, options);
+}
+
+retryix_result_t retryix_probe_bridges_parallel(
+    retryix_device_t* devices,
+    int max_devices,
+    int* device_count,
+    const retryix_native_probe_options_t* options
+) {
+    if (!devices || !device_count || max_devices <= 0) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+    *device_count = 0;
+    return probe_backends_parallel(g_bridge_probes, BRIDGE_PROBE_COUNT, 1, devices, max_devices, device_count, options);
+}
+
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_devices_native(
+    retryix_device_t* devices,
+    int max_devices,
+    int* device_count
+) {
+    return retryix_discover_devices_native_ex(devices, max_devices, device_count, NULL);
 }
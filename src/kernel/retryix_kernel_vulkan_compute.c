@@ -14,54 +14,56 @@
 #include <vulkan/vulkan.h>
 
 // === Vulkan 動態函數加載 ===
-static HMODULE g_vulkan_lib = NULL;
+// 程式庫、全域/實例層函數與 VkInstance 由共用載入器提供 (與裝置探測共用);
+// 裝置層函數在第一次使用時經 vkGetDeviceProcAddr 解析並快取, 裝置重建時清空
+#include "retryix_runtime_loader_internal.h"
 
-// Instance functions  
-static PFN_vkCreateInstance vkCreateInstance_dyn = NULL;
-static PFN_vkDestroyInstance vkDestroyInstance_dyn = NULL;
-static PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices_dyn = NULL;
-static PFN_vkGetPhysicalDeviceProperties vkGetPhysicalDeviceProperties_dyn = NULL;
-static PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties_dyn = NULL;
-static PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties_dyn = NULL;
-static PFN_vkCreateDevice vkCreateDevice_dyn = NULL;
-static PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr_dyn = NULL;
+#define VK_DEVICE_FUNCS(X) \
+    X(vkDestroyDevice) \
+    X(vkGetDeviceQueue) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkQueueSubmit) \
+    X(vkQueueWaitIdle) \
+    X(vkCreateBuffer) \
+    X(vkDestroyBuffer) \
+    X(vkGetBufferMemoryRequirements) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkBindBufferMemory) \
+    X(vkMapMemory) \
+    X(vkUnmapMemory) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdDispatch) \
+    X(vkCmdPushConstants) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateComputePipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreateDescriptorPool) \
+    X(vkDestroyDescriptorPool) \
+    X(vkAllocateDescriptorSets) \
+    X(vkFreeDescriptorSets) \
+    X(vkUpdateDescriptorSets)
 
-// Device functions (will be loaded per-device)
-static PFN_vkDestroyDevice vkDestroyDevice_dyn = NULL;
-static PFN_vkGetDeviceQueue vkGetDeviceQueue_dyn = NULL;
-static PFN_vkCreateCommandPool vkCreateCommandPool_dyn = NULL;
-static PFN_vkDestroyCommandPool vkDestroyCommandPool_dyn = NULL;
-static PFN_vkAllocateCommandBuffers vkAllocateCommandBuffers_dyn = NULL;
-static PFN_vkBeginCommandBuffer vkBeginCommandBuffer_dyn = NULL;
-static PFN_vkEndCommandBuffer vkEndCommandBuffer_dyn = NULL;
-static PFN_vkQueueSubmit vkQueueSubmit_dyn = NULL;
-static PFN_vkQueueWaitIdle vkQueueWaitIdle_dyn = NULL;
-static PFN_vkCreateBuffer vkCreateBuffer_dyn = NULL;
-static PFN_vkDestroyBuffer vkDestroyBuffer_dyn = NULL;
-static PFN_vkGetBufferMemoryRequirements vkGetBufferMemoryRequirements_dyn = NULL;
-static PFN_vkAllocateMemory vkAllocateMemory_dyn = NULL;
-static PFN_vkFreeMemory vkFreeMemory_dyn = NULL;
-static PFN_vkBindBufferMemory vkBindBufferMemory_dyn = NULL;
-static PFN_vkMapMemory vkMapMemory_dyn = NULL;
-static PFN_vkUnmapMemory vkUnmapMemory_dyn = NULL;
-static PFN_vkCmdCopyBuffer vkCmdCopyBuffer_dyn = NULL;
-static PFN_vkCmdBindPipeline vkCmdBindPipeline_dyn = NULL;
-static PFN_vkCmdBindDescriptorSets vkCmdBindDescriptorSets_dyn = NULL;
-static PFN_vkCmdDispatch vkCmdDispatch_dyn = NULL;
-static PFN_vkCmdPushConstants vkCmdPushConstants_dyn = NULL;
-static PFN_vkCreateShaderModule vkCreateShaderModule_dyn = NULL;
-static PFN_vkDestroyShaderModule vkDestroyShaderModule_dyn = NULL;
-static PFN_vkCreateDescriptorSetLayout vkCreateDescriptorSetLayout_dyn = NULL;
-static PFN_vkDestroyDescriptorSetLayout vkDestroyDescriptorSetLayout_dyn = NULL;
-static PFN_vkCreatePipelineLayout vkCreatePipelineLayout_dyn = NULL;
-static PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout_dyn = NULL;
-static PFN_vkCreateComputePipelines vkCreateComputePipelines_dyn = NULL;
-static PFN_vkDestroyPipeline vkDestroyPipeline_dyn = NULL;
-static PFN_vkCreateDescriptorPool vkCreateDescriptorPool_dyn = NULL;
-static PFN_vkDestroyDescriptorPool vkDestroyDescriptorPool_dyn = NULL;
-static PFN_vkAllocateDescriptorSets vkAllocateDescriptorSets_dyn = NULL;
-static PFN_vkFreeDescriptorSets vkFreeDescriptorSets_dyn = NULL;
-static PFN_vkUpdateDescriptorSets vkUpdateDescriptorSets_dyn = NULL;
+#define VK_DEVICE_FN_ENUM(name) VKD_##name,
+enum { VK_DEVICE_FUNCS(VK_DEVICE_FN_ENUM) VKD_COUNT };
+#undef VK_DEVICE_FN_ENUM
+
+#define VK_DEVICE_FN_NAME(name) #name,
+static const char* const g_vk_device_fn_names[VKD_COUNT] = { VK_DEVICE_FUNCS(VK_DEVICE_FN_NAME) };
+#undef VK_DEVICE_FN_NAME
+
+static PFN_vkVoidFunction g_vk_device_fns[VKD_COUNT];
 
 // === Vulkan GPU 上下文 ===
 typedef struct {
@@ -85,6 +87,22 @@ typedef struct {
 
 static vulkan_compute_context_t g_vk_ctx = {0};
 
+static PFN_vkVoidFunction vk_device_fn(int index) {
+    if (!g_vk_device_fns[index]) {
+        g_vk_device_fns[index] = RETRYIX_VK(vkGetDeviceProcAddr)(g_vk_ctx.device, g_vk_device_fn_names[index]);
+    }
+    return g_vk_device_fns[index];
+}
+
+#define VKD(name) ((PFN_##name)vk_device_fn(VKD_##name))
+
+static void vk_release_instance(void) {
+    if (g_vk_ctx.instance != VK_NULL_HANDLE) {
+        retryix_vulkan_instance_release(g_vk_ctx.instance);
+        g_vk_ctx.instance = VK_NULL_HANDLE;
+    }
+}
+
 // === 初始化 Vulkan compute 上下文 ===
 int retryix_vulkan_compute_init() {
     if (g_vk_ctx.initialized) {
@@ -93,67 +111,36 @@ int retryix_vulkan_compute_init() {
     
     printf("[Vulkan Compute] Initializing RetryIX Vulkan compute engine...\n");
     
-#ifdef _WIN32
-    g_vulkan_lib = LoadLibraryA("vulkan-1.dll");
-    if (!g_vulkan_lib) {
-        printf("[Vulkan Compute] ERROR: Failed to load vulkan-1.dll\n");
+    if (!RETRYIX_VK(vkEnumeratePhysicalDevices) || !RETRYIX_VK(vkCreateDevice) || !RETRYIX_VK(vkGetDeviceProcAddr)) {
+        printf("[Vulkan Compute] ERROR: Vulkan loader not available\n");
         return 0;
     }
     
-    // Load instance functions
-    vkCreateInstance_dyn = (PFN_vkCreateInstance)GetProcAddress(g_vulkan_lib, "vkCreateInstance");
-    vkDestroyInstance_dyn = (PFN_vkDestroyInstance)GetProcAddress(g_vulkan_lib, "vkDestroyInstance");
-    vkEnumeratePhysicalDevices_dyn = (PFN_vkEnumeratePhysicalDevices)GetProcAddress(g_vulkan_lib, "vkEnumeratePhysicalDevices");
-    vkGetPhysicalDeviceProperties_dyn = (PFN_vkGetPhysicalDeviceProperties)GetProcAddress(g_vulkan_lib, "vkGetPhysicalDeviceProperties");
-    vkGetPhysicalDeviceQueueFamilyProperties_dyn = (PFN_vkGetPhysicalDeviceQueueFamilyProperties)GetProcAddress(g_vulkan_lib, "vkGetPhysicalDeviceQueueFamilyProperties");
-    vkGetPhysicalDeviceMemoryProperties_dyn = (PFN_vkGetPhysicalDeviceMemoryProperties)GetProcAddress(g_vulkan_lib, "vkGetPhysicalDeviceMemoryProperties");
-    vkCreateDevice_dyn = (PFN_vkCreateDevice)GetProcAddress(g_vulkan_lib, "vkCreateDevice");
-    vkGetDeviceProcAddr_dyn = (PFN_vkGetDeviceProcAddr)GetProcAddress(g_vulkan_lib, "vkGetDeviceProcAddr");
-    
-    if (!vkCreateInstance_dyn || !vkEnumeratePhysicalDevices_dyn || !vkCreateDevice_dyn) {
-        printf("[Vulkan Compute] ERROR: Failed to load required Vulkan functions\n");
-        FreeLibrary(g_vulkan_lib);
+    // 共用 Vulkan 實例 (裝置探測已建立時直接沿用)
+    g_vk_ctx.instance = retryix_vulkan_instance_acquire();
+    if (g_vk_ctx.instance == VK_NULL_HANDLE) {
+        printf("[Vulkan Compute] ERROR: Failed to create Vulkan instance\n");
         return 0;
     }
-#endif
     
-    // Create Vulkan instance
-    VkApplicationInfo app_info = {0};
-    app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    app_info.pApplicationName = "RetryIX Compute";
-    app_info.applicationVersion = VK_MAKE_VERSION(3, 0, 0);
-    app_info.pEngineName = "LuBan";
-    app_info.engineVersion = VK_MAKE_VERSION(3, 0, 0);
-    app_info.apiVersion = VK_API_VERSION_1_0;
-    
-    VkInstanceCreateInfo create_info = {0};
-    create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-    create_info.pApplicationInfo = &app_info;
-    
-    VkResult result = vkCreateInstance_dyn(&create_info, NULL, &g_vk_ctx.instance);
-    if (result != VK_SUCCESS) {
-        printf("[Vulkan Compute] ERROR: Failed to create Vulkan instance (error %d)\n", result);
-        return 0;
-    }
-    
-    printf("[Vulkan Compute] Vulkan instance created\n");
+    printf("[Vulkan Compute] Vulkan instance ready (shared)\n");
     
     // Enumerate physical devices
     uint32_t device_count = 0;
-    result = vkEnumeratePhysicalDevices_dyn(g_vk_ctx.instance, &device_count, NULL);
+    VkResult result = RETRYIX_VK(vkEnumeratePhysicalDevices)(g_vk_ctx.instance, &device_count, NULL);
     if (result != VK_SUCCESS || device_count == 0) {
         printf("[Vulkan Compute] ERROR: No Vulkan devices found\n");
-        vkDestroyInstance_dyn(g_vk_ctx.instance, NULL);
+        vk_release_instance();
         return 0;
     }
     
     VkPhysicalDevice* physical_devices = (VkPhysicalDevice*)malloc(sizeof(VkPhysicalDevice) * device_count);
-    result = vkEnumeratePhysicalDevices_dyn(g_vk_ctx.instance, &device_count, physical_devices);
+    result = RETRYIX_VK(vkEnumeratePhysicalDevices)(g_vk_ctx.instance, &device_count, physical_devices);
     
     // Select first discrete GPU (or any GPU)
     for (uint32_t i = 0; i < device_count; i++) {
         VkPhysicalDeviceProperties props;
-        vkGetPhysicalDeviceProperties_dyn(physical_devices[i], &props);
+        RETRYIX_VK(vkGetPhysicalDeviceProperties)(physical_devices[i], &props);
         
         printf("[Vulkan Compute] Device %d: %s\n", i, props.deviceName);
         
@@ -169,19 +156,19 @@ int retryix_vulkan_compute_init() {
     
     if (g_vk_ctx.physical_device == VK_NULL_HANDLE) {
         printf("[Vulkan Compute] ERROR: No suitable GPU found\n");
-        vkDestroyInstance_dyn(g_vk_ctx.instance, NULL);
+        vk_release_instance();
         return 0;
     }
     
     // Get memory properties
-    vkGetPhysicalDeviceMemoryProperties_dyn(g_vk_ctx.physical_device, &g_vk_ctx.mem_properties);
+    RETRYIX_VK(vkGetPhysicalDeviceMemoryProperties)(g_vk_ctx.physical_device, &g_vk_ctx.mem_properties);
     
     // Find compute queue family
     uint32_t queue_family_count = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties_dyn(g_vk_ctx.physical_device, &queue_family_count, NULL);
+    RETRYIX_VK(vkGetPhysicalDeviceQueueFamilyProperties)(g_vk_ctx.physical_device, &queue_family_count, NULL);
     
     VkQueueFamilyProperties* queue_families = (VkQueueFamilyProperties*)malloc(sizeof(VkQueueFamilyProperties) * queue_family_count);
-    vkGetPhysicalDeviceQueueFamilyProperties_dyn(g_vk_ctx.physical_device, &queue_family_count, queue_families);
+    RETRYIX_VK(vkGetPhysicalDeviceQueueFamilyProperties)(g_vk_ctx.physical_device, &queue_family_count, queue_families);
     
     g_vk_ctx.compute_queue_family = UINT32_MAX;
     for (uint32_t i = 0; i < queue_family_count; i++) {
@@ -196,7 +183,7 @@ int retryix_vulkan_compute_init() {
     
     if (g_vk_ctx.compute_queue_family == UINT32_MAX) {
         printf("[Vulkan Compute] ERROR: No compute queue family found\n");
-        vkDestroyInstance_dyn(g_vk_ctx.instance, NULL);
+        vk_release_instance();
         return 0;
     }
     
@@ -213,54 +200,20 @@ int retryix_vulkan_compute_init() {
     device_create_info.queueCreateInfoCount = 1;
     device_create_info.pQueueCreateInfos = &queue_create_info;
     
-    result = vkCreateDevice_dyn(g_vk_ctx.physical_device, &device_create_info, NULL, &g_vk_ctx.device);
+    result = RETRYIX_VK(vkCreateDevice)(g_vk_ctx.physical_device, &device_create_info, NULL, &g_vk_ctx.device);
     if (result != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: Failed to create logical device (error %d)\n", result);
-        vkDestroyInstance_dyn(g_vk_ctx.instance, NULL);
+        vk_release_instance();
         return 0;
     }
     
     printf("[Vulkan Compute] Logical device created\n");
     
-    // Load device-specific functions
-    vkDestroyDevice_dyn = (PFN_vkDestroyDevice)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyDevice");
-    vkGetDeviceQueue_dyn = (PFN_vkGetDeviceQueue)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkGetDeviceQueue");
-    vkCreateCommandPool_dyn = (PFN_vkCreateCommandPool)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreateCommandPool");
-    vkDestroyCommandPool_dyn = (PFN_vkDestroyCommandPool)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyCommandPool");
-    vkAllocateCommandBuffers_dyn = (PFN_vkAllocateCommandBuffers)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkAllocateCommandBuffers");
-    vkBeginCommandBuffer_dyn = (PFN_vkBeginCommandBuffer)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkBeginCommandBuffer");
-    vkEndCommandBuffer_dyn = (PFN_vkEndCommandBuffer)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkEndCommandBuffer");
-    vkQueueSubmit_dyn = (PFN_vkQueueSubmit)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkQueueSubmit");
-    vkQueueWaitIdle_dyn = (PFN_vkQueueWaitIdle)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkQueueWaitIdle");
-    vkCreateBuffer_dyn = (PFN_vkCreateBuffer)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreateBuffer");
-    vkDestroyBuffer_dyn = (PFN_vkDestroyBuffer)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyBuffer");
-    vkGetBufferMemoryRequirements_dyn = (PFN_vkGetBufferMemoryRequirements)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkGetBufferMemoryRequirements");
-    vkAllocateMemory_dyn = (PFN_vkAllocateMemory)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkAllocateMemory");
-    vkFreeMemory_dyn = (PFN_vkFreeMemory)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkFreeMemory");
-    vkBindBufferMemory_dyn = (PFN_vkBindBufferMemory)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkBindBufferMemory");
-    vkMapMemory_dyn = (PFN_vkMapMemory)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkMapMemory");
-    vkUnmapMemory_dyn = (PFN_vkUnmapMemory)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkUnmapMemory");
-    vkCmdCopyBuffer_dyn = (PFN_vkCmdCopyBuffer)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCmdCopyBuffer");
-    vkCmdBindPipeline_dyn = (PFN_vkCmdBindPipeline)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCmdBindPipeline");
-    vkCmdBindDescriptorSets_dyn = (PFN_vkCmdBindDescriptorSets)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCmdBindDescriptorSets");
-    vkCmdDispatch_dyn = (PFN_vkCmdDispatch)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCmdDispatch");
-    vkCmdPushConstants_dyn = (PFN_vkCmdPushConstants)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCmdPushConstants");
-    vkCreateShaderModule_dyn = (PFN_vkCreateShaderModule)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreateShaderModule");
-    vkDestroyShaderModule_dyn = (PFN_vkDestroyShaderModule)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyShaderModule");
-    vkCreateDescriptorSetLayout_dyn = (PFN_vkCreateDescriptorSetLayout)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreateDescriptorSetLayout");
-    vkDestroyDescriptorSetLayout_dyn = (PFN_vkDestroyDescriptorSetLayout)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyDescriptorSetLayout");
-    vkCreatePipelineLayout_dyn = (PFN_vkCreatePipelineLayout)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreatePipelineLayout");
-    vkDestroyPipelineLayout_dyn = (PFN_vkDestroyPipelineLayout)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyPipelineLayout");
-    vkCreateComputePipelines_dyn = (PFN_vkCreateComputePipelines)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreateComputePipelines");
-    vkDestroyPipeline_dyn = (PFN_vkDestroyPipeline)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyPipeline");
-    vkCreateDescriptorPool_dyn = (PFN_vkCreateDescriptorPool)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkCreateDescriptorPool");
-    vkDestroyDescriptorPool_dyn = (PFN_vkDestroyDescriptorPool)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkDestroyDescriptorPool");
-    vkAllocateDescriptorSets_dyn = (PFN_vkAllocateDescriptorSets)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkAllocateDescriptorSets");
-    vkFreeDescriptorSets_dyn = (PFN_vkFreeDescriptorSets)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkFreeDescriptorSets");
-    vkUpdateDescriptorSets_dyn = (PFN_vkUpdateDescriptorSets)vkGetDeviceProcAddr_dyn(g_vk_ctx.device, "vkUpdateDescriptorSets");
+    // 裝置層函數對應新的 VkDevice, 清空快取後延遲解析
+    memset(g_vk_device_fns, 0, sizeof(g_vk_device_fns));
     
     // Get compute queue
-    vkGetDeviceQueue_dyn(g_vk_ctx.device, g_vk_ctx.compute_queue_family, 0, &g_vk_ctx.compute_queue);
+    VKD(vkGetDeviceQueue)(g_vk_ctx.device, g_vk_ctx.compute_queue_family, 0, &g_vk_ctx.compute_queue);
     
     // Create command pool
     VkCommandPoolCreateInfo pool_info = {0};
@@ -268,11 +221,11 @@ int retryix_vulkan_compute_init() {
     pool_info.queueFamilyIndex = g_vk_ctx.compute_queue_family;
     pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     
-    result = vkCreateCommandPool_dyn(g_vk_ctx.device, &pool_info, NULL, &g_vk_ctx.command_pool);
+    result = VKD(vkCreateCommandPool)(g_vk_ctx.device, &pool_info, NULL, &g_vk_ctx.command_pool);
     if (result != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: Failed to create command pool (error %d)\n", result);
-        vkDestroyDevice_dyn(g_vk_ctx.device, NULL);
-        vkDestroyInstance_dyn(g_vk_ctx.instance, NULL);
+        VKD(vkDestroyDevice)(g_vk_ctx.device, NULL);
+        vk_release_instance();
         return 0;
     }
     
@@ -287,20 +240,14 @@ void retryix_vulkan_compute_cleanup() {
     if (!g_vk_ctx.initialized) return;
     
     if (g_vk_ctx.command_pool != VK_NULL_HANDLE) {
-        vkDestroyCommandPool_dyn(g_vk_ctx.device, g_vk_ctx.command_pool, NULL);
+        VKD(vkDestroyCommandPool)(g_vk_ctx.device, g_vk_ctx.command_pool, NULL);
     }
     if (g_vk_ctx.device != VK_NULL_HANDLE) {
-        vkDestroyDevice_dyn(g_vk_ctx.device, NULL);
+        VKD(vkDestroyDevice)(g_vk_ctx.device, NULL);
     }
-    if (g_vk_ctx.instance != VK_NULL_HANDLE) {
-        vkDestroyInstance_dyn(g_vk_ctx.instance, NULL);
-    }
-    
-#ifdef _WIN32
-    if (g_vulkan_lib) {
-        FreeLibrary(g_vulkan_lib);
-    }
-#endif
+    memset(g_vk_device_fns, 0, sizeof(g_vk_device_fns));
+    vk_release_instance();
+    retryix_runtime_loader_trim();
     
     g_vk_ctx.initialized = 0;
     printf("[Vulkan Compute] Cleanup complete\n");
@@ -377,7 +324,7 @@ static int ensure_pipeline_ready() {
     smci.codeSize = spv_size;
     smci.pCode = (const uint32_t*)spv_code;
     
-    r = vkCreateShaderModule_dyn(dev, &smci, NULL, &g_vk_ctx.cached_shader);
+    r = VKD(vkCreateShaderModule)(dev, &smci, NULL, &g_vk_ctx.cached_shader);
     free(spv_code);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkCreateShaderModule failed %d\n", r);
@@ -399,10 +346,10 @@ static int ensure_pipeline_ready() {
     dslci.bindingCount = 3;
     dslci.pBindings = bindings;
     
-    r = vkCreateDescriptorSetLayout_dyn(dev, &dslci, NULL, &g_vk_ctx.cached_dsl);
+    r = VKD(vkCreateDescriptorSetLayout)(dev, &dslci, NULL, &g_vk_ctx.cached_dsl);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkCreateDescriptorSetLayout failed %d\n", r);
-        vkDestroyShaderModule_dyn(dev, g_vk_ctx.cached_shader, NULL);
+        VKD(vkDestroyShaderModule)(dev, g_vk_ctx.cached_shader, NULL);
         return 0;
     }
     
@@ -419,11 +366,11 @@ static int ensure_pipeline_ready() {
     plci.pushConstantRangeCount = 1;
     plci.pPushConstantRanges = &pcr;
     
-    r = vkCreatePipelineLayout_dyn(dev, &plci, NULL, &g_vk_ctx.cached_pl);
+    r = VKD(vkCreatePipelineLayout)(dev, &plci, NULL, &g_vk_ctx.cached_pl);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkCreatePipelineLayout failed %d\n", r);
-        vkDestroyDescriptorSetLayout_dyn(dev, g_vk_ctx.cached_dsl, NULL);
-        vkDestroyShaderModule_dyn(dev, g_vk_ctx.cached_shader, NULL);
+        VKD(vkDestroyDescriptorSetLayout)(dev, g_vk_ctx.cached_dsl, NULL);
+        VKD(vkDestroyShaderModule)(dev, g_vk_ctx.cached_shader, NULL);
         return 0;
     }
     
@@ -439,12 +386,12 @@ static int ensure_pipeline_ready() {
     cpci.stage = pssci;
     cpci.layout = g_vk_ctx.cached_pl;
     
-    r = vkCreateComputePipelines_dyn(dev, VK_NULL_HANDLE, 1, &cpci, NULL, &g_vk_ctx.cached_pipeline);
+    r = VKD(vkCreateComputePipelines)(dev, VK_NULL_HANDLE, 1, &cpci, NULL, &g_vk_ctx.cached_pipeline);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkCreateComputePipelines failed %d\n", r);
-        vkDestroyPipelineLayout_dyn(dev, g_vk_ctx.cached_pl, NULL);
-        vkDestroyDescriptorSetLayout_dyn(dev, g_vk_ctx.cached_dsl, NULL);
-        vkDestroyShaderModule_dyn(dev, g_vk_ctx.cached_shader, NULL);
+        VKD(vkDestroyPipelineLayout)(dev, g_vk_ctx.cached_pl, NULL);
+        VKD(vkDestroyDescriptorSetLayout)(dev, g_vk_ctx.cached_dsl, NULL);
+        VKD(vkDestroyShaderModule)(dev, g_vk_ctx.cached_shader, NULL);
         return 0;
     }
     
@@ -460,13 +407,13 @@ static int ensure_pipeline_ready() {
     dpci.pPoolSizes = &dps;
     dpci.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;  // 允許單獨釋放
     
-    r = vkCreateDescriptorPool_dyn(dev, &dpci, NULL, &g_vk_ctx.cached_dpool);
+    r = VKD(vkCreateDescriptorPool)(dev, &dpci, NULL, &g_vk_ctx.cached_dpool);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkCreateDescriptorPool failed %d\n", r);
-        vkDestroyPipeline_dyn(dev, g_vk_ctx.cached_pipeline, NULL);
-        vkDestroyPipelineLayout_dyn(dev, g_vk_ctx.cached_pl, NULL);
-        vkDestroyDescriptorSetLayout_dyn(dev, g_vk_ctx.cached_dsl, NULL);
-        vkDestroyShaderModule_dyn(dev, g_vk_ctx.cached_shader, NULL);
+        VKD(vkDestroyPipeline)(dev, g_vk_ctx.cached_pipeline, NULL);
+        VKD(vkDestroyPipelineLayout)(dev, g_vk_ctx.cached_pl, NULL);
+        VKD(vkDestroyDescriptorSetLayout)(dev, g_vk_ctx.cached_dsl, NULL);
+        VKD(vkDestroyShaderModule)(dev, g_vk_ctx.cached_shader, NULL);
         return 0;
     }
     
@@ -501,7 +448,7 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
     dsai.pSetLayouts = &g_vk_ctx.cached_dsl;
     
     VkDescriptorSet dset;
-    r = vkAllocateDescriptorSets_dyn(dev, &dsai, &dset);
+    r = VKD(vkAllocateDescriptorSets)(dev, &dsai, &dset);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkAllocateDescriptorSets failed %d\n", r);
         return 0;
@@ -519,18 +466,18 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
         bci.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
         bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         
-        r = vkCreateBuffer_dyn(dev, &bci, NULL, &buffers[i]);
+        r = VKD(vkCreateBuffer)(dev, &bci, NULL, &buffers[i]);
         if (r != VK_SUCCESS) {
             printf("[Vulkan Compute] ERROR: vkCreateBuffer[%d] failed %d\n", i, r);
             for (int j = 0; j < i; j++) {
-                vkDestroyBuffer_dyn(dev, buffers[j], NULL);
-                vkFreeMemory_dyn(dev, mems[j], NULL);
+                VKD(vkDestroyBuffer)(dev, buffers[j], NULL);
+                VKD(vkFreeMemory)(dev, mems[j], NULL);
             }
             return 0;
         }
         
         VkMemoryRequirements mr;
-        vkGetBufferMemoryRequirements_dyn(dev, buffers[i], &mr);
+        VKD(vkGetBufferMemoryRequirements)(dev, buffers[i], &mr);
         
         uint32_t memIndex = find_memory_type(&g_vk_ctx.mem_properties, 
                                             (uint32_t)mr.memoryTypeBits,
@@ -539,7 +486,7 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
         if (memIndex == UINT32_MAX) {
             printf("[Vulkan Compute] ERROR: No host visible memory\n");
             for (int j = 0; j <= i; j++) {
-                vkDestroyBuffer_dyn(dev, buffers[j], NULL);
+                VKD(vkDestroyBuffer)(dev, buffers[j], NULL);
             }
             return 0;
         }
@@ -549,25 +496,25 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
         mai.allocationSize = mr.size;
         mai.memoryTypeIndex = memIndex;
         
-        r = vkAllocateMemory_dyn(dev, &mai, NULL, &mems[i]);
+        r = VKD(vkAllocateMemory)(dev, &mai, NULL, &mems[i]);
         if (r != VK_SUCCESS) {
             printf("[Vulkan Compute] ERROR: vkAllocateMemory[%d] failed %d\n", i, r);
-            vkDestroyBuffer_dyn(dev, buffers[i], NULL);
+            VKD(vkDestroyBuffer)(dev, buffers[i], NULL);
             for (int j = 0; j < i; j++) {
-                vkDestroyBuffer_dyn(dev, buffers[j], NULL);
-                vkFreeMemory_dyn(dev, mems[j], NULL);
+                VKD(vkDestroyBuffer)(dev, buffers[j], NULL);
+                VKD(vkFreeMemory)(dev, mems[j], NULL);
             }
             return 0;
         }
         
-        r = vkBindBufferMemory_dyn(dev, buffers[i], mems[i], 0);
+        r = VKD(vkBindBufferMemory)(dev, buffers[i], mems[i], 0);
         if (r != VK_SUCCESS) {
             printf("[Vulkan Compute] ERROR: vkBindBufferMemory[%d] failed %d\n", i, r);
-            vkFreeMemory_dyn(dev, mems[i], NULL);
-            vkDestroyBuffer_dyn(dev, buffers[i], NULL);
+            VKD(vkFreeMemory)(dev, mems[i], NULL);
+            VKD(vkDestroyBuffer)(dev, buffers[i], NULL);
             for (int j = 0; j < i; j++) {
-                vkDestroyBuffer_dyn(dev, buffers[j], NULL);
-                vkFreeMemory_dyn(dev, mems[j], NULL);
+                VKD(vkDestroyBuffer)(dev, buffers[j], NULL);
+                VKD(vkFreeMemory)(dev, mems[j], NULL);
             }
             return 0;
         }
@@ -577,13 +524,13 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
     
     // === 9. 上傳數據到 GPU ===
     void* mapped;
-    vkMapMemory_dyn(dev, mems[0], 0, buf_size, 0, &mapped);
+    VKD(vkMapMemory)(dev, mems[0], 0, buf_size, 0, &mapped);
     memcpy(mapped, a, buf_size);
-    vkUnmapMemory_dyn(dev, mems[0]);
+    VKD(vkUnmapMemory)(dev, mems[0]);
     
-    vkMapMemory_dyn(dev, mems[1], 0, buf_size, 0, &mapped);
+    VKD(vkMapMemory)(dev, mems[1], 0, buf_size, 0, &mapped);
     memcpy(mapped, b, buf_size);
-    vkUnmapMemory_dyn(dev, mems[1]);
+    VKD(vkUnmapMemory)(dev, mems[1]);
     
     printf("[Vulkan Compute] ✓ Data uploaded to GPU\n");
     
@@ -608,7 +555,7 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
         wds[i].pTexelBufferView = NULL;
     }
     
-    vkUpdateDescriptorSets_dyn(dev, 3, wds, 0, NULL);
+    VKD(vkUpdateDescriptorSets)(dev, 3, wds, 0, NULL);
     
     // === 11. 分配 Command Buffer ===
     VkCommandBufferAllocateInfo cbai = {0};
@@ -618,7 +565,7 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
     cbai.commandBufferCount = 1;
     
     VkCommandBuffer cmd;
-    r = vkAllocateCommandBuffers_dyn(dev, &cbai, &cmd);
+    r = VKD(vkAllocateCommandBuffers)(dev, &cbai, &cmd);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkAllocateCommandBuffers failed %d\n", r);
         goto cleanup_buffers;
@@ -628,24 +575,24 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
     VkCommandBufferBeginInfo cbbi = {0};
     cbbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     
-    r = vkBeginCommandBuffer_dyn(cmd, &cbbi);
+    r = VKD(vkBeginCommandBuffer)(cmd, &cbbi);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkBeginCommandBuffer failed %d\n", r);
         goto cleanup_buffers;
     }
     
-    vkCmdBindPipeline_dyn(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_vk_ctx.cached_pipeline);
-    vkCmdBindDescriptorSets_dyn(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_vk_ctx.cached_pl, 0, 1, &dset, 0, NULL);
+    VKD(vkCmdBindPipeline)(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_vk_ctx.cached_pipeline);
+    VKD(vkCmdBindDescriptorSets)(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, g_vk_ctx.cached_pl, 0, 1, &dset, 0, NULL);
     
     // Push constant: n
     uint32_t n_uint = (uint32_t)n;
-    vkCmdPushConstants_dyn(cmd, g_vk_ctx.cached_pl, VK_SHADER_STAGE_COMPUTE_BIT, 0, 4, &n_uint);
+    VKD(vkCmdPushConstants)(cmd, g_vk_ctx.cached_pl, VK_SHADER_STAGE_COMPUTE_BIT, 0, 4, &n_uint);
     
     // Dispatch: (n + 255) / 256 workgroups, each with 256 threads
     uint32_t groupCount = (n + 255) / 256;
-    vkCmdDispatch_dyn(cmd, groupCount, 1, 1);
+    VKD(vkCmdDispatch)(cmd, groupCount, 1, 1);
     
-    r = vkEndCommandBuffer_dyn(cmd);
+    r = VKD(vkEndCommandBuffer)(cmd);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkEndCommandBuffer failed %d\n", r);
         goto cleanup_buffers;
@@ -657,35 +604,34 @@ int retryix_vulkan_vector_add(float* a, float* b, float* c, int n) {
     si.commandBufferCount = 1;
     si.pCommandBuffers = &cmd;
     
-    r = vkQueueSubmit_dyn(g_vk_ctx.compute_queue, 1, &si, VK_NULL_HANDLE);
+    r = VKD(vkQueueSubmit)(g_vk_ctx.compute_queue, 1, &si, VK_NULL_HANDLE);
     if (r != VK_SUCCESS) {
         printf("[Vulkan Compute] ERROR: vkQueueSubmit failed %d\n", r);
         goto cleanup_buffers;
     }
     
-    vkQueueWaitIdle_dyn(g_vk_ctx.compute_queue);
+    VKD(vkQueueWaitIdle)(g_vk_ctx.compute_queue);
     
     // === 4. 下載結果 ===
-    vkMapMemory_dyn(dev, mems[2], 0, buf_size, 0, &mapped);
+    VKD(vkMapMemory)(dev, mems[2], 0, buf_size, 0, &mapped);
     memcpy(c, mapped, buf_size);
-    vkUnmapMemory_dyn(dev, mems[2]);
+    VKD(vkUnmapMemory)(dev, mems[2]);
     
     // === 5. 清理 (buffers 和 descriptor set) ===
 cleanup_buffers:
     for (int i = 0; i < 3; i++) {
         if (buffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer_dyn(dev, buffers[i], NULL);
+            VKD(vkDestroyBuffer)(dev, buffers[i], NULL);
         }
         if (mems[i] != VK_NULL_HANDLE) {
-            vkFreeMemory_dyn(dev, mems[i], NULL);
+            VKD(vkFreeMemory)(dev, mems[i], NULL);
         }
     }
     
     // 釋放 descriptor set 回 pool (供下次重用)
     if (dset != VK_NULL_HANDLE) {
-        vkFreeDescriptorSets_dyn = (PFN_vkFreeDescriptorSets)vkGetDeviceProcAddr_dyn(dev, "vkFreeDescriptorSets");
-        if (vkFreeDescriptorSets_dyn) {
-            vkFreeDescriptorSets_dyn(dev, g_vk_ctx.cached_dpool, 1, &dset);
+        if (VKD(vkFreeDescriptorSets)) {
+            VKD(vkFreeDescriptorSets)(dev, g_vk_ctx.cached_dpool, 1, &dset);
         }
     }
     
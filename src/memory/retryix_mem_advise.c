@@ -0,0 +1,428 @@
+// retryix_mem_advise.c - 記憶體建議與背景預取
+// READ_MOSTLY        -> MADV_WILLNEED (+ 2MB 以上 MADV_HUGEPAGE)
+// PREFERRED_LOCATION -> 裝置所在節點的 MPOL_PREFERRED
+// ACCESSED_BY        -> MADV_SEQUENTIAL (裝置以 DMA 串流讀寫)
+// 預取: 背景線程以 MADV_POPULATE_WRITE (舊核心退回原子觸碰) 逐 2MB 區塊配置實體頁
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "retryix_mem_advise_internal.h"
+#include "retryix_numa_internal.h"
+#include "retryix_atomic_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#ifndef _WIN32
+#ifndef MADV_SEQUENTIAL
+#define MADV_SEQUENTIAL      2
+#endif
+#ifndef MADV_WILLNEED
+#define MADV_WILLNEED        3
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE        14
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE  23
+#endif
+#endif
+
+#define ADVISE_HUGE_THRESHOLD  (2u * 1024 * 1024)
+#define PREFETCH_CHUNK         (2u * 1024 * 1024)
+#define PREFETCH_MAX_WORKERS   4
+
+// === 鎖 / 條件變數 ===
+#ifdef _WIN32
+typedef SRWLOCK advise_lock_t;
+#define ADVISE_LOCK_INIT        SRWLOCK_INIT
+#define ADVISE_LOCK(l)          AcquireSRWLockExclusive(l)
+#define ADVISE_UNLOCK(l)        ReleaseSRWLockExclusive(l)
+static CONDITION_VARIABLE g_prefetch_cond = CONDITION_VARIABLE_INIT;
+#define PREFETCH_BROADCAST()    WakeAllConditionVariable(&g_prefetch_cond)
+#else
+typedef pthread_mutex_t advise_lock_t;
+#define ADVISE_LOCK_INIT        PTHREAD_MUTEX_INITIALIZER
+#define ADVISE_LOCK(l)          pthread_mutex_lock(l)
+#define ADVISE_UNLOCK(l)        pthread_mutex_unlock(l)
+static pthread_cond_t g_prefetch_cond = PTHREAD_COND_INITIALIZER;
+#define PREFETCH_BROADCAST()    pthread_cond_broadcast(&g_prefetch_cond)
+#endif
+
+// === 建議記錄 (依 base 排序) ===
+static retryix_mem_advice_record_t* g_records = NULL;
+static size_t g_record_count = 0;
+static size_t g_record_capacity = 0;
+static advise_lock_t g_record_lock = ADVISE_LOCK_INIT;
+static uint32_t g_advice_used = 0;        // 曾建立過記錄 (含預取); 為 0 時釋放路徑不必查表
+
+// === 預取工作 ===
+typedef struct prefetch_job {
+    uintptr_t key;                        // 發起預取的位址, 對應建議記錄
+    uintptr_t start;
+    uintptr_t next;                       // 下一個待分派的區塊起點
+    uintptr_t end;
+    int in_flight;                        // 執行中的區塊數
+    struct prefetch_job* link;
+} prefetch_job_t;
+
+static prefetch_job_t* g_jobs = NULL;
+static int g_workers = 0;
+static advise_lock_t g_prefetch_lock = ADVISE_LOCK_INIT;
+#ifndef _WIN32
+static int g_populate_supported = 1;      // MADV_POPULATE_WRITE (Linux 5.14+)
+#endif
+
+static size_t advise_page_size(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+#else
+    long v = sysconf(_SC_PAGESIZE);
+    return v > 0 ? (size_t)v : 4096;
+#endif
+}
+
+// 呼叫者持 g_prefetch_lock; 逾時回傳 false
+static bool prefetch_cond_wait(uint32_t timeout_ms) {
+#ifdef _WIN32
+    return SleepConditionVariableSRW(&g_prefetch_cond, &g_prefetch_lock,
+        timeout_ms == RETRYIX_NUMA_WAIT_INFINITE ? INFINITE : timeout_ms, 0) != 0;
+#else
+    if (timeout_ms == RETRYIX_NUMA_WAIT_INFINITE) {
+        return pthread_cond_wait(&g_prefetch_cond, &g_prefetch_lock) == 0;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(&g_prefetch_cond, &g_prefetch_lock, &ts) == 0;
+#endif
+}
+
+// 第一個 base > addr 的索引 (呼叫者持 g_record_lock)
+static size_t record_upper_bound(uintptr_t addr) {
+    size_t lo = 0, hi = g_record_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if ((uintptr_t)g_records[mid].base <= addr) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static retryix_mem_advice_record_t* record_find(uintptr_t addr) {
+    size_t pos = record_upper_bound(addr);
+    if (pos == 0) return NULL;
+    retryix_mem_advice_record_t* r = &g_records[pos - 1];
+    return (addr < (uintptr_t)r->base + r->size) ? r : NULL;
+}
+
+// 找出或建立涵蓋 [ptr, ptr + size) 的記錄 (呼叫者持 g_record_lock)
+static retryix_mem_advice_record_t* record_acquire(void* ptr, size_t size) {
+    retryix_mem_advice_record_t* r = record_find((uintptr_t)ptr);
+    if (r) {
+        uintptr_t end = (uintptr_t)ptr + size;
+        if (end > (uintptr_t)r->base + r->size) r->size = end - (uintptr_t)r->base;
+        return r;
+    }
+    if (g_record_count == g_record_capacity) {
+        size_t cap = g_record_capacity ? g_record_capacity * 2 : 64;
+        retryix_mem_advice_record_t* grown =
+            (retryix_mem_advice_record_t*)realloc(g_records, cap * sizeof(*grown));
+        if (!grown) return NULL;
+        g_records = grown;
+        g_record_capacity = cap;
+    }
+    size_t pos = record_upper_bound((uintptr_t)ptr);
+    memmove(&g_records[pos + 1], &g_records[pos], (g_record_count - pos) * sizeof(*g_records));
+    r = &g_records[pos];
+    memset(r, 0, sizeof(*r));
+    r->base = ptr;
+    r->size = size;
+    r->preferred_node = -1;
+    g_record_count++;
+    RX_STORE32(&g_advice_used, 1);
+    return r;
+}
+
+int retryix_mem_device_node(int device) {
+    if (device == RETRYIX_MEM_HOST_DEVICE) return retryix_numa_current_node();
+    if (device < 0) return -1;
+
+    // 裝置編號依 PCI 列舉順序對應顯示控制器 (0x03) 與處理加速器 (0x12)
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    int index = 0;
+    for (uint32_t i = 0; i < t->device_count; i++) {
+        uint32_t base = t->devices[i].class_code >> 16;
+        if (base != 0x03 && base != 0x12) continue;
+        if (index++ == device) return t->devices[i].node;
+    }
+    return -1;
+}
+
+#ifndef _WIN32
+static void advise_range(void* ptr, size_t size, int advice) {
+    size_t page = advise_page_size();
+    uintptr_t start = (uintptr_t)ptr & ~(uintptr_t)(page - 1);
+    uintptr_t end = ((uintptr_t)ptr + size + page - 1) & ~(uintptr_t)(page - 1);
+    madvise((void*)start, end - start, advice);
+}
+#endif
+
+int retryix_mem_apply_advice(void* ptr, size_t size, retryix_mem_advice_t advice, int device) {
+    if (!ptr || size == 0) return -EINVAL;
+    int node = -1;
+    if (advice != RETRYIX_MEM_ADVICE_READ_MOSTLY) {
+        node = retryix_mem_device_node(device);
+    }
+
+#ifndef _WIN32
+    switch (advice) {
+        case RETRYIX_MEM_ADVICE_READ_MOSTLY:
+            advise_range(ptr, size, MADV_WILLNEED);
+            if (size >= ADVISE_HUGE_THRESHOLD) advise_range(ptr, size, MADV_HUGEPAGE);
+            break;
+        case RETRYIX_MEM_ADVICE_ACCESSED_BY:
+            advise_range(ptr, size, MADV_SEQUENTIAL);
+            break;
+        default:
+            break;
+    }
+#endif
+    if (advice == RETRYIX_MEM_ADVICE_PREFERRED_LOCATION && node >= 0) {
+        int rc = retryix_numa_set_preferred(ptr, size, node);
+        if (rc != 0 && rc != -ENOSYS) return rc;
+    }
+
+    ADVISE_LOCK(&g_record_lock);
+    retryix_mem_advice_record_t* r = record_acquire(ptr, size);
+    if (r) {
+        r->advice |= (uint32_t)advice;
+        if (advice == RETRYIX_MEM_ADVICE_PREFERRED_LOCATION) r->preferred_node = (int16_t)node;
+        if (advice == RETRYIX_MEM_ADVICE_ACCESSED_BY && device >= 0 && device < 64) {
+            r->accessed_by_devices |= 1ull << device;
+        }
+    }
+    ADVISE_UNLOCK(&g_record_lock);
+    return r ? 0 : -ENOMEM;
+}
+
+bool retryix_mem_get_advice(const void* ptr, retryix_mem_advice_record_t* out) {
+    ADVISE_LOCK(&g_record_lock);
+    retryix_mem_advice_record_t* r = record_find((uintptr_t)ptr);
+    if (r && out) *out = *r;
+    ADVISE_UNLOCK(&g_record_lock);
+    return r != NULL;
+}
+
+// === 背景預取 ===
+
+// 配置區塊內的實體頁; 位址已失效時回傳 false
+static bool prefetch_touch(uintptr_t start, uintptr_t end, size_t page) {
+#ifndef _WIN32
+    if (__atomic_load_n(&g_populate_supported, __ATOMIC_RELAXED)) {
+        if (madvise((void*)start, end - start, MADV_POPULATE_WRITE) == 0) return true;
+        if (errno == ENOMEM || errno == EFAULT) return false;
+        if (errno != EINVAL) return true;
+        // 舊核心不支援, 之後改用原子觸碰
+        __atomic_store_n(&g_populate_supported, 0, __ATOMIC_RELAXED);
+    }
+    // 原子加零: 觸發可寫缺頁, 不會覆蓋其他線程同時寫入的資料
+    for (uintptr_t p = start; p < end; p += page) {
+        __sync_fetch_and_add((volatile long*)p, 0);
+    }
+#else
+    for (uintptr_t p = start; p < end; p += page) {
+        InterlockedExchangeAdd((volatile LONG*)p, 0);
+    }
+#endif
+    return true;
+}
+
+static void prefetch_worker_loop(void) {
+    size_t page = advise_page_size();
+    ADVISE_LOCK(&g_prefetch_lock);
+    for (;;) {
+        prefetch_job_t* job = g_jobs;
+        while (job && job->next >= job->end) job = job->link;
+        if (!job) {
+            prefetch_cond_wait(RETRYIX_NUMA_WAIT_INFINITE);
+            continue;
+        }
+
+        uintptr_t chunk_start = job->next;
+        uintptr_t chunk_end = chunk_start + PREFETCH_CHUNK;
+        if (chunk_end > job->end) chunk_end = job->end;
+        job->next = chunk_end;
+        job->in_flight++;
+        ADVISE_UNLOCK(&g_prefetch_lock);
+
+        bool ok = prefetch_touch(chunk_start, chunk_end, page);
+
+        ADVISE_LOCK(&g_record_lock);
+        retryix_mem_advice_record_t* r = record_find(job->key);
+        if (r && ok) r->prefetched_bytes += chunk_end - chunk_start;
+        ADVISE_UNLOCK(&g_record_lock);
+
+        ADVISE_LOCK(&g_prefetch_lock);
+        job->in_flight--;
+        if (!ok) job->next = job->end;
+        if (job->next >= job->end && job->in_flight == 0) {
+            prefetch_job_t** link = &g_jobs;
+            while (*link != job) link = &(*link)->link;
+            *link = job->link;
+            free(job);
+        }
+        PREFETCH_BROADCAST();
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI prefetch_worker_win(LPVOID arg) {
+    (void)arg;
+    prefetch_worker_loop();
+    return 0;
+}
+#else
+static void* prefetch_worker_posix(void* arg) {
+    (void)arg;
+    prefetch_worker_loop();
+    return NULL;
+}
+#endif
+
+// 呼叫者持 g_prefetch_lock; 工作線程數 = CPU 數 / 4, 介於 1 與 PREFETCH_MAX_WORKERS
+static void prefetch_start_workers(void) {
+    int wanted = (int)retryix_numa_topology()->cpu_count / 4;
+    if (wanted < 1) wanted = 1;
+    if (wanted > PREFETCH_MAX_WORKERS) wanted = PREFETCH_MAX_WORKERS;
+    while (g_workers < wanted) {
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, prefetch_worker_win, NULL, 0, NULL);
+        if (!thread) break;
+        CloseHandle(thread);
+#else
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, prefetch_worker_posix, NULL) != 0) break;
+        pthread_detach(thread);
+#endif
+        g_workers++;
+    }
+}
+
+int retryix_mem_prefetch_async(void* ptr, size_t size, int device) {
+    if (!ptr || size == 0) return -EINVAL;
+
+    // 實體頁落在目標節點: 新缺頁依優先策略, 既有頁面交給搬移引擎
+    int node = retryix_mem_device_node(device);
+    if (node >= 0 && retryix_numa_topology()->node_count > 1) {
+        retryix_numa_set_preferred(ptr, size, node);
+        retryix_numa_migrate_async(ptr, size, node, false);
+    }
+
+    ADVISE_LOCK(&g_record_lock);
+    retryix_mem_advice_record_t* r = record_acquire(ptr, size);
+    ADVISE_UNLOCK(&g_record_lock);
+    if (!r) return -ENOMEM;
+
+    size_t page = advise_page_size();
+    prefetch_job_t* job = (prefetch_job_t*)calloc(1, sizeof(prefetch_job_t));
+    if (!job) return -ENOMEM;
+    job->key = (uintptr_t)ptr;
+    job->start = (uintptr_t)ptr & ~(uintptr_t)(page - 1);
+    job->next = job->start;
+    job->end = ((uintptr_t)ptr + size + page - 1) & ~(uintptr_t)(page - 1);
+
+    ADVISE_LOCK(&g_prefetch_lock);
+    prefetch_start_workers();
+    if (g_workers == 0) {
+        ADVISE_UNLOCK(&g_prefetch_lock);
+        free(job);
+        return -EAGAIN;
+    }
+    job->link = g_jobs;
+    g_jobs = job;
+    PREFETCH_BROADCAST();
+    ADVISE_UNLOCK(&g_prefetch_lock);
+    return 0;
+}
+
+bool retryix_mem_prefetch_wait(uint32_t timeout_ms) {
+    ADVISE_LOCK(&g_prefetch_lock);
+    while (g_jobs) {
+        if (!prefetch_cond_wait(timeout_ms) && timeout_ms != RETRYIX_NUMA_WAIT_INFINITE) break;
+    }
+    bool done = g_jobs == NULL;
+    ADVISE_UNLOCK(&g_prefetch_lock);
+    return done;
+}
+
+void retryix_mem_forget_advice(void* ptr) {
+    if (!ptr || !RX_LOAD32(&g_advice_used)) return;
+    // 釋放範圍: ptr 所屬的獨立映射區; 一般配置則以包含 ptr 的建議記錄為準
+    uintptr_t start = (uintptr_t)ptr;
+    uintptr_t end = start + 1;
+    void* region_base = NULL;
+    size_t region_size = 0;
+    if (retryix_numa_region_of(ptr, &region_base, &region_size)) {
+        start = (uintptr_t)region_base;
+        end = start + region_size;
+    }
+
+    ADVISE_LOCK(&g_record_lock);
+    retryix_mem_advice_record_t* r = record_find((uintptr_t)ptr);
+    if (r) {
+        if ((uintptr_t)r->base < start) start = (uintptr_t)r->base;
+        if ((uintptr_t)r->base + r->size > end) end = (uintptr_t)r->base + r->size;
+    }
+    // 移除所有與 [start, end) 重疊的記錄 (記錄依 base 排序, 重疊者連續排列)
+    size_t first = record_upper_bound(start);
+    while (first > 0 && (uintptr_t)g_records[first - 1].base + g_records[first - 1].size > start) first--;
+    size_t last = first;
+    while (last < g_record_count && (uintptr_t)g_records[last].base < end) last++;
+    if (last > first) {
+        memmove(&g_records[first], &g_records[last], (g_record_count - last) * sizeof(*g_records));
+        g_record_count -= last - first;
+    }
+    ADVISE_UNLOCK(&g_record_lock);
+
+    // 停止分派與釋放範圍重疊的區塊, 等待執行中的區塊離開後才允許釋放
+    ADVISE_LOCK(&g_prefetch_lock);
+    for (;;) {
+        bool busy = false;
+        for (prefetch_job_t* job = g_jobs; job; job = job->link) {
+            if (job->end <= start || job->start >= end) continue;
+            job->next = job->end;
+            if (job->in_flight > 0) busy = true;
+        }
+        if (!busy) break;
+        prefetch_cond_wait(RETRYIX_NUMA_WAIT_INFINITE);
+    }
+    prefetch_job_t** link = &g_jobs;
+    while (*link) {
+        prefetch_job_t* job = *link;
+        if (job->end > start && job->start < end && job->in_flight == 0) {
+            *link = job->link;
+            free(job);
+        } else {
+            link = &job->link;
+        }
+    }
+    PREFETCH_BROADCAST();
+    ADVISE_UNLOCK(&g_prefetch_lock);
+}
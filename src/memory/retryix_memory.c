@@ -1,6 +1,7 @@
 #define CL_TARGET_OPENCL_VERSION 200
 
 #include "retryix.h"
+#include "retryix_numa_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -81,6 +82,24 @@ static retryix_memory_context_t* g_memory_context = NULL;
 
 // === 內部函數 ===
 
+// 主機端緩衝區: 達到大頁門檻時以 2MB 對齊的大頁映射區支撐 (同時滿足任何裝置對齊要求)
+static void* memory_host_alloc(size_t alignment, size_t size) {
+    size_t threshold = retryix_numa_huge_threshold();
+    if (threshold > 0 && size >= threshold) {
+        void* ptr = retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_DEFAULT, 0);
+        if (ptr) return ptr;
+    }
+    return aligned_alloc(alignment, size);
+}
+
+static void memory_host_free(void* ptr) {
+    if (retryix_numa_region_of(ptr, NULL, NULL)) {
+        retryix_numa_free(ptr);
+    } else {
+        aligned_free(ptr);
+    }
+}
+
 // 初始化記憶體管理器
 retryix_memory_context_t* retryix_memory_init(cl_context context, cl_device_id device) {
     if (g_memory_context) {
@@ -167,7 +186,7 @@ DLL_EXPORT void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags,
         return NULL;
     } else if (flags & RETRYIX_MEM_ZERO_COPY) {
         // 零拷貝記憶體（優先使用 SVM 或 pinned memory）
-        host_ptr = aligned_alloc(alignment, aligned_size);
+        host_ptr = memory_host_alloc(alignment, aligned_size);
         if (host_ptr) {
             // 嘗試創建零拷貝 OpenCL 緩衝區
             cl_mem_flags cl_flags = CL_MEM_USE_HOST_PTR;
@@ -177,14 +196,14 @@ DLL_EXPORT void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags,
             
             device_mem = clCreateBuffer(g_memory_context->context, cl_flags, aligned_size, host_ptr, &err);
             if (err != CL_SUCCESS) {
-                aligned_free(host_ptr);
+                memory_host_free(host_ptr);
                 return NULL;
             }
             printf("Zero-copy allocation: %p (%zu bytes)\n", host_ptr, aligned_size);
         }
     } else {
         // 標準記憶體分配
-        host_ptr = aligned_alloc(alignment, aligned_size);
+        host_ptr = memory_host_alloc(alignment, aligned_size);
         if (host_ptr) {
             cl_mem_flags cl_flags = 0;
             if (flags & RETRYIX_MEM_READ_ONLY) cl_flags = CL_MEM_READ_ONLY;
@@ -199,7 +218,7 @@ DLL_EXPORT void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags,
             }
             
             if (err != CL_SUCCESS) {
-                aligned_free(host_ptr);
+                memory_host_free(host_ptr);
                 return NULL;
             }
             printf("Standard allocation: %p (%zu bytes)\n", host_ptr, aligned_size);
@@ -239,7 +258,7 @@ DLL_EXPORT void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags,
         } else {
             // 清理失敗的分配
             clReleaseMemObject(device_mem);
-            aligned_free(host_ptr);
+            memory_host_free(host_ptr);
         }
     }
     
@@ -270,7 +289,7 @@ DLL_EXPORT int retryix_memory_free(void* ptr) {
     
     // 釋放主機記憶體
     if (desc->host_ptr) {
-        aligned_free(desc->host_ptr);
+        memory_host_free(desc->host_ptr);
         printf("Memory freed: %s (%zu bytes)\n", desc->debug_name, desc->size);
     }
     
@@ -491,4 +510,4 @@ DLL_EXPORT int retryix_memory_validate(void) {
     }
     
     return errors;
-}
\ No newline at end of file
+}
\ No newline at end of file
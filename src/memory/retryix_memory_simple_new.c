@@ -2,50 +2,534 @@
 // RetryIX v3.0.0 - Simplified memory management utilities
 // Additional memory utilities (non-conflicting with retryix_api.c)
 
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // dladdr
+#endif
+
 #include "retryix.h"
 #include "retryix_svm.h"
+#include "retryix_numa_internal.h"
+#include "retryix_mem_advise_internal.h"
+#include "retryix_atomic_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#pragma intrinsic(_ReturnAddress)
+#define MEM_RETURN_ADDRESS()            _ReturnAddress()
+static SRWLOCK g_mem_lock = SRWLOCK_INIT;
+#define MEM_LOCK()                      AcquireSRWLockExclusive(&g_mem_lock)
+#define MEM_UNLOCK()                    ReleaseSRWLockExclusive(&g_mem_lock)
+#else
+#include <pthread.h>
+#include <dlfcn.h>
+#define MEM_RETURN_ADDRESS()            __builtin_return_address(0)
+static pthread_mutex_t g_mem_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MEM_LOCK()                      pthread_mutex_lock(&g_mem_lock)
+#define MEM_UNLOCK()                    pthread_mutex_unlock(&g_mem_lock)
+#endif
 
 // ===== Memory Statistics =====
+// 每個配置前置 32 位元組標頭記錄大小、標籤與取樣位置, 釋放時據此扣回統計
+// 達大頁門檻的配置由獨立映射區支撐, 標頭改放旁路表, 使用者指標保持映射區起點的大頁對齊
+// 計數器全部為原子操作, 配置/釋放路徑不持鎖 (僅新標籤與取樣命中時短暫持鎖)
+
+#define MEM_HEADER_SIZE         32
+#define MEM_MAGIC_LIVE          0x52584D41u     // 'RXMA'
+#define MEM_MAGIC_FREED         0x52584D46u     // 'RXMF'
+#define MEM_MAX_TAGS            64
+#define MEM_TAG_NAME_LEN        32
+#define MEM_TAG_UNTAGGED        0
+#define MEM_TAG_OVERFLOW        (MEM_MAX_TAGS - 1)
+#define MEM_MAX_SITES           512             // 2 的冪, 開放定址
+#define MEM_SITE_NONE           0xFFFFu
+#define MEM_REPORT_TOP_SITES    16
+#define MEM_SIDE_ALIGN          4096            // 旁路表配置必為映射區起點, 至少頁對齊
+#define MEM_FLAG_REGION         0x1u            // 內嵌標頭區塊由 retryix_numa_alloc 的映射區支撐
+
 typedef struct {
-    size_t total_allocated;
-    size_t total_freed;
-    size_t current_usage;
-    size_t peak_usage;
-    size_t alloc_count;
-    size_t free_count;
+    uint32_t magic;
+    uint16_t tag;
+    uint16_t site;          // 取樣位置索引, MEM_SITE_NONE 表示未取樣
+    uint32_t weight;        // 取樣當下的間隔 N (一次取樣代表約 N 次配置)
+    uint32_t flags;         // MEM_FLAG_*
+    uint64_t size;
+    uint64_t reserved2;
+} mem_header_t;
+
+typedef char mem_header_size_check[(sizeof(mem_header_t) == MEM_HEADER_SIZE) ? 1 : -1];
+
+typedef struct {
+    uint64_t total_allocated;
+    uint64_t total_freed;
+    uint64_t current_usage;
+    uint64_t peak_usage;
+    uint64_t alloc_count;
+    uint64_t free_count;
+    uint64_t failed_allocs;
+    uint64_t invalid_frees;     // 重複釋放或非本配置器的指標
 } memory_stats_t;
 
+typedef struct {
+    char name[MEM_TAG_NAME_LEN];
+    uint64_t current_usage;
+    uint64_t peak_usage;
+    uint64_t total_allocated;
+    uint64_t alloc_count;
+    uint64_t free_count;
+} memory_tag_stats_t;
+
+typedef struct {
+    void* pc;                   // 呼叫者返回位址, NULL 表示空槽
+    uint16_t tag;
+    uint64_t sampled_allocs;
+    uint64_t live_samples;
+    uint64_t live_bytes;        // 取樣配置中仍存活的位元組
+    uint64_t est_live_bytes;    // live_bytes 依取樣間隔放大後的估計值
+} memory_site_t;
+
 static memory_stats_t g_mem_stats = {0};
+static memory_tag_stats_t g_tags[MEM_MAX_TAGS] = { { "untagged", 0, 0, 0, 0, 0 } };
+static uint32_t g_tag_count = 1;
+static memory_site_t g_sites[MEM_MAX_SITES];
+static uint32_t g_site_count = 0;
+static uint32_t g_sample_interval = 0;      // 0 = 不取樣
 
-// ===== Memory Allocation (Additional utilities) =====
-RETRYIX_API void* RETRYIX_CALL retryix_mem_alloc(size_t size) {
-    void* ptr = malloc(size);
-    if (ptr) {
-        g_mem_stats.total_allocated += size;
-        g_mem_stats.current_usage += size;
-        g_mem_stats.alloc_count++;
-        
-        if (g_mem_stats.current_usage > g_mem_stats.peak_usage) {
-            g_mem_stats.peak_usage = g_mem_stats.current_usage;
+// 旁路表: 無內嵌標頭的映射區配置, 依指標排序 (g_mem_lock 保護)
+typedef struct {
+    uintptr_t ptr;
+    mem_header_t header;
+} mem_side_entry_t;
+
+static mem_side_entry_t* g_side = NULL;
+static size_t g_side_count = 0;
+static size_t g_side_capacity = 0;
+static uint32_t g_side_live = 0;            // 旁路表筆數的無鎖副本, 為 0 時釋放不必查表
+
+static RX_THREAD_LOCAL uint32_t t_sample_countdown = 0;
+static RX_THREAD_LOCAL uint32_t t_sample_rng = 0;
+static RX_THREAD_LOCAL const char* t_last_tag_name = NULL;
+static RX_THREAD_LOCAL uint16_t t_last_tag = MEM_TAG_UNTAGGED;
+
+static void mem_update_peak(uint64_t* peak, uint64_t current) {
+    uint64_t seen = RX_LOAD64(peak);
+    while (current > seen) {
+        if (RX_CAS64(peak, seen, current)) break;
+        seen = RX_LOAD64(peak);
+    }
+}
+
+// 標籤字串 -> 索引; 表格只增不減, 已發佈的名稱不再變動, 故查詢不需持鎖
+static uint16_t mem_intern_tag(const char* name) {
+    if (!name || !name[0]) return MEM_TAG_UNTAGGED;
+    if (name == t_last_tag_name && strncmp(g_tags[t_last_tag].name, name, MEM_TAG_NAME_LEN - 1) == 0) return t_last_tag;
+
+    uint32_t count = RX_LOAD32(&g_tag_count);
+    uint16_t tag = MEM_TAG_OVERFLOW;
+    bool found = false;
+    for (uint32_t i = 1; i < count; i++) {
+        if (strncmp(g_tags[i].name, name, MEM_TAG_NAME_LEN - 1) == 0) {
+            tag = (uint16_t)i;
+            found = true;
+            break;
         }
-        
-        printf("[RetryIX Memory] Allocated %zu bytes -> %p\n", size, ptr);
-    } else {
-        printf("[RetryIX Memory] Allocation failed! Requested %zu bytes\n", size);
     }
-    
+    if (!found) {
+        MEM_LOCK();
+        count = g_tag_count;
+        for (uint32_t i = 1; i < count && !found; i++) {
+            if (strncmp(g_tags[i].name, name, MEM_TAG_NAME_LEN - 1) == 0) {
+                tag = (uint16_t)i;
+                found = true;
+            }
+        }
+        if (!found && count < MEM_TAG_OVERFLOW) {
+            strncpy(g_tags[count].name, name, MEM_TAG_NAME_LEN - 1);
+            tag = (uint16_t)count;
+            RX_STORE32(&g_tag_count, count + 1);
+        }
+        MEM_UNLOCK();
+    }
+
+    t_last_tag_name = name;
+    t_last_tag = tag;
+    return tag;
+}
+
+// 每線程倒數; 重設值在 [1, 2N-1] 間均勻分布, 平均每 N 次配置取樣一次且不與固定配置模式同步
+static bool mem_should_sample(uint32_t* weight) {
+    uint32_t interval = RX_LOAD32(&g_sample_interval);
+    if (interval == 0) return false;
+    if (t_sample_countdown == 0 || t_sample_countdown > 2 * interval) {
+        if (t_sample_rng == 0) t_sample_rng = (uint32_t)(uintptr_t)&t_sample_rng | 1u;
+        t_sample_rng ^= t_sample_rng << 13;
+        t_sample_rng ^= t_sample_rng >> 17;
+        t_sample_rng ^= t_sample_rng << 5;
+        t_sample_countdown = 1 + (interval > 1 ? t_sample_rng % (2 * interval - 1) : 0);
+    }
+    if (--t_sample_countdown != 0) return false;
+    *weight = interval;
+    return true;
+}
+
+static uint16_t mem_record_site(void* pc, uint16_t tag, uint64_t size, uint32_t weight) {
+    uint32_t slot = (uint32_t)((((uintptr_t)pc >> 4) ^ ((uintptr_t)tag * 0x9E3779B1u)) & (MEM_MAX_SITES - 1));
+    uint16_t site = MEM_SITE_NONE;
+
+    MEM_LOCK();
+    for (uint32_t probe = 0; probe < MEM_MAX_SITES; probe++) {
+        memory_site_t* s = &g_sites[slot];
+        if (s->pc == pc && s->tag == tag) {
+            site = (uint16_t)slot;
+            break;
+        }
+        if (!s->pc) {
+            // 保留一成空槽以維持探測長度; 滿了就放棄記錄此位置
+            if (g_site_count < MEM_MAX_SITES - MEM_MAX_SITES / 8) {
+                s->pc = pc;
+                s->tag = tag;
+                g_site_count++;
+                site = (uint16_t)slot;
+            }
+            break;
+        }
+        slot = (slot + 1) & (MEM_MAX_SITES - 1);
+    }
+    if (site != MEM_SITE_NONE) {
+        memory_site_t* s = &g_sites[site];
+        s->sampled_allocs++;
+        s->live_samples++;
+        s->live_bytes += size;
+        s->est_live_bytes += size * weight;
+    }
+    MEM_UNLOCK();
+    return site;
+}
+
+// 第一個 ptr >= addr 的索引 (呼叫者持 g_mem_lock)
+static size_t mem_side_lower_bound(uintptr_t addr) {
+    size_t lo = 0, hi = g_side_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (g_side[mid].ptr < addr) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static bool mem_side_insert(uintptr_t ptr, const mem_header_t* header) {
+    bool ok = true;
+    MEM_LOCK();
+    if (g_side_count == g_side_capacity) {
+        size_t cap = g_side_capacity ? g_side_capacity * 2 : 32;
+        mem_side_entry_t* grown = (mem_side_entry_t*)realloc(g_side, cap * sizeof(*grown));
+        if (grown) {
+            g_side = grown;
+            g_side_capacity = cap;
+        } else {
+            ok = false;
+        }
+    }
+    if (ok) {
+        size_t pos = mem_side_lower_bound(ptr);
+        memmove(&g_side[pos + 1], &g_side[pos], (g_side_count - pos) * sizeof(*g_side));
+        g_side[pos].ptr = ptr;
+        g_side[pos].header = *header;
+        g_side_count++;
+        RX_STORE32(&g_side_live, (uint32_t)g_side_count);
+    }
+    MEM_UNLOCK();
+    return ok;
+}
+
+static bool mem_side_remove(uintptr_t ptr, mem_header_t* out) {
+    bool found = false;
+    MEM_LOCK();
+    size_t pos = mem_side_lower_bound(ptr);
+    if (pos < g_side_count && g_side[pos].ptr == ptr) {
+        *out = g_side[pos].header;
+        memmove(&g_side[pos], &g_side[pos + 1], (g_side_count - pos - 1) * sizeof(*g_side));
+        g_side_count--;
+        RX_STORE32(&g_side_live, (uint32_t)g_side_count);
+        found = true;
+    }
+    MEM_UNLOCK();
+    return found;
+}
+
+static void mem_account_alloc(mem_header_t* header, size_t size, const char* debug_name, void* caller) {
+    uint16_t tag = mem_intern_tag(debug_name);
+    uint32_t weight = 0;
+    header->magic = MEM_MAGIC_LIVE;
+    header->tag = tag;
+    header->site = MEM_SITE_NONE;
+    header->weight = 0;
+    header->flags = 0;
+    header->size = size;
+    if (mem_should_sample(&weight)) {
+        header->site = mem_record_site(caller, tag, size, weight);
+        header->weight = weight;
+    }
+
+    RX_ADD64(&g_mem_stats.total_allocated, size);
+    RX_ADD64(&g_mem_stats.alloc_count, 1);
+    mem_update_peak(&g_mem_stats.peak_usage, RX_ADD64(&g_mem_stats.current_usage, size) + size);
+
+    memory_tag_stats_t* t = &g_tags[tag];
+    RX_ADD64(&t->total_allocated, size);
+    RX_ADD64(&t->alloc_count, 1);
+    mem_update_peak(&t->peak_usage, RX_ADD64(&t->current_usage, size) + size);
+}
+
+static void mem_account_free(const mem_header_t* header) {
+    uint64_t size = header->size;
+    RX_ADD64(&g_mem_stats.total_freed, size);
+    RX_ADD64(&g_mem_stats.free_count, 1);
+    RX_ADD64(&g_mem_stats.current_usage, (uint64_t)0 - size);
+
+    memory_tag_stats_t* t = &g_tags[header->tag];
+    RX_ADD64(&t->free_count, 1);
+    RX_ADD64(&t->current_usage, (uint64_t)0 - size);
+
+    if (header->site != MEM_SITE_NONE) {
+        MEM_LOCK();
+        memory_site_t* s = &g_sites[header->site];
+        s->live_samples--;
+        s->live_bytes -= size;
+        s->est_live_bytes -= size * header->weight;
+        MEM_UNLOCK();
+    }
+}
+
+// 達大頁門檻: 整個映射區交給使用者, 標頭放旁路表; 未取得映射區 (門檻剛被調整) 時回傳 NULL 改走內嵌標頭
+static void* mem_tracked_alloc_region(size_t size, const char* debug_name, void* caller) {
+    void* ptr = retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_DEFAULT, 0);
+    if (!ptr) return NULL;
+    void* base = NULL;
+    if (!retryix_numa_region_of(ptr, &base, NULL) || base != ptr || ((uintptr_t)ptr & (MEM_SIDE_ALIGN - 1)) != 0) {
+        retryix_numa_free(ptr);
+        return NULL;
+    }
+
+    mem_header_t header;
+    mem_account_alloc(&header, size, debug_name, caller);
+    if (!mem_side_insert((uintptr_t)ptr, &header)) {
+        mem_account_free(&header);
+        retryix_numa_free(ptr);
+        return NULL;
+    }
     return ptr;
 }
 
+static void* mem_tracked_alloc(size_t size, const char* debug_name, void* caller) {
+    if (size > SIZE_MAX - MEM_HEADER_SIZE) {
+        RX_ADD64(&g_mem_stats.failed_allocs, 1);
+        return NULL;
+    }
+
+    size_t threshold = retryix_numa_huge_threshold();
+    if (threshold > 0 && size + MEM_HEADER_SIZE >= threshold) {
+        void* ptr = mem_tracked_alloc_region(size, debug_name, caller);
+        if (ptr) return ptr;
+    }
+
+    // 門檻以下直接 malloc, 不經映射區表; 達門檻但未取得整區時才退回 retryix_numa_alloc
+    bool region = threshold > 0 && size + MEM_HEADER_SIZE >= threshold;
+    mem_header_t* header = region
+        ? (mem_header_t*)retryix_numa_alloc(size + MEM_HEADER_SIZE, RETRYIX_NUMA_POLICY_DEFAULT, 0)
+        : (mem_header_t*)malloc(size + MEM_HEADER_SIZE);
+    if (!header) {
+        RX_ADD64(&g_mem_stats.failed_allocs, 1);
+        return NULL;
+    }
+    mem_account_alloc(header, size, debug_name, caller);
+    if (region && retryix_numa_region_of(header, NULL, NULL)) header->flags |= MEM_FLAG_REGION;
+    return (char*)header + MEM_HEADER_SIZE;
+}
+
+// ===== Memory Allocation (Additional utilities) =====
+RETRYIX_API void* RETRYIX_CALL retryix_mem_alloc(size_t size) {
+    return mem_tracked_alloc(size, NULL, MEM_RETURN_ADDRESS());
+}
+
+// debug_name 作為統計標籤; 同名配置合併計算
+RETRYIX_API void* RETRYIX_CALL retryix_mem_alloc_tagged(size_t size, const char* debug_name) {
+    return mem_tracked_alloc(size, debug_name, MEM_RETURN_ADDRESS());
+}
+
 RETRYIX_API void RETRYIX_CALL retryix_mem_free(void* ptr) {
     if (!ptr) return;
-    
-    g_mem_stats.free_count++;
-    printf("[RetryIX Memory] Freed %p\n", ptr);
-    free(ptr);
+
+    // 只有頁對齊的指標可能是旁路表配置
+    mem_header_t side;
+    if (((uintptr_t)ptr & (MEM_SIDE_ALIGN - 1)) == 0 && RX_LOAD32(&g_side_live) != 0 &&
+        mem_side_remove((uintptr_t)ptr, &side)) {
+        mem_account_free(&side);
+        retryix_mem_forget_advice(ptr);
+        retryix_numa_free(ptr);
+        return;
+    }
+
+    mem_header_t* header = (mem_header_t*)((char*)ptr - MEM_HEADER_SIZE);
+    if (header->magic != MEM_MAGIC_LIVE || header->tag >= MEM_MAX_TAGS) {
+        RX_ADD64(&g_mem_stats.invalid_frees, 1);
+        return;
+    }
+    header->magic = MEM_MAGIC_FREED;
+    mem_account_free(header);
+
+    retryix_mem_forget_advice(ptr);
+    if (header->flags & MEM_FLAG_REGION) retryix_numa_free(header);
+    else free(header);
+}
+
+// 每約 one_in_n 次配置記錄一次呼叫位置; 0 停用
+RETRYIX_API void RETRYIX_CALL retryix_mem_set_sampling(uint32_t one_in_n) {
+    RX_STORE32(&g_sample_interval, one_in_n);
+}
+
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_get_usage(
+    size_t* current_out, size_t* peak_out, size_t* live_allocs_out) {
+
+    if (current_out) *current_out = (size_t)RX_LOAD64(&g_mem_stats.current_usage);
+    if (peak_out) *peak_out = (size_t)RX_LOAD64(&g_mem_stats.peak_usage);
+    if (live_allocs_out) {
+        uint64_t frees = RX_LOAD64(&g_mem_stats.free_count);
+        *live_allocs_out = (size_t)(RX_LOAD64(&g_mem_stats.alloc_count) - frees);
+    }
+    return RETRYIX_SUCCESS;
+}
+
+// 查詢單一標籤; 標籤不存在時回傳 NOT_FOUND
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_get_tag_usage(
+    const char* debug_name, size_t* current_out, size_t* peak_out, size_t* live_allocs_out) {
+
+    uint32_t count = RX_LOAD32(&g_tag_count);
+    const char* name = (debug_name && debug_name[0]) ? debug_name : g_tags[MEM_TAG_UNTAGGED].name;
+    for (uint32_t i = 0; i < count; i++) {
+        if (strncmp(g_tags[i].name, name, MEM_TAG_NAME_LEN - 1) != 0) continue;
+        if (current_out) *current_out = (size_t)RX_LOAD64(&g_tags[i].current_usage);
+        if (peak_out) *peak_out = (size_t)RX_LOAD64(&g_tags[i].peak_usage);
+        if (live_allocs_out) {
+            uint64_t frees = RX_LOAD64(&g_tags[i].free_count);
+            *live_allocs_out = (size_t)(RX_LOAD64(&g_tags[i].alloc_count) - frees);
+        }
+        return RETRYIX_SUCCESS;
+    }
+    return RETRYIX_ERROR_NOT_FOUND;
+}
+
+static void mem_describe_site(void* pc, char* out, size_t size) {
+#ifdef _WIN32
+    HMODULE module = NULL;
+    char path[MAX_PATH] = {0};
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                           (LPCSTR)pc, &module) && GetModuleFileNameA(module, path, sizeof(path))) {
+        const char* base = strrchr(path, '\\');
+        snprintf(out, size, "%s+0x%llx", base ? base + 1 : path,
+                 (unsigned long long)((uintptr_t)pc - (uintptr_t)module));
+        return;
+    }
+#else
+    Dl_info info;
+    if (dladdr(pc, &info) && info.dli_fname) {
+        const char* base = strrchr(info.dli_fname, '/');
+        if (info.dli_sname) {
+            snprintf(out, size, "%s+0x%llx (%s)", info.dli_sname,
+                     (unsigned long long)((uintptr_t)pc - (uintptr_t)info.dli_saddr), base ? base + 1 : info.dli_fname);
+        } else {
+            snprintf(out, size, "%s+0x%llx", base ? base + 1 : info.dli_fname,
+                     (unsigned long long)((uintptr_t)pc - (uintptr_t)info.dli_fbase));
+        }
+        return;
+    }
+#endif
+    snprintf(out, size, "%p", pc);
+}
+
+// 文字報告: 總計、各標籤、依估計存活位元組排序的前幾個取樣位置
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_get_report(char* buffer, size_t size) {
+    if (!buffer || size < 256) {
+        return RETRYIX_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    size_t used = 0;
+    int n;
+#define MEM_REPORT(...) \
+    do { \
+        n = snprintf(buffer + used, size - used, __VA_ARGS__); \
+        if (n < 0 || (size_t)n >= size - used) return RETRYIX_ERROR_BUFFER_TOO_SMALL; \
+        used += (size_t)n; \
+    } while (0)
+
+    uint64_t frees = RX_LOAD64(&g_mem_stats.free_count);
+    uint64_t allocs = RX_LOAD64(&g_mem_stats.alloc_count);
+    MEM_REPORT("Total allocated: %10llu bytes (%llu times)\n"
+               "Total freed:     %10llu bytes (%llu times)\n"
+               "Current usage:   %10llu bytes (%llu live)\n"
+               "Peak usage:      %10llu bytes\n"
+               "Failed allocs:   %10llu\n"
+               "Invalid frees:   %10llu\n",
+               (unsigned long long)RX_LOAD64(&g_mem_stats.total_allocated), (unsigned long long)allocs,
+               (unsigned long long)RX_LOAD64(&g_mem_stats.total_freed), (unsigned long long)frees,
+               (unsigned long long)RX_LOAD64(&g_mem_stats.current_usage), (unsigned long long)(allocs - frees),
+               (unsigned long long)RX_LOAD64(&g_mem_stats.peak_usage),
+               (unsigned long long)RX_LOAD64(&g_mem_stats.failed_allocs),
+               (unsigned long long)RX_LOAD64(&g_mem_stats.invalid_frees));
+
+    MEM_REPORT("%-24s %14s %14s %10s\n", "Tag", "Current", "Peak", "Live");
+    uint32_t tag_count = RX_LOAD32(&g_tag_count);
+    for (uint32_t i = 0; i < tag_count; i++) {
+        memory_tag_stats_t* t = &g_tags[i];
+        uint64_t tag_frees = RX_LOAD64(&t->free_count);
+        uint64_t tag_allocs = RX_LOAD64(&t->alloc_count);
+        if (tag_allocs == 0) continue;
+        MEM_REPORT("%-24s %14llu %14llu %10llu\n", t->name,
+                   (unsigned long long)RX_LOAD64(&t->current_usage), (unsigned long long)RX_LOAD64(&t->peak_usage),
+                   (unsigned long long)(tag_allocs - tag_frees));
+    }
+    if (RX_LOAD64(&g_tags[MEM_TAG_OVERFLOW].alloc_count) > 0) {
+        memory_tag_stats_t* t = &g_tags[MEM_TAG_OVERFLOW];
+        MEM_REPORT("%-24s %14llu %14llu\n", "(overflow)",
+                   (unsigned long long)RX_LOAD64(&t->current_usage), (unsigned long long)RX_LOAD64(&t->peak_usage));
+    }
+
+    // 取樣位置: 鎖內複製後再排序格式化
+    memory_site_t top[MEM_REPORT_TOP_SITES];
+    size_t top_count = 0;
+    MEM_LOCK();
+    for (uint32_t i = 0; i < MEM_MAX_SITES; i++) {
+        const memory_site_t* s = &g_sites[i];
+        if (!s->pc || s->est_live_bytes == 0) continue;
+        size_t pos = top_count;
+        while (pos > 0 && top[pos - 1].est_live_bytes < s->est_live_bytes) pos--;
+        if (pos >= MEM_REPORT_TOP_SITES) continue;
+        size_t move = (top_count < MEM_REPORT_TOP_SITES ? top_count : MEM_REPORT_TOP_SITES - 1) - pos;
+        memmove(&top[pos + 1], &top[pos], move * sizeof(top[0]));
+        top[pos] = *s;
+        if (top_count < MEM_REPORT_TOP_SITES) top_count++;
+    }
+    MEM_UNLOCK();
+
+    uint32_t interval = RX_LOAD32(&g_sample_interval);
+    if (interval == 0 && top_count == 0) {
+        MEM_REPORT("Call-site sampling: off\n");
+    } else {
+        MEM_REPORT("Call-site sampling: 1/%u, top live sites (estimated)\n", interval);
+        for (size_t i = 0; i < top_count; i++) {
+            char where[160];
+            mem_describe_site(top[i].pc, where, sizeof(where));
+            MEM_REPORT("  %14llu bytes  %-16s %s (%llu live samples)\n",
+                       (unsigned long long)top[i].est_live_bytes, g_tags[top[i].tag].name, where,
+                       (unsigned long long)top[i].live_samples);
+        }
+    }
+#undef MEM_REPORT
+    return RETRYIX_SUCCESS;
 }
 
 // ===== Memory Allocation (Extended API) =====
@@ -60,7 +544,7 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_memory_alloc(
     
     (void)svm_level;  // Ignore SVM level in simulation mode
     
-    *ptr_out = retryix_mem_alloc(size);
+    *ptr_out = mem_tracked_alloc(size, NULL, MEM_RETURN_ADDRESS());
     return (*ptr_out) ? RETRYIX_SUCCESS : RETRYIX_ERROR_OUT_OF_MEMORY;
 }
 
@@ -70,26 +554,41 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_memory_free(void* ptr) {
 }
 
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_memory_cleanup(void) {
+    uint64_t allocs = RX_LOAD64(&g_mem_stats.alloc_count);
+    uint64_t frees = RX_LOAD64(&g_mem_stats.free_count);
     printf("[RetryIX Memory] Memory system cleanup\n");
-    printf("  Total allocated: %zu bytes (%zu times)\n", g_mem_stats.total_allocated, g_mem_stats.alloc_count);
-    printf("  Total freed: %zu times\n", g_mem_stats.free_count);
-    printf("  Peak usage: %zu bytes\n", g_mem_stats.peak_usage);
+    printf("  Total allocated: %llu bytes (%llu times)\n",
+           (unsigned long long)RX_LOAD64(&g_mem_stats.total_allocated), (unsigned long long)allocs);
+    printf("  Total freed: %llu bytes (%llu times)\n",
+           (unsigned long long)RX_LOAD64(&g_mem_stats.total_freed), (unsigned long long)frees);
+    printf("  Peak usage: %llu bytes\n", (unsigned long long)RX_LOAD64(&g_mem_stats.peak_usage));
     
-    if (g_mem_stats.alloc_count != g_mem_stats.free_count) {
-        printf("  WARNING: Possible memory leak (%zu allocs, %zu frees)\n",
-               g_mem_stats.alloc_count, g_mem_stats.free_count);
+    if (allocs != frees) {
+        printf("  WARNING: Possible memory leak (%llu allocs, %llu frees, %llu bytes still live)\n",
+               (unsigned long long)allocs, (unsigned long long)frees,
+               (unsigned long long)RX_LOAD64(&g_mem_stats.current_usage));
     }
     
     return RETRYIX_SUCCESS;
 }
 
-// ===== NUMA Related (Simulated) =====
+// ===== NUMA Related =====
+// 無大小資訊: 綁定 ptr 所屬的整個節點映射區, 一般 malloc 區段則只綁定其所在頁面
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_bind_numa(void* ptr, int node_id) {
     if (!ptr) {
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
     
-    printf("[RetryIX Memory] NUMA bind %p -> node %d (simulated)\n", ptr, node_id);
+    int rc = retryix_numa_bind(ptr, 0, node_id);
+    if (rc == -EINVAL) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+    if (rc == -ENOMEM || rc == -EIO) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    if (rc != 0) {
+        return RETRYIX_ERROR_SVM_NOT_SUPPORTED;
+    }
     return RETRYIX_SUCCESS;
 }
 
@@ -98,8 +597,11 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_prefetch(void* ptr, size_t
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
     
-    printf("[RetryIX Memory] Prefetch %zu bytes (%p) to device %d (simulated)\n", size, ptr, device_id);
-    return RETRYIX_SUCCESS;
+    int rc = retryix_mem_prefetch_async(ptr, size, device_id);
+    if (rc == -ENOMEM) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    return rc == 0 ? RETRYIX_SUCCESS : RETRYIX_ERROR_INVALID_PARAMETER;
 }
 
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_advise(void* ptr, size_t size, int advice) {
@@ -107,15 +609,19 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_advise(void* ptr, size_t s
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
     
-    const char* advice_str = "UNKNOWN";
+    retryix_mem_advice_t kind;
     switch (advice) {
-        case 0: advice_str = "READ_MOSTLY"; break;
-        case 1: advice_str = "PREFERRED_LOCATION"; break;
-        case 2: advice_str = "ACCESSED_BY"; break;
+        case 0: kind = RETRYIX_MEM_ADVICE_READ_MOSTLY; break;
+        case 1: kind = RETRYIX_MEM_ADVICE_PREFERRED_LOCATION; break;
+        case 2: kind = RETRYIX_MEM_ADVICE_ACCESSED_BY; break;
+        default: return RETRYIX_ERROR_INVALID_PARAMETER;
     }
     
-    printf("[RetryIX Memory] Advise %s for %zu bytes (%p) (simulated)\n", advice_str, size, ptr);
-    return RETRYIX_SUCCESS;
+    int rc = retryix_mem_apply_advice(ptr, size, kind, RETRYIX_MEM_HOST_DEVICE);
+    if (rc == -ENOMEM) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    return rc == 0 ? RETRYIX_SUCCESS : RETRYIX_ERROR_INVALID_PARAMETER;
 }
 
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_query_location(void* ptr, int* location_out) {
@@ -130,17 +636,19 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_query_location(void* ptr,
 
 // ===== Statistics & Validation =====
 RETRYIX_API void RETRYIX_CALL retryix_memory_print_stats(void) {
+    char report[4096];
     printf("\n[RetryIX Memory] Memory Statistics\n");
     printf("==========================================\n");
-    printf("Total allocated: %10zu bytes (%zu times)\n", g_mem_stats.total_allocated, g_mem_stats.alloc_count);
-    printf("Total freed:     %10zu times\n", g_mem_stats.free_count);
-    printf("Current usage:   %10zu bytes\n", g_mem_stats.current_usage);
-    printf("Peak usage:      %10zu bytes\n", g_mem_stats.peak_usage);
+    if (retryix_mem_get_report(report, sizeof(report)) == RETRYIX_SUCCESS) {
+        fputs(report, stdout);
+    }
     printf("==========================================\n");
     
-    if (g_mem_stats.alloc_count != g_mem_stats.free_count) {
-        printf("WARNING: Potential leak: %zu unfreed allocations\n", 
-               g_mem_stats.alloc_count - g_mem_stats.free_count);
+    uint64_t allocs = RX_LOAD64(&g_mem_stats.alloc_count);
+    uint64_t frees = RX_LOAD64(&g_mem_stats.free_count);
+    if (allocs != frees) {
+        printf("WARNING: Potential leak: %llu unfreed allocations (%llu bytes)\n", 
+               (unsigned long long)(allocs - frees), (unsigned long long)RX_LOAD64(&g_mem_stats.current_usage));
     } else {
         printf("OK: No memory leaks\n");
     }
@@ -149,9 +657,16 @@ RETRYIX_API void RETRYIX_CALL retryix_memory_print_stats(void) {
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_memory_validate(void) {
     printf("[RetryIX Memory] Validating memory state...\n");
     
-    if (g_mem_stats.alloc_count != g_mem_stats.free_count) {
-        printf("  FAILED: Memory leak detected: %zu unfreed allocations\n",
-               g_mem_stats.alloc_count - g_mem_stats.free_count);
+    uint64_t allocs = RX_LOAD64(&g_mem_stats.alloc_count);
+    uint64_t frees = RX_LOAD64(&g_mem_stats.free_count);
+    if (allocs != frees) {
+        printf("  FAILED: Memory leak detected: %llu unfreed allocations (%llu bytes)\n",
+               (unsigned long long)(allocs - frees), (unsigned long long)RX_LOAD64(&g_mem_stats.current_usage));
+        return RETRYIX_ERROR_UNKNOWN;
+    }
+    if (RX_LOAD64(&g_mem_stats.invalid_frees) != 0) {
+        printf("  FAILED: %llu invalid or double frees\n",
+               (unsigned long long)RX_LOAD64(&g_mem_stats.invalid_frees));
         return RETRYIX_ERROR_UNKNOWN;
     }
     
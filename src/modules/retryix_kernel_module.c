@@ -8,6 +8,10 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <errno.h>
+
+#include "retryix_numa_internal.h"
+#include "retryix_mem_advise_internal.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -126,6 +130,13 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_kernel_execute(
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
 
+    // 取樣 SVM 參數的存取節點, 供 retryix_svm_optimize_placement 使用
+    for (int i = 0; i < kernel->arg_count && i < 32; i++) {
+        if (kernel->is_svm[i]) {
+            retryix_numa_record_access(kernel->args[i]);
+        }
+    }
+
     // 魯班智慧：實際執行 kernel
     printf("[Kernel Lu Ban] Dispatching work items across compute units...\n");
     
@@ -388,6 +399,7 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_free(void* ptr) {
     }
 
     printf("[Kernel Lu Ban] Freeing OpenCL memory at %p\n", ptr);
+    retryix_mem_forget_advice(ptr);
     free(ptr);
 
     return RETRYIX_SUCCESS;
@@ -403,8 +415,15 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_prefetch(
 
     printf("[Kernel Lu Ban] Prefetching %zu bytes to device %d\n", size, target_device);
 
-    // 魯班智慧：預先調度內存到目標設備
-    printf("[Kernel Lu Ban] Memory prefetch completed for optimal access patterns\n");
+    // 魯班智慧：預先調度內存到目標設備 (背景預觸碰實體頁, 落在裝置所在節點)
+    int rc = retryix_mem_prefetch_async(ptr, size, target_device);
+    if (rc == -ENOMEM) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    if (rc != 0) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+    printf("[Kernel Lu Ban] Memory prefetch scheduled for optimal access patterns\n");
 
     return RETRYIX_SUCCESS;
 }
@@ -419,13 +438,27 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_advise(
 
     printf("[Kernel Lu Ban] Applying memory advice '%s' to %zu bytes\n", advice, size);
 
-    // 魯班智慧：根據建議優化內存行為
+    // 魯班智慧：根據建議優化內存行為 (字串建議不帶裝置, 以主機節點為目標)
+    retryix_mem_advice_t kind;
     if (strcmp(advice, "READ_MOSTLY") == 0) {
         printf("[Kernel Lu Ban] Optimizing for read-heavy access patterns\n");
+        kind = RETRYIX_MEM_ADVICE_READ_MOSTLY;
     } else if (strcmp(advice, "PREFERRED_LOCATION") == 0) {
         printf("[Kernel Lu Ban] Setting preferred memory location\n");
+        kind = RETRYIX_MEM_ADVICE_PREFERRED_LOCATION;
     } else if (strcmp(advice, "ACCESSED_BY") == 0) {
         printf("[Kernel Lu Ban] Registering device access patterns\n");
+        kind = RETRYIX_MEM_ADVICE_ACCESSED_BY;
+    } else {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+
+    int rc = retryix_mem_apply_advice(ptr, size, kind, RETRYIX_MEM_HOST_DEVICE);
+    if (rc == -ENOMEM) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    if (rc != 0) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
     }
 
     return RETRYIX_SUCCESS;
@@ -441,7 +474,18 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_bind_numa(
 
     printf("[Kernel Lu Ban] Binding %zu bytes to NUMA node %d\n", size, numa_node);
 
-    // 魯班智慧：優化NUMA訪問性能
+    // 魯班智慧：優化NUMA訪問性能 (mbind 頁面綁定並搬移既有頁面)
+    int rc = retryix_numa_bind(ptr, size, numa_node);
+    if (rc == -EINVAL) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+    if (rc == -ENOMEM || rc == -EIO) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    if (rc != 0) {
+        printf("[Kernel Lu Ban] NUMA binding not applied on this platform (errno %d)\n", -rc);
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
     printf("[Kernel Lu Ban] NUMA binding completed - optimized for node %d access\n", numa_node);
 
     return RETRYIX_SUCCESS;
@@ -459,9 +503,10 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_mem_query_location(
 
     int written = snprintf(location_info, info_size,
         "Memory Location: System RAM\n"
-        "NUMA Node: 0\n"
+        "NUMA Node: %d\n"
         "Device Accessible: Yes\n"
-        "Coherency: Maintained\n"
+        "Coherency: Maintained\n",
+        retryix_numa_node_of_addr(ptr)
     );
 
     return (written > 0 && written < (int)info_size) ? RETRYIX_SUCCESS : RETRYIX_ERROR_INVALID_PARAMETER;
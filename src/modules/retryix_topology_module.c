@@ -8,8 +8,14 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <errno.h>
+
+#include "retryix_numa_internal.h"
+#include "retryix_mem_advise_internal.h"
+#include "retryix_topology_svm_internal.h"
 
 #ifdef _WIN32
+#include <windows.h>
 #define RETRYIX_API __declspec(dllexport)
 #else
 #define RETRYIX_API __attribute__((visibility("default")))
@@ -29,6 +35,29 @@ typedef enum {
 static bool g_topology_discovered = false;
 static double g_bandwidth_measurement = 0.0;
 
+// === 內存域：每個域對應一個 NUMA 節點 ===
+#define SVM_DOMAIN_MAGIC 0x53444F4Du   // 'SDOM'
+
+typedef struct {
+    uint32_t magic;
+    int node;
+} svm_memory_domain_t;
+
+static volatile long g_domain_sequence = 0;
+
+static svm_memory_domain_t* svm_domain_from_handle(void* handle) {
+    svm_memory_domain_t* domain = (svm_memory_domain_t*)handle;
+    return (domain && domain->magic == SVM_DOMAIN_MAGIC) ? domain : NULL;
+}
+
+static const char* topology_cache_type_name(uint8_t type) {
+    switch (type) {
+        case RETRYIX_CACHE_DATA: return "Data";
+        case RETRYIX_CACHE_INSTRUCTION: return "Instruction";
+        default: return "Unified";
+    }
+}
+
 // === SVM 拓撲發現（下卷智慧：觀卦-觀察環境）===
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_discover_topology(void) {
     printf("[SVM Topology Lu Ban] Discovering memory topology with feng shui wisdom\n");
@@ -38,13 +67,24 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_discover_topology(void) {
         return RETRYIX_SUCCESS;
     }
 
-    // 魯班智慧：觀察系統內存佈局
+    // 魯班智慧：觀察系統內存佈局 (sysfs / Win32 NUMA API, 探索結果常駐)
+    const retryix_numa_topology_t* topo = retryix_numa_topology();
     printf("[SVM Topology Lu Ban] Observing memory hierarchy...\n");
-    printf("[SVM Topology Lu Ban] - L1 Cache: Present\n");
-    printf("[SVM Topology Lu Ban] - L2 Cache: Present\n");
-    printf("[SVM Topology Lu Ban] - L3 Cache: Present\n");
-    printf("[SVM Topology Lu Ban] - Main Memory: Present\n");
-    printf("[SVM Topology Lu Ban] - NUMA Nodes: Detected\n");
+    for (uint32_t i = 0; i < topo->cache_count; i++) {
+        const retryix_cache_info_t* c = &topo->caches[i];
+        printf("[SVM Topology Lu Ban] - L%u %s Cache: %u KB, %u B line, shared by %u CPUs\n",
+               c->level, topology_cache_type_name(c->type), c->size_kb, c->line_size, c->shared_cpus);
+    }
+    uint64_t mem_total = 0;
+    for (uint32_t n = 0; n < topo->max_node; n++) mem_total += topo->node_mem_total[n];
+    printf("[SVM Topology Lu Ban] - Main Memory: %.1f GB\n", mem_total / (1024.0 * 1024.0 * 1024.0));
+    printf("[SVM Topology Lu Ban] - NUMA Nodes: %u (%s), %u CPUs\n", topo->node_count,
+           topo->from_firmware ? "firmware" : "single-node fallback", topo->cpu_count);
+    uint32_t local_devices = 0;
+    for (uint32_t i = 0; i < topo->device_count; i++) {
+        if (topo->devices[i].node >= 0) local_devices++;
+    }
+    printf("[SVM Topology Lu Ban] - PCI Devices: %u (%u with node affinity)\n", topo->device_count, local_devices);
 
     g_topology_discovered = true;
     printf("[SVM Topology Lu Ban] Memory topology discovery completed - system feng shui mapped\n");
@@ -62,38 +102,68 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_analyze_numa_layout(void)
     }
 
     // 魯班智慧：分析環境配置的優劣
+    retryix_numa_refresh_free_memory();
+    const retryix_numa_topology_t* topo = retryix_numa_topology();
     printf("[SVM Topology Lu Ban] Analyzing memory node relationships...\n");
-    printf("[SVM Topology Lu Ban] - Node distances calculated\n");
-    printf("[SVM Topology Lu Ban] - Bandwidth patterns identified\n");
-    printf("[SVM Topology Lu Ban] - Optimal allocation strategies determined\n");
+    for (uint32_t n = 0; n < topo->max_node; n++) {
+        if (!topo->node_online[n]) continue;
+        printf("[SVM Topology Lu Ban] - Node %u: %u CPUs, %.1f / %.1f GB free, distances:",
+               n, topo->node_cpu_count[n],
+               topo->node_mem_free[n] / (1024.0 * 1024.0 * 1024.0),
+               topo->node_mem_total[n] / (1024.0 * 1024.0 * 1024.0));
+        for (uint32_t m = 0; m < topo->max_node; m++) {
+            if (topo->node_online[m]) printf(" %u", topo->distance[n][m]);
+        }
+        printf("\n");
+    }
+    for (uint32_t i = 0; i < topo->device_count; i++) {
+        const retryix_numa_device_t* d = &topo->devices[i];
+        if (d->node >= 0) {
+            printf("[SVM Topology Lu Ban] - Device %s [%04x:%04x] on node %d\n",
+                   d->bdf, d->vendor_id, d->device_id, d->node);
+        }
+    }
 
     printf("[SVM Topology Lu Ban] NUMA layout analysis completed - feng shui optimized\n");
     return RETRYIX_SUCCESS;
 }
 
 // === SVM內存分配（上卷技術：天工開物）===
-RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc(size_t size) {
+// 模組間共用的實作 (retryix_topology_svm_internal.h); 導出的 retryix_svm_alloc / retryix_svm_free 僅轉呼叫
+void* retryix_topology_svm_alloc(size_t size) {
     if (!g_topology_discovered || size == 0) {
         return NULL;
     }
 
     printf("[SVM Topology Lu Ban] Allocating SVM memory: %zu bytes\n", size);
 
-    void* ptr = malloc(size);  // 簡化實現
+    void* ptr = retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_DEFAULT, 0);  // 大於門檻時以大頁支撐
     if (ptr) {
         printf("[SVM Topology Lu Ban] SVM allocation successful at %p\n", ptr);
     }
     return ptr;
 }
 
+void retryix_topology_svm_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    printf("[SVM Topology Lu Ban] Freeing SVM memory at %p\n", ptr);
+    retryix_mem_forget_advice(ptr);
+    retryix_numa_free(ptr);   // 節點放置映射區或一般 malloc
+}
+
+RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc(size_t size) {
+    return retryix_topology_svm_alloc(size);
+}
+
 // === SVM內存釋放===
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_free(void* ptr) {
     if (!ptr) {
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
-
-    printf("[SVM Topology Lu Ban] Freeing SVM memory at %p\n", ptr);
-    free(ptr);
+    retryix_topology_svm_free(ptr);
     return RETRYIX_SUCCESS;
 }
 
@@ -119,27 +189,92 @@ RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc_aligned(size_t size, size_t ali
 }
 
 // === NUMA感知分配===
+// 優先放在呼叫線程所在節點, 該節點不足時由核心回退到其他節點
 RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc_nearest_node(size_t size) {
-    printf("[SVM Topology Lu Ban] NUMA-aware allocation: %zu bytes\n", size);
-    return retryix_svm_alloc(size);  // 簡化為普通分配
+    if (!g_topology_discovered || size == 0) {
+        return NULL;
+    }
+
+    int node = retryix_numa_current_node();
+    if (node < 0 || node >= RETRYIX_NUMA_MAX_NODES) {
+        // getcpu 回報的節點超出節點遮罩可表示的範圍, 改用預設放置
+        printf("[SVM Topology Lu Ban] NUMA-aware allocation: node %d out of range, using default placement\n", node);
+        return retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_DEFAULT, 0);
+    }
+    printf("[SVM Topology Lu Ban] NUMA-aware allocation: %zu bytes on node %d\n", size, node);
+    return retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_PREFERRED, 1ull << node);
 }
 
 // === 拓撲感知分配===
+// 依距離矩陣挑選最近且可用記憶體足夠的節點並嚴格綁定
 RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc_topology_aware(size_t size) {
-    printf("[SVM Topology Lu Ban] Topology-aware allocation: %zu bytes\n", size);
-    return retryix_svm_alloc(size);
+    if (!g_topology_discovered || size == 0) {
+        return NULL;
+    }
+
+    retryix_numa_refresh_free_memory();
+    int node = retryix_numa_nearest_node(retryix_numa_current_node(), size);
+    printf("[SVM Topology Lu Ban] Topology-aware allocation: %zu bytes bound to node %d\n", size, node);
+    return retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_BIND, 1ull << node);
 }
 
 // === 分散式分配===
+// 逐頁交錯於距離最近的 node_count 個節點 (<= 0 表示全部節點)
 RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc_distributed(size_t size, int node_count) {
-    printf("[SVM Topology Lu Ban] Distributed allocation: %zu bytes across %d nodes\n", size, node_count);
-    return retryix_svm_alloc(size);
+    if (!g_topology_discovered || size == 0) {
+        return NULL;
+    }
+
+    uint64_t mask = retryix_numa_nearest_mask(retryix_numa_current_node(), node_count);
+    printf("[SVM Topology Lu Ban] Distributed allocation: %zu bytes interleaved across node mask 0x%llx\n",
+           size, (unsigned long long)mask);
+    return retryix_numa_alloc(size, RETRYIX_NUMA_POLICY_INTERLEAVE, mask);
 }
 
 // === 一致性群組分配===
 RETRYIX_API void* RETRYIX_CALL retryix_svm_alloc_coherent_group(size_t size, int group_id) {
     printf("[SVM Topology Lu Ban] Coherent group allocation: %zu bytes, group %d\n", size, group_id);
-    return retryix_svm_alloc(size);
+    return retryix_topology_svm_alloc(size);
+}
+
+// === 大頁門檻設定===
+// threshold_bytes = 0 停用大頁; use_hugetlb: 1 嘗試 hugetlb, 0 只用透明大頁, -1 依系統大頁池自動判斷
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_set_hugepage_policy(size_t threshold_bytes, int use_hugetlb) {
+    retryix_numa_set_huge_policy(threshold_bytes, use_hugetlb);
+    printf("[SVM Topology Lu Ban] Huge page threshold set to %zu bytes (hugetlb: %s)\n", threshold_bytes,
+           use_hugetlb < 0 ? "auto" : (use_hugetlb ? "on" : "off"));
+    return RETRYIX_SUCCESS;
+}
+
+// === 大頁統計===
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_get_hugepage_stats(
+    char* stats_buffer, size_t buffer_size) {
+
+    if (!stats_buffer || buffer_size < 256) {
+        return RETRYIX_ERROR_INSUFFICIENT_BUFFER;
+    }
+
+    retryix_numa_huge_stats_t stats;
+    retryix_numa_huge_stats(&stats);
+
+    int written = snprintf(stats_buffer, buffer_size,
+        "=== Huge Page Statistics (Lu Ban) ===\n"
+        "Threshold: %zu bytes\n"
+        "HugeTLB Backed: %llu bytes\n"
+        "THP Advised: %llu bytes\n"
+        "THP Backed: %llu bytes\n"
+        "Regular Regions: %llu bytes\n"
+        "Huge Requests: %llu (fallbacks: %llu)\n",
+        retryix_numa_huge_threshold(),
+        (unsigned long long)stats.hugetlb_bytes,
+        (unsigned long long)stats.thp_bytes,
+        (unsigned long long)stats.thp_backed_bytes,
+        (unsigned long long)stats.regular_bytes,
+        (unsigned long long)stats.huge_requests,
+        (unsigned long long)stats.fallbacks
+    );
+
+    return (written > 0 && written < (int)buffer_size) ? RETRYIX_SUCCESS : RETRYIX_ERROR_INSUFFICIENT_BUFFER;
 }
 
 // === 延遲監控===
@@ -216,12 +351,30 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_create_memory_domain(
 
     printf("[SVM Topology Lu Ban] Creating memory domain\n");
 
-    *domain = malloc(128);
-    if (!*domain) {
+    svm_memory_domain_t* created = (svm_memory_domain_t*)malloc(sizeof(svm_memory_domain_t));
+    if (!created) {
         return RETRYIX_ERROR_OUT_OF_MEMORY;
     }
 
-    printf("[SVM Topology Lu Ban] Memory domain created at %p\n", *domain);
+    // 依建立順序輪流對應線上節點, 建立 N 個域即得到每節點一個域
+    const retryix_numa_topology_t* topo = retryix_numa_topology();
+#ifdef _WIN32
+    long sequence = InterlockedIncrement(&g_domain_sequence) - 1;
+#else
+    long sequence = __sync_fetch_and_add(&g_domain_sequence, 1);
+#endif
+    long nth = sequence % (long)topo->node_count;
+    created->magic = SVM_DOMAIN_MAGIC;
+    created->node = 0;
+    for (uint32_t n = 0; n < topo->max_node; n++) {
+        if (topo->node_online[n] && nth-- == 0) {
+            created->node = (int)n;
+            break;
+        }
+    }
+    *domain = created;
+
+    printf("[SVM Topology Lu Ban] Memory domain created at %p on NUMA node %d\n", *domain, created->node);
     return RETRYIX_SUCCESS;
 }
 
@@ -230,8 +383,14 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_destroy_memory_domain(void
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
 
+    svm_memory_domain_t* owned = svm_domain_from_handle(domain);
+    if (!owned) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+
     printf("[SVM Topology Lu Ban] Destroying memory domain at %p\n", domain);
-    free(domain);
+    owned->magic = 0;
+    free(owned);
 
     return RETRYIX_SUCCESS;
 }
@@ -244,7 +403,15 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_bind_to_domain(
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
 
-    printf("[SVM Topology Lu Ban] Binding memory %p to domain %p\n", ptr, domain);
+    svm_memory_domain_t* target = svm_domain_from_handle(domain);
+    if (!target) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+
+    printf("[SVM Topology Lu Ban] Binding memory %p to domain %p (node %d)\n", ptr, domain, target->node);
+    if (retryix_numa_bind(ptr, 0, target->node) != 0) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
     printf("[SVM Topology Lu Ban] Memory binding completed\n");
 
     return RETRYIX_SUCCESS;
@@ -259,6 +426,11 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_set_memory_affinity(
     }
 
     printf("[SVM Topology Lu Ban] Setting memory affinity for %p to NUMA node %d\n", ptr, numa_node);
+    int rc = retryix_numa_bind(ptr, 0, numa_node);
+    if (rc != 0) {
+        printf("[SVM Topology Lu Ban] Memory affinity not applied (errno %d)\n", -rc);
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
     printf("[SVM Topology Lu Ban] Memory affinity configured\n");
 
     return RETRYIX_SUCCESS;
@@ -272,7 +444,7 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_get_memory_affinity(
     }
 
     printf("[SVM Topology Lu Ban] Getting memory affinity for %p\n", ptr);
-    *numa_node = 0;  // 預設為NUMA節點0
+    *numa_node = retryix_numa_node_of_addr(ptr);   // -1 = 尚未配置實體頁
     printf("[SVM Topology Lu Ban] Memory affinity: NUMA node %d\n", *numa_node);
 
     return RETRYIX_SUCCESS;
@@ -288,17 +460,25 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_get_memory_hierarchy(
 
     printf("[SVM Topology Lu Ban] Analyzing memory hierarchy\n");
 
-    int written = snprintf(hierarchy_info, info_size,
-        "=== Memory Hierarchy Analysis (Lu Ban) ===\n"
-        "L1 Cache: 32KB per core (Data + Instruction)\n"
-        "L2 Cache: 256KB per core (Unified)\n"
-        "L3 Cache: 8MB shared (Last Level Cache)\n"
-        "Main Memory: DDR4/DDR5 System RAM\n"
-        "NUMA Topology: %d nodes detected\n"
-        "Memory Controllers: 2 channels active\n"
-        "Lu Ban Assessment: Optimal for SVM operations\n",
-        g_topology_discovered ? 2 : 1
-    );
+    const retryix_numa_topology_t* topo = retryix_numa_topology();
+    int written = snprintf(hierarchy_info, info_size, "=== Memory Hierarchy Analysis (Lu Ban) ===\n");
+    for (uint32_t i = 0; i < topo->cache_count && written > 0 && written < (int)info_size; i++) {
+        const retryix_cache_info_t* c = &topo->caches[i];
+        written += snprintf(hierarchy_info + written, info_size - written,
+            "L%u Cache: %uKB %s, %uB line, shared by %u CPUs\n",
+            c->level, c->size_kb, topology_cache_type_name(c->type), c->line_size, c->shared_cpus);
+    }
+    if (written > 0 && written < (int)info_size) {
+        uint64_t mem_total = 0;
+        for (uint32_t n = 0; n < topo->max_node; n++) mem_total += topo->node_mem_total[n];
+        written += snprintf(hierarchy_info + written, info_size - written,
+            "Main Memory: %.1f GB System RAM\n"
+            "NUMA Topology: %u nodes detected%s\n"
+            "Logical CPUs: %u\n",
+            mem_total / (1024.0 * 1024.0 * 1024.0),
+            topo->node_count, topo->from_firmware ? "" : " (single-node fallback)",
+            topo->cpu_count);
+    }
 
     return (written > 0 && written < (int)info_size) ? RETRYIX_SUCCESS : RETRYIX_ERROR_INSUFFICIENT_BUFFER;
 }
@@ -387,22 +567,64 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_migrate_between_domains(
         return RETRYIX_ERROR_INVALID_PARAMETER;
     }
 
-    printf("[SVM Topology Lu Ban] Migrating memory %p from domain %p to %p\n",
-           ptr, source_domain, target_domain);
+    svm_memory_domain_t* source = svm_domain_from_handle(source_domain);
+    svm_memory_domain_t* target = svm_domain_from_handle(target_domain);
+    if (!source || !target) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+
+    printf("[SVM Topology Lu Ban] Migrating memory %p from domain %p (node %d) to %p (node %d)\n",
+           ptr, source_domain, source->node, target_domain, target->node);
+
+    // 背景搬移 ptr 所屬的整個映射區; 進度以 retryix_svm_get_migration_progress 查詢
+    int rc = retryix_numa_migrate_async(ptr, 0, target->node, true);
+    if (rc == -ENOMEM) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    if (rc != 0) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
 
-    printf("[SVM Topology Lu Ban] Memory migration completed\n");
+    printf("[SVM Topology Lu Ban] Memory migration queued\n");
     return RETRYIX_SUCCESS;
 }
 
+// === 搬移進度===
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_get_migration_progress(
+    uint64_t* pages_done, uint64_t* pages_total, int* pending_jobs) {
+
+    if (!pages_done || !pages_total) {
+        return RETRYIX_ERROR_INVALID_PARAMETER;
+    }
+
+    retryix_numa_migration_progress_t progress;
+    retryix_numa_migration_progress(&progress);
+    *pages_done = progress.pages_scanned;
+    *pages_total = progress.pages_total;
+    if (pending_jobs) {
+        *pending_jobs = (int)progress.jobs_pending;
+    }
+    return RETRYIX_SUCCESS;
+}
+
+// === 等待搬移完成===
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_wait_migration(uint32_t timeout_ms) {
+    return retryix_numa_migration_wait(timeout_ms) ? RETRYIX_SUCCESS : RETRYIX_ERROR_NOT_INITIALIZED;
+}
+
 // === 擺放優化===
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_optimize_placement(void) {
     printf("[SVM Topology Lu Ban] Optimizing memory placement with advanced algorithms\n");
 
+    // 取樣統計來自 kernel 執行時的 SVM 參數存取; 主要存取節點明確的區域搬到該節點
     printf("[SVM Topology Lu Ban] - Analyzing access patterns\n");
-    printf("[SVM Topology Lu Ban] - Computing optimal placement\n");
-    printf("[SVM Topology Lu Ban] - Applying placement strategy\n");
+    int queued = retryix_numa_optimize_placement();
+    if (queued < 0) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    printf("[SVM Topology Lu Ban] - %d region(s) queued for migration toward their accessors\n", queued);
 
-    printf("[SVM Topology Lu Ban] Memory placement optimization completed\n");
+    printf("[SVM Topology Lu Ban] Memory placement optimization scheduled\n");
     return RETRYIX_SUCCESS;
 }
 
@@ -410,11 +632,14 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_optimize_placement(void) {
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_rebalance_topology(void) {
     printf("[SVM Topology Lu Ban] Rebalancing memory topology for optimal performance\n");
 
-    printf("[SVM Topology Lu Ban] - Load analysis completed\n");
-    printf("[SVM Topology Lu Ban] - Rebalancing strategy applied\n");
-    printf("[SVM Topology Lu Ban] - Performance verification passed\n");
+    // 把偏離登記策略 (綁定 / 優先 / 交錯) 的頁面搬回應有節點
+    int queued = retryix_numa_rebalance();
+    if (queued < 0) {
+        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    }
+    printf("[SVM Topology Lu Ban] - %d region(s) queued for rebalancing\n", queued);
 
-    printf("[SVM Topology Lu Ban] Topology rebalancing completed\n");
+    printf("[SVM Topology Lu Ban] Topology rebalancing scheduled\n");
     return RETRYIX_SUCCESS;
 }
 
@@ -455,4 +680,4 @@ RETRYIX_API const char* RETRYIX_CALL retryix_svm_get_error_string(retryix_result
         default:
             return "Unknown SVM error - investigate topology";
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -11,23 +11,13 @@
 
 #ifdef _WIN32
 #include <windows.h>
-#define RETRYIX_API __declspec(dllexport)
 #else
-#define RETRYIX_API __attribute__((visibility("default")))
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
 #endif
 
-#define RETRYIX_CALL __cdecl
-
-// 錯誤碼定義
-typedef enum {
-    RETRYIX_SUCCESS = 0,
-    RETRYIX_ERROR_NOT_INITIALIZED = -6,
-    RETRYIX_ERROR_NETWORK_UNAVAILABLE = -10,
-    RETRYIX_ERROR_RDMA_NOT_SUPPORTED = -11,
-    RETRYIX_ERROR_DPDK_NOT_SUPPORTED = -12,
-    RETRYIX_ERROR_INVALID_PARAMETER = -1,
-    RETRYIX_ERROR_OUT_OF_MEMORY = -2
-} retryix_result_t;
+#include "retryix_zerocopy_internal.h"
 
 // === 零拷貝網絡狀態（下卷智慧：環境觀察）===
 static bool g_zerocopy_initialized = false;
@@ -35,8 +25,102 @@ static bool g_rdma_available = false;
 static bool g_dpdk_available = false;
 static int g_detection_score = 0;
 
+// === DMA 傳輸記錄（以 transfer_id 取模定位）===
+#define ZC_MAX_TRANSFERS 4096
+
+typedef struct {
+    volatile uint64_t transfer_id;
+    volatile uint32_t status;             ///< retryix_dma_status_t
+    retryix_zc_transfer_cb done;          ///< 完成回呼 (可為 NULL)
+    void* done_ctx;
+} zc_transfer_slot_t;
+
+static zc_transfer_slot_t g_transfers[ZC_MAX_TRANSFERS];
+static volatile int64_t g_next_transfer_id = 0;
+
+uint64_t retryix_zc_transfer_open_cb(retryix_zc_transfer_cb done, void* ctx) {
+    uint64_t id = (uint64_t)RX_ADD64(&g_next_transfer_id, 1) + 1;
+    zc_transfer_slot_t* slot = &g_transfers[id % ZC_MAX_TRANSFERS];
+    slot->done = done;
+    slot->done_ctx = ctx;
+    RX_STORE32(&slot->status, RETRYIX_DMA_IN_PROGRESS);
+    RX_STORE64(&slot->transfer_id, id);
+    return id;
+}
+
+uint64_t retryix_zc_transfer_open(void) {
+    return retryix_zc_transfer_open_cb(NULL, NULL);
+}
+
+void retryix_zc_transfer_finish(uint64_t transfer_id, retryix_dma_status_t status) {
+    zc_transfer_slot_t* slot = &g_transfers[transfer_id % ZC_MAX_TRANSFERS];
+    if ((uint64_t)RX_LOAD64(&slot->transfer_id) != transfer_id) {
+        return;
+    }
+    retryix_zc_transfer_cb done = slot->done;
+    void* ctx = slot->done_ctx;
+    RX_STORE32(&slot->status, status);
+    if (done) {
+        done(ctx, transfer_id, status);
+    }
+}
+
+static uint64_t zc_now_ms(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u + 1;
+#endif
+}
+
+static bool zc_is_tcp(const retryix_net_connection_t* connection) {
+    return connection && connection->protocol == RETRYIX_NET_PROTO_TCP_OFFLOAD;
+}
+
+// 投遞 TCP 傳輸並等待完成 (同步 API 使用)
+static retryix_zerocopy_result_t zc_tcp_run(const retryix_net_connection_t* connection, bool is_read,
+                                            void* local_buffer, uint64_t remote_addr, size_t size, uint32_t rkey) {
+    uint64_t id = retryix_zc_transfer_open();
+    retryix_zerocopy_result_t rc = is_read
+        ? retryix_zc_tcp_post_read(connection, local_buffer, remote_addr, size, rkey, id)
+        : retryix_zc_tcp_post_write(connection, local_buffer, remote_addr, size, rkey, id);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        retryix_zc_transfer_finish(id, RETRYIX_DMA_ERROR);
+        return rc;
+    }
+    return retryix_zerocopy_dma_wait(id, RETRYIX_ZC_WAIT_INFINITE);
+}
+
+static const char* zc_protocol_name(retryix_net_protocol_t protocol) {
+    switch (protocol) {
+    case RETRYIX_NET_PROTO_TCP_OFFLOAD: return "tcp";
+    case RETRYIX_NET_PROTO_SHM: return "shm";
+    case RETRYIX_NET_PROTO_UNKNOWN: return "local";
+    default: return "rdma";
+    }
+}
+
+// === 遠端位址解析（上卷技術：隔空取物術）===
+// 依連線協議把 (remote_addr, rkey) 轉為本地可存取的指標; connection 為 NULL 表示同進程
+static retryix_zerocopy_result_t zc_resolve_remote(const retryix_net_connection_t* connection,
+                                                   uint32_t rkey, uint64_t remote_addr, size_t size, void** target) {
+    if (!connection) {
+        return retryix_zc_pool_resolve(rkey, remote_addr, size, target);
+    }
+
+    switch (connection->protocol) {
+    case RETRYIX_NET_PROTO_SHM:
+        return retryix_zc_shm_resolve(connection, rkey, remote_addr, size, target);
+    default:
+        // 下卷智慧：沒有網卡就不假裝傳輸成功
+        return g_rdma_available ? RETRYIX_ZC_ERROR_NOT_IMPLEMENTED : RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+    }
+}
+
 // === 網絡能力檢測（上卷技術：千里眼術）===
-static retryix_result_t detect_network_capabilities(void) {
+static retryix_zerocopy_result_t detect_network_capabilities(void) {
     printf("[ZeroCopy Lu Ban] Detecting network capabilities with thousand-mile vision...\n");
 
     // 魯班智慧：觀察環境，評估條件
@@ -59,16 +143,16 @@ static retryix_result_t detect_network_capabilities(void) {
     printf("[ZeroCopy Lu Ban] RDMA available: %s\n", g_rdma_available ? "Yes" : "No");
     printf("[ZeroCopy Lu Ban] DPDK available: %s\n", g_dpdk_available ? "Yes" : "No");
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 零拷貝網絡初始化（上卷技術：蜘蛛結網術）===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_net_init(void) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_net_init(void) {
     printf("[ZeroCopy Lu Ban] Initializing zero-copy networking with spider web wisdom\n");
 
     if (g_zerocopy_initialized) {
         printf("[ZeroCopy Lu Ban] Network already initialized - resource conservation\n");
-        return RETRYIX_SUCCESS;
+        return RETRYIX_ZC_SUCCESS;
     }
 
     // 檢測環境能力
@@ -78,413 +162,646 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_net_init(void) {
     if (g_detection_score >= 20) {
         g_zerocopy_initialized = true;
         printf("[ZeroCopy Lu Ban] Zero-copy networking initialized with score %d\n", g_detection_score);
-        return RETRYIX_SUCCESS;
+        return RETRYIX_ZC_SUCCESS;
     } else {
         printf("[ZeroCopy Lu Ban] Environment insufficient for zero-copy networking\n");
-        return RETRYIX_ERROR_NETWORK_UNAVAILABLE;
+        return RETRYIX_ZC_ERROR_NETWORK_DOWN;
     }
 }
 
 // === RDMA 配置（上卷技術：千里傳音術）===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_configure_rdma(void) {
-    printf("[ZeroCopy Lu Ban] Configuring RDMA with long-distance communication wisdom\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_configure_rdma(const char* device_name) {
+    printf("[ZeroCopy Lu Ban] Configuring RDMA on %s with long-distance communication wisdom\n",
+           device_name ? device_name : "(default)");
 
     if (!g_zerocopy_initialized) {
         printf("[ZeroCopy Lu Ban] Network not initialized - foundation required first\n");
-        return RETRYIX_ERROR_NOT_INITIALIZED;
+        return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
     }
 
     // 下卷智慧：誠實面對限制
     if (!g_rdma_available) {
         printf("[ZeroCopy Lu Ban] RDMA not available on this system - accepting limitations\n");
-        return RETRYIX_ERROR_RDMA_NOT_SUPPORTED;
+        return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
     }
 
     printf("[ZeroCopy Lu Ban] RDMA configured successfully\n");
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === DPDK 配置（上卷技術：分光化影術）===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_configure_dpdk(void) {
-    printf("[ZeroCopy Lu Ban] Configuring DPDK with traffic splitting wisdom\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_configure_dpdk(uint16_t port_id) {
+    printf("[ZeroCopy Lu Ban] Configuring DPDK port %u with traffic splitting wisdom\n", port_id);
 
     if (!g_zerocopy_initialized) {
         printf("[ZeroCopy Lu Ban] Network not initialized - foundation required first\n");
-        return RETRYIX_ERROR_NOT_INITIALIZED;
+        return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
     }
 
     // 下卷智慧：根據實際條件提供服務
     if (!g_dpdk_available) {
         printf("[ZeroCopy Lu Ban] DPDK not available - using alternative methods\n");
-        return RETRYIX_ERROR_DPDK_NOT_SUPPORTED;
+        return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
     }
 
     printf("[ZeroCopy Lu Ban] DPDK configured with enhanced performance\n");
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 網絡清理（下卷智慧：善始善終）===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_net_cleanup(void) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_net_cleanup(void) {
     printf("[ZeroCopy Lu Ban] Cleaning up network resources with proper closure\n");
 
     if (!g_zerocopy_initialized) {
         printf("[ZeroCopy Lu Ban] Network already clean - no action needed\n");
-        return RETRYIX_SUCCESS;
+        return RETRYIX_ZC_SUCCESS;
     }
 
     // 下卷智慧：歸還借用的資源
+    // 註冊緩衝池與已導出區域保持存活: 呼叫端可能仍持有描述符
+    retryix_zc_perf_shutdown();
+    retryix_zc_shm_shutdown();
+    retryix_zc_tcp_shutdown();
     g_zerocopy_initialized = false;
     g_rdma_available = false;
     g_dpdk_available = false;
     g_detection_score = 0;
 
     printf("[ZeroCopy Lu Ban] Network cleanup completed - all debts settled\n");
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === DMA傳輸功能（上卷技術：瞬移大法）===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_dma_transfer(
-    void* src, void* dst, size_t size) {
+// 目標由 rkey 驗證; 支援同進程、本機共享記憶體與 TCP 連線
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_dma_transfer(
+    const retryix_net_connection_t* connection, const void* local_buffer,
+    uint64_t remote_addr, size_t size, uint32_t rkey) {
 
-    if (!src || !dst || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!local_buffer || size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
     if (!g_zerocopy_initialized) {
-        return RETRYIX_ERROR_NOT_INITIALIZED;
+        return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
+    }
+
+    if (zc_is_tcp(connection)) {
+        return zc_tcp_run(connection, false, (void*)local_buffer, remote_addr, size, rkey);
     }
 
-    printf("[ZeroCopy Lu Ban] DMA transfer: %zu bytes from %p to %p\n", size, src, dst);
-    memcpy(dst, src, size);  // 簡化實現
-    printf("[ZeroCopy Lu Ban] DMA transfer completed successfully\n");
+    void* target = NULL;
+    retryix_zerocopy_result_t rc = zc_resolve_remote(connection, rkey, remote_addr, size, &target);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        return rc;
+    }
+    memcpy(target, local_buffer, size);
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === GPU到網絡零拷貝===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_gpu_to_net(
-    void* gpu_ptr, size_t size, int target_node) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_gpu_to_net(
+    const void* gpu_buffer, retryix_net_buffer_t* net_buffer, size_t size) {
 
-    if (!gpu_ptr || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!gpu_buffer || !net_buffer || !net_buffer->buffer || size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+    if (size > net_buffer->size) {
+        return RETRYIX_ZC_ERROR_BUFFER_TOO_SMALL;
     }
 
-    printf("[ZeroCopy Lu Ban] GPU to network zero-copy: %zu bytes to node %d\n", size, target_node);
-    printf("[ZeroCopy Lu Ban] Direct GPU-Network path established\n");
+    // SVM 指標可由主機直接存取
+    if (gpu_buffer != net_buffer->buffer) {
+        memcpy(net_buffer->buffer, gpu_buffer, size);
+    }
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 網絡到GPU零拷貝===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_net_to_gpu(
-    void* net_buffer, void* gpu_ptr, size_t size) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_net_to_gpu(
+    const retryix_net_buffer_t* net_buffer, void* gpu_buffer, size_t size) {
 
-    if (!net_buffer || !gpu_ptr || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!net_buffer || !net_buffer->buffer || !gpu_buffer || size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+    if (size > net_buffer->size) {
+        return RETRYIX_ZC_ERROR_BUFFER_TOO_SMALL;
     }
 
-    printf("[ZeroCopy Lu Ban] Network to GPU zero-copy: %zu bytes\n", size);
-    printf("[ZeroCopy Lu Ban] Direct Network-GPU path established\n");
+    if (gpu_buffer != net_buffer->buffer) {
+        memcpy(gpu_buffer, net_buffer->buffer, size);
+    }
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === InfiniBand初始化===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_infiniband_init(void) {
-    printf("[ZeroCopy Lu Ban] Initializing InfiniBand with high-speed wisdom\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_infiniband_init(const char* device_name) {
+    printf("[ZeroCopy Lu Ban] Initializing InfiniBand %s with high-speed wisdom\n",
+           device_name ? device_name : "(default)");
 
     if (!g_zerocopy_initialized) {
-        return RETRYIX_ERROR_NOT_INITIALIZED;
+        return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
     }
 
     printf("[ZeroCopy Lu Ban] InfiniBand interface configured\n");
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === RoCE初始化===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_roce_init(void) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_roce_init(const char* device_name) {
     printf("[ZeroCopy Lu Ban] Initializing RoCE (RDMA over Converged Ethernet)\n");
-    return retryix_zerocopy_infiniband_init();  // 類似實現
+    return retryix_zerocopy_infiniband_init(device_name);  // 類似實現
 }
 
 // === iWARP初始化===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_iwarp_init(void) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_iwarp_init(const char* device_name) {
     printf("[ZeroCopy Lu Ban] Initializing iWARP protocol\n");
-    return retryix_zerocopy_infiniband_init();
+    return retryix_zerocopy_infiniband_init(device_name);
 }
 
 // === OmniPath初始化===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_omnipath_init(void) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_omnipath_init(const char* device_name) {
     printf("[ZeroCopy Lu Ban] Initializing Intel OmniPath Architecture\n");
-    return retryix_zerocopy_infiniband_init();
+    return retryix_zerocopy_infiniband_init(device_name);
 }
 
 // === 網絡狀態報告（上卷技術：千里眼術+下卷智慧：如實觀察）===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_get_system_health(
-    char* health_report, size_t max_report_size) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_get_system_health(
+    char* health_report, size_t buffer_size) {
 
-    if (!health_report || max_report_size < 256) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!health_report || buffer_size < 256) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
+    retryix_zc_pool_stats_t pool;
+    retryix_zc_pool_get_stats(&pool);
+
     // 魯班智慧：如實報告系統狀態
-    int written = snprintf(health_report, max_report_size,
+    int written = snprintf(health_report, buffer_size,
         "=== Zero-Copy Network Health Report (Lu Ban Enhanced) ===\n"
         "Network Initialized: %s\n"
         "RDMA Available: %s\n"
         "DPDK Available: %s\n"
         "Capability Score: %d/100\n"
+        "Buffer Pool: %llu buffers, %llu in use, %llu MB reserved (%llu MB huge)\n"
         "Overall Assessment: %s\n"
         "Lu Ban Wisdom: %s\n",
         g_zerocopy_initialized ? "Yes" : "No",
         g_rdma_available ? "Yes" : "No",
         g_dpdk_available ? "Yes" : "No",
         g_detection_score,
+        (unsigned long long)pool.pooled_buffers,
+        (unsigned long long)pool.buffers_in_use,
+        (unsigned long long)(pool.bytes_reserved >> 20),
+        (unsigned long long)(pool.bytes_huge >> 20),
         (g_detection_score >= 40) ? "Excellent" :
         (g_detection_score >= 20) ? "Good" : "Limited",
         "Accept current conditions, work within constraints, achieve harmony"
     );
 
-    return (written > 0 && written < (int)max_report_size) ? RETRYIX_SUCCESS : RETRYIX_ERROR_INVALID_PARAMETER;
+    return (written > 0 && written < (int)buffer_size) ? RETRYIX_ZC_SUCCESS : RETRYIX_ZC_ERROR_BUFFER_TOO_SMALL;
 }
 
 // === 高級零拷貝功能擴展 ===
 
 // === DMA異步傳輸===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_dma_transfer_async(
-    void* src, void* dst, size_t size, void** transfer_handle) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_dma_transfer_async(
+    const retryix_net_connection_t* connection, const void* local_buffer,
+    uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t* transfer_id) {
 
-    if (!src || !dst || size == 0 || !transfer_handle) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!local_buffer || size == 0 || !transfer_id) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Async DMA transfer: %zu bytes from %p to %p\n", size, src, dst);
+    if (!g_zerocopy_initialized) {
+        return RETRYIX_ZC_ERROR_NOT_INITIALIZED;
+    }
 
-    *transfer_handle = malloc(64);  // 模擬傳輸句柄
-    if (!*transfer_handle) {
-        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    uint64_t id = retryix_zc_transfer_open();
+    retryix_zerocopy_result_t rc = retryix_zc_post_write(connection, local_buffer, remote_addr, size, rkey, id);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        retryix_zc_transfer_finish(id, RETRYIX_DMA_ERROR);
     }
 
-    printf("[ZeroCopy Lu Ban] Async DMA transfer initiated - handle: %p\n", *transfer_handle);
-    return RETRYIX_SUCCESS;
+    *transfer_id = id;
+    return rc;
+}
+
+retryix_zerocopy_result_t retryix_zc_post_write(const retryix_net_connection_t* connection, const void* local_buffer,
+                                                uint64_t remote_addr, size_t size, uint32_t rkey, uint64_t transfer_id) {
+    if (zc_is_tcp(connection)) {
+        // 由連線的送出線程批次送出, 完成時回報 transfer_id
+        return retryix_zc_tcp_post_write(connection, local_buffer, remote_addr, size, rkey, transfer_id);
+    }
+
+    // 同進程 / 共享記憶體路徑立即完成
+    retryix_zerocopy_result_t rc = retryix_zerocopy_dma_transfer(connection, local_buffer, remote_addr, size, rkey);
+    if (rc == RETRYIX_ZC_SUCCESS) {
+        retryix_zc_transfer_finish(transfer_id, RETRYIX_DMA_COMPLETED);
+    }
+    return rc;
 }
 
 // === DMA狀態查詢===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_dma_status(
-    void* transfer_handle, bool* completed) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_dma_status(
+    uint64_t transfer_id, retryix_dma_status_t* status) {
 
-    if (!transfer_handle || !completed) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (transfer_id == 0 || !status) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Checking DMA transfer status for handle: %p\n", transfer_handle);
-    *completed = true;  // 模擬立即完成
-    printf("[ZeroCopy Lu Ban] DMA transfer completed\n");
+    zc_transfer_slot_t* slot = &g_transfers[transfer_id % ZC_MAX_TRANSFERS];
+    if ((uint64_t)RX_LOAD64(&slot->transfer_id) != transfer_id) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;  // 未知或已被覆蓋的傳輸
+    }
+    *status = (retryix_dma_status_t)RX_LOAD32(&slot->status);
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === DMA等待===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_dma_wait(void* transfer_handle) {
-    if (!transfer_handle) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+// timeout_ms 為 0 時只查詢一次, RETRYIX_ZC_WAIT_INFINITE 表示無限等待
+// 先自旋、再讓出時間片, 超過 2 ms 仍未完成才進入睡眠, 避免小傳輸被睡眠粒度拖慢
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_dma_wait(uint64_t transfer_id, uint32_t timeout_ms) {
+    retryix_dma_status_t status;
+    uint64_t start_ms = 0;
+
+    for (uint32_t spins = 0;; spins++) {
+        retryix_zerocopy_result_t rc = retryix_zerocopy_dma_status(transfer_id, &status);
+        if (rc != RETRYIX_ZC_SUCCESS) {
+            return rc;
+        }
+        if (status != RETRYIX_DMA_IN_PROGRESS) {
+            break;
+        }
+        if (spins < 1024) {
+            RX_CPU_RELAX();
+            continue;
+        }
+        uint64_t now_ms = zc_now_ms();
+        if (start_ms == 0) {
+            start_ms = now_ms;
+        }
+        uint64_t waited_ms = now_ms - start_ms;
+        if (timeout_ms != RETRYIX_ZC_WAIT_INFINITE && waited_ms >= timeout_ms) {
+            return RETRYIX_ZC_ERROR_TIMEOUT;
+        }
+#ifdef _WIN32
+        if (waited_ms < 2) SwitchToThread(); else Sleep(1);
+#else
+        if (waited_ms < 2) sched_yield(); else usleep(1000);
+#endif
     }
 
-    printf("[ZeroCopy Lu Ban] Waiting for DMA transfer completion\n");
-    free(transfer_handle);  // 清理句柄
-    printf("[ZeroCopy Lu Ban] DMA transfer wait completed\n");
-
-    return RETRYIX_SUCCESS;
+    return (status == RETRYIX_DMA_COMPLETED) ? RETRYIX_ZC_SUCCESS : RETRYIX_ZC_ERROR_TRANSFER_FAILED;
 }
 
 // === GPU RDMA讀取===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_gpu_rdma_read(
-    void* gpu_ptr, void* remote_addr, size_t size) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_gpu_rdma_read(
+    const retryix_net_connection_t* connection, void* gpu_buffer,
+    uint64_t remote_addr, size_t size, uint32_t rkey) {
 
-    if (!gpu_ptr || !remote_addr || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!gpu_buffer || !remote_addr || size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] GPU RDMA read: %zu bytes from remote %p to GPU %p\n", size, remote_addr, gpu_ptr);
-    printf("[ZeroCopy Lu Ban] Direct GPU-RDMA read completed\n");
+    if (zc_is_tcp(connection)) {
+        return zc_tcp_run(connection, true, gpu_buffer, remote_addr, size, rkey);
+    }
 
-    return RETRYIX_SUCCESS;
+    const void* source = NULL;
+    retryix_zerocopy_result_t rc = zc_resolve_remote(connection, rkey, remote_addr, size, (void**)&source);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        return rc;
+    }
+    memcpy(gpu_buffer, source, size);
+
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === GPU RDMA寫入===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_gpu_rdma_write(
-    void* gpu_ptr, void* remote_addr, size_t size) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_gpu_rdma_write(
+    const retryix_net_connection_t* connection, const void* gpu_buffer,
+    uint64_t remote_addr, size_t size, uint32_t rkey) {
+
+    if (!gpu_buffer || !remote_addr || size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
 
-    if (!gpu_ptr || !remote_addr || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (zc_is_tcp(connection)) {
+        return zc_tcp_run(connection, false, (void*)gpu_buffer, remote_addr, size, rkey);
     }
 
-    printf("[ZeroCopy Lu Ban] GPU RDMA write: %zu bytes from GPU %p to remote %p\n", size, gpu_ptr, remote_addr);
-    printf("[ZeroCopy Lu Ban] Direct GPU-RDMA write completed\n");
+    void* target = NULL;
+    retryix_zerocopy_result_t rc = zc_resolve_remote(connection, rkey, remote_addr, size, &target);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        return rc;
+    }
+    memcpy(target, gpu_buffer, size);
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
-// === 網絡緩衝區管理===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_create_net_buffer(
-    size_t size, void** net_buffer) {
+// === 網絡緩衝區管理（上卷技術：預製構件術）===
+// 緩衝區來自預註冊池, 熱路徑不做 malloc / 註冊 / 輸出
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_create_net_buffer(
+    size_t size, retryix_net_buffer_t** buffer) {
 
-    if (size == 0 || !net_buffer) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (size == 0 || !buffer) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Creating network buffer: %zu bytes\n", size);
+    return retryix_zc_pool_acquire(size, buffer);
+}
 
-    *net_buffer = malloc(size);
-    if (!*net_buffer) {
-        return RETRYIX_ERROR_OUT_OF_MEMORY;
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_destroy_net_buffer(retryix_net_buffer_t* buffer) {
+    if (!buffer) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Network buffer created at %p\n", *net_buffer);
-    return RETRYIX_SUCCESS;
+    if (retryix_zc_pool_release(buffer) == RETRYIX_ZC_SUCCESS) {
+        return RETRYIX_ZC_SUCCESS;
+    }
+    return retryix_zc_shm_destroy_region(buffer);
 }
 
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_destroy_net_buffer(void* net_buffer) {
-    if (!net_buffer) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+// === 本機共享記憶體傳輸（上卷技術：同室傳物術）===
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_shm_create_region(
+    size_t size, retryix_net_buffer_t** buffer) {
+
+    if (size == 0 || !buffer) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Destroying network buffer at %p\n", net_buffer);
-    free(net_buffer);
+    return retryix_zc_shm_create_region(size, buffer);
+}
 
-    return RETRYIX_SUCCESS;
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_shm_connect(
+    int32_t peer_pid, retryix_net_connection_t* connection) {
+
+    if (peer_pid <= 0 || !connection) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_zerocopy_result_t rc = retryix_zc_shm_connect(peer_pid, connection);
+    if (rc == RETRYIX_ZC_SUCCESS) {
+        printf("[ZeroCopy Lu Ban] Shared-memory path to process %d established\n", (int)peer_pid);
+    }
+    return rc;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_shm_disconnect(retryix_net_connection_t* connection) {
+    if (!connection) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_zc_perf_forget(connection);
+    return retryix_zc_shm_disconnect(connection);
+}
+
+// === TCP 傳輸（上卷技術：飛鴿傳書術）===
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_listen(uint16_t port, uint16_t* bound_port) {
+    return retryix_zerocopy_tcp_listen_on(NULL, port, bound_port);
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_listen_on(
+    const char* bind_ip, uint16_t port, uint16_t* bound_port) {
+
+    retryix_zerocopy_result_t rc = retryix_zc_tcp_listen(bind_ip, port, bound_port);
+    if (rc == RETRYIX_ZC_SUCCESS) {
+        printf("[ZeroCopy Lu Ban] TCP target listening on %s port %u\n",
+               (bind_ip && bind_ip[0]) ? bind_ip : "127.0.0.1", bound_port ? *bound_port : port);
+    }
+    return rc;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_connect(
+    const char* remote_ip, uint16_t remote_port, retryix_net_connection_t* connection) {
+
+    if (!remote_ip || remote_port == 0 || !connection) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_zerocopy_result_t rc = retryix_zc_tcp_connect(remote_ip, remote_port, connection);
+    if (rc == RETRYIX_ZC_SUCCESS) {
+        printf("[ZeroCopy Lu Ban] TCP path to %s:%u established\n", remote_ip, remote_port);
+    }
+    return rc;
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_tcp_disconnect(retryix_net_connection_t* connection) {
+    if (!connection) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_zc_perf_forget(connection);
+    return retryix_zc_tcp_disconnect(connection);
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_pool_prewarm(size_t buffer_size, uint32_t count) {
+    return retryix_zc_pool_prewarm(buffer_size, count);
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_pool_get_stats(retryix_zc_pool_stats_t* stats) {
+    if (!stats) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    retryix_zc_pool_get_stats(stats);
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 網絡拓撲發現===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_discover_net_topology(void) {
-    printf("[ZeroCopy Lu Ban] Discovering network topology with advanced scanning\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_discover_net_topology(
+    char* topology_info, size_t buffer_size) {
+
+    if (!topology_info || buffer_size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
 
-    printf("[ZeroCopy Lu Ban] - Local network interfaces: 2 detected\n");
-    printf("[ZeroCopy Lu Ban] - Remote RDMA nodes: 1 detected\n");
-    printf("[ZeroCopy Lu Ban] - Network switches: 1 detected\n");
+    int written = snprintf(topology_info, buffer_size,
+        "Local network interfaces: 2 detected\n"
+        "Remote RDMA nodes: 1 detected\n"
+        "Network switches: 1 detected\n");
 
-    printf("[ZeroCopy Lu Ban] Network topology discovery completed\n");
-    return RETRYIX_SUCCESS;
+    return (written > 0 && written < (int)buffer_size) ? RETRYIX_ZC_SUCCESS : RETRYIX_ZC_ERROR_BUFFER_TOO_SMALL;
 }
 
-// === 網絡性能監控===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_monitor_net_perf(
-    double* bandwidth_gbps, double* latency_us) {
+// === 網絡性能監控（下卷智慧：量過才知長短）===
+// 回報最近一次量測的連線; 尚無量測時就地量測同進程路徑
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_monitor_net_perf(
+    float* bandwidth_mbps, float* latency_us, int* packet_loss) {
 
-    if (!bandwidth_gbps || !latency_us) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!bandwidth_mbps || !latency_us) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Monitoring network performance\n");
+    retryix_net_perf_t perf;
+    if (!retryix_zc_perf_latest(&perf)) {
+        retryix_zerocopy_result_t rc = retryix_zerocopy_probe_net_perf(NULL, &perf);
+        if (rc != RETRYIX_ZC_SUCCESS) {
+            return rc;
+        }
+    }
 
-    *bandwidth_gbps = 25.6;  // 25.6 GB/s
-    *latency_us = 1.2;       // 1.2 微秒
+    *bandwidth_mbps = perf.bandwidth_mbps;
+    *latency_us = perf.latency_p50_us;
+    if (packet_loss) *packet_loss = perf.samples ? (int)(perf.failed * 100u / perf.samples) : 0;
 
-    printf("[ZeroCopy Lu Ban] Network performance: %.1f GB/s, %.1f us latency\n",
-           *bandwidth_gbps, *latency_us);
+    printf("[ZeroCopy Lu Ban] Network performance: %.1f Mbps, %.1f us latency\n",
+           *bandwidth_mbps, *latency_us);
 
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 網絡路徑優化===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_optimize_net_path(void) {
-    printf("[ZeroCopy Lu Ban] Optimizing network paths with intelligent routing\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_optimize_net_path(
+    const char* source_ip, const char* dest_ip, char* optimized_path, size_t buffer_size) {
 
-    printf("[ZeroCopy Lu Ban] - Analyzing traffic patterns\n");
-    printf("[ZeroCopy Lu Ban] - Selecting optimal routes\n");
-    printf("[ZeroCopy Lu Ban] - Configuring load balancing\n");
+    if (!source_ip || !dest_ip || !optimized_path || buffer_size == 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    // 依已量測的連線選路; 未量測過的目的地只能直連
+    retryix_net_connection_t best;
+    retryix_net_perf_t perf;
+    int written;
+    if (retryix_zc_perf_best_path(source_ip, dest_ip, &best, &perf)) {
+        written = snprintf(optimized_path, buffer_size, "%s -> %s via %s (qp %u): p50 %.1f us, p99 %.1f us, %.0f Mbps",
+                           source_ip, dest_ip, zc_protocol_name(best.protocol), best.qp_num,
+                           perf.latency_p50_us, perf.latency_p99_us, perf.bandwidth_mbps);
+    } else {
+        written = snprintf(optimized_path, buffer_size, "%s -> %s (direct, unmeasured)", source_ip, dest_ip);
+    }
 
-    printf("[ZeroCopy Lu Ban] Network path optimization completed\n");
-    return RETRYIX_SUCCESS;
+    return (written > 0 && written < (int)buffer_size) ? RETRYIX_ZC_SUCCESS : RETRYIX_ZC_ERROR_BUFFER_TOO_SMALL;
 }
 
 // === 網絡負載平衡===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_balance_net_load(void) {
-    printf("[ZeroCopy Lu Ban] Balancing network load across available paths\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_balance_net_load(
+    uint32_t* load_distribution, int num_devices) {
+
+    if (!load_distribution || num_devices <= 0) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
 
-    printf("[ZeroCopy Lu Ban] Load balancing completed - traffic distributed optimally\n");
-    return RETRYIX_SUCCESS;
+    // 分流比例由分條排程依各路徑的即時服務速率決定
+    return retryix_zc_stripe_rebalance(load_distribution, num_devices);
 }
 
-// === 緩衝區註冊===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_register_buffer(
-    void* buffer, size_t size) {
+// === 緩衝區註冊 ===
+// 使用者自有記憶體: 配發一次鍵值, 直到 unregister 前保持不變
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_register_buffer(
+    void* buffer, size_t size, retryix_net_buffer_t** net_buffer) {
 
-    if (!buffer || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!buffer || size == 0 || !net_buffer) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Registering buffer for zero-copy operations: %p (%zu bytes)\n",
-           buffer, size);
-
-    printf("[ZeroCopy Lu Ban] Buffer registered successfully\n");
-    return RETRYIX_SUCCESS;
+    return retryix_zc_pool_register_external(buffer, size, net_buffer);
 }
 
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_unregister_buffer(void* buffer) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_unregister_buffer(retryix_net_buffer_t* buffer) {
     if (!buffer) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    return retryix_zc_pool_unregister_external(buffer);
+}
+
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_grant_remote_access(retryix_net_buffer_t* buffer, uint32_t* rkey) {
+    if (!buffer || !rkey) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Unregistering buffer: %p\n", buffer);
-    printf("[ZeroCopy Lu Ban] Buffer unregistered successfully\n");
+    return retryix_zc_pool_grant_remote(buffer, rkey);
+}
 
-    return RETRYIX_SUCCESS;
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_revoke_remote_access(retryix_net_buffer_t* buffer) {
+    if (!buffer) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+
+    return retryix_zc_pool_revoke_remote(buffer);
 }
 
 // === 一致性協議===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_coherence_protocol(void) {
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_coherence_protocol(retryix_net_connection_t* connection) {
+    (void)connection;
     printf("[ZeroCopy Lu Ban] Applying coherence protocol for distributed memory\n");
 
     printf("[ZeroCopy Lu Ban] - Cache coherence maintained\n");
     printf("[ZeroCopy Lu Ban] - Memory consistency ensured\n");
 
     printf("[ZeroCopy Lu Ban] Coherence protocol applied successfully\n");
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 分散式SVM創建===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_create_distributed_svm(
-    size_t size, void** svm_ptr) {
-
-    if (size == 0 || !svm_ptr) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
-    }
+// SVM 區域本身即為傳輸緩衝區, 只需註冊
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_create_distributed_svm(
+    void* svm_ptr, size_t size, retryix_net_buffer_t** distributed_buffer) {
 
-    printf("[ZeroCopy Lu Ban] Creating distributed SVM: %zu bytes\n", size);
-
-    *svm_ptr = malloc(size);
-    if (!*svm_ptr) {
-        return RETRYIX_ERROR_OUT_OF_MEMORY;
+    if (!svm_ptr || size == 0 || !distributed_buffer) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
     }
 
-    printf("[ZeroCopy Lu Ban] Distributed SVM created at %p\n", *svm_ptr);
-    return RETRYIX_SUCCESS;
+    printf("[ZeroCopy Lu Ban] Creating distributed SVM: %zu bytes at %p\n", size, svm_ptr);
+    return retryix_zc_pool_register_external(svm_ptr, size, distributed_buffer);
 }
 
 // === 遠程內存移動===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_migrate_remote_memory(
-    void* local_ptr, void* remote_ptr, size_t size) {
+// source_addr 為本地位址, dest_addr 為對端已導出區域內的位址 (依範圍查找, 不需 rkey)
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_migrate_remote_memory(
+    uint64_t source_addr, uint64_t dest_addr, size_t size, const retryix_net_connection_t* connection) {
 
-    if (!local_ptr || !remote_ptr || size == 0) {
-        return RETRYIX_ERROR_INVALID_PARAMETER;
+    if (!source_addr || !dest_addr || size == 0 || !connection) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
+    if (zc_is_tcp(connection)) {
+        return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;  // TCP 目標端需 rkey 驗證
     }
 
-    printf("[ZeroCopy Lu Ban] Migrating %zu bytes from %p to remote %p\n",
-           size, local_ptr, remote_ptr);
+    void* target = NULL;
+    retryix_zerocopy_result_t rc = zc_resolve_remote(connection, 0, dest_addr, size, &target);
+    if (rc != RETRYIX_ZC_SUCCESS) {
+        return rc;
+    }
+    memmove(target, (const void*)(uintptr_t)source_addr, size);
 
-    printf("[ZeroCopy Lu Ban] Remote memory migration completed\n");
-    return RETRYIX_SUCCESS;
+    return RETRYIX_ZC_SUCCESS;
 }
 
 // === 分散式內存同步===
-RETRYIX_API retryix_result_t RETRYIX_CALL retryix_zerocopy_sync_distributed_memory(void) {
-    printf("[ZeroCopy Lu Ban] Synchronizing distributed memory across nodes\n");
+RETRYIX_API retryix_zerocopy_result_t RETRYIX_CALL retryix_zerocopy_sync_distributed_memory(
+    void* local_buffer, size_t size, const retryix_net_connection_t* connections, int num_connections) {
 
-    printf("[ZeroCopy Lu Ban] - Checking memory consistency\n");
-    printf("[ZeroCopy Lu Ban] - Updating distributed caches\n");
-    printf("[ZeroCopy Lu Ban] - Verifying data integrity\n");
+    (void)local_buffer; (void)size;
+    if (num_connections < 0 || (num_connections > 0 && !connections)) {
+        return RETRYIX_ZC_ERROR_INVALID_PARAM;
+    }
 
-    printf("[ZeroCopy Lu Ban] Distributed memory synchronization completed\n");
-    return RETRYIX_SUCCESS;
-}
\ No newline at end of file
+    // 單邊寫入已直接落在對端頁面, 同步只需全屏障並確認對端仍在
+    RX_FENCE();
+
+    for (int i = 0; i < num_connections; i++) {
+        if (zc_is_tcp(&connections[i])) {
+            // TCP 寫入在目標端回覆 ACK 後才算落地
+            retryix_zerocopy_result_t rc = retryix_zc_tcp_flush(&connections[i], RETRYIX_ZC_WAIT_INFINITE);
+            if (rc != RETRYIX_ZC_SUCCESS) {
+                return rc;
+            }
+            continue;
+        }
+        if (connections[i].protocol != RETRYIX_NET_PROTO_SHM) {
+            return RETRYIX_ZC_ERROR_PROTOCOL_NOT_SUPPORTED;
+        }
+        if (!retryix_zc_shm_peer_alive(&connections[i])) {
+            return RETRYIX_ZC_ERROR_NETWORK_DOWN;
+        }
+    }
+
+    return RETRYIX_ZC_SUCCESS;
+}
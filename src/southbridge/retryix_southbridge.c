@@ -42,11 +42,31 @@ static bool read_pci_config(int bus, int device, int function, int offset, uint3
     return false;
 }
 
+#else
+// Linux/其他平台的實現: 經由 sysfs 讀取配置空間 (前 64 位元組不需 root)
+static bool read_pci_config(int bus, int device, int function, int offset, uint32_t* value) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/bus/pci/devices/0000:%02x:%02x.%x/config", bus, device, function);
+    *value = 0xFFFFFFFF;
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t bytes[4];
+    bool ok = fseek(f, offset, SEEK_SET) == 0 && fread(bytes, 1, sizeof(bytes), f) == sizeof(bytes);
+    fclose(f);
+    if (ok) {
+        *value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    }
+    return ok;
+}
+#endif
+
 // 檢測晶片組類型
 static retryix_chipset_type_t detect_chipset_type(void) {
     uint32_t vendor_device;
 
-    if (read_pci_config(0, 31, 0, 0x00, &vendor_device)) {
+    // Intel PCH LPC 位於 00:1f.0, AMD FCH LPC 位於 00:14.3
+    if (read_pci_config(0, 31, 0, 0x00, &vendor_device) ||
+        read_pci_config(0, 20, 3, 0x00, &vendor_device)) {
         uint16_t vendor_id = vendor_device & 0xFFFF;
         uint16_t device_id = (vendor_device >> 16) & 0xFFFF;
 
@@ -70,19 +90,6 @@ static retryix_chipset_type_t detect_chipset_type(void) {
     return RETRYIX_CHIPSET_UNKNOWN;
 }
 
-#else
-// Linux/其他平台的實現
-static bool read_pci_config(int bus, int device, int function, int offset, uint32_t* value) {
-    // 可以使用 /sys/bus/pci/devices/ 或 libpci
-    *value = 0x8086A282;  // 模擬Intel PCH
-    return true;
-}
-
-static retryix_chipset_type_t detect_chipset_type(void) {
-    return RETRYIX_CHIPSET_INTEL_Z690;  // 預設
-}
-#endif
-
 // ===================== 核心API實現 =====================
 
 RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
@@ -161,6 +168,9 @@ retryix_southbridge_init(void) {
     printf("[南橋溝通] 📊 PCH通道: %d總數, %d可用\n",
            g_southbridge_info.total_pch_lanes, g_southbridge_info.available_pch_lanes);
 
+    // 通道使用率取樣 (Windows 無計數來源時略過)
+    retryix_southbridge_start_sampler(1000);
+
     return RETRYIX_SB_SUCCESS;
 }
 
@@ -382,19 +392,19 @@ retryix_southbridge_get_lane_utilization(float* slot_utilization, int max_slots,
         return RETRYIX_SB_ERROR_ACCESS_DENIED;
     }
 
-    // 模擬實時使用率數據
-    int slots = (max_slots < 4) ? max_slots : 4;
-    *actual_slots = slots;
-
-    for (int i = 0; i < slots; i++) {
-        // 模擬不同插槽的使用率
-        switch (i) {
-            case 0: slot_utilization[i] = 85.5f; break;  // 主要NVMe
-            case 1: slot_utilization[i] = 45.2f; break;  // 次要存儲
-            case 2: slot_utilization[i] = 12.8f; break;  // 網卡
-            case 3: slot_utilization[i] = 0.0f; break;   // 空插槽
-        }
+    // 取樣執行緒發佈的快照, 依 PCI 位址排序
+    retryix_southbridge_lane_stats_t stats[RETRYIX_SB_MAX_LANE_DEVICES];
+    int count = 0;
+    retryix_southbridge_result_t result = retryix_southbridge_get_lane_stats(
+        stats, max_slots < RETRYIX_SB_MAX_LANE_DEVICES ? max_slots : RETRYIX_SB_MAX_LANE_DEVICES, &count);
+    if (result != RETRYIX_SB_SUCCESS) {
+        return result;
+    }
+
+    for (int i = 0; i < count; i++) {
+        slot_utilization[i] = stats[i].utilization;
     }
+    *actual_slots = count;
 
     return RETRYIX_SB_SUCCESS;
 }
@@ -404,6 +414,8 @@ retryix_southbridge_cleanup(void) {
     printf("[南橋溝通] 🧹 清理南橋溝通資源...\n");
 
     if (g_southbridge_initialized) {
+        retryix_southbridge_stop_sampler();
+
         // 恢復預設電源設定
         g_southbridge_info.power_gating_active = true;
         g_southbridge_info.clock_gating_active = true;
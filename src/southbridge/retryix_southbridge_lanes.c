@@ -0,0 +1,502 @@
+/*
+ * retryix_southbridge_lanes.c
+ * 通道使用率取樣 - 由核心計數換算每個 PCIe 裝置的實際流量
+ *
+ * 取樣執行緒每個間隔讀取 /proc/diskstats (區塊裝置讀寫扇區)、
+ * /sys/class/net/<介面>/statistics (收發位元組) 與 PCIe 裝置的 AER / 鏈路屬性，
+ * 依區塊裝置與網路介面在 sysfs 中的 PCI 上游歸併到各 BDF。
+ * 每個裝置一個單寫多讀的環形緩衝區: 寫入端先填好槽位再以 release 發佈 head，
+ * 讀取端讀完後重新檢查 head，若讀過的槽位可能已被覆寫就重讀，全程不加鎖也不做系統呼叫。
+ */
+#define RETRYIX_BUILD_DLL
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../../include/retryix_southbridge.h"
+#include "../../include/retryix_atomic_internal.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#define SB_RING_SIZE            64
+#define SB_WINDOW_SHORT         10
+#define SB_WINDOW_LONG          60
+#define SB_MAX_PORTS            4              // 每個 PCIe 裝置最多追蹤的區塊裝置 / 網路介面數
+#define SB_MIN_INTERVAL_MS      10
+#define SB_MAX_INTERVAL_MS      60000
+#define SB_DISKSTATS_MAX        (256 * 1024)
+
+typedef struct {
+    uint64_t time_ns;
+    uint64_t rx_bps;                       // 位元組/秒
+    uint64_t tx_bps;
+    uint32_t util_milli;                   // 千分之一百分比
+    uint32_t aer_delta;
+} sb_sample_t;
+
+typedef struct {
+    // 啟動時建立, 之後唯讀
+    char bdf[16];
+    char devices[64];
+    char block[SB_MAX_PORTS][32];
+    int block_count;
+    char net[SB_MAX_PORTS][32];
+    int net_count;
+    int max_link_width;
+    // 取樣執行緒私有
+    uint64_t prev_rx;
+    uint64_t prev_tx;
+    uint64_t prev_time_ns;
+    uint64_t prev_aer;
+    bool has_prev;
+    // 發佈給讀取端 (原子存取)
+    uint32_t link_width;
+    uint32_t link_mgts;                    // GT/s × 1000
+    uint64_t aer_correctable;
+    uint64_t aer_nonfatal;
+    uint64_t aer_fatal;
+    sb_sample_t ring[SB_RING_SIZE];
+    uint64_t head;                         // 已發佈的樣本數
+} sb_lane_device_t;
+
+static sb_lane_device_t g_lanes[RETRYIX_SB_MAX_LANE_DEVICES];
+static int g_lane_count = 0;
+static bool g_lanes_discovered = false;
+static char g_sys_root[256] = "/sys";
+static char g_proc_root[256] = "/proc";
+
+static pthread_mutex_t g_sampler_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_sampler_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_sampler_thread;
+static bool g_sampler_running = false;
+static bool g_sampler_stop = false;
+static bool g_sampler_kick = false;            // 間隔變更, 立即以新間隔重新計時
+static unsigned int g_sampler_interval_ms = 1000;
+
+// ===================== sysfs / procfs 讀取 =====================
+
+static uint64_t sb_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static size_t sb_read_file(const char* path, char* buf, size_t size) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    size_t n = fread(buf, 1, size - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    return n;
+}
+
+static bool sb_read_u64(const char* path, uint64_t* value) {
+    char buf[64];
+    if (sb_read_file(path, buf, sizeof(buf)) == 0) return false;
+    *value = strtoull(buf, NULL, 10);
+    return true;
+}
+
+// AER 統計檔案的 TOTAL_ERR_* 一行
+static uint64_t sb_read_aer_total(const char* bdf, const char* attr, const char* key) {
+    char path[512];
+    char buf[2048];
+    snprintf(path, sizeof(path), "%s/bus/pci/devices/%s/%s", g_sys_root, bdf, attr);
+    if (sb_read_file(path, buf, sizeof(buf)) == 0) return 0;
+    const char* p = strstr(buf, key);
+    return p ? strtoull(p + strlen(key), NULL, 10) : 0;
+}
+
+static void sb_read_link(sb_lane_device_t* d) {
+    char path[512];
+    char buf[64];
+    uint32_t width = 0, mgts = 0;
+    snprintf(path, sizeof(path), "%s/bus/pci/devices/%s/current_link_width", g_sys_root, d->bdf);
+    if (sb_read_file(path, buf, sizeof(buf))) width = (uint32_t)strtoul(buf, NULL, 10);
+    snprintf(path, sizeof(path), "%s/bus/pci/devices/%s/current_link_speed", g_sys_root, d->bdf);
+    if (sb_read_file(path, buf, sizeof(buf))) mgts = (uint32_t)(strtod(buf, NULL) * 1000.0 + 0.5);   // "16.0 GT/s PCIe"
+    RX_STORE32(&d->link_width, width);
+    RX_STORE32(&d->link_mgts, mgts);
+}
+
+// 單向可用帶寬 (位元組/秒): Gen1/2 為 8b/10b, Gen3 起為 128b/130b
+static double sb_link_bytes_per_sec(uint32_t width, uint32_t mgts) {
+    double gts = mgts / 1000.0;
+    double encoding = gts < 8.0 ? 0.8 : 128.0 / 130.0;
+    return gts * 1e9 * encoding / 8.0 * (double)width;
+}
+
+// 路徑中最後一個 BDF 形式的元件 (dddd:bb:dd.f)
+static bool sb_bdf_from_path(const char* path, char* bdf, size_t size) {
+    bool found = false;
+    const char* p = path;
+    while ((p = strchr(p, '/')) != NULL) {
+        p++;
+        unsigned domain, bus, dev, fn;
+        char tail;
+        int n = sscanf(p, "%4x:%2x:%2x.%1x%c", &domain, &bus, &dev, &fn, &tail);
+        if ((n == 5 && tail == '/') || n == 4) {
+            snprintf(bdf, size, "%.12s", p);
+            found = true;
+        }
+    }
+    return found;
+}
+
+static sb_lane_device_t* sb_find_or_add(const char* bdf) {
+    for (int i = 0; i < g_lane_count; i++) {
+        if (strcmp(g_lanes[i].bdf, bdf) == 0) return &g_lanes[i];
+    }
+    if (g_lane_count >= RETRYIX_SB_MAX_LANE_DEVICES) return NULL;
+    sb_lane_device_t* d = &g_lanes[g_lane_count++];
+    memset(d, 0, sizeof(*d));
+    snprintf(d->bdf, sizeof(d->bdf), "%s", bdf);
+    return d;
+}
+
+static void sb_append_name(sb_lane_device_t* d, const char* name) {
+    size_t len = strlen(d->devices);
+    snprintf(d->devices + len, sizeof(d->devices) - len, "%s%s", len ? "," : "", name);
+}
+
+// 掃描 <sys>/block 或 <sys>/class/net, 依上游 PCI 裝置歸併
+static void sb_scan_ports(const char* subdir, bool network) {
+    char dir_path[512];
+    snprintf(dir_path, sizeof(dir_path), "%s/%s", g_sys_root, subdir);
+    DIR* dir = opendir(dir_path);
+    if (!dir) return;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char link[768];
+        char resolved[PATH_MAX];
+        char bdf[16];
+        snprintf(link, sizeof(link), "%s/%s", dir_path, ent->d_name);
+        if (!realpath(link, resolved) || !sb_bdf_from_path(resolved, bdf, sizeof(bdf))) continue;   // 虛擬裝置
+        sb_lane_device_t* d = sb_find_or_add(bdf);
+        if (!d) continue;
+        if (network && d->net_count < SB_MAX_PORTS) {
+            snprintf(d->net[d->net_count++], sizeof(d->net[0]), "%.31s", ent->d_name);
+        } else if (!network && d->block_count < SB_MAX_PORTS) {
+            snprintf(d->block[d->block_count++], sizeof(d->block[0]), "%.31s", ent->d_name);
+        } else {
+            continue;
+        }
+        sb_append_name(d, ent->d_name);
+    }
+    closedir(dir);
+}
+
+static void sb_discover(void) {
+    g_lane_count = 0;
+    sb_scan_ports("block", false);
+    sb_scan_ports("class/net", true);
+    // 依 BDF 排序, 使輸出順序穩定
+    for (int i = 1; i < g_lane_count; i++) {
+        for (int j = i; j > 0 && strcmp(g_lanes[j - 1].bdf, g_lanes[j].bdf) > 0; j--) {
+            sb_lane_device_t tmp = g_lanes[j - 1];
+            g_lanes[j - 1] = g_lanes[j];
+            g_lanes[j] = tmp;
+        }
+    }
+    for (int i = 0; i < g_lane_count; i++) {
+        char path[512];
+        uint64_t width = 0;
+        int n = snprintf(path, sizeof(path), "%s/bus/pci/devices/%s/max_link_width", g_sys_root, g_lanes[i].bdf);
+        if (n > 0 && (size_t)n < sizeof(path) && sb_read_u64(path, &width)) g_lanes[i].max_link_width = (int)width;
+        sb_read_link(&g_lanes[i]);
+    }
+    g_lanes_discovered = true;
+}
+
+// ===================== 取樣 =====================
+
+static void sb_push_sample(sb_lane_device_t* d, const sb_sample_t* s) {
+    uint64_t h = d->head;   // 只有取樣執行緒寫入
+    sb_sample_t* slot = &d->ring[h % SB_RING_SIZE];
+    RX_STORE64(&slot->time_ns, s->time_ns);
+    RX_STORE64(&slot->rx_bps, s->rx_bps);
+    RX_STORE64(&slot->tx_bps, s->tx_bps);
+    RX_STORE32(&slot->util_milli, s->util_milli);
+    RX_STORE32(&slot->aer_delta, s->aer_delta);
+    RX_STORE64(&d->head, h + 1);
+}
+
+static void sb_sample_once(void) {
+    char* stats = (char*)malloc(SB_DISKSTATS_MAX);
+    size_t stats_len = 0;
+    if (stats) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/diskstats", g_proc_root);
+        stats_len = sb_read_file(path, stats, SB_DISKSTATS_MAX);
+    }
+    uint64_t now = sb_now_ns();
+
+    for (int i = 0; i < g_lane_count; i++) {
+        sb_lane_device_t* d = &g_lanes[i];
+        uint64_t rx = 0, tx = 0;
+        int found = 0;
+
+        // diskstats: major minor name reads merged sectors_read ms writes merged sectors_written ...
+        for (const char* line = stats; stats_len && line && *line; ) {
+            unsigned major, minor;
+            char name[64];
+            unsigned long long f[7];
+            if (sscanf(line, "%u %u %63s %llu %llu %llu %llu %llu %llu %llu", &major, &minor, name,
+                       &f[0], &f[1], &f[2], &f[3], &f[4], &f[5], &f[6]) == 10) {
+                for (int b = 0; b < d->block_count; b++) {
+                    if (strcmp(name, d->block[b]) == 0) {
+                        rx += f[2] * 512ull;
+                        tx += f[6] * 512ull;
+                        found++;
+                    }
+                }
+            }
+            line = strchr(line, '\n');
+            if (line) line++;
+        }
+        for (int n = 0; n < d->net_count; n++) {
+            char path[512];
+            uint64_t value;
+            snprintf(path, sizeof(path), "%s/class/net/%s/statistics/rx_bytes", g_sys_root, d->net[n]);
+            if (sb_read_u64(path, &value)) { rx += value; found++; }
+            snprintf(path, sizeof(path), "%s/class/net/%s/statistics/tx_bytes", g_sys_root, d->net[n]);
+            if (sb_read_u64(path, &value)) { tx += value; found++; }
+        }
+
+        sb_read_link(d);
+        uint64_t cor = sb_read_aer_total(d->bdf, "aer_dev_correctable", "TOTAL_ERR_COR");
+        uint64_t nonfatal = sb_read_aer_total(d->bdf, "aer_dev_nonfatal", "TOTAL_ERR_NONFATAL");
+        uint64_t fatal = sb_read_aer_total(d->bdf, "aer_dev_fatal", "TOTAL_ERR_FATAL");
+        RX_STORE64(&d->aer_correctable, cor);
+        RX_STORE64(&d->aer_nonfatal, nonfatal);
+        RX_STORE64(&d->aer_fatal, fatal);
+        uint64_t aer = cor + nonfatal + fatal;
+
+        // 有計數讀不到 (裝置移除中) 時保留上一次基準, 避免下一次差值暴衝
+        if (found != d->block_count + d->net_count * 2) {
+            continue;
+        }
+        if (d->has_prev && now > d->prev_time_ns) {
+            double seconds = (double)(now - d->prev_time_ns) / 1e9;
+            // 計數歸零 (介面重建) 時該間隔記為 0
+            uint64_t drx = rx >= d->prev_rx ? rx - d->prev_rx : 0;
+            uint64_t dtx = tx >= d->prev_tx ? tx - d->prev_tx : 0;
+            sb_sample_t s;
+            s.time_ns = now;
+            s.rx_bps = (uint64_t)((double)drx / seconds);
+            s.tx_bps = (uint64_t)((double)dtx / seconds);
+            double link = sb_link_bytes_per_sec(RX_LOAD32(&d->link_width), RX_LOAD32(&d->link_mgts));
+            double busiest = (double)(s.rx_bps > s.tx_bps ? s.rx_bps : s.tx_bps);
+            double util = link > 0.0 ? busiest / link * 100.0 : 0.0;
+            s.util_milli = (uint32_t)((util > 100.0 ? 100.0 : util) * 1000.0);
+            s.aer_delta = (uint32_t)(aer >= d->prev_aer ? aer - d->prev_aer : 0);
+            sb_push_sample(d, &s);
+        }
+        d->prev_rx = rx;
+        d->prev_tx = tx;
+        d->prev_aer = aer;
+        d->prev_time_ns = now;
+        d->has_prev = true;
+    }
+    free(stats);
+}
+
+static void* sb_sampler_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_sampler_lock);
+    while (!g_sampler_stop) {
+        pthread_mutex_unlock(&g_sampler_lock);
+        sb_sample_once();
+        pthread_mutex_lock(&g_sampler_lock);
+        if (g_sampler_stop) break;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += g_sampler_interval_ms / 1000;
+        ts.tv_nsec += (long)(g_sampler_interval_ms % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        while (!g_sampler_stop && !g_sampler_kick &&
+               pthread_cond_timedwait(&g_sampler_cond, &g_sampler_lock, &ts) != ETIMEDOUT) {
+        }
+        g_sampler_kick = false;
+    }
+    pthread_mutex_unlock(&g_sampler_lock);
+    return NULL;
+}
+
+// ===================== 無鎖讀取 =====================
+
+static void sb_window_add(retryix_sb_window_t* w, float value) {
+    if (w->samples == 0 || value < w->min) w->min = value;
+    if (w->samples == 0 || value > w->max) w->max = value;
+    w->avg += value;
+    w->samples++;
+}
+
+static void sb_read_device(const sb_lane_device_t* d, retryix_southbridge_lane_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    snprintf(out->bdf, sizeof(out->bdf), "%s", d->bdf);
+    snprintf(out->devices, sizeof(out->devices), "%s", d->devices);
+    out->is_storage = d->block_count > 0;
+    out->is_network = d->net_count > 0;
+    out->max_link_width = d->max_link_width;
+    out->link_width = (int)RX_LOAD32(&d->link_width);
+    out->link_gts = RX_LOAD32(&d->link_mgts) / 1000.0f;
+    out->link_bandwidth_gbps = (float)(sb_link_bytes_per_sec((uint32_t)out->link_width, RX_LOAD32(&d->link_mgts)) / 1e9);
+    out->aer_correctable = RX_LOAD64(&d->aer_correctable);
+    out->aer_nonfatal = RX_LOAD64(&d->aer_nonfatal);
+    out->aer_fatal = RX_LOAD64(&d->aer_fatal);
+
+    for (;;) {
+        uint64_t h1 = RX_LOAD64(&d->head);
+        uint64_t n = h1 < SB_WINDOW_LONG ? h1 : SB_WINDOW_LONG;
+        retryix_sb_window_t short_w, long_w;
+        uint64_t aer_recent = 0, time_ns = 0, rx = 0, tx = 0;
+        memset(&short_w, 0, sizeof(short_w));
+        memset(&long_w, 0, sizeof(long_w));
+        float latest = 0.0f;
+        for (uint64_t k = 0; k < n; k++) {
+            const sb_sample_t* s = &d->ring[(h1 - 1 - k) % SB_RING_SIZE];
+            float util = RX_LOAD32(&s->util_milli) / 1000.0f;
+            if (k == 0) {
+                latest = util;
+                time_ns = RX_LOAD64(&s->time_ns);
+                rx = RX_LOAD64(&s->rx_bps);
+                tx = RX_LOAD64(&s->tx_bps);
+            }
+            if (k < SB_WINDOW_SHORT) sb_window_add(&short_w, util);
+            sb_window_add(&long_w, util);
+            aer_recent += RX_LOAD32(&s->aer_delta);
+        }
+        // 槽位以 acquire 讀取, 下面重讀 head 不會提前到槽位之前; 讀取期間寫入端若已繞回覆寫最舊的槽位, 重讀
+        if (RX_LOAD64(&d->head) - (h1 - n) >= SB_RING_SIZE) continue;
+        if (short_w.samples) short_w.avg /= (float)short_w.samples;
+        if (long_w.samples) long_w.avg /= (float)long_w.samples;
+        out->utilization = latest;
+        out->rx_gbps = (double)rx / 1e9;
+        out->tx_gbps = (double)tx / 1e9;
+        out->window_short = short_w;
+        out->window_long = long_w;
+        out->aer_recent = aer_recent;
+        out->sample_count = h1;
+        out->sample_time_ns = time_ns;
+        return;
+    }
+}
+
+// ===================== API =====================
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_start_sampler(unsigned int interval_ms) {
+    if (interval_ms < SB_MIN_INTERVAL_MS) interval_ms = SB_MIN_INTERVAL_MS;
+    if (interval_ms > SB_MAX_INTERVAL_MS) interval_ms = SB_MAX_INTERVAL_MS;
+
+    pthread_mutex_lock(&g_sampler_lock);
+    g_sampler_interval_ms = interval_ms;
+    if (g_sampler_running) {
+        g_sampler_kick = true;
+        pthread_cond_broadcast(&g_sampler_cond);
+        pthread_mutex_unlock(&g_sampler_lock);
+        return RETRYIX_SB_SUCCESS;
+    }
+    if (!g_lanes_discovered) {
+        sb_discover();
+        printf("[南橋溝通] 📡 通道取樣: %d 個 PCIe 裝置, 每 %u ms\n", g_lane_count, interval_ms);
+    }
+    g_sampler_stop = false;
+    g_sampler_kick = false;
+    if (pthread_create(&g_sampler_thread, NULL, sb_sampler_main, NULL) != 0) {
+        pthread_mutex_unlock(&g_sampler_lock);
+        return RETRYIX_SB_ERROR_ACCESS_DENIED;
+    }
+    g_sampler_running = true;
+    pthread_mutex_unlock(&g_sampler_lock);
+    return RETRYIX_SB_SUCCESS;
+}
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_stop_sampler(void) {
+    pthread_mutex_lock(&g_sampler_lock);
+    if (!g_sampler_running) {
+        pthread_mutex_unlock(&g_sampler_lock);
+        return RETRYIX_SB_SUCCESS;
+    }
+    g_sampler_stop = true;
+    pthread_cond_broadcast(&g_sampler_cond);
+    pthread_mutex_unlock(&g_sampler_lock);
+    pthread_join(g_sampler_thread, NULL);
+
+    pthread_mutex_lock(&g_sampler_lock);
+    g_sampler_running = false;
+    pthread_mutex_unlock(&g_sampler_lock);
+    return RETRYIX_SB_SUCCESS;
+}
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_get_lane_stats(retryix_southbridge_lane_stats_t* stats, int max_devices, int* actual_devices) {
+    if (!stats || !actual_devices || max_devices < 0) {
+        return RETRYIX_SB_ERROR_ACCESS_DENIED;
+    }
+    // 裝置清單在取樣執行緒啟動前建立, pthread_create 之後的讀取都能看到
+    int count = g_lane_count < max_devices ? g_lane_count : max_devices;
+    for (int i = 0; i < count; i++) {
+        sb_read_device(&g_lanes[i], &stats[i]);
+    }
+    *actual_devices = count;
+    return RETRYIX_SB_SUCCESS;
+}
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_set_sampler_roots(const char* sys_root, const char* proc_root) {
+    pthread_mutex_lock(&g_sampler_lock);
+    if (g_sampler_running) {
+        pthread_mutex_unlock(&g_sampler_lock);
+        return RETRYIX_SB_ERROR_ACCESS_DENIED;
+    }
+    snprintf(g_sys_root, sizeof(g_sys_root), "%s", sys_root && sys_root[0] ? sys_root : "/sys");
+    snprintf(g_proc_root, sizeof(g_proc_root), "%s", proc_root && proc_root[0] ? proc_root : "/proc");
+    g_lanes_discovered = false;
+    g_lane_count = 0;
+    pthread_mutex_unlock(&g_sampler_lock);
+    return RETRYIX_SB_SUCCESS;
+}
+
+#else
+
+// Windows 尚無對應的區塊 / 網路計數來源 (需 PDH 或 ETW)
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_start_sampler(unsigned int interval_ms) {
+    (void)interval_ms;
+    return RETRYIX_SB_ERROR_ACCESS_DENIED;
+}
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_stop_sampler(void) {
+    return RETRYIX_SB_SUCCESS;
+}
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_get_lane_stats(retryix_southbridge_lane_stats_t* stats, int max_devices, int* actual_devices) {
+    if (!stats || !actual_devices || max_devices < 0) {
+        return RETRYIX_SB_ERROR_ACCESS_DENIED;
+    }
+    *actual_devices = 0;
+    return RETRYIX_SB_SUCCESS;
+}
+
+RETRYIX_API retryix_southbridge_result_t RETRYIX_CALL
+retryix_southbridge_set_sampler_roots(const char* sys_root, const char* proc_root) {
+    (void)sys_root;
+    (void)proc_root;
+    return RETRYIX_SB_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,518 @@
+// retryix_numa_alloc.c - 節點放置配置與頁面綁定
+// Linux: mmap + mbind / get_mempolicy 直接系統呼叫 (不依賴 libnuma)
+// Windows: VirtualAllocExNuma / QueryWorkingSetEx
+// 獨立映射區以起點排序登記, 供釋放、整區綁定、位址查詢與存取取樣使用
+// 超過門檻的配置以 2MB 對齊映射: 優先 hugetlb (MAP_HUGETLB / MEM_LARGE_PAGES), 否則 MADV_HUGEPAGE
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "retryix_numa_internal.h"
+#include "retryix_atomic_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef _WIN32
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT     0
+#define MPOL_PREFERRED   1
+#define MPOL_BIND        2
+#define MPOL_INTERLEAVE  3
+#endif
+#ifndef MPOL_MF_STRICT
+#define MPOL_MF_STRICT   (1 << 0)
+#define MPOL_MF_MOVE     (1 << 1)
+#endif
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB      0x40000
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE    14
+#endif
+#ifndef MPOL_F_NODE
+#define MPOL_F_NODE      (1 << 0)
+#define MPOL_F_ADDR      (1 << 1)
+#endif
+// maxnode 為位元數 + 1 (核心會先減一)
+#define NUMA_MAXNODE     (RETRYIX_NUMA_MAX_NODES + 1)
+#endif
+
+#define NUMA_HUGE_PAGE   (2u * 1024 * 1024)
+
+typedef enum {
+    NUMA_BACKING_PAGES = 0,            // 一般頁面
+    NUMA_BACKING_THP,                  // 2MB 對齊 + MADV_HUGEPAGE
+    NUMA_BACKING_HUGETLB               // MAP_HUGETLB / MEM_LARGE_PAGES
+} numa_backing_t;
+
+typedef struct {
+    uintptr_t base;
+    size_t size;
+    uint8_t backing;                   // numa_backing_t
+    retryix_numa_policy_t policy;
+    uint64_t nodemask;
+    uint32_t access[RETRYIX_NUMA_MAX_NODES];   // 各節點線程的取樣存取次數
+} numa_region_t;
+
+// 依 base 排序的映射區表
+static numa_region_t* g_regions = NULL;
+static size_t g_region_count = 0;
+static size_t g_region_capacity = 0;
+
+// 大頁設定與統計 (受 g_region_lock 保護; 門檻另可不持鎖原子讀取)
+static uint64_t g_huge_threshold = RETRYIX_NUMA_HUGE_THRESHOLD_DEFAULT;
+static int g_huge_use_hugetlb = -1;     // -1 = 依系統大頁池自動判斷
+static retryix_numa_huge_stats_t g_huge_stats;
+
+#ifdef _WIN32
+static __declspec(thread) uint32_t t_access_tick = 0;
+#else
+static __thread uint32_t t_access_tick = 0;
+#endif
+
+#ifdef _WIN32
+static SRWLOCK g_region_lock = SRWLOCK_INIT;
+#define REGION_LOCK()   AcquireSRWLockExclusive(&g_region_lock)
+#define REGION_UNLOCK() ReleaseSRWLockExclusive(&g_region_lock)
+#else
+static pthread_mutex_t g_region_lock = PTHREAD_MUTEX_INITIALIZER;
+#define REGION_LOCK()   pthread_mutex_lock(&g_region_lock)
+#define REGION_UNLOCK() pthread_mutex_unlock(&g_region_lock)
+#endif
+
+static size_t numa_page_size(void) {
+    static size_t page = 0;
+    if (page == 0) {
+#ifdef _WIN32
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        page = si.dwPageSize;
+#else
+        long v = sysconf(_SC_PAGESIZE);
+        page = v > 0 ? (size_t)v : 4096;
+#endif
+    }
+    return page;
+}
+
+// 第一個 base > addr 的索引 (呼叫者持鎖)
+static size_t region_upper_bound(uintptr_t addr) {
+    size_t lo = 0, hi = g_region_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (g_regions[mid].base <= addr) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void region_account(const numa_region_t* r, int sign) {
+    uint64_t bytes = r->size;
+    if (r->backing == NUMA_BACKING_HUGETLB) g_huge_stats.hugetlb_bytes += sign > 0 ? bytes : (uint64_t)0 - bytes;
+    else if (r->backing == NUMA_BACKING_THP) g_huge_stats.thp_bytes += sign > 0 ? bytes : (uint64_t)0 - bytes;
+    else g_huge_stats.regular_bytes += sign > 0 ? bytes : (uint64_t)0 - bytes;
+}
+
+static bool region_insert(const numa_region_t* r) {
+    REGION_LOCK();
+    if (g_region_count == g_region_capacity) {
+        size_t cap = g_region_capacity ? g_region_capacity * 2 : 64;
+        numa_region_t* grown = (numa_region_t*)realloc(g_regions, cap * sizeof(numa_region_t));
+        if (!grown) {
+            REGION_UNLOCK();
+            return false;
+        }
+        g_regions = grown;
+        g_region_capacity = cap;
+    }
+    size_t pos = region_upper_bound(r->base);
+    memmove(&g_regions[pos + 1], &g_regions[pos], (g_region_count - pos) * sizeof(numa_region_t));
+    g_regions[pos] = *r;
+    g_region_count++;
+    region_account(r, 1);
+    REGION_UNLOCK();
+    return true;
+}
+
+// 找出包含 addr 的映射區 (呼叫者持鎖); 不存在回傳 NULL
+static numa_region_t* region_find(uintptr_t addr) {
+    size_t pos = region_upper_bound(addr);
+    if (pos == 0) return NULL;
+    numa_region_t* r = &g_regions[pos - 1];
+    return (addr < r->base + r->size) ? r : NULL;
+}
+
+// 以精確起點移除映射區; 回傳是否找到
+static bool region_remove(uintptr_t base, size_t* size) {
+    bool found = false;
+    REGION_LOCK();
+    size_t pos = region_upper_bound(base);
+    if (pos > 0 && g_regions[pos - 1].base == base) {
+        *size = g_regions[pos - 1].size;
+        region_account(&g_regions[pos - 1], -1);
+        memmove(&g_regions[pos - 1], &g_regions[pos], (g_region_count - pos) * sizeof(numa_region_t));
+        g_region_count--;
+        found = true;
+    }
+    REGION_UNLOCK();
+    return found;
+}
+
+static int numa_lowest_node(uint64_t mask) {
+    for (int n = 0; n < RETRYIX_NUMA_MAX_NODES; n++) {
+        if (mask & (1ull << n)) return n;
+    }
+    return 0;
+}
+
+#ifdef _WIN32
+
+static void* numa_map(size_t size, retryix_numa_policy_t policy, uint64_t nodemask, bool huge, bool use_hugetlb, uint8_t* backing) {
+    HANDLE process = GetCurrentProcess();
+    *backing = NUMA_BACKING_PAGES;
+    if (policy != RETRYIX_NUMA_POLICY_INTERLEAVE) {
+        DWORD node = (policy == RETRYIX_NUMA_POLICY_DEFAULT) ? NUMA_NO_PREFERRED_NODE : (DWORD)numa_lowest_node(nodemask);
+        // 大頁需要 SeLockMemoryPrivilege; 失敗時退回一般頁面 (Windows 沒有透明大頁)
+        SIZE_T large = GetLargePageMinimum();
+        if (huge && use_hugetlb && large > 0 && size % large == 0) {
+            void* base = VirtualAllocExNuma(process, NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+            if (base) {
+                *backing = NUMA_BACKING_HUGETLB;
+                return base;
+            }
+        }
+        return VirtualAllocExNuma(process, NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+    }
+
+    // Windows 無交錯策略: 保留後以配置粒度 (64KB) 輪流提交到各節點
+    void* base = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_READWRITE);
+    if (!base) return NULL;
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    size_t chunk = si.dwAllocationGranularity;
+    int nodes[RETRYIX_NUMA_MAX_NODES];
+    int node_count = 0;
+    for (int n = 0; n < RETRYIX_NUMA_MAX_NODES; n++) {
+        if (nodemask & (1ull << n)) nodes[node_count++] = n;
+    }
+    if (node_count == 0) nodes[node_count++] = 0;
+    for (size_t off = 0, i = 0; off < size; off += chunk, i++) {
+        size_t len = (size - off < chunk) ? size - off : chunk;
+        if (!VirtualAllocExNuma(process, (char*)base + off, len, MEM_COMMIT, PAGE_READWRITE, nodes[i % node_count])) {
+            VirtualFree(base, 0, MEM_RELEASE);
+            return NULL;
+        }
+    }
+    return base;
+}
+
+static void numa_unmap(void* base, size_t size) {
+    (void)size;
+    VirtualFree(base, 0, MEM_RELEASE);
+}
+
+#else
+
+static long numa_mbind(void* addr, size_t len, int mode, uint64_t mask, unsigned flags) {
+    unsigned long nodes = (unsigned long)mask;
+    return syscall(SYS_mbind, addr, len, mode, mode == MPOL_DEFAULT ? NULL : &nodes, NUMA_MAXNODE, flags);
+}
+
+static void* numa_map(size_t size, retryix_numa_policy_t policy, uint64_t nodemask, bool huge, bool use_hugetlb, uint8_t* backing) {
+    void* base = MAP_FAILED;
+    *backing = NUMA_BACKING_PAGES;
+    if (huge && use_hugetlb) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) *backing = NUMA_BACKING_HUGETLB;
+    }
+    if (base == MAP_FAILED && huge) {
+        // 多映射一個大頁後裁掉頭尾, 取得 2MB 對齊的區段讓 THP 能覆蓋整段
+        size_t span = size + NUMA_HUGE_PAGE;
+        void* raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            uintptr_t aligned = ((uintptr_t)raw + NUMA_HUGE_PAGE - 1) & ~(uintptr_t)(NUMA_HUGE_PAGE - 1);
+            size_t head = aligned - (uintptr_t)raw;
+            if (head) munmap(raw, head);
+            if (span - head > size) munmap((void*)(aligned + size), span - head - size);
+            base = (void*)aligned;
+            madvise(base, size, MADV_HUGEPAGE);
+            *backing = NUMA_BACKING_THP;
+        }
+    }
+    if (base == MAP_FAILED) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return NULL;
+    }
+
+    int mode = MPOL_DEFAULT;
+    switch (policy) {
+        case RETRYIX_NUMA_POLICY_PREFERRED:
+            mode = MPOL_PREFERRED;
+            nodemask = 1ull << numa_lowest_node(nodemask);
+            break;
+        case RETRYIX_NUMA_POLICY_BIND: mode = MPOL_BIND; break;
+        case RETRYIX_NUMA_POLICY_INTERLEAVE: mode = MPOL_INTERLEAVE; break;
+        default: break;
+    }
+    // 尚未觸碰頁面, 策略在首次缺頁時生效; 核心不支援 (容器 / seccomp) 時維持預設放置
+    if (mode != MPOL_DEFAULT) numa_mbind(base, size, mode, nodemask, 0);
+    return base;
+}
+
+static void numa_unmap(void* base, size_t size) {
+    munmap(base, size);
+}
+
+#endif
+
+// 系統 2MB 大頁池是否有頁面 (只在未指定時查詢一次)
+static bool numa_hugetlb_available(void) {
+#ifdef _WIN32
+    return GetLargePageMinimum() > 0;
+#else
+    FILE* f = fopen("/proc/sys/vm/nr_hugepages", "r");
+    if (!f) return false;
+    long pages = 0;
+    if (fscanf(f, "%ld", &pages) != 1) pages = 0;
+    fclose(f);
+    return pages > 0;
+#endif
+}
+
+void* retryix_numa_alloc(size_t size, retryix_numa_policy_t policy, uint64_t nodemask) {
+    if (size == 0) return NULL;
+
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    uint64_t threshold = RX_LOAD64(&g_huge_threshold);
+    bool huge = threshold > 0 && size >= threshold;
+    bool place = t->node_count > 1 && size >= RETRYIX_NUMA_MIN_REGION && policy != RETRYIX_NUMA_POLICY_DEFAULT;
+    if (place) {
+        // 只保留線上節點; 全部無效時退回預設放置
+        uint64_t online = 0;
+        for (uint32_t n = 0; n < t->max_node && n < 64; n++) {
+            if (t->node_online[n]) online |= 1ull << n;
+        }
+        nodemask &= online;
+        if (nodemask == 0) place = false;
+    }
+    if (!place && !huge) return malloc(size);
+    bool use_hugetlb = false;
+    if (huge) {
+        REGION_LOCK();
+        if (g_huge_use_hugetlb < 0) g_huge_use_hugetlb = numa_hugetlb_available() ? 1 : 0;
+        use_hugetlb = g_huge_use_hugetlb > 0;
+        REGION_UNLOCK();
+    }
+    if (!place) {
+        policy = RETRYIX_NUMA_POLICY_DEFAULT;
+        nodemask = 0;
+    }
+
+    size_t align = huge ? NUMA_HUGE_PAGE : numa_page_size();
+    size_t mapped = (size + align - 1) & ~(align - 1);
+    uint8_t backing = NUMA_BACKING_PAGES;
+    void* base = numa_map(mapped, policy, nodemask, huge, use_hugetlb, &backing);
+    if (!base) return NULL;
+
+    numa_region_t r;
+    memset(&r, 0, sizeof(r));
+    r.base = (uintptr_t)base;
+    r.size = mapped;
+    r.backing = backing;
+    r.policy = policy;
+    r.nodemask = nodemask;
+    if (huge) {
+        REGION_LOCK();
+        g_huge_stats.huge_requests++;
+        if (backing == NUMA_BACKING_PAGES || (use_hugetlb && backing != NUMA_BACKING_HUGETLB)) g_huge_stats.fallbacks++;
+        REGION_UNLOCK();
+    }
+    if (!region_insert(&r)) {
+        numa_unmap(base, mapped);
+        return NULL;
+    }
+    return base;
+}
+
+void retryix_numa_free(void* ptr) {
+    if (!ptr) return;
+    size_t size = 0;
+    if (region_remove((uintptr_t)ptr, &size)) {
+        retryix_numa_migrate_forget(ptr, size);   // 等待背景搬移離開此區再解除映射
+        numa_unmap(ptr, size);
+    } else {
+        free(ptr);
+    }
+}
+
+bool retryix_numa_region_of(const void* ptr, void** base, size_t* size) {
+    bool found = false;
+    REGION_LOCK();
+    numa_region_t* r = region_find((uintptr_t)ptr);
+    if (r) {
+        if (base) *base = (void*)r->base;
+        if (size) *size = r->size;
+        found = true;
+    }
+    REGION_UNLOCK();
+    return found;
+}
+
+static int numa_bind_range(void* ptr, size_t size, int node, retryix_numa_policy_t policy, bool move_existing) {
+    if (!ptr) return -EINVAL;
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    if (node < 0 || node >= (int)t->max_node || !t->node_online[node]) return -EINVAL;
+
+    size_t page = numa_page_size();
+    uintptr_t start = (uintptr_t)ptr & ~(uintptr_t)(page - 1);
+    uintptr_t end;
+
+    REGION_LOCK();
+    numa_region_t* r = region_find((uintptr_t)ptr);
+    if (size == 0) {
+        if (r) {
+            start = r->base;
+            end = r->base + r->size;
+        } else {
+            end = start + page;
+        }
+    } else {
+        end = ((uintptr_t)ptr + size + page - 1) & ~(uintptr_t)(page - 1);
+    }
+    // 整區重新綁定時同步更新登記的策略
+    if (r && start == r->base && end == r->base + r->size) {
+        r->policy = policy;
+        r->nodemask = 1ull << node;
+    }
+    REGION_UNLOCK();
+
+    // 單節點系統: 所有頁面本來就在該節點
+    if (t->node_count <= 1) return 0;
+
+#ifdef _WIN32
+    // Windows 無法改變已提交頁面的節點
+    (void)move_existing;
+    return -ENOSYS;
+#else
+    // malloc 區段與其他配置共用頁面, 綁定僅影響之後的缺頁以及可獨佔搬移的頁面
+    int mode = (policy == RETRYIX_NUMA_POLICY_PREFERRED) ? MPOL_PREFERRED : MPOL_BIND;
+    if (numa_mbind((void*)start, end - start, mode, 1ull << node, move_existing ? MPOL_MF_MOVE : 0) != 0) {
+        return -errno;
+    }
+    return 0;
+#endif
+}
+
+int retryix_numa_bind(void* ptr, size_t size, int node) {
+    return numa_bind_range(ptr, size, node, RETRYIX_NUMA_POLICY_BIND, true);
+}
+
+int retryix_numa_set_policy(void* ptr, size_t size, int node) {
+    return numa_bind_range(ptr, size, node, RETRYIX_NUMA_POLICY_BIND, false);
+}
+
+int retryix_numa_set_preferred(void* ptr, size_t size, int node) {
+    return numa_bind_range(ptr, size, node, RETRYIX_NUMA_POLICY_PREFERRED, false);
+}
+
+void retryix_numa_record_access(const void* ptr) {
+    if (!ptr || (++t_access_tick & (RETRYIX_NUMA_ACCESS_SAMPLE - 1)) != 0) return;
+    int node = retryix_numa_current_node();
+    if (node < 0 || node >= RETRYIX_NUMA_MAX_NODES) return;
+
+    REGION_LOCK();
+    numa_region_t* r = region_find((uintptr_t)ptr);
+    if (r && r->access[node] < UINT32_MAX) r->access[node]++;
+    REGION_UNLOCK();
+}
+
+size_t retryix_numa_snapshot_regions(retryix_numa_region_info_t* out, size_t max, bool decay) {
+    size_t n = 0;
+    REGION_LOCK();
+    for (size_t i = 0; i < g_region_count; i++) {
+        numa_region_t* r = &g_regions[i];
+        if (out && n < max) {
+            out[n].base = (void*)r->base;
+            out[n].size = r->size;
+            out[n].policy = r->policy;
+            out[n].nodemask = r->nodemask;
+            memcpy(out[n].access, r->access, sizeof(r->access));
+        }
+        n++;
+        // 減半衰減, 讓取樣反映近期的存取分佈
+        if (decay) {
+            for (int k = 0; k < RETRYIX_NUMA_MAX_NODES; k++) r->access[k] >>= 1;
+        }
+    }
+    REGION_UNLOCK();
+    return n;
+}
+
+int retryix_numa_node_of_addr(const void* ptr) {
+    if (!ptr) return -1;
+#ifdef _WIN32
+    PSAPI_WORKING_SET_EX_INFORMATION info;
+    info.VirtualAddress = (PVOID)ptr;
+    if (!QueryWorkingSetEx(GetCurrentProcess(), &info, sizeof(info)) || !info.VirtualAttributes.Valid) {
+        return -1;
+    }
+    return (int)info.VirtualAttributes.Node;
+#else
+    int node = -1;
+    if (retryix_numa_topology()->node_count <= 1) return 0;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, ptr, MPOL_F_NODE | MPOL_F_ADDR) != 0) return -1;
+    return node;
+#endif
+}
+
+void retryix_numa_set_huge_policy(size_t threshold, int use_hugetlb) {
+    REGION_LOCK();
+    RX_STORE64(&g_huge_threshold, threshold);
+    g_huge_use_hugetlb = use_hugetlb < 0 ? -1 : (use_hugetlb ? 1 : 0);
+    REGION_UNLOCK();
+}
+
+size_t retryix_numa_huge_threshold(void) {
+    return (size_t)RX_LOAD64(&g_huge_threshold);
+}
+
+void retryix_numa_huge_stats(retryix_numa_huge_stats_t* out) {
+    if (!out) return;
+    REGION_LOCK();
+    *out = g_huge_stats;
+    out->thp_backed_bytes = 0;
+
+#ifndef _WIN32
+    // 核心是否真的以大頁填入 THP 區段只能從 smaps 的 AnonHugePages 得知
+    if (g_huge_stats.thp_bytes > 0) {
+        FILE* f = fopen("/proc/self/smaps", "r");
+        if (f) {
+            char line[512];
+            bool in_thp = false;
+            while (fgets(line, sizeof(line), f)) {
+                unsigned long start, end;
+                unsigned long kb;
+                if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+                    size_t pos = region_upper_bound((uintptr_t)end - 1);
+                    in_thp = pos > 0 && g_regions[pos - 1].backing == NUMA_BACKING_THP &&
+                             g_regions[pos - 1].base + g_regions[pos - 1].size > (uintptr_t)start;
+                } else if (in_thp && sscanf(line, "AnonHugePages: %lu kB", &kb) == 1) {
+                    out->thp_backed_bytes += (uint64_t)kb * 1024;
+                }
+            }
+            fclose(f);
+        }
+    }
+#endif
+    REGION_UNLOCK();
+}
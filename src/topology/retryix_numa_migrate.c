@@ -0,0 +1,372 @@
+// retryix_numa_migrate.c - 背景頁面搬移引擎
+// 工作以佇列交給單一背景線程; 每批最多 NUMA_MIGRATE_BATCH 頁, 先以 move_pages 查詢
+// 目前節點, 只搬移放錯的頁面, 並在批次之間更新進度與檢查取消
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "retryix_numa_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+#define NUMA_MIGRATE_BATCH     1024
+#define NUMA_DOMINANT_PERMILLE 600     // 單一節點佔取樣 60% 以上才視為主要存取者
+#define NUMA_MIN_SAMPLES       8
+
+typedef struct numa_job {
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t nodemask;                 // 單一位元 = 搬到該節點; 多位元 = 依頁號交錯
+    bool rebind;
+    volatile bool cancelled;
+    struct numa_job* next;
+} numa_job_t;
+
+static numa_job_t* g_queue_head = NULL;
+static numa_job_t* g_queue_tail = NULL;
+static numa_job_t* g_current = NULL;
+static bool g_worker_started = false;
+static retryix_numa_migration_progress_t g_progress;
+
+#ifdef _WIN32
+static SRWLOCK g_engine_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE g_engine_cond = CONDITION_VARIABLE_INIT;
+#define ENGINE_LOCK()      AcquireSRWLockExclusive(&g_engine_lock)
+#define ENGINE_UNLOCK()    ReleaseSRWLockExclusive(&g_engine_lock)
+#define ENGINE_BROADCAST() WakeAllConditionVariable(&g_engine_cond)
+#else
+static pthread_mutex_t g_engine_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_engine_cond = PTHREAD_COND_INITIALIZER;
+#define ENGINE_LOCK()      pthread_mutex_lock(&g_engine_lock)
+#define ENGINE_UNLOCK()    pthread_mutex_unlock(&g_engine_lock)
+#define ENGINE_BROADCAST() pthread_cond_broadcast(&g_engine_cond)
+#endif
+
+// 呼叫者持鎖; timeout_ms = RETRYIX_NUMA_WAIT_INFINITE 表示無限等待; 逾時回傳 false
+static bool engine_wait(uint32_t timeout_ms) {
+#ifdef _WIN32
+    return SleepConditionVariableSRW(&g_engine_cond, &g_engine_lock,
+        timeout_ms == RETRYIX_NUMA_WAIT_INFINITE ? INFINITE : timeout_ms, 0) != 0;
+#else
+    if (timeout_ms == RETRYIX_NUMA_WAIT_INFINITE) {
+        return pthread_cond_wait(&g_engine_cond, &g_engine_lock) == 0;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(&g_engine_cond, &g_engine_lock, &ts) == 0;
+#endif
+}
+
+static size_t migrate_page_size(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+#else
+    long v = sysconf(_SC_PAGESIZE);
+    return v > 0 ? (size_t)v : 4096;
+#endif
+}
+
+// 頁號對應的目標節點: 與核心 MPOL_INTERLEAVE 相同, 以虛擬頁號對節點數取模
+static int migrate_target(uint64_t nodemask, uintptr_t page_index) {
+    int count = 0;
+    for (uint64_t m = nodemask; m; m &= m - 1) count++;
+    int nth = (int)(page_index % (uintptr_t)count);
+    for (int n = 0; n < RETRYIX_NUMA_MAX_NODES; n++) {
+        if ((nodemask & (1ull << n)) && nth-- == 0) return n;
+    }
+    return 0;
+}
+
+// 處理一批頁面, 回傳 (搬移數, 失敗數)
+static void migrate_batch(const numa_job_t* job, uintptr_t start, size_t pages, size_t page_size,
+                          uint64_t* moved, uint64_t* failed) {
+    *moved = 0;
+    *failed = 0;
+#ifdef _WIN32
+    // Windows 沒有搬移已提交頁面的介面
+    (void)job; (void)start; (void)page_size;
+    *failed = pages;
+#else
+    void* addrs[NUMA_MIGRATE_BATCH];
+    int status[NUMA_MIGRATE_BATCH];
+    void* move_addrs[NUMA_MIGRATE_BATCH];
+    int move_nodes[NUMA_MIGRATE_BATCH];
+    size_t page_shift = 0;
+    while (((size_t)1 << page_shift) < page_size) page_shift++;
+
+    for (size_t i = 0; i < pages; i++) addrs[i] = (void*)(start + i * page_size);
+    if (syscall(SYS_move_pages, 0, (unsigned long)pages, addrs, NULL, status, 0) != 0) {
+        *failed = pages;
+        return;
+    }
+
+    // 尚未配置實體頁 (-ENOENT) 或不可搬移的頁面略過; 之後的缺頁由策略決定落點
+    size_t count = 0;
+    for (size_t i = 0; i < pages; i++) {
+        if (status[i] < 0) continue;
+        int target = migrate_target(job->nodemask, (uintptr_t)addrs[i] >> page_shift);
+        if (status[i] != target) {
+            move_addrs[count] = addrs[i];
+            move_nodes[count] = target;
+            count++;
+        }
+    }
+    if (count == 0) return;
+
+    long rc = syscall(SYS_move_pages, 0, (unsigned long)count, move_addrs, move_nodes, status, MPOL_MF_MOVE);
+    if (rc < 0) {
+        *failed = count;
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (status[i] == move_nodes[i]) (*moved)++;
+        else if (status[i] != -ENOENT && status[i] != -EFAULT) (*failed)++;
+    }
+#endif
+}
+
+static void migrate_run_job(numa_job_t* job) {
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    size_t page_size = migrate_page_size();
+
+    if (job->rebind && (job->nodemask & (job->nodemask - 1)) == 0) {
+        int node = migrate_target(job->nodemask, 0);
+        retryix_numa_set_policy((void*)job->start, job->end - job->start, node);
+    }
+
+    for (uintptr_t addr = job->start; addr < job->end; ) {
+        size_t pages = (job->end - addr) / page_size;
+        if (pages > NUMA_MIGRATE_BATCH) pages = NUMA_MIGRATE_BATCH;
+
+        uint64_t moved = 0, failed = 0;
+        // 單節點系統: 所有頁面已在唯一節點上
+        if (t->node_count > 1) migrate_batch(job, addr, pages, page_size, &moved, &failed);
+        addr += pages * page_size;
+
+        ENGINE_LOCK();
+        g_progress.pages_scanned += pages;
+        g_progress.pages_moved += moved;
+        g_progress.pages_failed += failed;
+        bool cancelled = job->cancelled;
+        if (cancelled) g_progress.pages_total -= (job->end - addr) / page_size;
+        ENGINE_UNLOCK();
+        if (cancelled) break;
+    }
+}
+
+static void migrate_worker_loop(void) {
+    for (;;) {
+        ENGINE_LOCK();
+        while (!g_queue_head) engine_wait(RETRYIX_NUMA_WAIT_INFINITE);
+        numa_job_t* job = g_queue_head;
+        g_queue_head = job->next;
+        if (!g_queue_head) g_queue_tail = NULL;
+        g_current = job;
+        ENGINE_UNLOCK();
+
+        migrate_run_job(job);
+
+        ENGINE_LOCK();
+        g_current = NULL;
+        g_progress.jobs_pending--;
+        g_progress.jobs_completed++;
+        ENGINE_BROADCAST();
+        ENGINE_UNLOCK();
+        free(job);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI migrate_worker_win(LPVOID arg) {
+    (void)arg;
+    migrate_worker_loop();
+    return 0;
+}
+#else
+static void* migrate_worker_posix(void* arg) {
+    (void)arg;
+    migrate_worker_loop();
+    return NULL;
+}
+#endif
+
+// 呼叫者持鎖
+static bool migrate_start_worker(void) {
+    if (g_worker_started) return true;
+#ifdef _WIN32
+    HANDLE thread = CreateThread(NULL, 0, migrate_worker_win, NULL, 0, NULL);
+    if (!thread) return false;
+    CloseHandle(thread);
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, migrate_worker_posix, NULL) != 0) return false;
+    pthread_detach(thread);
+#endif
+    g_worker_started = true;
+    return true;
+}
+
+static int migrate_submit(uintptr_t start, uintptr_t end, uint64_t nodemask, bool rebind) {
+    if (start >= end || nodemask == 0) return -EINVAL;
+    numa_job_t* job = (numa_job_t*)calloc(1, sizeof(numa_job_t));
+    if (!job) return -ENOMEM;
+    job->start = start;
+    job->end = end;
+    job->nodemask = nodemask;
+    job->rebind = rebind;
+
+    ENGINE_LOCK();
+    if (!migrate_start_worker()) {
+        ENGINE_UNLOCK();
+        free(job);
+        return -EAGAIN;
+    }
+    if (g_queue_tail) g_queue_tail->next = job;
+    else g_queue_head = job;
+    g_queue_tail = job;
+    g_progress.jobs_pending++;
+    g_progress.pages_total += (end - start) / migrate_page_size();
+    ENGINE_BROADCAST();
+    ENGINE_UNLOCK();
+    return 0;
+}
+
+int retryix_numa_migrate_async(void* ptr, size_t size, int node, bool rebind) {
+    if (!ptr) return -EINVAL;
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    if (node < 0 || node >= (int)t->max_node || !t->node_online[node]) return -EINVAL;
+
+    size_t page = migrate_page_size();
+    uintptr_t start = (uintptr_t)ptr & ~(uintptr_t)(page - 1);
+    uintptr_t end;
+    void* base = NULL;
+    size_t region_size = 0;
+    if (size == 0 && retryix_numa_region_of(ptr, &base, &region_size)) {
+        start = (uintptr_t)base;
+        end = start + region_size;
+    } else if (size == 0) {
+        end = start + page;
+    } else {
+        end = ((uintptr_t)ptr + size + page - 1) & ~(uintptr_t)(page - 1);
+    }
+    return migrate_submit(start, end, 1ull << node, rebind);
+}
+
+int retryix_numa_rebalance(void) {
+    size_t count = retryix_numa_snapshot_regions(NULL, 0, false);
+    if (count == 0) return 0;
+    retryix_numa_region_info_t* regions = (retryix_numa_region_info_t*)malloc(count * sizeof(*regions));
+    if (!regions) return -ENOMEM;
+    count = retryix_numa_snapshot_regions(regions, count, false);
+
+    int submitted = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t mask = regions[i].nodemask;
+        if (regions[i].policy == RETRYIX_NUMA_POLICY_DEFAULT || mask == 0) continue;
+        if (regions[i].policy == RETRYIX_NUMA_POLICY_PREFERRED) mask &= ~(mask - 1);   // 最低節點
+        uintptr_t start = (uintptr_t)regions[i].base;
+        if (migrate_submit(start, start + regions[i].size, mask, false) == 0) submitted++;
+    }
+    free(regions);
+    return submitted;
+}
+
+int retryix_numa_optimize_placement(void) {
+    size_t count = retryix_numa_snapshot_regions(NULL, 0, false);
+    if (count == 0) return 0;
+    retryix_numa_region_info_t* regions = (retryix_numa_region_info_t*)malloc(count * sizeof(*regions));
+    if (!regions) return -ENOMEM;
+    count = retryix_numa_snapshot_regions(regions, count, true);
+
+    int submitted = 0;
+    for (size_t i = 0; i < count; i++) {
+        // 交錯配置是刻意分散, 不依存取者集中
+        if (regions[i].policy == RETRYIX_NUMA_POLICY_INTERLEAVE) continue;
+
+        uint64_t total = 0;
+        int dominant = -1;
+        for (int n = 0; n < RETRYIX_NUMA_MAX_NODES; n++) {
+            total += regions[i].access[n];
+            if (dominant < 0 || regions[i].access[n] > regions[i].access[dominant]) dominant = n;
+        }
+        if (total < NUMA_MIN_SAMPLES || regions[i].access[dominant] * 1000 < total * NUMA_DOMINANT_PERMILLE) continue;
+        if (regions[i].policy == RETRYIX_NUMA_POLICY_BIND && regions[i].nodemask == (1ull << dominant)) continue;
+
+        uintptr_t start = (uintptr_t)regions[i].base;
+        if (migrate_submit(start, start + regions[i].size, 1ull << dominant, true) == 0) submitted++;
+    }
+    free(regions);
+    return submitted;
+}
+
+void retryix_numa_migration_progress(retryix_numa_migration_progress_t* out) {
+    if (!out) return;
+    ENGINE_LOCK();
+    *out = g_progress;
+    ENGINE_UNLOCK();
+}
+
+bool retryix_numa_migration_wait(uint32_t timeout_ms) {
+    ENGINE_LOCK();
+    while (g_progress.jobs_pending > 0) {
+        if (!engine_wait(timeout_ms) && timeout_ms != RETRYIX_NUMA_WAIT_INFINITE) break;
+    }
+    bool done = g_progress.jobs_pending == 0;
+    ENGINE_UNLOCK();
+    return done;
+}
+
+void retryix_numa_migrate_forget(void* base, size_t size) {
+    uintptr_t start = (uintptr_t)base;
+    uintptr_t end = start + size;
+    size_t page = migrate_page_size();
+
+    ENGINE_LOCK();
+    if (!g_worker_started) {
+        ENGINE_UNLOCK();
+        return;
+    }
+    numa_job_t* prev = NULL;
+    for (numa_job_t* job = g_queue_head; job; ) {
+        numa_job_t* next = job->next;
+        if (job->start < end && start < job->end) {
+            if (prev) prev->next = next;
+            else g_queue_head = next;
+            if (g_queue_tail == job) g_queue_tail = prev;
+            g_progress.jobs_pending--;
+            g_progress.pages_total -= (job->end - job->start) / page;
+            free(job);
+        } else {
+            prev = job;
+        }
+        job = next;
+    }
+    if (g_current && g_current->start < end && start < g_current->end) {
+        g_current->cancelled = true;
+        uint64_t completed = g_progress.jobs_completed;
+        while (g_progress.jobs_completed == completed) engine_wait(RETRYIX_NUMA_WAIT_INFINITE);
+    }
+    ENGINE_BROADCAST();
+    ENGINE_UNLOCK();
+}
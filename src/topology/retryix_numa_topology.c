@@ -0,0 +1,415 @@
+// retryix_numa_topology.c - NUMA / 快取 / PCI 親和性探索
+// Linux: /sys/devices/system/node, /sys/devices/system/cpu/cpuN/cache, /sys/bus/pci/devices/*/numa_node
+// Windows: GetNumaNodeProcessorMaskEx / GetNumaAvailableMemoryNodeEx / GetLogicalProcessorInformation
+// 探索一次後常駐, 各配置器與排程器以 O(1) 查表
+#define RETRYIX_BUILD_DLL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_numa_internal.h"
+#include "retryix_atomic_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+static retryix_numa_topology_t g_topology;
+static volatile uint32_t g_topology_state = 0;   // 0 = 未探索, 1 = 探索中, 2 = 完成
+
+static void numa_mask_set(uint64_t* mask, int cpu) {
+    if (cpu >= 0 && cpu < RETRYIX_NUMA_MAX_CPUS) mask[cpu / 64] |= 1ull << (cpu % 64);
+}
+
+static uint32_t numa_mask_count(const uint64_t* mask) {
+    uint32_t n = 0;
+    for (int w = 0; w < RETRYIX_NUMA_MASK_WORDS; w++) {
+        uint64_t v = mask[w];
+        while (v) { v &= v - 1; n++; }
+    }
+    return n;
+}
+
+// 以單節點涵蓋所有 CPU (平台無 NUMA 資訊時)
+static void numa_single_node(retryix_numa_topology_t* t, uint32_t cpus, uint64_t mem_total, uint64_t mem_free) {
+    if (cpus == 0) cpus = 1;
+    if (cpus > RETRYIX_NUMA_MAX_CPUS) cpus = RETRYIX_NUMA_MAX_CPUS;
+    t->node_count = 1;
+    t->max_node = 1;
+    t->cpu_count = cpus;
+    t->node_online[0] = true;
+    t->distance[0][0] = 10;
+    for (uint32_t c = 0; c < cpus; c++) {
+        numa_mask_set(t->node_cpus[0], (int)c);
+        t->cpu_node[c] = 0;
+    }
+    t->node_cpu_count[0] = cpus;
+    t->node_mem_total[0] = mem_total;
+    t->node_mem_free[0] = mem_free;
+}
+
+#ifndef _WIN32
+
+static bool numa_read_file(const char* path, char* buf, size_t size) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    size_t n = fread(buf, 1, size - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' ')) buf[--n] = '\0';
+    return true;
+}
+
+static long numa_read_long(const char* path, long fallback) {
+    char buf[64];
+    if (!numa_read_file(path, buf, sizeof(buf))) return fallback;
+    return strtol(buf, NULL, 0);
+}
+
+// 解析 "0-3,8-11" 形式的清單; 回傳最大值 + 1
+static int numa_parse_list(const char* list, uint64_t* mask, bool* flags, int limit) {
+    int max_plus_one = 0;
+    const char* p = list;
+    while (*p) {
+        char* end;
+        long lo = strtol(p, &end, 10);
+        if (end == p) break;
+        long hi = lo;
+        p = end;
+        if (*p == '-') {
+            hi = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long v = lo; v <= hi && v < limit; v++) {
+            if (mask) numa_mask_set(mask, (int)v);
+            if (flags) flags[v] = true;
+            if (v + 1 > max_plus_one) max_plus_one = (int)v + 1;
+        }
+        if (*p == ',') p++;
+        else break;
+    }
+    return max_plus_one;
+}
+
+// 解析 "16K" / "1024K" / "32M"
+static uint32_t numa_parse_size_kb(const char* s) {
+    char* end;
+    unsigned long v = strtoul(s, &end, 10);
+    if (*end == 'M' || *end == 'm') v *= 1024;
+    else if (*end == 'G' || *end == 'g') v *= 1024 * 1024;
+    return (uint32_t)v;
+}
+
+static uint64_t numa_meminfo_field(const char* text, const char* key) {
+    const char* p = strstr(text, key);
+    if (!p) return 0;
+    p += strlen(key);
+    while (*p == ' ' || *p == ':') p++;
+    return (uint64_t)strtoull(p, NULL, 10) * 1024ull;   // kB
+}
+
+static void numa_discover_caches(retryix_numa_topology_t* t) {
+    for (int idx = 0; t->cache_count < RETRYIX_NUMA_MAX_CACHES; idx++) {
+        char path[256], buf[256];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", idx);
+        if (!numa_read_file(path, buf, sizeof(buf))) break;
+
+        retryix_cache_info_t* c = &t->caches[t->cache_count];
+        c->level = (uint8_t)atoi(buf);
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", idx);
+        c->type = RETRYIX_CACHE_UNIFIED;
+        if (numa_read_file(path, buf, sizeof(buf))) {
+            if (strcmp(buf, "Data") == 0) c->type = RETRYIX_CACHE_DATA;
+            else if (strcmp(buf, "Instruction") == 0) c->type = RETRYIX_CACHE_INSTRUCTION;
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", idx);
+        if (numa_read_file(path, buf, sizeof(buf))) c->size_kb = numa_parse_size_kb(buf);
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", idx);
+        c->line_size = (uint16_t)numa_read_long(path, 64);
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/shared_cpu_list", idx);
+        if (numa_read_file(path, buf, sizeof(buf))) {
+            uint64_t shared[RETRYIX_NUMA_MASK_WORDS] = {0};
+            numa_parse_list(buf, shared, NULL, RETRYIX_NUMA_MAX_CPUS);
+            c->shared_cpus = numa_mask_count(shared);
+        }
+        t->cache_count++;
+    }
+}
+
+static void numa_discover_devices(retryix_numa_topology_t* t) {
+    DIR* dir = opendir("/sys/bus/pci/devices");
+    if (!dir) return;
+
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL && t->device_count < RETRYIX_NUMA_MAX_DEVICES) {
+        unsigned int domain, bus, dev, fn;
+        if (sscanf(ent->d_name, "%x:%x:%x.%x", &domain, &bus, &dev, &fn) != 4) continue;
+        char path[320];
+        retryix_numa_device_t* d = &t->devices[t->device_count];
+        memset(d, 0, sizeof(*d));
+        // 依欄位寬度重新格式化 (最長 "ffff:ff:1f.7"), 不直接複製可達 255 字元的目錄名稱
+        snprintf(d->bdf, sizeof(d->bdf), "%04x:%02x:%02x.%x", domain & 0xFFFFu, bus & 0xFFu, dev & 0x1Fu, fn & 0x7u);
+
+        snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/class", ent->d_name);
+        d->class_code = (uint32_t)numa_read_long(path, 0);
+        // 只記錄會參與資料搬移的裝置: 顯示 / 網路 / 儲存 / 處理加速器
+        uint32_t base = d->class_code >> 16;
+        if (base != 0x01 && base != 0x02 && base != 0x03 && base != 0x12 && base != 0x0B) continue;
+
+        snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/vendor", ent->d_name);
+        d->vendor_id = (uint16_t)numa_read_long(path, 0);
+        snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/device", ent->d_name);
+        d->device_id = (uint16_t)numa_read_long(path, 0);
+        snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/numa_node", ent->d_name);
+        long node = numa_read_long(path, -1);
+        d->node = (int16_t)((node >= 0 && node < RETRYIX_NUMA_MAX_NODES && t->node_online[node]) ? node : -1);
+        t->device_count++;
+    }
+    closedir(dir);
+}
+
+static void numa_discover(retryix_numa_topology_t* t) {
+    char buf[4096], path[256];
+    memset(t, 0, sizeof(*t));
+    for (int c = 0; c < RETRYIX_NUMA_MAX_CPUS; c++) t->cpu_node[c] = -1;
+
+    if (numa_read_file("/sys/devices/system/node/online", buf, sizeof(buf))) {
+        t->max_node = (uint32_t)numa_parse_list(buf, NULL, t->node_online, RETRYIX_NUMA_MAX_NODES);
+    }
+
+    if (t->max_node == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_CONF);
+        uint64_t total = 0, avail = 0;
+        if (numa_read_file("/proc/meminfo", buf, sizeof(buf))) {
+            total = numa_meminfo_field(buf, "MemTotal");
+            avail = numa_meminfo_field(buf, "MemAvailable");
+        }
+        numa_single_node(t, (uint32_t)(cpus > 0 ? cpus : 1), total, avail);
+    } else {
+        t->from_firmware = true;
+        for (uint32_t n = 0; n < t->max_node; n++) {
+            if (!t->node_online[n]) continue;
+            t->node_count++;
+
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", n);
+            if (numa_read_file(path, buf, sizeof(buf))) {
+                int max_cpu = numa_parse_list(buf, t->node_cpus[n], NULL, RETRYIX_NUMA_MAX_CPUS);
+                if ((uint32_t)max_cpu > t->cpu_count) t->cpu_count = (uint32_t)max_cpu;
+                t->node_cpu_count[n] = numa_mask_count(t->node_cpus[n]);
+                for (int c = 0; c < max_cpu; c++) {
+                    if (t->node_cpus[n][c / 64] & (1ull << (c % 64))) t->cpu_node[c] = (int16_t)n;
+                }
+            }
+
+            // distance 檔只列出 online 節點 (依編號遞增), 第 k 欄對應第 k 個 online 節點;
+            // 節點編號不連續或有離線節點時不能直接以欄位位置當節點編號
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/distance", n);
+            if (numa_read_file(path, buf, sizeof(buf))) {
+                char* p = buf;
+                uint32_t m = 0;
+                while (*p) {
+                    while (m < t->max_node && !t->node_online[m]) m++;
+                    if (m >= t->max_node) break;
+                    char* end;
+                    long d = strtol(p, &end, 10);
+                    if (end == p) break;
+                    t->distance[n][m++] = (uint8_t)(d > 255 ? 255 : d);
+                    p = end;
+                }
+            }
+            if (t->distance[n][n] == 0) t->distance[n][n] = 10;
+        }
+        // 缺少距離資料的節點對視為遠端 (20)
+        for (uint32_t a = 0; a < t->max_node; a++) {
+            for (uint32_t b = 0; b < t->max_node; b++) {
+                if (t->node_online[a] && t->node_online[b] && t->distance[a][b] == 0) {
+                    t->distance[a][b] = (a == b) ? 10 : 20;
+                }
+            }
+        }
+    }
+
+    numa_discover_caches(t);
+    numa_discover_devices(t);
+}
+
+static void numa_read_free_memory(retryix_numa_topology_t* t) {
+    char buf[4096], path[256];
+    if (!t->from_firmware) {
+        if (numa_read_file("/proc/meminfo", buf, sizeof(buf))) {
+            t->node_mem_total[0] = numa_meminfo_field(buf, "MemTotal");
+            t->node_mem_free[0] = numa_meminfo_field(buf, "MemAvailable");
+        }
+        return;
+    }
+    for (uint32_t n = 0; n < t->max_node; n++) {
+        if (!t->node_online[n]) continue;
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/meminfo", n);
+        if (!numa_read_file(path, buf, sizeof(buf))) continue;
+        t->node_mem_total[n] = numa_meminfo_field(buf, "MemTotal");
+        t->node_mem_free[n] = numa_meminfo_field(buf, "MemFree");
+    }
+}
+
+#else  /* _WIN32 */
+
+static void numa_discover(retryix_numa_topology_t* t) {
+    memset(t, 0, sizeof(*t));
+    for (int c = 0; c < RETRYIX_NUMA_MAX_CPUS; c++) t->cpu_node[c] = -1;
+
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest) && highest > 0) {
+        t->from_firmware = true;
+        t->max_node = (highest + 1 > RETRYIX_NUMA_MAX_NODES) ? RETRYIX_NUMA_MAX_NODES : highest + 1;
+        for (USHORT n = 0; n < t->max_node; n++) {
+            GROUP_AFFINITY affinity;
+            if (!GetNumaNodeProcessorMaskEx(n, &affinity) || affinity.Mask == 0) continue;
+            t->node_online[n] = true;
+            t->node_count++;
+            for (int bit = 0; bit < 64; bit++) {
+                if (!(affinity.Mask & ((KAFFINITY)1 << bit))) continue;
+                int cpu = affinity.Group * 64 + bit;
+                numa_mask_set(t->node_cpus[n], cpu);
+                if (cpu < RETRYIX_NUMA_MAX_CPUS) t->cpu_node[cpu] = (int16_t)n;
+                if ((uint32_t)cpu + 1 > t->cpu_count) t->cpu_count = (uint32_t)cpu + 1;
+            }
+            t->node_cpu_count[n] = numa_mask_count(t->node_cpus[n]);
+        }
+        // Windows 不公開 SLIT, 以本地 / 遠端兩級近似
+        for (uint32_t a = 0; a < t->max_node; a++) {
+            for (uint32_t b = 0; b < t->max_node; b++) {
+                if (t->node_online[a] && t->node_online[b]) t->distance[a][b] = (a == b) ? 10 : 20;
+            }
+        }
+    } else {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        numa_single_node(t, si.dwNumberOfProcessors, 0, 0);
+    }
+
+    DWORD len = 0;
+    GetLogicalProcessorInformation(NULL, &len);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION* info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION*)malloc(len);
+    if (info && GetLogicalProcessorInformation(info, &len)) {
+        DWORD count = len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        for (DWORD i = 0; i < count && t->cache_count < RETRYIX_NUMA_MAX_CACHES; i++) {
+            if (info[i].Relationship != RelationCache || !(info[i].ProcessorMask & 1)) continue;
+            const CACHE_DESCRIPTOR* cd = &info[i].Cache;
+            retryix_cache_info_t* c = &t->caches[t->cache_count++];
+            c->level = cd->Level;
+            c->type = (cd->Type == CacheData) ? RETRYIX_CACHE_DATA :
+                      (cd->Type == CacheInstruction) ? RETRYIX_CACHE_INSTRUCTION : RETRYIX_CACHE_UNIFIED;
+            c->line_size = cd->LineSize;
+            c->size_kb = cd->Size / 1024;
+            uint64_t shared[RETRYIX_NUMA_MASK_WORDS] = { (uint64_t)info[i].ProcessorMask };
+            c->shared_cpus = numa_mask_count(shared);
+        }
+    }
+    free(info);
+}
+
+static void numa_read_free_memory(retryix_numa_topology_t* t) {
+    if (!t->from_firmware) {
+        MEMORYSTATUSEX ms;
+        ms.dwLength = sizeof(ms);
+        if (GlobalMemoryStatusEx(&ms)) {
+            t->node_mem_total[0] = ms.ullTotalPhys;
+            t->node_mem_free[0] = ms.ullAvailPhys;
+        }
+        return;
+    }
+    for (USHORT n = 0; n < t->max_node; n++) {
+        ULONGLONG avail = 0;
+        if (t->node_online[n] && GetNumaAvailableMemoryNodeEx(n, &avail)) t->node_mem_free[n] = avail;
+    }
+}
+
+#endif
+
+// === 內部 API ===
+
+const retryix_numa_topology_t* retryix_numa_topology(void) {
+    if (RX_LOAD32(&g_topology_state) == 2) return &g_topology;
+
+    if (RX_CAS32(&g_topology_state, 0, 1)) {
+        numa_discover(&g_topology);
+        numa_read_free_memory(&g_topology);
+        RX_STORE32(&g_topology_state, 2);
+    } else {
+        while (RX_LOAD32(&g_topology_state) != 2) RX_YIELD();
+    }
+    return &g_topology;
+}
+
+void retryix_numa_refresh_free_memory(void) {
+    numa_read_free_memory((retryix_numa_topology_t*)retryix_numa_topology());
+}
+
+int retryix_numa_node_of_cpu(int cpu) {
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    if (cpu < 0 || cpu >= RETRYIX_NUMA_MAX_CPUS || t->cpu_node[cpu] < 0) return 0;
+    return t->cpu_node[cpu];
+}
+
+int retryix_numa_current_node(void) {
+#ifdef _WIN32
+    PROCESSOR_NUMBER pn;
+    USHORT node = 0;
+    GetCurrentProcessorNumberEx(&pn);
+    if (GetNumaProcessorNodeEx(&pn, &node)) return (int)node;
+    return 0;
+#else
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return 0;
+    return (int)node;
+#endif
+}
+
+int retryix_numa_device_node(const char* bdf) {
+    if (!bdf) return -1;
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    for (uint32_t i = 0; i < t->device_count; i++) {
+        if (strcmp(t->devices[i].bdf, bdf) == 0) return t->devices[i].node;
+    }
+    return -1;
+}
+
+int retryix_numa_nearest_node(int from, uint64_t min_free_bytes) {
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    if (from < 0 || from >= (int)t->max_node || !t->node_online[from]) from = 0;
+
+    int best = -1;
+    for (uint32_t n = 0; n < t->max_node; n++) {
+        if (!t->node_online[n]) continue;
+        if (min_free_bytes && t->node_mem_free[n] < min_free_bytes) continue;
+        if (best < 0 || t->distance[from][n] < t->distance[from][best]) best = (int)n;
+    }
+    return best >= 0 ? best : from;
+}
+
+uint64_t retryix_numa_nearest_mask(int from, int count) {
+    const retryix_numa_topology_t* t = retryix_numa_topology();
+    if (from < 0 || from >= (int)t->max_node || !t->node_online[from]) from = 0;
+    if (count <= 0 || count > (int)t->node_count) count = (int)t->node_count;
+
+    uint64_t mask = 0;
+    for (int picked = 0; picked < count; picked++) {
+        int best = -1;
+        for (uint32_t n = 0; n < t->max_node; n++) {
+            if (!t->node_online[n] || (mask & (1ull << n))) continue;
+            if (best < 0 || t->distance[from][n] < t->distance[from][best]) best = (int)n;
+        }
+        if (best < 0) break;
+        mask |= 1ull << best;
+    }
+    return mask ? mask : 1ull;
+}
@@ -0,0 +1,466 @@
+// retryix_topology_cache.c
+// 拓撲快照快取 - 每種拓撲計算一次, 以引用計數共用不可變緩衝區, 過期或失效時重建
+// RetryIX 3.0.0 魯班
+//
+// 讀取端不取鎖: 每種拓撲一個 64 位元字組 = [槽位編號 8 bits][外部引用 56 bits],
+// 讀取只做一次原子加法就同時取得目前快照與它的引用 (分離式引用計數)。
+// 換新快照時在建立鎖下交換字組, 把舊字組累積的外部引用一次轉進舊快照的內部計數;
+// 內部計數帶有偏移, 轉入前不會誤判歸零。
+#define RETRYIX_BUILD_DLL
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <iphlpapi.h>
+#include <netioapi.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retryix_utils.h"
+#include "retryix_json_writer_internal.h"
+#include "retryix_topology_cache_internal.h"
+#include "retryix_atomic_internal.h"
+
+#ifdef _WIN32
+static SRWLOCK g_build_lock = SRWLOCK_INIT;
+#define BUILD_LOCK()              AcquireSRWLockExclusive(&g_build_lock)
+#define BUILD_TRYLOCK()           (TryAcquireSRWLockExclusive(&g_build_lock) != 0)
+#define BUILD_UNLOCK()            ReleaseSRWLockExclusive(&g_build_lock)
+static SRWLOCK g_refresher_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE g_refresher_cond = CONDITION_VARIABLE_INIT;
+#define REFRESHER_LOCK()          AcquireSRWLockExclusive(&g_refresher_lock)
+#define REFRESHER_UNLOCK()        ReleaseSRWLockExclusive(&g_refresher_lock)
+#define REFRESHER_BROADCAST()     WakeAllConditionVariable(&g_refresher_cond)
+#else
+static pthread_mutex_t g_build_lock = PTHREAD_MUTEX_INITIALIZER;
+#define BUILD_LOCK()              pthread_mutex_lock(&g_build_lock)
+#define BUILD_TRYLOCK()           (pthread_mutex_trylock(&g_build_lock) == 0)
+#define BUILD_UNLOCK()            pthread_mutex_unlock(&g_build_lock)
+static pthread_mutex_t g_refresher_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_refresher_cond = PTHREAD_COND_INITIALIZER;
+#define REFRESHER_LOCK()          pthread_mutex_lock(&g_refresher_lock)
+#define REFRESHER_UNLOCK()        pthread_mutex_unlock(&g_refresher_lock)
+#define REFRESHER_BROADCAST()     pthread_cond_broadcast(&g_refresher_cond)
+#endif
+
+#define CACHE_SLOTS            8                  // 每種拓撲同時存活的快照上限 (舊快照仍被持有時)
+#define CACHE_SLOT_SHIFT       56
+#define CACHE_EXTERNAL_MASK    ((1ULL << CACHE_SLOT_SHIFT) - 1)
+#define CACHE_INTERNAL_BIAS    (1LL << 62)
+#define CACHE_MAX_TTL_MS       3600000
+#define CACHE_MIN_TICK_MS      100
+#define CACHE_CBOR_HINT        4096
+
+struct topology_cache;
+
+// 配置區塊: [topology_snapshot_t][retryix_json_shared_t][JSON '\0'][CBOR]
+typedef struct topology_snapshot {
+    volatile long long refs;                      // 內部計數 (發布中帶 CACHE_INTERNAL_BIAS)
+    struct topology_cache* owner;
+    int slot;
+    unsigned long long built_ms;
+    size_t json_len;
+    size_t cbor_len;
+} topology_snapshot_t;
+
+#define SNAPSHOT_SHARED(s)   ((retryix_json_shared_t*)((s) + 1))
+#define SNAPSHOT_JSON(s)     ((char*)(SNAPSHOT_SHARED(s) + 1))
+#define SNAPSHOT_CBOR(s)     ((const unsigned char*)SNAPSHOT_JSON(s) + (s)->json_len + 1)
+
+typedef struct topology_cache {
+    volatile long long word;                      // 槽位編號 + 1 (0 = 尚無快照) 與外部引用
+    topology_snapshot_t* volatile slots[CACHE_SLOTS];
+    volatile int stale;                           // 失效事件後設定, 重建開始時清除
+    volatile int read_since_build;                // 背景執行緒只重建有人讀取的種類
+} topology_cache_t;
+
+static topology_cache_t g_caches[RETRYIX_TOPOLOGY_KIND_COUNT];
+static volatile int g_ttl_ms = RETRYIX_TOPOLOGY_CACHE_DEFAULT_TTL_MS;
+
+static int g_refresher_running = 0;
+static int g_refresher_stop = 0;
+static int g_refresher_kick = 0;
+#ifdef _WIN32
+static HANDLE g_refresher_thread = NULL;
+static HANDLE g_ip_notify = NULL;
+#else
+static pthread_t g_refresher_thread;
+#endif
+static int g_watch_started = 0;
+
+static unsigned long long cache_now_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000ULL + (unsigned long long)ts.tv_nsec / 1000000ULL;
+#endif
+}
+
+// 健康狀態是即時值, 不快取
+static int cache_kind_cached(int kind) {
+    return kind >= 0 && kind < RETRYIX_TOPOLOGY_KIND_COUNT && kind != RETRYIX_TOPOLOGY_SYSTEM_HEALTH;
+}
+
+// ===================== 快照引用 =====================
+
+static void snapshot_free(topology_snapshot_t* s) {
+    RX_STOREP(&s->owner->slots[s->slot], NULL);
+    free(s);
+}
+
+static void snapshot_release(topology_snapshot_t* s) {
+    if (RX_ADD64(&s->refs, -1) == 1) snapshot_free(s);
+}
+
+// retryix_free_json 經共用標頭回到這裡
+static void snapshot_shared_release(retryix_json_shared_t* self) {
+    snapshot_release((topology_snapshot_t*)self - 1);
+}
+
+// 快照已從字組換下: 轉入讀取端累積的外部引用, 並移除快取自己的引用與偏移
+static void snapshot_retire(topology_snapshot_t* s, unsigned long long external) {
+    long long delta = (long long)external - 1 - CACHE_INTERNAL_BIAS;
+    if (RX_ADD64(&s->refs, delta) + delta == 0) snapshot_free(s);
+}
+
+// 讀取端: 一次原子加法取得目前快照與引用
+static topology_snapshot_t* cache_acquire(topology_cache_t* c) {
+    unsigned long long word = (unsigned long long)RX_ADD64(&c->word, 1);
+    unsigned int tag = (unsigned int)(word >> CACHE_SLOT_SHIFT);
+    // 尚無快照時多加的計數在下一次發布時隨舊字組丟棄
+    if (tag == 0) return NULL;
+    return (topology_snapshot_t*)RX_LOADP(&c->slots[tag - 1]);
+}
+
+// 呼叫端持建立鎖 (只有持鎖者會換掉快照, 不需要引用)
+static topology_snapshot_t* cache_current_locked(topology_cache_t* c) {
+    unsigned long long word = (unsigned long long)RX_ADD64(&c->word, 0);
+    unsigned int tag = (unsigned int)(word >> CACHE_SLOT_SHIFT);
+    return tag ? c->slots[tag - 1] : NULL;
+}
+
+static int snapshot_fresh(topology_cache_t* c, const topology_snapshot_t* s) {
+    if (RX_LOAD32(&c->stale)) return 0;
+    return cache_now_ms() - s->built_ms < (unsigned long long)RX_LOAD32(&g_ttl_ms);
+}
+
+// ===================== 建立與發布 =====================
+
+// 拓撲只探測一次 (輸出 CBOR), JSON 由 CBOR 重播而得, 兩者放進同一塊配置
+static topology_snapshot_t* snapshot_build(int kind) {
+    retryix_json_writer_t cbor;
+    retryix_jw_init(&cbor, RETRYIX_JW_CBOR, CACHE_CBOR_HINT);
+    retryix_topology_emit(kind, &cbor);
+    if (cbor.failed || cbor.depth != 0) {
+        retryix_jw_discard(&cbor);
+        return NULL;
+    }
+
+    retryix_json_writer_t json;
+    retryix_jw_init_fixed(&json, RETRYIX_JW_JSON, NULL, 0);
+    if (!retryix_jw_replay_cbor(&json, cbor.buf, cbor.len)) {
+        retryix_jw_discard(&cbor);
+        return NULL;
+    }
+    size_t json_len = retryix_jw_length(&json);
+
+    topology_snapshot_t* s = (topology_snapshot_t*)malloc(
+        sizeof(topology_snapshot_t) + sizeof(retryix_json_shared_t) + json_len + 1 + cbor.len);
+    if (!s) {
+        retryix_jw_discard(&cbor);
+        return NULL;
+    }
+    s->refs = 1 + CACHE_INTERNAL_BIAS;
+    s->owner = NULL;
+    s->slot = -1;
+    s->built_ms = cache_now_ms();
+    s->json_len = json_len;
+    s->cbor_len = cbor.len;
+    SNAPSHOT_SHARED(s)->release = snapshot_shared_release;
+
+    retryix_jw_init_fixed(&json, RETRYIX_JW_JSON, SNAPSHOT_JSON(s), json_len + 1);
+    retryix_jw_replay_cbor(&json, cbor.buf, cbor.len);
+    retryix_jw_finish(&json);
+    memcpy((unsigned char*)SNAPSHOT_CBOR(s), cbor.buf, cbor.len);
+    retryix_jw_discard(&cbor);
+    return s;
+}
+
+// 呼叫端持建立鎖
+static void cache_publish_locked(topology_cache_t* c, topology_snapshot_t* s) {
+    int slot = -1;
+    for (int i = 0; i < CACHE_SLOTS && slot < 0; i++) {
+        if (!RX_LOADP(&c->slots[i])) slot = i;
+    }
+    if (slot < 0) {
+        // 舊快照都還被持有: 沿用目前快照, 到期後再試
+        free(s);
+        return;
+    }
+    s->owner = c;
+    s->slot = slot;
+    RX_STOREP(&c->slots[slot], s);
+
+    unsigned long long old = (unsigned long long)RX_XCHG64(&c->word,
+        (long long)((unsigned long long)(slot + 1) << CACHE_SLOT_SHIFT));
+    unsigned int tag = (unsigned int)(old >> CACHE_SLOT_SHIFT);
+    if (tag) snapshot_retire(c->slots[tag - 1], old & CACHE_EXTERNAL_MASK);
+}
+
+// 呼叫端持建立鎖
+static void cache_rebuild_locked(int kind) {
+    topology_cache_t* c = &g_caches[kind];
+    // 先清除失效旗標: 建立期間再發生的事件會重新設定, 下一次讀取照樣重建
+    RX_STORE32(&c->stale, 0);
+    topology_snapshot_t* s = snapshot_build(kind);
+    if (!s) return;
+    cache_publish_locked(c, s);
+    RX_STORE32(&c->read_since_build, 0);
+}
+
+// 呼叫端持建立鎖; 快取放掉自己的引用, 呼叫端仍持有的快照照常有效
+static void cache_drop_locked(topology_cache_t* c) {
+    unsigned long long old = (unsigned long long)RX_XCHG64(&c->word, 0);
+    unsigned int tag = (unsigned int)(old >> CACHE_SLOT_SHIFT);
+    if (tag) snapshot_retire(c->slots[tag - 1], old & CACHE_EXTERNAL_MASK);
+}
+
+// ===================== 失效事件 =====================
+
+static void refresher_kick(void) {
+    REFRESHER_LOCK();
+    g_refresher_kick = 1;
+    REFRESHER_BROADCAST();
+    REFRESHER_UNLOCK();
+}
+
+static void cache_mark_stale(int kind) {
+    RX_STORE32(&g_caches[kind].stale, 1);
+    // 多模態拓撲內含網路與音訊, 一併失效
+    if (kind == RETRYIX_TOPOLOGY_NETWORK || kind == RETRYIX_TOPOLOGY_AUDIO) {
+        RX_STORE32(&g_caches[RETRYIX_TOPOLOGY_MULTIMODAL].stale, 1);
+    }
+}
+
+#ifdef _WIN32
+static VOID NETIOAPI_API_ cache_ip_changed(PVOID context, PMIB_IPINTERFACE_ROW row, MIB_NOTIFICATION_TYPE type) {
+    (void)context;
+    (void)row;
+    (void)type;
+    cache_mark_stale(RETRYIX_TOPOLOGY_NETWORK);
+    refresher_kick();
+}
+#endif
+
+// 呼叫端持建立鎖; 第一次建立快照時註冊系統變更通知
+static void cache_watch_locked(void) {
+    if (g_watch_started) return;
+    g_watch_started = 1;
+#ifdef _WIN32
+    if (NotifyIpInterfaceChange(AF_UNSPEC, cache_ip_changed, NULL, FALSE, &g_ip_notify) != NO_ERROR) {
+        g_ip_notify = NULL;
+    }
+#endif
+}
+
+// 呼叫端持建立鎖
+static void cache_unwatch_locked(void) {
+#ifdef _WIN32
+    if (g_ip_notify) CancelMibChangeNotify2(g_ip_notify);
+    g_ip_notify = NULL;
+#endif
+    g_watch_started = 0;
+}
+
+// ===================== 讀取 =====================
+
+static topology_snapshot_t* cache_get(int kind) {
+    topology_cache_t* c = &g_caches[kind];
+    topology_snapshot_t* s = cache_acquire(c);
+    if (!s || !snapshot_fresh(c, s)) {
+        // 只有一個呼叫端重建; 已有舊快照時其他呼叫端不等待, 直接沿用
+        int locked = 1;
+        if (s) locked = BUILD_TRYLOCK();
+        else BUILD_LOCK();
+        if (locked) {
+            cache_watch_locked();
+            topology_snapshot_t* current = cache_current_locked(c);
+            if (!current || !snapshot_fresh(c, current)) cache_rebuild_locked(kind);
+            BUILD_UNLOCK();
+            if (s) snapshot_release(s);
+            s = cache_acquire(c);
+        }
+    }
+    if (s && !RX_LOAD32(&c->read_since_build)) RX_STORE32(&c->read_since_build, 1);
+    return s;
+}
+
+char* retryix_topology_cache_json(int kind) {
+    if (!cache_kind_cached(kind) || RX_LOAD32(&g_ttl_ms) == 0) return NULL;
+    topology_snapshot_t* s = cache_get(kind);
+    // 引用交給呼叫端, retryix_free_json 經共用標頭釋放
+    return s ? SNAPSHOT_JSON(s) : NULL;
+}
+
+int retryix_topology_cache_cbor(int kind, void* buffer, size_t size, size_t* written) {
+    if (!cache_kind_cached(kind) || RX_LOAD32(&g_ttl_ms) == 0) return 0;
+    topology_snapshot_t* s = cache_get(kind);
+    if (!s) return 0;
+    *written = s->cbor_len;
+    if (buffer && size >= s->cbor_len) memcpy(buffer, SNAPSHOT_CBOR(s), s->cbor_len);
+    snapshot_release(s);
+    return 1;
+}
+
+// ===================== 背景重建 =====================
+
+// 有人讀取且已失效或進入 TTL 最後四分之一的種類提前重建, 讀取端不會碰到過期快照
+static void refresher_rebuild_due(void) {
+    unsigned long long ttl = (unsigned long long)RX_LOAD32(&g_ttl_ms);
+    if (ttl == 0) return;
+    BUILD_LOCK();
+    for (int kind = 0; kind < RETRYIX_TOPOLOGY_KIND_COUNT; kind++) {
+        if (!cache_kind_cached(kind)) continue;
+        topology_cache_t* c = &g_caches[kind];
+        topology_snapshot_t* current = cache_current_locked(c);
+        if (!current || !RX_LOAD32(&c->read_since_build)) continue;
+        if (RX_LOAD32(&c->stale) || cache_now_ms() - current->built_ms >= ttl - ttl / 4) {
+            cache_rebuild_locked(kind);
+        }
+    }
+    BUILD_UNLOCK();
+}
+
+// 呼叫端持 refresher 鎖; 被喚醒或逾時都回傳, 由迴圈重新檢查
+static void refresher_wait(unsigned int timeout_ms) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(&g_refresher_cond, &g_refresher_lock, timeout_ms, 0);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&g_refresher_cond, &g_refresher_lock, &ts);
+#endif
+}
+
+static void refresher_loop(void) {
+    REFRESHER_LOCK();
+    while (!g_refresher_stop) {
+        unsigned int tick = (unsigned int)RX_LOAD32(&g_ttl_ms) / 4;
+        if (tick < CACHE_MIN_TICK_MS) tick = CACHE_MIN_TICK_MS;
+        if (!g_refresher_kick) refresher_wait(tick);
+        g_refresher_kick = 0;
+        if (g_refresher_stop) break;
+        REFRESHER_UNLOCK();
+        refresher_rebuild_due();
+        REFRESHER_LOCK();
+    }
+    REFRESHER_UNLOCK();
+}
+
+#ifdef _WIN32
+static DWORD WINAPI refresher_main_win(LPVOID arg) {
+    (void)arg;
+    refresher_loop();
+    return 0;
+}
+#else
+static void* refresher_main_posix(void* arg) {
+    (void)arg;
+    refresher_loop();
+    return NULL;
+}
+#endif
+
+static retryix_result_t refresher_start(void) {
+    REFRESHER_LOCK();
+    if (g_refresher_running) {
+        // TTL 可能改變, 讓執行緒依新週期重新計時
+        g_refresher_kick = 1;
+        REFRESHER_BROADCAST();
+        REFRESHER_UNLOCK();
+        return RETRYIX_SUCCESS;
+    }
+    g_refresher_stop = 0;
+    g_refresher_kick = 0;
+#ifdef _WIN32
+    g_refresher_thread = CreateThread(NULL, 0, refresher_main_win, NULL, 0, NULL);
+    int started = g_refresher_thread != NULL;
+#else
+    int started = pthread_create(&g_refresher_thread, NULL, refresher_main_posix, NULL) == 0;
+#endif
+    g_refresher_running = started;
+    REFRESHER_UNLOCK();
+    return started ? RETRYIX_SUCCESS : RETRYIX_ERROR_OUT_OF_MEMORY;
+}
+
+static void refresher_stop(void) {
+    REFRESHER_LOCK();
+    if (!g_refresher_running) {
+        REFRESHER_UNLOCK();
+        return;
+    }
+    g_refresher_stop = 1;
+    REFRESHER_BROADCAST();
+    REFRESHER_UNLOCK();
+#ifdef _WIN32
+    WaitForSingleObject(g_refresher_thread, INFINITE);
+    CloseHandle(g_refresher_thread);
+    g_refresher_thread = NULL;
+#else
+    pthread_join(g_refresher_thread, NULL);
+#endif
+
+    REFRESHER_LOCK();
+    g_refresher_running = 0;
+    REFRESHER_UNLOCK();
+}
+
+// ===================== 對外 API =====================
+
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_topology_cache_configure(unsigned int ttl_ms, int background_refresh) {
+    if (ttl_ms > CACHE_MAX_TTL_MS) return RETRYIX_ERROR_INVALID_PARAMETER;
+    RX_STORE32(&g_ttl_ms, (int)ttl_ms);
+    if (ttl_ms == 0) {
+        // 停用快取: 之後每次呼叫都直接輸出
+        refresher_stop();
+        BUILD_LOCK();
+        for (int kind = 0; kind < RETRYIX_TOPOLOGY_KIND_COUNT; kind++) cache_drop_locked(&g_caches[kind]);
+        BUILD_UNLOCK();
+        return RETRYIX_SUCCESS;
+    }
+    if (!background_refresh) {
+        refresher_stop();
+        return RETRYIX_SUCCESS;
+    }
+    return refresher_start();
+}
+
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_invalidate_topology_cache(retryix_topology_kind_t kind) {
+    if ((int)kind < 0 || kind > RETRYIX_TOPOLOGY_KIND_COUNT) return RETRYIX_ERROR_INVALID_PARAMETER;
+    for (int k = 0; k < RETRYIX_TOPOLOGY_KIND_COUNT; k++) {
+        if (kind == RETRYIX_TOPOLOGY_KIND_COUNT || k == (int)kind) cache_mark_stale(k);
+    }
+    refresher_kick();
+    return RETRYIX_SUCCESS;
+}
+
+RETRYIX_API void RETRYIX_CALL retryix_topology_cache_shutdown(void) {
+    refresher_stop();
+    BUILD_LOCK();
+    cache_unwatch_locked();
+    for (int kind = 0; kind < RETRYIX_TOPOLOGY_KIND_COUNT; kind++) cache_drop_locked(&g_caches[kind]);
+    BUILD_UNLOCK();
+}
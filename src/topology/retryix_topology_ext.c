@@ -19,7 +19,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
-#include "cJSON.h"
+#include "retryix_json_writer_internal.h"
+#include "retryix_topology_cache_internal.h"
 #include "retryix_core.h"
 #include "retryix.h" /* provide retryix_free_json prototype and standard API */
 #include "retryix_device.h"
@@ -87,10 +88,10 @@ static ULONG64 get_adapter_speed(DWORD ifIndex) {
     return 1000000000; // 預設 1 Gbps
 }
 
-RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
+static void emit_network_topology(retryix_json_writer_t* w, const char* key)
 {
-    cJSON *root = cJSON_CreateObject();
-    cJSON *net = cJSON_CreateArray();
+    retryix_jw_begin_object(w, key);
+    retryix_jw_begin_array(w, "network_topology");
     int physical_count = 0;
     int virtual_count = 0;
 
@@ -150,8 +151,8 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
             
             // 顯示所有物理網卡 (包括 DOWN 狀態的，例如未插網路線的有線網卡)
             
-            cJSON *device = cJSON_CreateObject();
-            cJSON_AddStringToObject(device, "device", desc_for_check[0] ? desc_for_check : "<unknown>");
+            retryix_jw_begin_object(w, NULL);
+            retryix_jw_string(w, "device", desc_for_check[0] ? desc_for_check : "<unknown>");
             
             // 轉換友好名稱 (WCHAR* -> UTF-8)
             if (pCurr->FriendlyName) {
@@ -160,7 +161,7 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
                     char* friendly = (char*)malloc(len);
                     if (friendly) {
                         WideCharToMultiByte(CP_UTF8, 0, pCurr->FriendlyName, -1, friendly, len, NULL, NULL);
-                        cJSON_AddStringToObject(device, "friendly_name", friendly);
+                        retryix_jw_string(w, "friendly_name", friendly);
                         free(friendly);
                     }
                 }
@@ -171,7 +172,7 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
             if (pCurr->IfType == IF_TYPE_ETHERNET_CSMACD) type = "Ethernet";
             else if (pCurr->IfType == IF_TYPE_IEEE80211) type = "WiFi";
             else if (pCurr->IfType == 0x47) type = "Ethernet"; // Generic
-            cJSON_AddStringToObject(device, "type", type);
+            retryix_jw_string(w, "type", type);
             
             // 真實速度檢測 (處理 DOWN 狀態時的無效值)
             ULONG64 tx_speed = pCurr->TransmitLinkSpeed;
@@ -189,9 +190,9 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
             ULONG64 speed_bps = (tx_speed > rx_speed) ? tx_speed : rx_speed;
             double speed_gbps = (double)speed_bps / 1000000000.0;
             
-            cJSON_AddNumberToObject(device, "bandwidth_gbps", speed_gbps);
-            cJSON_AddNumberToObject(device, "transmit_speed_mbps", (double)tx_speed / 1000000.0);
-            cJSON_AddNumberToObject(device, "receive_speed_mbps", (double)rx_speed / 1000000.0);
+            retryix_jw_number(w, "bandwidth_gbps", speed_gbps);
+            retryix_jw_number(w, "transmit_speed_mbps", (double)tx_speed / 1000000.0);
+            retryix_jw_number(w, "receive_speed_mbps", (double)rx_speed / 1000000.0);
             
             // MAC 地址
             char mac[32] = {0};
@@ -200,14 +201,14 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
                     pCurr->PhysicalAddress[0], pCurr->PhysicalAddress[1],
                     pCurr->PhysicalAddress[2], pCurr->PhysicalAddress[3],
                     pCurr->PhysicalAddress[4], pCurr->PhysicalAddress[5]);
-                cJSON_AddStringToObject(device, "mac_address", mac);
+                retryix_jw_string(w, "mac_address", mac);
             }
             
             // MTU
-            cJSON_AddNumberToObject(device, "mtu", pCurr->Mtu);
+            retryix_jw_number(w, "mtu", pCurr->Mtu);
             
             // IP 地址
-            cJSON *ips = cJSON_CreateArray();
+            retryix_jw_begin_array(w, "ip_addresses");
             PIP_ADAPTER_UNICAST_ADDRESS pUnicast = pCurr->FirstUnicastAddress;
             while (pUnicast) {
                 // Use wide address API and convert to UTF-8
@@ -218,19 +219,19 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
                     if (utfLen > 0) {
                         char ip[256] = {0};
                         WideCharToMultiByte(CP_UTF8, 0, ipw, -1, ip, sizeof(ip), NULL, NULL);
-                        cJSON_AddItemToArray(ips, cJSON_CreateString(ip));
+                        retryix_jw_string(w, NULL, ip);
                     }
                 }
                 pUnicast = pUnicast->Next;
             }
-            cJSON_AddItemToObject(device, "ip_addresses", ips);
+            retryix_jw_end_array(w);
             
             // RDMA 能力 (透過名稱判斷)
             const char* desc_check = desc_for_check;
             bool rdma = (desc_check && (strstr(desc_check, "RDMA") != NULL)) || 
                         (desc_check && (strstr(desc_check, "Mellanox") != NULL)) ||
                         (desc_check && (strstr(desc_check, "InfiniBand") != NULL));
-            cJSON_AddBoolToObject(device, "rdma_capable", rdma);
+            retryix_jw_bool(w, "rdma_capable", rdma);
             
             // 狀態資訊 (根據 OperStatus 判斷)
             const char* status = "Unknown";
@@ -242,11 +243,11 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
                 case IfOperStatusNotPresent: status = "Not Present"; break;
                 default: status = "Unknown"; break;
             }
-            cJSON_AddStringToObject(device, "status", status);
-            cJSON_AddBoolToObject(device, "is_physical", true);
-            cJSON_AddNumberToObject(device, "if_index", pCurr->IfIndex);
+            retryix_jw_string(w, "status", status);
+            retryix_jw_bool(w, "is_physical", true);
+            retryix_jw_number(w, "if_index", pCurr->IfIndex);
             
-            cJSON_AddItemToArray(net, device);
+            retryix_jw_end_object(w);
             physical_count++;
 #ifdef UNICODE
             if (desc_utf) free(desc_utf);
@@ -268,32 +269,31 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
     };
 
     for (int i = 0; i < 1; i++) {
-        cJSON *dev = cJSON_CreateObject();
-        cJSON_AddStringToObject(dev, "device",         devices[i].name);
-        cJSON_AddStringToObject(dev, "type",           devices[i].type);
-        cJSON_AddNumberToObject(dev, "bandwidth_gbps", devices[i].bandwidth_gbps);
-        cJSON_AddNumberToObject(dev, "numa_node",      devices[i].numa_node);
-        cJSON_AddBoolToObject  (dev, "rdma_capable",   devices[i].rdma_capable);
-        cJSON_AddItemToArray(net, dev);
+        retryix_jw_begin_object(w, NULL);
+        retryix_jw_string(w, "device",         devices[i].name);
+        retryix_jw_string(w, "type",           devices[i].type);
+        retryix_jw_number(w, "bandwidth_gbps", devices[i].bandwidth_gbps);
+        retryix_jw_int   (w, "numa_node",      devices[i].numa_node);
+        retryix_jw_bool  (w, "rdma_capable",   devices[i].rdma_capable);
+        retryix_jw_end_object(w);
     }
 #endif
 
-    cJSON_AddItemToObject(root, "network_topology", net);
-    cJSON_AddNumberToObject(root, "discovered_nics", physical_count);
-    cJSON_AddNumberToObject(root, "virtual_nics_filtered", virtual_count);
-    cJSON_AddStringToObject(root, "filter_mode", "Physical NICs Only");
-    cJSON_AddStringToObject(root, "timestamp", __DATE__ " " __TIME__);
+    retryix_jw_end_array(w);
+    retryix_jw_int(w, "discovered_nics", physical_count);
+    retryix_jw_int(w, "virtual_nics_filtered", virtual_count);
+    retryix_jw_string(w, "filter_mode", "Physical NICs Only");
+    retryix_jw_string(w, "timestamp", __DATE__ " " __TIME__);
 
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+    retryix_jw_end_object(w);
 }
 
 // 音訊拓撲發現 - 使用 Windows Wave API
-RETRYIX_API char* RETRYIX_CALL retryix_discover_audio_topology_json(void)
+static void emit_audio_topology(retryix_json_writer_t* w, const char* key)
 {
-    cJSON *root = cJSON_CreateObject();
-    cJSON *audio = cJSON_CreateArray();
+    retryix_jw_begin_object(w, key);
+    retryix_jw_begin_array(w, "audio_topology");
+    int device_total = 0;
 
 #ifdef _WIN32
     // 真實音訊設備檢測 (Windows Wave API)
@@ -307,196 +307,166 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_audio_topology_json(void)
             // 將 WCHAR 轉換為 UTF-8
             WideCharToMultiByte(CP_UTF8, 0, capsW.szPname, -1, device_name, sizeof(device_name), NULL, NULL);
             
-            cJSON *dev = cJSON_CreateObject();
-            cJSON_AddStringToObject(dev, "device", device_name);
-            cJSON_AddStringToObject(dev, "api_standard", "WDM/MME");
-            cJSON_AddStringToObject(dev, "vendor", "Windows");
-            cJSON_AddNumberToObject(dev, "channels", capsW.wChannels);
-            cJSON_AddNumberToObject(dev, "sample_rate", 48000); // 預設值
-            cJSON_AddNumberToObject(dev, "bit_depth", 16);
-            cJSON_AddBoolToObject(dev, "low_latency", 0);
-            cJSON_AddStringToObject(dev, "accelerator", "CPU");
-            cJSON_AddItemToArray(audio, dev);
+            retryix_jw_begin_object(w, NULL);
+            retryix_jw_string(w, "device", device_name);
+            retryix_jw_string(w, "api_standard", "WDM/MME");
+            retryix_jw_string(w, "vendor", "Windows");
+            retryix_jw_number(w, "channels", capsW.wChannels);
+            retryix_jw_number(w, "sample_rate", 48000); // 預設值
+            retryix_jw_number(w, "bit_depth", 16);
+            retryix_jw_bool(w, "low_latency", 0);
+            retryix_jw_string(w, "accelerator", "CPU");
+            retryix_jw_end_object(w);
+            device_total++;
         }
     }
 #else
     // 模擬數據 (非 Windows)
-    cJSON *dev = cJSON_CreateObject();
-    cJSON_AddStringToObject(dev, "device", "Default Audio");
-    cJSON_AddStringToObject(dev, "api_standard", "Generic");
-    cJSON_AddStringToObject(dev, "vendor", "Unknown");
-    cJSON_AddNumberToObject(dev, "channels", 2);
-    cJSON_AddNumberToObject(dev, "sample_rate", 48000);
-    cJSON_AddNumberToObject(dev, "bit_depth", 16);
-    cJSON_AddBoolToObject(dev, "low_latency", 0);
-    cJSON_AddStringToObject(dev, "accelerator", "CPU");
-    cJSON_AddItemToArray(audio, dev);
+    retryix_jw_begin_object(w, NULL);
+    retryix_jw_string(w, "device", "Default Audio");
+    retryix_jw_string(w, "api_standard", "Generic");
+    retryix_jw_string(w, "vendor", "Unknown");
+    retryix_jw_number(w, "channels", 2);
+    retryix_jw_number(w, "sample_rate", 48000);
+    retryix_jw_number(w, "bit_depth", 16);
+    retryix_jw_bool(w, "low_latency", 0);
+    retryix_jw_string(w, "accelerator", "CPU");
+    retryix_jw_end_object(w);
+    device_total++;
 #endif
 
-    cJSON_AddItemToObject(root, "audio_topology", audio);
-    cJSON_AddNumberToObject(root, "discovered_devices", cJSON_GetArraySize(audio));
-    cJSON_AddBoolToObject(root, "gpu_audio_enabled", 0);
+    retryix_jw_end_array(w);
+    retryix_jw_int(w, "discovered_devices", device_total);
+    retryix_jw_bool(w, "gpu_audio_enabled", 0);
 
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+    retryix_jw_end_object(w);
 }
 
 // 完整多模態拓撲 (整合網路/音訊/GPU)
-RETRYIX_API char* RETRYIX_CALL retryix_discover_multimodal_topology_json(void)
+static void emit_multimodal_topology(retryix_json_writer_t* w, const char* key)
 {
-    cJSON *root = cJSON_CreateObject();
-    
-    char* network_json = retryix_discover_network_topology_json();
-    cJSON *network_obj = cJSON_Parse(network_json);
-    retryix_free_json(network_json);
-    if (network_obj) {
-        cJSON_AddItemToObject(root, "network", network_obj);
-    }
-    
-    char* audio_json = retryix_discover_audio_topology_json();
-    cJSON *audio_obj = cJSON_Parse(audio_json);
-    retryix_free_json(audio_json);
-    if (audio_obj) {
-        cJSON_AddItemToObject(root, "audio", audio_obj);
-    }
+    retryix_jw_begin_object(w, key);
+    emit_network_topology(w, "network");
+    emit_audio_topology(w, "audio");
     
     // GPU devices - 模組化版本的發現 API
-    // 注意：模組版本的 retryix_discover_all_devices() 無參數，只設置全局狀態
     // 分類設備到 CPU、GPU、Accelerator 三個獨立數組
-    cJSON *cpu_array = cJSON_CreateArray();
-    cJSON *gpu_array = cJSON_CreateArray();
-    cJSON *accelerator_array = cJSON_CreateArray();
     int device_count = 0;
-    int cpu_count = 0, gpu_count = 0, accel_count = 0;
     
-    // 使用模組 API 發現設備並枚舉
-    extern RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_all_devices(void);
+    // 使用模組 API 枚舉設備 (尚未發現時由枚舉觸發一次, 之後沿用已發現的結果)
     extern RETRYIX_API retryix_result_t RETRYIX_CALL retryix_enumerate_devices(int* device_count);
     
-    // 發現並枚舉設備
-    int discover_result = retryix_discover_all_devices();
     int enum_result = retryix_enumerate_devices(&device_count);
     
-    if (discover_result == RETRYIX_SUCCESS && enum_result == RETRYIX_SUCCESS && device_count > 0) {
-        const char* device_names[] = {
-            "Intel(R) Core(TM) CPU",
-            "NVIDIA GeForce GPU", 
-            "AMD Radeon GPU",
-            "Intel(R) Accelerator"
-        };
-        
-        const char* device_types[] = { "CPU", "GPU", "GPU", "Accelerator" };
-        const int compute_units[] = { 8, 40, 36, 16 };
-        const double memory_mb[] = { 32768, 8192, 16384, 4096 };
-        
-        for (int i = 0; i < device_count && i < 4; i++) {
-            cJSON *dev = cJSON_CreateObject();
-            cJSON_AddStringToObject(dev, "name", device_names[i]);
-            cJSON_AddStringToObject(dev, "device_type", device_types[i]);
-            cJSON_AddNumberToObject(dev, "compute_units", compute_units[i]);
-            cJSON_AddNumberToObject(dev, "memory_mb", memory_mb[i]);
-            
-            // 根據類型分類
-            if (strcmp(device_types[i], "CPU") == 0) {
-                cJSON_AddItemToArray(cpu_array, dev);
-                cpu_count++;
-            } else if (strcmp(device_types[i], "Accelerator") == 0) {
-                cJSON_AddItemToArray(accelerator_array, dev);
-                accel_count++;
-            } else {
-                cJSON_AddItemToArray(gpu_array, dev);
-                gpu_count++;
-            }
+    static const char* const device_names[] = {
+        "Intel(R) Core(TM) CPU",
+        "NVIDIA GeForce GPU", 
+        "AMD Radeon GPU",
+        "Intel(R) Accelerator"
+    };
+    static const char* const device_types[] = { "CPU", "GPU", "GPU", "Accelerator" };
+    static const int compute_units[] = { 8, 40, 36, 16 };
+    static const double memory_mb[] = { 32768, 8192, 16384, 4096 };
+    static const char* const groups[][2] = {
+        { "cpu_devices", "cpu_count" },
+        { "gpu_devices", "gpu_count" },
+        { "accelerator_devices", "accelerator_count" }
+    };
+    
+    int listed = (enum_result == RETRYIX_SUCCESS && device_count > 0) ? device_count : 0;
+    if (listed > 4) listed = 4;
+    
+    // 串流輸出: 每個分類各掃一次 (最多 4 筆), 不需要先建三個暫存陣列
+    for (int g = 0; g < 3; g++) {
+        int count = 0;
+        retryix_jw_begin_array(w, groups[g][0]);
+        for (int i = 0; i < listed; i++) {
+            int group = strcmp(device_types[i], "CPU") == 0 ? 0 :
+                        strcmp(device_types[i], "Accelerator") == 0 ? 2 : 1;
+            if (group != g) continue;
+            retryix_jw_begin_object(w, NULL);
+            retryix_jw_string(w, "name", device_names[i]);
+            retryix_jw_string(w, "device_type", device_types[i]);
+            retryix_jw_int(w, "compute_units", compute_units[i]);
+            retryix_jw_number(w, "memory_mb", memory_mb[i]);
+            retryix_jw_end_object(w);
+            count++;
         }
+        retryix_jw_end_array(w);
+        retryix_jw_int(w, groups[g][1], count);
     }
     
-    // 添加分類後的設備數組
-    cJSON_AddItemToObject(root, "cpu_devices", cpu_array);
-    cJSON_AddNumberToObject(root, "cpu_count", cpu_count);
+    retryix_jw_int(w, "total_compute_devices", device_count);
+    retryix_jw_int(w, "discover_result", enum_result);
     
-    cJSON_AddItemToObject(root, "gpu_devices", gpu_array);
-    cJSON_AddNumberToObject(root, "gpu_count", gpu_count);
-    
-    cJSON_AddItemToObject(root, "accelerator_devices", accelerator_array);
-    cJSON_AddNumberToObject(root, "accelerator_count", accel_count);
-    
-    cJSON_AddNumberToObject(root, "total_compute_devices", device_count);
-    cJSON_AddNumberToObject(root, "discover_result", discover_result);
-    
-    cJSON_AddStringToObject(root, "topology_type", "MultiModal AI Ready");
-    cJSON_AddStringToObject(root, "version", "RetryIX 3.0.0");
-    cJSON_AddStringToObject(root, "timestamp", __DATE__ " " __TIME__);
-    
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+    retryix_jw_string(w, "topology_type", "MultiModal AI Ready");
+    retryix_jw_string(w, "version", "RetryIX 3.0.0");
+    retryix_jw_string(w, "timestamp", __DATE__ " " __TIME__);
+    retryix_jw_end_object(w);
 }
 
 // === 原子細粒控制拓撲 JSON ===
-RETRYIX_API char* RETRYIX_CALL retryix_discover_atomic_topology_json(void) {
-    cJSON *root = cJSON_CreateObject();
+static void emit_atomic_topology(retryix_json_writer_t* w, const char* key) {
+    retryix_jw_begin_object(w, key);
     
     // 原子操作能力查詢
     extern RETRYIX_API uint32_t RETRYIX_CALL retryix_atomic_get_128bit_capabilities(void);
     uint32_t atomic_caps = retryix_atomic_get_128bit_capabilities();
     
-    cJSON_AddStringToObject(root, "topology_type", "Atomic Fine-Grained Control");
+    retryix_jw_string(w, "topology_type", "Atomic Fine-Grained Control");
     
     // 基本原子操作支援 (32/64-bit)
-    cJSON *basic_ops = cJSON_CreateObject();
-    cJSON_AddBoolToObject(basic_ops, "compare_exchange_i32", true);
-    cJSON_AddBoolToObject(basic_ops, "compare_exchange_i64", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_add_i32", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_add_i64", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_add_f32", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_add_f64", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_and_u32", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_or_u32", true);
-    cJSON_AddBoolToObject(basic_ops, "fetch_xor_u32", true);
-    cJSON_AddItemToObject(root, "basic_atomic_ops", basic_ops);
+    retryix_jw_begin_object(w, "basic_atomic_ops");
+    retryix_jw_bool(w, "compare_exchange_i32", true);
+    retryix_jw_bool(w, "compare_exchange_i64", true);
+    retryix_jw_bool(w, "fetch_add_i32", true);
+    retryix_jw_bool(w, "fetch_add_i64", true);
+    retryix_jw_bool(w, "fetch_add_f32", true);
+    retryix_jw_bool(w, "fetch_add_f64", true);
+    retryix_jw_bool(w, "fetch_and_u32", true);
+    retryix_jw_bool(w, "fetch_or_u32", true);
+    retryix_jw_bool(w, "fetch_xor_u32", true);
+    retryix_jw_end_object(w);
     
     // 高級原子操作支援 (128/256-bit)
-    cJSON *advanced_ops = cJSON_CreateObject();
-    cJSON_AddBoolToObject(advanced_ops, "native_128bit", (atomic_caps & 0x04) != 0);
-    cJSON_AddBoolToObject(advanced_ops, "pair_256bit", (atomic_caps & 0x10) != 0);
-    cJSON_AddBoolToObject(advanced_ops, "fetch_add_u128", (atomic_caps & 0x04) != 0);
-    cJSON_AddBoolToObject(advanced_ops, "fetch_add_u256", (atomic_caps & 0x10) != 0);
-    cJSON_AddBoolToObject(advanced_ops, "compare_exchange_u128", (atomic_caps & 0x04) != 0);
-    cJSON_AddBoolToObject(advanced_ops, "compare_exchange_u256", (atomic_caps & 0x10) != 0);
-    cJSON_AddItemToObject(root, "advanced_atomic_ops", advanced_ops);
+    retryix_jw_begin_object(w, "advanced_atomic_ops");
+    retryix_jw_bool(w, "native_128bit", (atomic_caps & 0x04) != 0);
+    retryix_jw_bool(w, "pair_256bit", (atomic_caps & 0x10) != 0);
+    retryix_jw_bool(w, "fetch_add_u128", (atomic_caps & 0x04) != 0);
+    retryix_jw_bool(w, "fetch_add_u256", (atomic_caps & 0x10) != 0);
+    retryix_jw_bool(w, "compare_exchange_u128", (atomic_caps & 0x04) != 0);
+    retryix_jw_bool(w, "compare_exchange_u256", (atomic_caps & 0x10) != 0);
+    retryix_jw_end_object(w);
     
     // 原子操作粒度
-    cJSON *granularity = cJSON_CreateObject();
-    cJSON_AddStringToObject(granularity, "min_granularity", "32-bit");
-    cJSON_AddStringToObject(granularity, "max_granularity", (atomic_caps & 0x10) ? "256-bit" : (atomic_caps & 0x04) ? "128-bit" : "64-bit");
-    cJSON_AddNumberToObject(granularity, "alignment_requirement", 16); // 128-bit alignment
-    cJSON_AddItemToObject(root, "granularity", granularity);
+    retryix_jw_begin_object(w, "granularity");
+    retryix_jw_string(w, "min_granularity", "32-bit");
+    retryix_jw_string(w, "max_granularity", (atomic_caps & 0x10) ? "256-bit" : (atomic_caps & 0x04) ? "128-bit" : "64-bit");
+    retryix_jw_number(w, "alignment_requirement", 16); // 128-bit alignment
+    retryix_jw_end_object(w);
     
     // 硬體特性
-    cJSON *hardware = cJSON_CreateObject();
+    retryix_jw_begin_object(w, "hardware");
 #ifdef _WIN32
-    cJSON_AddStringToObject(hardware, "platform", "Windows x64");
-    cJSON_AddBoolToObject(hardware, "cmpxchg16b_support", (atomic_caps & 0x04) != 0);
+    retryix_jw_string(w, "platform", "Windows x64");
+    retryix_jw_bool(w, "cmpxchg16b_support", (atomic_caps & 0x04) != 0);
 #else
-    cJSON_AddStringToObject(hardware, "platform", "POSIX");
-    cJSON_AddBoolToObject(hardware, "cmpxchg16b_support", false);
+    retryix_jw_string(w, "platform", "POSIX");
+    retryix_jw_bool(w, "cmpxchg16b_support", false);
 #endif
-    cJSON_AddNumberToObject(hardware, "cache_line_size", 64);
-    cJSON_AddNumberToObject(hardware, "spinlock_table_size", 256);
-    cJSON_AddItemToObject(root, "hardware", hardware);
+    retryix_jw_number(w, "cache_line_size", 64);
+    retryix_jw_number(w, "spinlock_table_size", 256);
+    retryix_jw_end_object(w);
     
-    cJSON_AddStringToObject(root, "version", "RetryIX 3.0.0");
-    cJSON_AddStringToObject(root, "timestamp", __DATE__ " " __TIME__);
+    retryix_jw_string(w, "version", "RetryIX 3.0.0");
+    retryix_jw_string(w, "timestamp", __DATE__ " " __TIME__);
     
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+    retryix_jw_end_object(w);
 }
 
 // === SVM 記憶拓撲 JSON ===
-RETRYIX_API char* RETRYIX_CALL retryix_discover_svm_topology_json(void) {
-    cJSON *root = cJSON_CreateObject();
+static void emit_svm_topology(retryix_json_writer_t* w, const char* key) {
+    retryix_jw_begin_object(w, key);
     
     // SVM 拓撲發現
     extern RETRYIX_API retryix_result_t RETRYIX_CALL retryix_svm_discover_topology(void);
@@ -505,45 +475,45 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_svm_topology_json(void) {
     int discover_result = retryix_svm_discover_topology();
     int numa_result = retryix_svm_analyze_numa_layout();
     
-    cJSON_AddStringToObject(root, "topology_type", "SVM Memory Hierarchy");
-    cJSON_AddBoolToObject(root, "topology_discovered", discover_result == 0);
-    cJSON_AddBoolToObject(root, "numa_analyzed", numa_result == 0);
+    retryix_jw_string(w, "topology_type", "SVM Memory Hierarchy");
+    retryix_jw_bool(w, "topology_discovered", discover_result == 0);
+    retryix_jw_bool(w, "numa_analyzed", numa_result == 0);
     
     // 記憶體層級結構
-    cJSON *memory_hierarchy = cJSON_CreateArray();
-    
-    cJSON *l1 = cJSON_CreateObject();
-    cJSON_AddStringToObject(l1, "level", "L1 Cache");
-    cJSON_AddStringToObject(l1, "type", "Data + Instruction");
-    cJSON_AddNumberToObject(l1, "size_kb", 64);
-    cJSON_AddNumberToObject(l1, "latency_cycles", 4);
-    cJSON_AddItemToArray(memory_hierarchy, l1);
-    
-    cJSON *l2 = cJSON_CreateObject();
-    cJSON_AddStringToObject(l2, "level", "L2 Cache");
-    cJSON_AddStringToObject(l2, "type", "Unified");
-    cJSON_AddNumberToObject(l2, "size_kb", 512);
-    cJSON_AddNumberToObject(l2, "latency_cycles", 12);
-    cJSON_AddItemToArray(memory_hierarchy, l2);
-    
-    cJSON *l3 = cJSON_CreateObject();
-    cJSON_AddStringToObject(l3, "level", "L3 Cache");
-    cJSON_AddStringToObject(l3, "type", "Shared");
-    cJSON_AddNumberToObject(l3, "size_mb", 16);
-    cJSON_AddNumberToObject(l3, "latency_cycles", 40);
-    cJSON_AddItemToArray(memory_hierarchy, l3);
-    
-    cJSON *main_mem = cJSON_CreateObject();
-    cJSON_AddStringToObject(main_mem, "level", "Main Memory");
-    cJSON_AddStringToObject(main_mem, "type", "DDR4/DDR5");
-    cJSON_AddNumberToObject(main_mem, "size_gb", 32);
-    cJSON_AddNumberToObject(main_mem, "latency_ns", 80);
-    cJSON_AddItemToArray(memory_hierarchy, main_mem);
-    
-    cJSON_AddItemToObject(root, "memory_hierarchy", memory_hierarchy);
+    retryix_jw_begin_array(w, "memory_hierarchy");
+    
+    retryix_jw_begin_object(w, NULL);
+    retryix_jw_string(w, "level", "L1 Cache");
+    retryix_jw_string(w, "type", "Data + Instruction");
+    retryix_jw_number(w, "size_kb", 64);
+    retryix_jw_number(w, "latency_cycles", 4);
+    retryix_jw_end_object(w);
+    
+    retryix_jw_begin_object(w, NULL);
+    retryix_jw_string(w, "level", "L2 Cache");
+    retryix_jw_string(w, "type", "Unified");
+    retryix_jw_number(w, "size_kb", 512);
+    retryix_jw_number(w, "latency_cycles", 12);
+    retryix_jw_end_object(w);
+    
+    retryix_jw_begin_object(w, NULL);
+    retryix_jw_string(w, "level", "L3 Cache");
+    retryix_jw_string(w, "type", "Shared");
+    retryix_jw_number(w, "size_mb", 16);
+    retryix_jw_number(w, "latency_cycles", 40);
+    retryix_jw_end_object(w);
+    
+    retryix_jw_begin_object(w, NULL);
+    retryix_jw_string(w, "level", "Main Memory");
+    retryix_jw_string(w, "type", "DDR4/DDR5");
+    retryix_jw_number(w, "size_gb", 32);
+    retryix_jw_number(w, "latency_ns", 80);
+    retryix_jw_end_object(w);
+    
+    retryix_jw_end_array(w);
     
     // NUMA 配置（檢測實際配置）
-    cJSON *numa = cJSON_CreateObject();
+    retryix_jw_begin_object(w, "numa");
     
 #ifdef _WIN32
     // Windows: 使用 GetLogicalProcessorInformationEx 檢測 NUMA 節點
@@ -574,48 +544,126 @@ RETRYIX_API char* RETRYIX_CALL retryix_discover_svm_topology_json(void) {
         if (buffer) free(buffer);
     }
     
-    cJSON_AddNumberToObject(numa, "node_count", numa_nodes);
-    cJSON_AddBoolToObject(numa, "numa_enabled", numa_enabled);
-    cJSON_AddStringToObject(numa, "allocation_policy", numa_enabled ? "NUMA-Aware" : "Local-First");
-    cJSON_AddStringToObject(numa, "topology", numa_nodes == 1 ? "Uniform Memory Access (UMA)" : "Non-Uniform Memory Access (NUMA)");
+    retryix_jw_number(w, "node_count", numa_nodes);
+    retryix_jw_bool(w, "numa_enabled", numa_enabled);
+    retryix_jw_string(w, "allocation_policy", numa_enabled ? "NUMA-Aware" : "Local-First");
+    retryix_jw_string(w, "topology", numa_nodes == 1 ? "Uniform Memory Access (UMA)" : "Non-Uniform Memory Access (NUMA)");
 #else
-    cJSON_AddNumberToObject(numa, "node_count", 1);
-    cJSON_AddBoolToObject(numa, "numa_enabled", false);
-    cJSON_AddStringToObject(numa, "allocation_policy", "Local-First");
-    cJSON_AddStringToObject(numa, "topology", "Uniform Memory Access (UMA)");
+    retryix_jw_number(w, "node_count", 1);
+    retryix_jw_bool(w, "numa_enabled", false);
+    retryix_jw_string(w, "allocation_policy", "Local-First");
+    retryix_jw_string(w, "topology", "Uniform Memory Access (UMA)");
 #endif
     
-    cJSON_AddItemToObject(root, "numa", numa);
+    retryix_jw_end_object(w);
     
     // SVM 能力
-    cJSON *svm_capabilities = cJSON_CreateObject();
-    cJSON_AddBoolToObject(svm_capabilities, "coarse_grain_buffer", true);
-    cJSON_AddBoolToObject(svm_capabilities, "fine_grain_buffer", true);
-    cJSON_AddBoolToObject(svm_capabilities, "fine_grain_system", false);
-    cJSON_AddBoolToObject(svm_capabilities, "atomic_support", true);
-    cJSON_AddItemToObject(root, "svm_capabilities", svm_capabilities);
+    retryix_jw_begin_object(w, "svm_capabilities");
+    retryix_jw_bool(w, "coarse_grain_buffer", true);
+    retryix_jw_bool(w, "fine_grain_buffer", true);
+    retryix_jw_bool(w, "fine_grain_system", false);
+    retryix_jw_bool(w, "atomic_support", true);
+    retryix_jw_end_object(w);
     
     // 分配策略
-    cJSON *allocation = cJSON_CreateArray();
-    cJSON_AddItemToArray(allocation, cJSON_CreateString("Standard"));
-    cJSON_AddItemToArray(allocation, cJSON_CreateString("Aligned"));
-    cJSON_AddItemToArray(allocation, cJSON_CreateString("NUMA-Aware"));
-    cJSON_AddItemToArray(allocation, cJSON_CreateString("Topology-Aware"));
-    cJSON_AddItemToArray(allocation, cJSON_CreateString("Distributed"));
-    cJSON_AddItemToArray(allocation, cJSON_CreateString("Coherent-Group"));
-    cJSON_AddItemToObject(root, "allocation_strategies", allocation);
+    retryix_jw_begin_array(w, "allocation_strategies");
+    retryix_jw_string(w, NULL, "Standard");
+    retryix_jw_string(w, NULL, "Aligned");
+    retryix_jw_string(w, NULL, "NUMA-Aware");
+    retryix_jw_string(w, NULL, "Topology-Aware");
+    retryix_jw_string(w, NULL, "Distributed");
+    retryix_jw_string(w, NULL, "Coherent-Group");
+    retryix_jw_end_array(w);
     
     // 性能監控
-    cJSON *monitoring = cJSON_CreateObject();
-    cJSON_AddBoolToObject(monitoring, "latency_monitor", true);
-    cJSON_AddBoolToObject(monitoring, "bandwidth_monitor", true);
-    cJSON_AddStringToObject(monitoring, "units", "ns / GB/s");
-    cJSON_AddItemToObject(root, "monitoring", monitoring);
-    
-    cJSON_AddStringToObject(root, "version", "RetryIX 3.0.0");
-    cJSON_AddStringToObject(root, "timestamp", __DATE__ " " __TIME__);
-    
-    char* json = cJSON_Print(root);
-    cJSON_Delete(root);
-    return json;
+    retryix_jw_begin_object(w, "monitoring");
+    retryix_jw_bool(w, "latency_monitor", true);
+    retryix_jw_bool(w, "bandwidth_monitor", true);
+    retryix_jw_string(w, "units", "ns / GB/s");
+    retryix_jw_end_object(w);
+    
+    retryix_jw_string(w, "version", "RetryIX 3.0.0");
+    retryix_jw_string(w, "timestamp", __DATE__ " " __TIME__);
+    
+    retryix_jw_end_object(w);
+}
+
+// ===================== 匯出 =====================
+// 所有拓撲輸出都是單趟串流: 欄位直接寫進一塊緩衝區, 預估容量猜準時整次只配置一次;
+// 拓撲種類經快照快取共用 (retryix_topology_cache.c), 健康狀態與停用快取時直接輸出
+
+typedef void (*topology_emit_fn)(retryix_json_writer_t* w, const char* key);
+
+static const struct {
+    topology_emit_fn emit;
+    size_t size_hint;
+} g_topology_emitters[RETRYIX_TOPOLOGY_KIND_COUNT] = {
+    { emit_network_topology,    4096 },
+    { emit_audio_topology,      2048 },
+    { emit_multimodal_topology, 8192 },
+    { emit_atomic_topology,     2048 },
+    { emit_svm_topology,        2048 },
+    { retryix_emit_system_health, 2048 },
+};
+
+void retryix_topology_emit(int kind, retryix_json_writer_t* w)
+{
+    g_topology_emitters[kind].emit(w, NULL);
+}
+
+static char* topology_json(retryix_topology_kind_t kind)
+{
+    char* shared = retryix_topology_cache_json(kind);
+    if (shared) return shared;
+
+    retryix_json_writer_t w;
+    retryix_jw_init(&w, RETRYIX_JW_JSON, g_topology_emitters[kind].size_hint);
+    g_topology_emitters[kind].emit(&w, NULL);
+    return retryix_jw_finish(&w);
+}
+
+RETRYIX_API char* RETRYIX_CALL retryix_discover_network_topology_json(void)
+{
+    return topology_json(RETRYIX_TOPOLOGY_NETWORK);
+}
+
+RETRYIX_API char* RETRYIX_CALL retryix_discover_audio_topology_json(void)
+{
+    return topology_json(RETRYIX_TOPOLOGY_AUDIO);
+}
+
+RETRYIX_API char* RETRYIX_CALL retryix_discover_multimodal_topology_json(void)
+{
+    return topology_json(RETRYIX_TOPOLOGY_MULTIMODAL);
+}
+
+RETRYIX_API char* RETRYIX_CALL retryix_discover_atomic_topology_json(void)
+{
+    return topology_json(RETRYIX_TOPOLOGY_ATOMIC);
+}
+
+RETRYIX_API char* RETRYIX_CALL retryix_discover_svm_topology_json(void)
+{
+    return topology_json(RETRYIX_TOPOLOGY_SVM);
+}
+
+// 二進位快照: 與 JSON 同一段輸出程式; 快取命中時複製快取的 CBOR, 否則直接寫入呼叫端緩衝區
+RETRYIX_API retryix_result_t RETRYIX_CALL retryix_get_topology_snapshot(
+    retryix_topology_kind_t kind,
+    void* buffer,
+    size_t buffer_size,
+    size_t* written)
+{
+    if (!written) return RETRYIX_ERROR_NULL_PTR;
+    if ((int)kind < 0 || kind >= RETRYIX_TOPOLOGY_KIND_COUNT) return RETRYIX_ERROR_INVALID_PARAMETER;
+
+    if (retryix_topology_cache_cbor(kind, buffer, buffer_size, written)) {
+        return (buffer && *written <= buffer_size) ? RETRYIX_SUCCESS : RETRYIX_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    retryix_json_writer_t w;
+    retryix_jw_init_fixed(&w, RETRYIX_JW_CBOR, buffer, buffer_size);
+    g_topology_emitters[kind].emit(&w, NULL);
+    *written = retryix_jw_length(&w);
+    return retryix_jw_finish(&w) ? RETRYIX_SUCCESS : RETRYIX_ERROR_BUFFER_TOO_SMALL;
 }
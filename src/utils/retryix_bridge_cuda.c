@@ -4,22 +4,17 @@
 #include <string.h>
 
 
-// 動態載入工具
-#ifdef _WIN32
-#include <windows.h>
+// 動態載入工具: cudart 由共用載入器開啟一次, 符號首次使用時解析
+#include "retryix_runtime_loader_internal.h"
 #include <stdio.h>
-#define DLOPEN(x)   LoadLibraryA(x)
-#define DLSYM(h, n) GetProcAddress((HMODULE)h, n)
-#define DLCLOSE(h)  FreeLibrary((HMODULE)h)
-#else
-#include <dlfcn.h>
-#define DLOPEN(x)   dlopen(x, RTLD_NOW)
-#define DLSYM(h, n) dlsym(h, n)
-#define DLCLOSE(h)  dlclose(h)
-#endif
 
 #ifdef RETRYIX_HAS_CUDA
 #include <cuda_runtime.h>
+
+typedef cudaError_t (*PFN_cudaGetDeviceCount)(int*);
+typedef cudaError_t (*PFN_cudaGetDeviceProperties)(void*, int);
+static retryix_runtime_lazy_t g_cudaGetDeviceCount = RETRYIX_RUNTIME_LAZY("cudaGetDeviceCount");
+static retryix_runtime_lazy_t g_cudaGetDeviceProperties = RETRYIX_RUNTIME_LAZY("cudaGetDeviceProperties");
 #endif
 
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_cuda_platforms(
@@ -31,46 +26,18 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_cuda_platforms(
         return RETRYIX_ERROR_NULL_PTR;
 #ifdef RETRYIX_HAS_CUDA
 
-    // 動態載入 cudart64_*.dll (Windows) 或 libcudart.so (Linux)
-    void* hCudart = NULL;
-#ifdef _WIN32
-    const char* dlls[] = {
-        "cudart64_120.dll", "cudart64_110.dll", "cudart64_101.dll", "cudart64_100.dll",
-        "cudart64_92.dll", "cudart64_91.dll", "cudart64_90.dll", "cudart64_80.dll"
-    };
-    for (int i = 0; i < sizeof(dlls)/sizeof(dlls[0]); ++i) {
-        hCudart = DLOPEN(dlls[i]);
-        if (hCudart) break;
-    }
-    // Driver API (nvcuda.dll) 可選擇性支援
-    if (!hCudart) hCudart = DLOPEN("nvcuda.dll");
-#else
-    hCudart = DLOPEN("libcudart.so");
-    if (!hCudart) hCudart = DLOPEN("libcudart.so.11.0");
-    if (!hCudart) hCudart = DLOPEN("libcudart.so.10.1");
-    if (!hCudart) hCudart = DLOPEN("libcudart.so.10.0");
-#endif
-    if (!hCudart) {
-        *platform_count = 0;
-        return RETRYIX_ERROR_NO_PLATFORM;
-    }
-
-    typedef cudaError_t (*PFN_cudaGetDeviceCount)(int*);
-    typedef cudaError_t (*PFN_cudaGetDeviceProperties)(void*, int);
-    PFN_cudaGetDeviceCount pCount = (PFN_cudaGetDeviceCount)DLSYM(hCudart, "cudaGetDeviceCount");
-    PFN_cudaGetDeviceProperties pProps = (PFN_cudaGetDeviceProperties)DLSYM(hCudart, "cudaGetDeviceProperties");
+    PFN_cudaGetDeviceCount pCount = (PFN_cudaGetDeviceCount)retryix_runtime_lazy(RETRYIX_RUNTIME_CUDART, &g_cudaGetDeviceCount);
+    PFN_cudaGetDeviceProperties pProps = (PFN_cudaGetDeviceProperties)retryix_runtime_lazy(RETRYIX_RUNTIME_CUDART, &g_cudaGetDeviceProperties);
     if (!pCount || !pProps) {
         *platform_count = 0;
-    DLCLOSE(hCudart);
-    return RETRYIX_ERROR_NO_PLATFORM;
+        return RETRYIX_ERROR_NO_PLATFORM;
     }
 
     int cuda_count = 0;
     cudaError_t err = pCount(&cuda_count);
     if (err != 0 || cuda_count <= 0) {
         *platform_count = 0;
-    DLCLOSE(hCudart);
-    return RETRYIX_ERROR_NO_PLATFORM;
+        return RETRYIX_ERROR_NO_PLATFORM;
     }
     int n = (cuda_count > max_platforms) ? max_platforms : cuda_count;
     int valid_count = 0;
@@ -126,7 +93,6 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_cuda_platforms(
         ++valid_count;
     }
     *platform_count = valid_count;
-    DLCLOSE(hCudart);
     return RETRYIX_SUCCESS;
 #else
     *platform_count = 0;
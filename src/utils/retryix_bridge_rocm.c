@@ -4,20 +4,9 @@
 #include <string.h>
 #include <stdio.h>
 
-// 動態載入 HIP/ROCm 工具
-#ifdef _WIN32
-#include <windows.h>
-#define DLOPEN(x)   LoadLibraryA(x)
-#define DLSYM(h, n) GetProcAddress((HMODULE)h, n)
-#define DLCLOSE(h)  FreeLibrary((HMODULE)h)
-#define RTLD_HANDLE HMODULE
-#else
-#include <dlfcn.h>
-#define DLOPEN(x)   dlopen(x, RTLD_NOW)
-#define DLSYM(h, n) dlsym(h, n)
-#define DLCLOSE(h)  dlclose(h)
-#define RTLD_HANDLE void*
-#endif
+// 動態載入 HIP/ROCm 工具: 程式庫由共用載入器開啟一次 (amdhip64 / libamdhip64 / libhip_hcc),
+// 符號首次使用時解析並快取, 之後的探測不再重新載入
+#include "retryix_runtime_loader_internal.h"
 
 // ---- Minimal HIP typedefs（用函式而非 struct，避免 header 相依） ----
 typedef int hipError_t;
@@ -33,16 +22,14 @@ typedef hipError_t (*PFN_hipRuntimeGetVersion)(int* runtimeVersion);
 
 static inline int hip_ok(hipError_t e) { return e==0; }
 
-static RTLD_HANDLE rix_open_hip(void) {
-#ifdef _WIN32
-    RTLD_HANDLE h = DLOPEN("amdhip64.dll");      // Windows ROCm/HIP
-#else
-    RTLD_HANDLE h = DLOPEN("libamdhip64.so");    // Linux ROCm/HIP (通用名)
-    if (!h) h = DLOPEN("libamdhip64.so.5");      // 版本後綴
-    if (!h) h = DLOPEN("libhip_hcc.so");         // 最後遺產 fallback（舊版）
-#endif
-    return h;
-}
+static retryix_runtime_lazy_t g_hipInit = RETRYIX_RUNTIME_LAZY("hipInit");
+static retryix_runtime_lazy_t g_hipGetDeviceCount = RETRYIX_RUNTIME_LAZY("hipGetDeviceCount");
+static retryix_runtime_lazy_t g_hipDeviceGetName = RETRYIX_RUNTIME_LAZY("hipDeviceGetName");
+static retryix_runtime_lazy_t g_hipDeviceComputeCapability = RETRYIX_RUNTIME_LAZY("hipDeviceComputeCapability");
+static retryix_runtime_lazy_t g_hipDriverGetVersion = RETRYIX_RUNTIME_LAZY("hipDriverGetVersion");
+static retryix_runtime_lazy_t g_hipRuntimeGetVersion = RETRYIX_RUNTIME_LAZY("hipRuntimeGetVersion");
+
+#define HIP_LAZY(slot) retryix_runtime_lazy(RETRYIX_RUNTIME_HIP, &(slot))
 
 RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_rocm_platforms(
     retryix_platform_t* platforms, int max_platforms, int* platform_count)
@@ -50,19 +37,17 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_rocm_platforms(
     if (!platforms || !platform_count || max_platforms <= 0)
         return RETRYIX_ERROR_NULL_PTR;
 
-    RTLD_HANDLE h = rix_open_hip();
-    if (!h) { *platform_count = 0; return RETRYIX_ERROR_NO_PLATFORM; }
+    if (!retryix_runtime_open(RETRYIX_RUNTIME_HIP)) { *platform_count = 0; return RETRYIX_ERROR_NO_PLATFORM; }
 
     // 綁定必要函式
-    PFN_hipInit                 p_hipInit                 = (PFN_hipInit)(void*)                DLSYM(h, "hipInit");
-    PFN_hipGetDeviceCount       p_hipGetDeviceCount       = (PFN_hipGetDeviceCount)(void*)      DLSYM(h, "hipGetDeviceCount");
-    PFN_hipDeviceGetName        p_hipDeviceGetName        = (PFN_hipDeviceGetName)(void*)       DLSYM(h, "hipDeviceGetName");
-    PFN_hipDeviceComputeCapability p_hipDeviceComputeCapability = (PFN_hipDeviceComputeCapability)(void*) DLSYM(h, "hipDeviceComputeCapability");
-    PFN_hipDriverGetVersion     p_hipDriverGetVersion     = (PFN_hipDriverGetVersion)(void*)    DLSYM(h, "hipDriverGetVersion");
-    PFN_hipRuntimeGetVersion    p_hipRuntimeGetVersion    = (PFN_hipRuntimeGetVersion)(void*)   DLSYM(h, "hipRuntimeGetVersion");
+    PFN_hipInit                 p_hipInit                 = (PFN_hipInit)                HIP_LAZY(g_hipInit);
+    PFN_hipGetDeviceCount       p_hipGetDeviceCount       = (PFN_hipGetDeviceCount)      HIP_LAZY(g_hipGetDeviceCount);
+    PFN_hipDeviceGetName        p_hipDeviceGetName        = (PFN_hipDeviceGetName)       HIP_LAZY(g_hipDeviceGetName);
+    PFN_hipDeviceComputeCapability p_hipDeviceComputeCapability = (PFN_hipDeviceComputeCapability) HIP_LAZY(g_hipDeviceComputeCapability);
+    PFN_hipDriverGetVersion     p_hipDriverGetVersion     = (PFN_hipDriverGetVersion)    HIP_LAZY(g_hipDriverGetVersion);
+    PFN_hipRuntimeGetVersion    p_hipRuntimeGetVersion    = (PFN_hipRuntimeGetVersion)   HIP_LAZY(g_hipRuntimeGetVersion);
 
     if (!p_hipGetDeviceCount || !p_hipDeviceGetName || !p_hipDeviceComputeCapability) {
-        DLCLOSE(h);
         *platform_count = 0;
         return RETRYIX_ERROR_NO_PLATFORM;
     }
@@ -74,7 +59,6 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_rocm_platforms(
 
     int count = 0;
     if (!hip_ok(p_hipGetDeviceCount(&count)) || count <= 0) {
-        DLCLOSE(h);
         *platform_count = 0;
         return RETRYIX_ERROR_NO_PLATFORM;
     }
@@ -108,6 +92,5 @@ RETRYIX_API retryix_result_t RETRYIX_CALL retryix_discover_rocm_platforms(
     }
 
     *platform_count = out;
-    DLCLOSE(h);
     return (out > 0) ? RETRYIX_SUCCESS : RETRYIX_ERROR_NO_PLATFORM;
 }
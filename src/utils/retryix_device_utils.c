@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include "retryix.h"
+#include "retryix_json_writer_internal.h"
 
 // 若 retryix.h 未定義 RetryIXDevice，則補充定義
 #ifndef RETRYIXDEVICE_DEFINED
@@ -30,13 +31,17 @@ DLL_EXPORT retryix_result_t retryix_export_all_devices_json(const char* out_path
     cl_int status = clGetPlatformIDs(8, platforms, &num_platforms);
     if (status != CL_SUCCESS || num_platforms == 0) return -1;
 
-    FILE* fp = fopen(out_path, "w");
-    if (!fp) return -2;
-    fprintf(fp, "{\n  \"platforms\": [\n");
+    // 名稱與擴充字串來自驅動, 須經跳脫; 整份文件寫進一塊緩衝區後一次寫檔
+    retryix_json_writer_t w;
+    retryix_jw_init(&w, RETRYIX_JW_JSON, 16384);
+    retryix_jw_begin_object(&w, NULL);
+    retryix_jw_begin_array(&w, "platforms");
     for (cl_uint p = 0; p < num_platforms; ++p) {
         char plat_name[256] = {0};
         clGetPlatformInfo(platforms[p], CL_PLATFORM_NAME, sizeof(plat_name), plat_name, NULL);
-        fprintf(fp, "    {\n      \"name\": \"%s\",\n      \"devices\": [\n", plat_name);
+        retryix_jw_begin_object(&w, NULL);
+        retryix_jw_string(&w, "name", plat_name);
+        retryix_jw_begin_array(&w, "devices");
 
         cl_device_id devices[32];
         cl_uint num_devices = 0;
@@ -55,14 +60,33 @@ DLL_EXPORT retryix_result_t retryix_export_all_devices_json(const char* out_path
             clGetDeviceInfo(devices[d], CL_DEVICE_EXTENSIONS, sizeof(extensions), extensions, NULL);
             clGetDeviceInfo(devices[d], CL_DEVICE_SVM_CAPABILITIES, sizeof(svm_caps), &svm_caps, NULL);
 
-            fprintf(fp, "        {\n          \"name\": \"%s\",\n          \"type\": %lu,\n          \"global_mem_size\": %llu,\n          \"opencl_version\": \"%s\",\n          \"extensions\": \"%s\",\n          \"svm_capabilities\": %llu\n        }%s\n",
-                dev_name, (unsigned long)dev_type, (unsigned long long)mem, version, extensions, (unsigned long long)svm_caps,
-                (d == num_devices-1) ? "" : ",");
+            retryix_jw_begin_object(&w, NULL);
+            retryix_jw_string(&w, "name", dev_name);
+            retryix_jw_int(&w, "type", (long long)dev_type);
+            retryix_jw_int(&w, "global_mem_size", (long long)mem);
+            retryix_jw_string(&w, "opencl_version", version);
+            retryix_jw_string(&w, "extensions", extensions);
+            retryix_jw_int(&w, "svm_capabilities", (long long)svm_caps);
+            retryix_jw_end_object(&w);
         }
-        fprintf(fp, "      ]\n    }%s\n", (p == num_platforms-1) ? "" : ",");
+        retryix_jw_end_array(&w);
+        retryix_jw_end_object(&w);
     }
-    fprintf(fp, "  ]\n}\n");
-    fclose(fp);
+    retryix_jw_end_array(&w);
+    retryix_jw_end_object(&w);
+
+    size_t len = retryix_jw_length(&w);
+    char* json = retryix_jw_finish(&w);
+    if (!json) return -2;
+
+    FILE* fp = fopen(out_path, "w");
+    if (!fp) {
+        retryix_free_json(json);
+        return -2;
+    }
+    size_t out = fwrite(json, 1, len, fp);
+    retryix_free_json(json);
+    if (fclose(fp) != 0 || out != len) return -2;
     return 0;
 }
 
@@ -99,15 +123,17 @@ DLL_EXPORT int retryix_get_device_info(int device_index, RetryIXDeviceInfo* info
 DLL_EXPORT int retryix_export_device_info_json(int device_index, char* json_buffer, int buffer_size) {
     RetryIXDeviceInfo info;
     if (retryix_get_device_info(device_index, &info) != 0) return -1;
-
-    snprintf(json_buffer, buffer_size,
-        "{ \"name\": \"%s\", \"type\": %lu, \"global_mem_size\": %llu, \"opencl_version\": \"%s\" }",
-        info.name,
-        (unsigned long)info.type,
-        (unsigned long long)info.global_mem_size,
-        info.opencl_version
-    );
-    return 0;
+    if (!json_buffer || buffer_size <= 0) return -2;
+
+    retryix_json_writer_t w;
+    retryix_jw_init_fixed(&w, RETRYIX_JW_JSON, json_buffer, (size_t)buffer_size);
+    retryix_jw_begin_object(&w, NULL);
+    retryix_jw_string(&w, "name", info.name);
+    retryix_jw_int(&w, "type", (long long)info.type);
+    retryix_jw_int(&w, "global_mem_size", (long long)info.global_mem_size);
+    retryix_jw_string(&w, "opencl_version", info.opencl_version);
+    retryix_jw_end_object(&w);
+    return retryix_jw_finish(&w) ? 0 : -2;
 }
 
 DLL_EXPORT int retryix_enumerate_platforms(char* buffer, int buffer_size) {
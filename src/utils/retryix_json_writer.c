@@ -0,0 +1,413 @@
+// retryix_json_writer.c
+// 單趟串流 JSON / CBOR 寫入器 - 拓撲與健康狀態匯出共用
+// RetryIX 3.0.0 魯班
+#ifndef RETRYIX_BUILD_DLL
+#define RETRYIX_BUILD_DLL
+#endif
+
+#include "retryix_json_writer_internal.h"
+#include "retryix_utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ===================== 緩衝區 =====================
+// 堆積模式的配置區塊: [retryix_json_shared_t][輸出], buf 指向輸出起點
+
+#define JW_HEADER sizeof(retryix_json_shared_t)
+
+static void jw_shared_free(retryix_json_shared_t* self) {
+    free(self);
+}
+
+void retryix_jw_init(retryix_json_writer_t* w, retryix_jw_format_t format, size_t initial_capacity) {
+    memset(w, 0, sizeof(*w));
+    w->format = format;
+    w->heap = 1;
+    w->cap = initial_capacity ? initial_capacity : 1024;
+    unsigned char* block = (unsigned char*)malloc(JW_HEADER + w->cap);
+    if (!block) {
+        w->cap = 0;
+        w->failed = 1;
+        return;
+    }
+    w->buf = block + JW_HEADER;
+}
+
+void retryix_jw_init_fixed(retryix_json_writer_t* w, retryix_jw_format_t format, void* buffer, size_t size) {
+    memset(w, 0, sizeof(*w));
+    w->format = format;
+    w->buf = (unsigned char*)buffer;
+    w->cap = buffer ? size : 0;
+}
+
+// 確保還能寫入 n 個位元組; 固定緩衝區不足時只累計長度
+static int jw_reserve(retryix_json_writer_t* w, size_t n) {
+    if (w->len + n <= w->cap) return 1;
+    if (!w->heap || w->failed) return 0;
+
+    size_t cap = w->cap * 2;
+    while (cap < w->len + n) cap *= 2;
+    unsigned char* grown = (unsigned char*)realloc(w->buf - JW_HEADER, JW_HEADER + cap);
+    if (!grown) {
+        w->failed = 1;
+        return 0;
+    }
+    w->buf = grown + JW_HEADER;
+    w->cap = cap;
+    return 1;
+}
+
+static void jw_put(retryix_json_writer_t* w, const void* data, size_t n) {
+    if (jw_reserve(w, n)) memcpy(w->buf + w->len, data, n);
+    w->len += n;
+}
+
+static void jw_byte(retryix_json_writer_t* w, unsigned char c) {
+    if (jw_reserve(w, 1)) w->buf[w->len] = c;
+    w->len++;
+}
+
+// ===================== JSON =====================
+
+static void json_string(retryix_json_writer_t* w, const char* s) {
+    static const char hex[] = "0123456789abcdef";
+    jw_byte(w, '"');
+    const unsigned char* run = (const unsigned char*)s;
+    const unsigned char* p = run;
+    for (; *p; p++) {
+        unsigned char c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // 連續的一般字元整段複製, UTF-8 原樣輸出
+        jw_put(w, run, (size_t)(p - run));
+        char esc[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t n = 2;
+        switch (c) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b';  break;
+            case '\f': esc[1] = 'f';  break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            default:
+                esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+                esc[4] = hex[c >> 4]; esc[5] = hex[c & 0x0F];
+                n = 6;
+                break;
+        }
+        jw_put(w, esc, n);
+        run = p + 1;
+    }
+    jw_put(w, run, (size_t)(p - run));
+    jw_byte(w, '"');
+}
+
+static void json_number(retryix_json_writer_t* w, double value) {
+    char text[32];
+    int n;
+    if (!isfinite(value)) {
+        n = snprintf(text, sizeof(text), "null");
+    } else if (value == floor(value) && fabs(value) < 1e15) {
+        n = snprintf(text, sizeof(text), "%lld", (long long)value);
+    } else {
+        // 與 cJSON 相同: 15 位有效數字不能還原時改用 17 位
+        n = snprintf(text, sizeof(text), "%1.15g", value);
+        if (strtod(text, NULL) != value) n = snprintf(text, sizeof(text), "%1.17g", value);
+    }
+    jw_put(w, text, (size_t)n);
+}
+
+// ===================== CBOR =====================
+
+static void cbor_head(retryix_json_writer_t* w, unsigned char major, unsigned long long value) {
+    unsigned char head[9];
+    size_t n;
+    major = (unsigned char)(major << 5);
+    if (value < 24) {
+        head[0] = (unsigned char)(major | value);
+        n = 1;
+    } else if (value <= 0xFF) {
+        head[0] = major | 24;
+        n = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = major | 25;
+        n = 3;
+    } else if (value <= 0xFFFFFFFFULL) {
+        head[0] = major | 26;
+        n = 5;
+    } else {
+        head[0] = major | 27;
+        n = 9;
+    }
+    for (size_t i = n - 1; i >= 1; i--) {
+        head[i] = (unsigned char)(value & 0xFF);
+        value >>= 8;
+    }
+    jw_put(w, head, n);
+}
+
+static void cbor_string(retryix_json_writer_t* w, const char* s) {
+    size_t len = strlen(s);
+    cbor_head(w, 3, len);
+    jw_put(w, s, len);
+}
+
+static void cbor_int(retryix_json_writer_t* w, long long value) {
+    if (value >= 0) cbor_head(w, 0, (unsigned long long)value);
+    else cbor_head(w, 1, (unsigned long long)(-1 - value));
+}
+
+static void cbor_number(retryix_json_writer_t* w, double value) {
+    if (isfinite(value) && value == floor(value) && fabs(value) < 9e15) {
+        cbor_int(w, (long long)value);
+        return;
+    }
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned char out[9];
+    out[0] = 0xFB;
+    for (int i = 8; i >= 1; i--) {
+        out[i] = (unsigned char)(bits & 0xFF);
+        bits >>= 8;
+    }
+    jw_put(w, out, sizeof(out));
+}
+
+// ===================== 結構 =====================
+
+// 每個值之前: 陣列/物件內補逗號, 物件內先寫欄位名稱
+static void jw_value_prefix(retryix_json_writer_t* w, const char* key) {
+    int level = w->depth > 0 ? w->depth - 1 : -1;
+    if (w->format == RETRYIX_JW_CBOR) {
+        if (key) cbor_string(w, key);
+        return;
+    }
+    if (level >= 0) {
+        if (w->has_items[level]) jw_byte(w, ',');
+        w->has_items[level] = 1;
+    }
+    if (key) {
+        json_string(w, key);
+        jw_byte(w, ':');
+    }
+}
+
+static void jw_open(retryix_json_writer_t* w, const char* key, unsigned char json_open, unsigned char cbor_open) {
+    jw_value_prefix(w, key);
+    jw_byte(w, w->format == RETRYIX_JW_CBOR ? cbor_open : json_open);
+    if (w->depth >= RETRYIX_JW_MAX_DEPTH) {
+        w->failed = 1;
+        return;
+    }
+    w->has_items[w->depth++] = 0;
+}
+
+static void jw_close(retryix_json_writer_t* w, unsigned char json_close) {
+    jw_byte(w, w->format == RETRYIX_JW_CBOR ? 0xFF : json_close);
+    if (w->depth > 0) w->depth--;
+}
+
+void retryix_jw_begin_object(retryix_json_writer_t* w, const char* key) { jw_open(w, key, '{', 0xBF); }
+void retryix_jw_end_object(retryix_json_writer_t* w)                    { jw_close(w, '}'); }
+void retryix_jw_begin_array(retryix_json_writer_t* w, const char* key)  { jw_open(w, key, '[', 0x9F); }
+void retryix_jw_end_array(retryix_json_writer_t* w)                     { jw_close(w, ']'); }
+
+void retryix_jw_string(retryix_json_writer_t* w, const char* key, const char* value) {
+    jw_value_prefix(w, key);
+    if (w->format == RETRYIX_JW_CBOR) {
+        if (value) cbor_string(w, value);
+        else jw_byte(w, 0xF6);
+    } else {
+        if (value) json_string(w, value);
+        else jw_put(w, "null", 4);
+    }
+}
+
+void retryix_jw_number(retryix_json_writer_t* w, const char* key, double value) {
+    jw_value_prefix(w, key);
+    if (w->format == RETRYIX_JW_CBOR) cbor_number(w, value);
+    else json_number(w, value);
+}
+
+void retryix_jw_int(retryix_json_writer_t* w, const char* key, long long value) {
+    jw_value_prefix(w, key);
+    if (w->format == RETRYIX_JW_CBOR) {
+        cbor_int(w, value);
+    } else {
+        char text[24];
+        int n = snprintf(text, sizeof(text), "%lld", value);
+        jw_put(w, text, (size_t)n);
+    }
+}
+
+void retryix_jw_bool(retryix_json_writer_t* w, const char* key, int value) {
+    jw_value_prefix(w, key);
+    if (w->format == RETRYIX_JW_CBOR) jw_byte(w, value ? 0xF5 : 0xF4);
+    else if (value) jw_put(w, "true", 4);
+    else jw_put(w, "false", 5);
+}
+
+char* retryix_jw_finish(retryix_json_writer_t* w) {
+    size_t len = w->len;
+    if (w->format == RETRYIX_JW_JSON) {
+        jw_byte(w, '\0');
+        w->len = len;               // 結尾 '\0' 不計入長度
+    }
+    int ok = !w->failed && w->depth == 0 && len + (w->format == RETRYIX_JW_JSON) <= w->cap;
+    if (!ok) {
+        retryix_jw_discard(w);
+        return NULL;
+    }
+    char* out = (char*)w->buf;
+    if (w->heap) ((retryix_json_shared_t*)(w->buf - JW_HEADER))->release = jw_shared_free;
+    w->buf = NULL;
+    w->cap = 0;
+    return out;
+}
+
+void retryix_jw_discard(retryix_json_writer_t* w) {
+    if (w->heap && w->buf) free(w->buf - JW_HEADER);
+    w->buf = NULL;
+    w->cap = 0;
+}
+
+size_t retryix_jw_length(const retryix_json_writer_t* w) {
+    return w->len;
+}
+
+// ===================== CBOR 重播 =====================
+// 只需處理本寫入器產生的子集: 整數、文字、float64、true/false/null、不定長容器
+
+typedef struct {
+    const unsigned char* p;
+    const unsigned char* end;
+} cbor_reader_t;
+
+static int cbor_read_arg(cbor_reader_t* r, unsigned char info, unsigned long long* value) {
+    size_t n;
+    if (info < 24) {
+        *value = info;
+        return 1;
+    }
+    switch (info) {
+        case 24: n = 1; break;
+        case 25: n = 2; break;
+        case 26: n = 4; break;
+        case 27: n = 8; break;
+        default: return 0;
+    }
+    if ((size_t)(r->end - r->p) < n) return 0;
+    unsigned long long v = 0;
+    for (size_t i = 0; i < n; i++) v = (v << 8) | r->p[i];
+    r->p += n;
+    *value = v;
+    return 1;
+}
+
+static int cbor_replay_item(cbor_reader_t* r, retryix_json_writer_t* w, const char* key, int depth);
+
+// 讀一個文字字串到暫存 (欄位名稱與字串值都不長, 超長時截斷不影響結構)
+static int cbor_read_text(cbor_reader_t* r, unsigned long long len, char* out, size_t out_size) {
+    if ((unsigned long long)(r->end - r->p) < len) return 0;
+    size_t copy = len < out_size - 1 ? (size_t)len : out_size - 1;
+    memcpy(out, r->p, copy);
+    out[copy] = '\0';
+    r->p += len;
+    return 1;
+}
+
+static int cbor_replay_container(cbor_reader_t* r, retryix_json_writer_t* w, int is_map, int depth) {
+    if (depth >= RETRYIX_JW_MAX_DEPTH) return 0;
+    for (;;) {
+        if (r->p >= r->end) return 0;
+        if (*r->p == 0xFF) {
+            r->p++;
+            return 1;
+        }
+        if (!is_map) {
+            if (!cbor_replay_item(r, w, NULL, depth + 1)) return 0;
+            continue;
+        }
+        unsigned char ib = *r->p++;
+        unsigned long long len;
+        char name[256];
+        if ((ib >> 5) != 3 || !cbor_read_arg(r, ib & 31, &len) || !cbor_read_text(r, len, name, sizeof(name))) return 0;
+        if (!cbor_replay_item(r, w, name, depth + 1)) return 0;
+    }
+}
+
+static int cbor_replay_item(cbor_reader_t* r, retryix_json_writer_t* w, const char* key, int depth) {
+    if (r->p >= r->end) return 0;
+    unsigned char ib = *r->p++;
+    unsigned char major = ib >> 5, info = ib & 31;
+    unsigned long long arg;
+
+    switch (major) {
+        case 0:
+        case 1:
+            if (!cbor_read_arg(r, info, &arg)) return 0;
+            retryix_jw_int(w, key, major == 0 ? (long long)arg : -1 - (long long)arg);
+            return 1;
+        case 3: {
+            if (!cbor_read_arg(r, info, &arg)) return 0;
+            if ((unsigned long long)(r->end - r->p) < arg) return 0;
+            // 字串值可能較長 (如 OpenCL 擴充清單), 超過堆疊暫存時另外配置
+            char stack_text[512];
+            char* text = arg < sizeof(stack_text) ? stack_text : (char*)malloc((size_t)arg + 1);
+            if (!text) return 0;
+            memcpy(text, r->p, (size_t)arg);
+            text[arg] = '\0';
+            r->p += arg;
+            retryix_jw_string(w, key, text);
+            if (text != stack_text) free(text);
+            return 1;
+        }
+        case 4:
+        case 5:
+            if (info != 31) return 0;
+            if (major == 4) retryix_jw_begin_array(w, key);
+            else retryix_jw_begin_object(w, key);
+            if (!cbor_replay_container(r, w, major == 5, depth)) return 0;
+            if (major == 4) retryix_jw_end_array(w);
+            else retryix_jw_end_object(w);
+            return 1;
+        case 7:
+            if (info == 20 || info == 21) {
+                retryix_jw_bool(w, key, info == 21);
+                return 1;
+            }
+            if (info == 22) {
+                retryix_jw_string(w, key, NULL);
+                return 1;
+            }
+            if (info == 27 && r->end - r->p >= 8) {
+                unsigned long long bits = 0;
+                double value;
+                for (int i = 0; i < 8; i++) bits = (bits << 8) | r->p[i];
+                r->p += 8;
+                memcpy(&value, &bits, sizeof(value));
+                retryix_jw_number(w, key, value);
+                return 1;
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+int retryix_jw_replay_cbor(retryix_json_writer_t* w, const void* cbor, size_t size) {
+    cbor_reader_t r;
+    r.p = (const unsigned char*)cbor;
+    r.end = r.p + size;
+    return cbor_replay_item(&r, w, NULL, 0) && r.p == r.end;
+}
+
+// 所有 *_json 匯出函數回傳的字串都由此釋放 (一般輸出或共用快照)
+RETRYIX_API void RETRYIX_CALL retryix_free_json(char* json) {
+    if (!json) return;
+    retryix_json_shared_t* header = (retryix_json_shared_t*)(json - sizeof(retryix_json_shared_t));
+    header->release(header);
+}
@@ -0,0 +1,259 @@
+// retryix_runtime_loader.c
+// 共用執行時載入器 - Vulkan / CUDA Runtime / HIP 各只載入一次, 符號延遲解析
+// RetryIX 3.0.0 魯班
+
+#include "retryix_runtime_loader_internal.h"
+#include "retryix_atomic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define DLOPEN(x)   ((void*)LoadLibraryA(x))
+#define DLSYM(h, n) ((void*)GetProcAddress((HMODULE)(h), n))
+#define DLCLOSE(h)  FreeLibrary((HMODULE)(h))
+typedef SRWLOCK loader_lock_t;
+#define LOADER_LOCK_INIT         SRWLOCK_INIT
+#define LOCK_ACQUIRE(l)          AcquireSRWLockExclusive(l)
+#define LOCK_RELEASE(l)          ReleaseSRWLockExclusive(l)
+#else
+#include <dlfcn.h>
+#include <pthread.h>
+#define DLOPEN(x)   dlopen(x, RTLD_NOW | RTLD_LOCAL)
+#define DLSYM(h, n) dlsym(h, n)
+#define DLCLOSE(h)  dlclose(h)
+typedef pthread_mutex_t loader_lock_t;
+#define LOADER_LOCK_INIT         PTHREAD_MUTEX_INITIALIZER
+#define LOCK_ACQUIRE(l)          pthread_mutex_lock(l)
+#define LOCK_RELEASE(l)          pthread_mutex_unlock(l)
+#endif
+
+// 鎖的分工: 每個執行時的載入各有一把鎖 (只與同一執行時的首次載入互斥),
+// vkCreateInstance 另有一把; g_loader_lock 只保護實例表, 持有期間不呼叫任何外部程式庫。
+// 因此卡住的 dlopen 或 vkCreateInstance 不會擋住其他執行時的載入與實例引用計數。
+static loader_lock_t g_loader_lock = LOADER_LOCK_INIT;
+static loader_lock_t g_runtime_locks[RETRYIX_RUNTIME_COUNT] = { LOADER_LOCK_INIT, LOADER_LOCK_INIT, LOADER_LOCK_INIT };
+static loader_lock_t g_vk_create_lock = LOADER_LOCK_INIT;
+#define LOADER_LOCK()            LOCK_ACQUIRE(&g_loader_lock)
+#define LOADER_UNLOCK()          LOCK_RELEASE(&g_loader_lock)
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+// 依序嘗試的程式庫名稱 (NULL 結尾)
+static const char* const g_vulkan_names[] = {
+#ifdef _WIN32
+    "vulkan-1.dll",
+#elif defined(__APPLE__)
+    "libvulkan.1.dylib", "libMoltenVK.dylib",
+#else
+    "libvulkan.so.1", "libvulkan.so",
+#endif
+    NULL
+};
+
+static const char* const g_cudart_names[] = {
+#ifdef _WIN32
+    "cudart64_120.dll", "cudart64_110.dll", "cudart64_101.dll", "cudart64_100.dll",
+    "cudart64_92.dll", "cudart64_91.dll", "cudart64_90.dll", "cudart64_80.dll",
+    "nvcuda.dll",
+#else
+    "libcudart.so", "libcudart.so.12", "libcudart.so.11.0", "libcudart.so.10.1", "libcudart.so.10.0",
+#endif
+    NULL
+};
+
+static const char* const g_hip_names[] = {
+#ifdef _WIN32
+    "amdhip64.dll",
+#else
+    "libamdhip64.so", "libamdhip64.so.5", "libhip_hcc.so",
+#endif
+    NULL
+};
+
+static const char* const* const g_runtime_names[RETRYIX_RUNTIME_COUNT] = {
+    g_vulkan_names, g_cudart_names, g_hip_names
+};
+
+static void* volatile g_runtime_handles[RETRYIX_RUNTIME_COUNT];
+static volatile int g_runtime_tried[RETRYIX_RUNTIME_COUNT];
+
+void* retryix_runtime_open(retryix_runtime_id_t id) {
+    if ((int)id < 0 || id >= RETRYIX_RUNTIME_COUNT) return NULL;
+    if (RX_LOAD32(&g_runtime_tried[id])) return RX_LOADP(&g_runtime_handles[id]);
+
+    LOCK_ACQUIRE(&g_runtime_locks[id]);
+    if (!g_runtime_tried[id]) {
+        void* handle = NULL;
+        for (const char* const* name = g_runtime_names[id]; *name && !handle; name++) {
+            handle = DLOPEN(*name);
+        }
+        // 程式庫保持載入到行程結束: 逾時放棄的探測執行緒可能仍在其中執行
+        RX_STOREP(&g_runtime_handles[id], handle);
+        RX_STORE32(&g_runtime_tried[id], 1);
+        if (getenv("RETRYIX_DEBUG")) {
+            fprintf(stderr, "[runtime_loader] runtime %d %s\n", (int)id, handle ? "loaded" : "not available");
+        }
+    }
+    void* handle = g_runtime_handles[id];
+    LOCK_RELEASE(&g_runtime_locks[id]);
+    return handle;
+}
+
+void* retryix_runtime_lazy(retryix_runtime_id_t id, retryix_runtime_lazy_t* slot) {
+    void* fn = RX_LOADP(&slot->fn);
+    if (fn) return fn;
+    if (RX_LOAD32(&slot->missing)) return NULL;
+
+    void* handle = retryix_runtime_open(id);
+    fn = handle ? DLSYM(handle, slot->name) : NULL;
+    // 多個執行緒同時解析時寫入同一個值, 無害
+    if (fn) RX_STOREP(&slot->fn, fn);
+    else RX_STORE32(&slot->missing, 1);
+    return fn;
+}
+
+// ===================== Vulkan =====================
+
+#define RETRYIX_VK_FN_SLOT_(name) RETRYIX_RUNTIME_LAZY(#name),
+static retryix_runtime_lazy_t g_vk_slots[RETRYIX_VK_FN_COUNT] = {
+    RETRYIX_VK_GLOBAL_FUNCS(RETRYIX_VK_FN_SLOT_)
+};
+#undef RETRYIX_VK_FN_SLOT_
+
+void* retryix_vulkan_fn(retryix_vk_fn_t fn) {
+    if ((int)fn < 0 || fn >= RETRYIX_VK_FN_COUNT) return NULL;
+    return retryix_runtime_lazy(RETRYIX_RUNTIME_VULKAN, &g_vk_slots[fn]);
+}
+
+// 共用實例表: 最多一個目前實例 (retired = 0); 失效或修剪時仍被引用的實例轉為 retired,
+// 由最後一次釋放銷毀, 新的取用者則建立新實例 (熱插拔後的設備才會被列舉)
+#define VK_INSTANCE_SLOTS 4
+
+typedef struct {
+    VkInstance instance;
+    int refs;
+    int retired;
+} vk_instance_slot_t;
+
+static vk_instance_slot_t g_vk_instances[VK_INSTANCE_SLOTS];
+
+static void vulkan_destroy_instances(VkInstance* doomed, int count) {
+    PFN_vkDestroyInstance destroy = RETRYIX_VK(vkDestroyInstance);
+    for (int i = 0; i < count; i++) {
+        if (destroy) destroy(doomed[i], NULL);
+    }
+}
+
+// 呼叫者持有 g_loader_lock
+static vk_instance_slot_t* vulkan_current_locked(void) {
+    for (int i = 0; i < VK_INSTANCE_SLOTS; i++) {
+        if (g_vk_instances[i].instance != VK_NULL_HANDLE && !g_vk_instances[i].retired) return &g_vk_instances[i];
+    }
+    return NULL;
+}
+
+// 呼叫者持有 g_loader_lock; 取出所有無人引用的 retired 實例 (retire_current 時先將目前實例轉為 retired)
+static int vulkan_collect_locked(int retire_current, VkInstance* doomed) {
+    int count = 0;
+    for (int i = 0; i < VK_INSTANCE_SLOTS; i++) {
+        vk_instance_slot_t* slot = &g_vk_instances[i];
+        if (slot->instance == VK_NULL_HANDLE) continue;
+        if (retire_current) slot->retired = 1;
+        if (slot->retired && slot->refs == 0) {
+            doomed[count++] = slot->instance;
+            memset(slot, 0, sizeof(*slot));
+        }
+    }
+    return count;
+}
+
+static VkInstance vulkan_acquire_current(void) {
+    VkInstance instance = VK_NULL_HANDLE;
+    LOADER_LOCK();
+    vk_instance_slot_t* current = vulkan_current_locked();
+    if (current) {
+        current->refs++;
+        instance = current->instance;
+    }
+    LOADER_UNLOCK();
+    return instance;
+}
+
+struct VkInstance_T* retryix_vulkan_instance_acquire(void) {
+    PFN_vkCreateInstance create = RETRYIX_VK(vkCreateInstance);
+    if (!create || !RETRYIX_VK(vkDestroyInstance)) return NULL;
+
+    VkInstance instance = vulkan_acquire_current();
+    if (instance != VK_NULL_HANDLE) return instance;
+
+    // 同時只建立一個實例; 等待者取得鎖後先看是否已由前一個建立
+    LOCK_ACQUIRE(&g_vk_create_lock);
+    instance = vulkan_acquire_current();
+    if (instance == VK_NULL_HANDLE) {
+        VkApplicationInfo app_info;
+        memset(&app_info, 0, sizeof(app_info));
+        app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        app_info.pApplicationName = "RetryIX";
+        app_info.applicationVersion = VK_MAKE_VERSION(3, 0, 0);
+        app_info.pEngineName = "LuBan";
+        app_info.engineVersion = VK_MAKE_VERSION(3, 0, 0);
+        app_info.apiVersion = VK_API_VERSION_1_0;
+
+        VkInstanceCreateInfo create_info;
+        memset(&create_info, 0, sizeof(create_info));
+        create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        create_info.pApplicationInfo = &app_info;
+
+        if (create(&create_info, NULL, &instance) != VK_SUCCESS) instance = VK_NULL_HANDLE;
+
+        int installed = 0;
+        if (instance != VK_NULL_HANDLE) {
+            LOADER_LOCK();
+            for (int i = 0; i < VK_INSTANCE_SLOTS && !installed; i++) {
+                if (g_vk_instances[i].instance != VK_NULL_HANDLE) continue;
+                g_vk_instances[i].instance = instance;
+                g_vk_instances[i].refs = 1;
+                g_vk_instances[i].retired = 0;
+                installed = 1;
+            }
+            LOADER_UNLOCK();
+        }
+        // 表已被仍在使用的舊實例佔滿: 視為暫時無法取得
+        if (instance != VK_NULL_HANDLE && !installed) {
+            vulkan_destroy_instances(&instance, 1);
+            instance = VK_NULL_HANDLE;
+        }
+    }
+    LOCK_RELEASE(&g_vk_create_lock);
+    return instance;
+}
+
+void retryix_vulkan_instance_release(struct VkInstance_T* instance) {
+    if (instance == VK_NULL_HANDLE) return;
+    VkInstance doomed[VK_INSTANCE_SLOTS];
+    int count = 0;
+    LOADER_LOCK();
+    for (int i = 0; i < VK_INSTANCE_SLOTS; i++) {
+        vk_instance_slot_t* slot = &g_vk_instances[i];
+        if (slot->instance != instance || slot->refs == 0) continue;
+        if (--slot->refs == 0 && slot->retired) count = vulkan_collect_locked(0, doomed);
+        break;
+    }
+    LOADER_UNLOCK();
+    vulkan_destroy_instances(doomed, count);
+}
+
+void retryix_vulkan_instance_invalidate(void) {
+    VkInstance doomed[VK_INSTANCE_SLOTS];
+    LOADER_LOCK();
+    int count = vulkan_collect_locked(1, doomed);
+    LOADER_UNLOCK();
+    vulkan_destroy_instances(doomed, count);
+}
+
+void retryix_runtime_loader_trim(void) {
+    retryix_vulkan_instance_invalidate();
+}